@@ -90,6 +90,34 @@ uint8_t w25qxx_interface_spi_qspi_write_read(uint8_t instruction, uint8_t instru
     return 0;
 }
 
+/**
+ * @brief     interface spi qspi bus select the bus of the calling thread
+ * @param[in] bus is the bus index
+ * @param[in] *name points to the bus device name, NULL keeps the current one
+ * @return    status code
+ *            - 0 success
+ *            - 4 bus is invalid
+ * @note      only hosts with several buses need it, the other hooks of the calling thread
+ *            use this bus until the next call, threads that never call it use bus 0
+ */
+uint8_t w25qxx_interface_spi_qspi_set_bus(uint8_t bus, char *name)
+{
+    return 0;
+}
+
+/**
+ * @brief     interface spi qspi bus set the clock of the calling thread bus
+ * @param[in] freq is the bus clock
+ * @return    status code
+ *            - 0 success
+ *            - 1 set freq failed
+ * @note      a clock set before the bus init is used by the init
+ */
+uint8_t w25qxx_interface_spi_qspi_set_freq(uint32_t freq)
+{
+    return 0;
+}
+
 /**
  * @brief     interface delay ms
  * @param[in] ms
@@ -0,0 +1,215 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      posix_driver_w25qxx_shared_interface.c
+ * @brief     posix driver w25qxx shared test interface source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_shared_test.h"
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+/**
+ * @brief shared test mutex and condition definition
+ */
+static pthread_mutex_t gs_shared_mutex = PTHREAD_MUTEX_INITIALIZER;        /**< shared test mutex */
+static pthread_cond_t gs_shared_cond = PTHREAD_COND_INITIALIZER;           /**< shared test condition */
+
+/**
+ * @brief shared test interface mutex lock
+ * @note  none
+ */
+void w25qxx_shared_test_interface_mutex_lock(void)
+{
+    (void)pthread_mutex_lock(&gs_shared_mutex);
+}
+
+/**
+ * @brief shared test interface mutex unlock
+ * @note  none
+ */
+void w25qxx_shared_test_interface_mutex_unlock(void)
+{
+    (void)pthread_mutex_unlock(&gs_shared_mutex);
+}
+
+/**
+ * @brief shared test interface condition wait
+ * @note  releases the mutex while it sleeps
+ */
+void w25qxx_shared_test_interface_cond_wait(void)
+{
+    (void)pthread_cond_wait(&gs_shared_cond, &gs_shared_mutex);
+}
+
+/**
+ * @brief shared test interface condition broadcast
+ * @note  none
+ */
+void w25qxx_shared_test_interface_cond_broadcast(void)
+{
+    (void)pthread_cond_broadcast(&gs_shared_cond);
+}
+
+/**
+ * @brief  shared test interface timestamp
+ * @return monotonic time in us
+ * @note   none
+ */
+uint64_t w25qxx_shared_test_interface_timestamp_us(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief shared test thread argument definition
+ */
+typedef struct shared_test_thread_s
+{
+    pthread_t thread;                     /**< thread */
+    void (*entry)(uint32_t index);        /**< thread function */
+    uint32_t index;                       /**< thread index */
+} shared_test_thread_t;
+
+/**
+ * @brief     shared test thread entry
+ * @param[in] *arg points to a shared_test_thread_t structure
+ * @return    NULL
+ * @note      none
+ */
+static void *a_shared_test_thread(void *arg)
+{
+    shared_test_thread_t *t = (shared_test_thread_t *)arg;
+    
+    t->entry(t->index);
+    
+    return NULL;
+}
+
+/**
+ * @brief     shared test interface run threads
+ * @param[in] *entry points to the thread function, called with the thread index
+ * @param[in] num is the thread number
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      returns when every thread finished
+ */
+uint8_t w25qxx_shared_test_interface_run(void (*entry)(uint32_t index), uint32_t num)
+{
+    shared_test_thread_t *t;
+    uint32_t started;
+    uint8_t res;
+    
+    t = (shared_test_thread_t *)malloc(sizeof(shared_test_thread_t) * num);
+    if (t == NULL)
+    {
+        return 1;
+    }
+    res = 0;
+    for (started = 0; started < num; started++)
+    {
+        t[started].entry = entry;
+        t[started].index = started;
+        if (pthread_create(&t[started].thread, NULL, a_shared_test_thread, &t[started]) != 0)
+        {
+            res = 1;
+            
+            break;
+        }
+    }
+    while (started != 0)
+    {
+        started--;
+        (void)pthread_join(t[started].thread, NULL);
+    }
+    free(t);
+    
+    return res;
+}
+
+/**
+ * @brief shared test discard worker definition
+ */
+static pthread_t gs_worker;                 /**< discard worker thread */
+static uint8_t gs_worker_res;               /**< discard worker result */
+
+/**
+ * @brief     shared test discard worker entry
+ * @param[in] *arg points to a w25qxx_shared_t structure
+ * @return    NULL
+ * @note      none
+ */
+static void *a_shared_test_worker(void *arg)
+{
+    gs_worker_res = w25qxx_shared_discard_worker((w25qxx_shared_t *)arg);
+    
+    return NULL;
+}
+
+/**
+ * @brief     shared test interface start the discard worker
+ * @param[in] *shared points to an inited w25qxx shared structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 start failed
+ * @note      runs w25qxx_shared_discard_worker on its own thread
+ */
+uint8_t w25qxx_shared_test_interface_worker_start(w25qxx_shared_t *shared)
+{
+    gs_worker_res = 0;
+    if (pthread_create(&gs_worker, NULL, a_shared_test_worker, shared) != 0)
+    {
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     shared test interface stop the discard worker
+ * @param[in] *shared points to the w25qxx shared structure of the worker
+ * @return    status code of w25qxx_shared_discard_worker
+ * @note      returns when the worker thread finished
+ */
+uint8_t w25qxx_shared_test_interface_worker_stop(w25qxx_shared_t *shared)
+{
+    (void)w25qxx_shared_discard_stop(shared);
+    (void)pthread_join(gs_worker, NULL);
+    
+    return gs_worker_res;
+}
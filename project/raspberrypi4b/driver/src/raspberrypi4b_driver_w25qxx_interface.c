@@ -35,6 +35,9 @@
  */
 
 #include "driver_w25qxx_interface.h"
+#include "driver_w25qxx_benchmark_test.h"
+#include "driver_w25qxx_shared_test.h"
+#include "delay.h"
 #include "spi.h"
 #include <stdarg.h>
 
@@ -42,10 +45,16 @@
  * @brief spi device name definition
  */
 #define SPI_DEVICE_NAME "/dev/spidev0.0"    /**< spi device name */
+#define SPI_BUS_MAX     8                   /**< max buses */
+#define SPI_FREQ        1000000             /**< default spi clock */
 /**
  * @brief spi device hanble definition
  */
-static int gs_fd;                           /**< spi handle */
+static int gs_fd[SPI_BUS_MAX];                                     /**< spi handle of every bus */
+static char *gs_name[SPI_BUS_MAX] = {SPI_DEVICE_NAME};             /**< spi device of every bus */
+static uint32_t gs_freq[SPI_BUS_MAX];                              /**< spi clock of every bus, 0 is SPI_FREQ */
+static uint8_t gs_inited[SPI_BUS_MAX];                             /**< inited flag of every bus */
+static __thread uint8_t gs_bus;                                    /**< bus of the calling thread */
 
 /**
  * @brief  interface spi qspi bus init
@@ -56,7 +65,16 @@ static int gs_fd;                           /**< spi handle */
  */
 uint8_t w25qxx_interface_spi_qspi_init(void)
 {
-    return spi_init(SPI_DEVICE_NAME, &gs_fd, SPI_MODE_TYPE_3, 1000 * 1000);
+    uint32_t freq;
+    
+    freq = (gs_freq[gs_bus] != 0) ? gs_freq[gs_bus] : SPI_FREQ;
+    if (spi_init(gs_name[gs_bus], &gs_fd[gs_bus], SPI_MODE_TYPE_3, freq) != 0)
+    {
+        return 1;
+    }
+    gs_inited[gs_bus] = 1;
+    
+    return 0;
 }
 
 /**
@@ -68,7 +86,9 @@ uint8_t w25qxx_interface_spi_qspi_init(void)
  */
 uint8_t w25qxx_interface_spi_qspi_deinit(void)
 {
-    return spi_deinit(gs_fd);
+    gs_inited[gs_bus] = 0;
+    
+    return spi_deinit(gs_fd[gs_bus]);
 }
 
 /**
@@ -103,7 +123,50 @@ uint8_t w25qxx_interface_spi_qspi_write_read(uint8_t instruction, uint8_t instru
         return 1;
     }
     
-    return spi_write_read(gs_fd, in_buf, in_len, out_buf, out_len);
+    return spi_write_read(gs_fd[gs_bus], in_buf, in_len, out_buf, out_len);
+}
+
+/**
+ * @brief     interface spi qspi bus select the bus of the calling thread
+ * @param[in] bus is the bus index
+ * @param[in] *name points to the spidev device of the bus, NULL keeps the current one
+ * @return    status code
+ *            - 0 success
+ *            - 4 bus is invalid
+ * @note      none
+ */
+uint8_t w25qxx_interface_spi_qspi_set_bus(uint8_t bus, char *name)
+{
+    if (bus >= SPI_BUS_MAX)
+    {
+        return 4;
+    }
+    if (name != NULL)
+    {
+        gs_name[bus] = name;
+    }
+    gs_bus = bus;
+    
+    return 0;
+}
+
+/**
+ * @brief     interface spi qspi bus set the clock of the calling thread bus
+ * @param[in] freq is the spi clock
+ * @return    status code
+ *            - 0 success
+ *            - 1 set freq failed
+ * @note      the clock is kept for the next init of the bus
+ */
+uint8_t w25qxx_interface_spi_qspi_set_freq(uint32_t freq)
+{
+    gs_freq[gs_bus] = freq;
+    if (gs_inited[gs_bus] == 0)
+    {
+        return 0;
+    }
+    
+    return spi_set_freq(gs_fd[gs_bus], freq);
 }
 
 /**
@@ -113,7 +176,7 @@ uint8_t w25qxx_interface_spi_qspi_write_read(uint8_t instruction, uint8_t instru
  */
 void w25qxx_interface_delay_ms(uint32_t ms)
 {
-    usleep(1000 * ms);
+    delay_ms(ms);
 }
 
 /**
@@ -123,7 +186,7 @@ void w25qxx_interface_delay_ms(uint32_t ms)
  */
 void w25qxx_interface_delay_us(uint32_t us)
 {
-    usleep(us);
+    delay_us(us);
 }
 
 /**
@@ -153,3 +216,13 @@ uint16_t w25qxx_interface_debug_print(char *fmt, ...)
         return len;
     }
 }
+
+/**
+ * @brief  benchmark test interface timestamp
+ * @return monotonic time in us
+ * @note   uses the posix shared test clock
+ */
+uint64_t w25qxx_benchmark_test_interface_timestamp_us(void)
+{
+    return w25qxx_shared_test_interface_timestamp_us();
+}
@@ -0,0 +1,82 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      delay.h
+ * @brief     delay header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-02-12
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/02/12  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DELAY_H_
+#define _DELAY_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief delay definition
+ */
+#define DELAY_SPIN_US            100        /**< waits below this are spun */
+#define DELAY_REALTIME_PRIORITY  50         /**< default SCHED_FIFO priority */
+
+/**
+ * @brief     delay us
+ * @param[in] us is the delay time
+ * @note      short waits spin on CLOCK_MONOTONIC, long waits sleep with clock_nanosleep
+ *            until the calibrated wake up latency before the deadline and spin the rest
+ */
+void delay_us(uint32_t us);
+
+/**
+ * @brief     delay ms
+ * @param[in] ms is the delay time
+ * @note      none
+ */
+void delay_ms(uint32_t ms);
+
+/**
+ * @brief     delay run the calling process in real time
+ * @param[in] priority is the SCHED_FIFO priority
+ * @return    status code
+ *            - 0 success
+ *            - 1 realtime init failed
+ * @note      locks all pages with mlockall and moves the process to SCHED_FIFO,
+ *            needs root or CAP_SYS_NICE and CAP_IPC_LOCK
+ */
+uint8_t delay_realtime_init(int priority);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      delay.c
+ * @brief     delay source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-02-12
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/02/12  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "delay.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/mman.h>
+
+/**
+ * @brief delay calibration definition
+ */
+#define DELAY_CALIBRATE_LOOPS    8          /**< calibration sleeps */
+#define DELAY_CALIBRATE_US       200        /**< calibration sleep time */
+
+static pthread_once_t gs_once = PTHREAD_ONCE_INIT;        /**< calibration once */
+static uint64_t gs_slack_ns = DELAY_SPIN_US * 1000;       /**< wake up latency of clock_nanosleep */
+
+/**
+ * @brief  delay get the monotonic time
+ * @return time in ns
+ * @note   none
+ */
+static uint64_t a_delay_now(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief     delay sleep until a time
+ * @param[in] ns is the monotonic wake up time
+ * @note      none
+ */
+static void a_delay_sleep_until(uint64_t ns)
+{
+    struct timespec ts;
+    
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+    {
+        
+    }
+}
+
+/**
+ * @brief delay calibrate the wake up latency
+ * @note  keeps the worst of DELAY_CALIBRATE_LOOPS sleeps
+ */
+static void a_delay_calibrate(void)
+{
+    uint64_t deadline;
+    uint64_t late;
+    uint64_t worst;
+    uint32_t i;
+    
+    worst = 0;
+    for (i = 0; i < DELAY_CALIBRATE_LOOPS; i++)
+    {
+        deadline = a_delay_now() + DELAY_CALIBRATE_US * 1000;
+        a_delay_sleep_until(deadline);
+        late = a_delay_now() - deadline;
+        worst = (late > worst) ? late : worst;
+    }
+    gs_slack_ns = worst + worst / 2;
+}
+
+/**
+ * @brief     delay us
+ * @param[in] us is the delay time
+ * @note      short waits spin on CLOCK_MONOTONIC, long waits sleep with clock_nanosleep
+ *            until the calibrated wake up latency before the deadline and spin the rest
+ */
+void delay_us(uint32_t us)
+{
+    uint64_t deadline;
+    
+    (void)pthread_once(&gs_once, a_delay_calibrate);
+    deadline = a_delay_now() + (uint64_t)us * 1000;
+    if ((us >= DELAY_SPIN_US) && ((uint64_t)us * 1000 > gs_slack_ns))
+    {
+        a_delay_sleep_until(deadline - gs_slack_ns);
+    }
+    while (a_delay_now() < deadline)
+    {
+        
+    }
+}
+
+/**
+ * @brief     delay ms
+ * @param[in] ms is the delay time
+ * @note      none
+ */
+void delay_ms(uint32_t ms)
+{
+    a_delay_sleep_until(a_delay_now() + (uint64_t)ms * 1000000ULL);
+}
+
+/**
+ * @brief     delay run the calling process in real time
+ * @param[in] priority is the SCHED_FIFO priority
+ * @return    status code
+ *            - 0 success
+ *            - 1 realtime init failed
+ * @note      locks all pages with mlockall and moves the process to SCHED_FIFO,
+ *            needs root or CAP_SYS_NICE and CAP_IPC_LOCK
+ */
+uint8_t delay_realtime_init(int priority)
+{
+    struct sched_param param;
+    
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        perror("delay: mlockall failed");
+        
+        return 1;
+    }
+    param.sched_priority = priority;
+    if (sched_setscheduler(0, SCHED_FIFO, &param) != 0)
+    {
+        perror("delay: sched_setscheduler failed");
+        
+        return 1;
+    }
+    
+    return 0;
+}
@@ -139,6 +139,36 @@ uint8_t spi_deinit(int fd)
     }
 }
 
+/**
+ * @brief     spi bus set the frequence
+ * @param[in] fd is the spi device handle
+ * @param[in] freq is the spi running frequence
+ * @return    status code
+ *            - 0 success
+ *            - 1 set frequence failed
+ * @note      none
+ */
+uint8_t spi_set_freq(int fd, uint32_t freq)
+{
+    int i;
+    
+    i = freq;                                                    /* set spi frequence */
+    if (ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &i) < 0)              /* set write max frequence */
+    {
+        perror("spi: set spi write speed failed.\n");            /* set spi write speed failed */
+     
+        return 1;                                                /* return error */
+    }
+    if (ioctl(fd, SPI_IOC_RD_MAX_SPEED_HZ, &i) < 0)              /* set read max frequence */
+    {
+        perror("spi: set spi read speed failed.\n");             /* set spi read speed failed */
+     
+        return 1;                                                /* return error */
+    }
+    
+    return 0;                                                    /* success return 0 */
+}
+
 /**
  * @brief      spi bus read command
  * @param[in]  fd is the spi handle
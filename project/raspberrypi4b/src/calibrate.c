@@ -0,0 +1,395 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      calibrate.c
+ * @brief     calibrate source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "calibrate.h"
+#include "driver_w25qxx_crc.h"
+#include "driver_w25qxx_interface.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief calibrate clock steps, the core clock divided by even dividers
+ */
+static const uint32_t gsc_freq[] =
+{
+    1000000, 2000000, 4000000, 8000000, 10000000, 12500000, 15625000, 20000000, 25000000,
+    31250000, 41666666, 50000000, 62500000, 83333333, 100000000, 125000000,
+};
+
+/**
+ * @brief calibrate reference structure definition
+ */
+typedef struct calibrate_ref_s
+{
+    uint8_t manufacturer;        /**< manufacturer */
+    uint8_t id[2];               /**< jedec device id */
+    uint8_t sfdp_ok;             /**< sfdp is readable */
+    uint32_t sfdp_crc;           /**< sfdp crc32 */
+    uint32_t page_addr;          /**< test page address */
+    uint32_t page_crc;           /**< test page crc32 */
+} calibrate_ref_t;
+
+/**
+ * @brief      calibrate get the board serial number
+ * @param[out] *board points to a board buffer
+ * @param[in]  len is the buffer length
+ * @note       none
+ */
+static void a_calibrate_board(char *board, uint32_t len)
+{
+    FILE *fp;
+    size_t n;
+    
+    strncpy(board, "unknown", len);
+    fp = fopen("/proc/device-tree/serial-number", "r");
+    if (fp == NULL)
+    {
+        return;
+    }
+    n = fread(board, 1, len - 1, fp);
+    (void)fclose(fp);
+    board[n] = '\0';
+    if (board[0] == '\0')
+    {
+        strncpy(board, "unknown", len);
+    }
+}
+
+/**
+ * @brief      calibrate load the saved clock of a device
+ * @param[in]  *device points to the spidev device
+ * @param[out] *freq points to a clock buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 no saved clock of this board and device
+ * @note       none
+ */
+uint8_t w25qxx_calibrate_load(char *device, uint32_t *freq)
+{
+    char board[64];
+    char b[64];
+    char d[64];
+    unsigned long f;
+    uint8_t res;
+    FILE *fp;
+    
+    a_calibrate_board(board, sizeof(board));
+    fp = fopen(W25QXX_CALIBRATE_FILE, "r");
+    if (fp == NULL)
+    {
+        return 1;
+    }
+    res = 1;
+    while (fscanf(fp, "%63s %63s %lu", b, d, &f) == 3)
+    {
+        if ((strcmp(b, board) == 0) && (strcmp(d, device) == 0) && (f != 0))
+        {
+            *freq = (uint32_t)f;
+            res = 0;
+        }
+    }
+    (void)fclose(fp);
+    
+    return res;
+}
+
+/**
+ * @brief     calibrate apply the saved clock of a device
+ * @param[in] *device points to the spidev device
+ * @return    status code
+ *            - 0 success
+ *            - 1 no saved clock of this board and device
+ * @note      sets the clock of the calling thread bus, call it after the bus is selected
+ */
+uint8_t w25qxx_calibrate_apply(char *device)
+{
+    uint32_t freq;
+    
+    if (w25qxx_calibrate_load(device, &freq) != 0)
+    {
+        return 1;
+    }
+    
+    return w25qxx_interface_spi_qspi_set_freq(freq);
+}
+
+/**
+ * @brief     calibrate save the clock of a device
+ * @param[in] *device points to the spidev device
+ * @param[in] freq is the spi clock
+ * @return    status code
+ *            - 0 success
+ *            - 1 save failed
+ * @note      replaces the line of this board and device in W25QXX_CALIBRATE_FILE
+ */
+uint8_t w25qxx_calibrate_save(char *device, uint32_t freq)
+{
+    char board[64];
+    char b[64];
+    char d[64];
+    unsigned long f;
+    FILE *in;
+    FILE *out;
+    
+    a_calibrate_board(board, sizeof(board));
+    out = fopen(W25QXX_CALIBRATE_FILE ".tmp", "w");
+    if (out == NULL)
+    {
+        return 1;
+    }
+    
+    /* keep the other boards and devices */
+    in = fopen(W25QXX_CALIBRATE_FILE, "r");
+    if (in != NULL)
+    {
+        while (fscanf(in, "%63s %63s %lu", b, d, &f) == 3)
+        {
+            if ((strcmp(b, board) != 0) || (strcmp(d, device) != 0))
+            {
+                fprintf(out, "%s %s %lu\n", b, d, f);
+            }
+        }
+        (void)fclose(in);
+    }
+    fprintf(out, "%s %s %lu\n", board, device, (unsigned long)freq);
+    if (fclose(out) != 0)
+    {
+        return 1;
+    }
+    
+    return (rename(W25QXX_CALIBRATE_FILE ".tmp", W25QXX_CALIBRATE_FILE) == 0) ? 0 : 1;
+}
+
+/**
+ * @brief     calibrate check one clock step
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *ref points to the reference
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      none
+ */
+static uint8_t a_calibrate_check(w25qxx_handle_t *handle, calibrate_ref_t *ref)
+{
+    uint8_t manufacturer;
+    uint8_t id[2];
+    uint8_t buf[256];
+    uint32_t i;
+    
+    for (i = 0; i < W25QXX_CALIBRATE_LOOPS; i++)
+    {
+        if ((w25qxx_get_jedec_id(handle, &manufacturer, id) != 0) || (manufacturer != ref->manufacturer) ||
+            (id[0] != ref->id[0]) || (id[1] != ref->id[1]))
+        {
+            return 1;
+        }
+        if ((ref->sfdp_ok != 0) &&
+            ((w25qxx_get_sfdp(handle, buf) != 0) || (w25qxx_crc32(0, buf, 256) != ref->sfdp_crc)))
+        {
+            return 1;
+        }
+        if ((w25qxx_read(handle, ref->page_addr, buf, 256) != 0) || (w25qxx_crc32(0, buf, 256) != ref->page_crc))
+        {
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief      calibrate find the highest reliable spi clock
+ * @param[in]  *handle points to an inited w25qxx handle structure
+ * @param[out] *freq points to a clock buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 calibrate failed
+ * @note       none
+ */
+uint8_t w25qxx_calibrate_spi(w25qxx_handle_t *handle, uint32_t *freq)
+{
+    const uint32_t size[] = {0x100000, 0x200000, 0x400000, 0x800000, 0x1000000, 0x2000000};
+    w25qxx_type_t type;
+    calibrate_ref_t ref;
+    uint8_t buf[256];
+    uint32_t i;
+    uint32_t pass;
+    uint32_t target;
+    
+    /* reference at the safe clock */
+    if ((w25qxx_get_type(handle, &type) != 0) || (w25qxx_interface_spi_qspi_set_freq(gsc_freq[0]) != 0))
+    {
+        return 1;
+    }
+    if (w25qxx_get_jedec_id(handle, &ref.manufacturer, ref.id) != 0)
+    {
+        return 1;
+    }
+    ref.sfdp_ok = (w25qxx_get_sfdp(handle, buf) == 0) ? 1 : 0;
+    ref.sfdp_crc = w25qxx_crc32(0, buf, 256);
+    ref.page_addr = size[type - W25Q80] - 256;
+    if (w25qxx_read(handle, ref.page_addr, buf, 256) != 0)
+    {
+        return 1;
+    }
+    for (i = 0; (i < 256) && (buf[i] == 0xFF); i++)
+    {
+        
+    }
+    if (i == 256)
+    {
+        /* toggle every data line in both directions */
+        for (i = 0; i < 256; i++)
+        {
+            buf[i] = (uint8_t)(((i & 1) != 0) ? (0x55 ^ i) : (0xAA ^ (i >> 1)));
+        }
+        if (w25qxx_page_program(handle, ref.page_addr, buf, 256) != 0)
+        {
+            return 1;
+        }
+        if (w25qxx_read(handle, ref.page_addr, buf, 256) != 0)
+        {
+            return 1;
+        }
+    }
+    ref.page_crc = w25qxx_crc32(0, buf, 256);
+    if (a_calibrate_check(handle, &ref) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: %uHz is not reliable.\n", gsc_freq[0]);
+        
+        return 1;
+    }
+    
+    /* step up until the first failure */
+    pass = 0;
+    for (i = 1; i < sizeof(gsc_freq) / sizeof(gsc_freq[0]); i++)
+    {
+        if ((w25qxx_interface_spi_qspi_set_freq(gsc_freq[i]) != 0) || (a_calibrate_check(handle, &ref) != 0))
+        {
+            w25qxx_interface_debug_print("w25qxx: %uHz failed.\n", gsc_freq[i]);
+            
+            break;
+        }
+        w25qxx_interface_debug_print("w25qxx: %uHz ok.\n", gsc_freq[i]);
+        pass = i;
+    }
+    
+    /* back off by the margin */
+    target = (uint32_t)((uint64_t)gsc_freq[pass] * W25QXX_CALIBRATE_MARGIN / 100);
+    for (i = pass; (i > 0) && (gsc_freq[i] > target); i--)
+    {
+        
+    }
+    if ((w25qxx_interface_spi_qspi_set_freq(gsc_freq[i]) != 0) || (a_calibrate_check(handle, &ref) != 0))
+    {
+        return 1;
+    }
+    *freq = gsc_freq[i];
+    
+    return 0;
+}
+
+/**
+ * @brief     calibrate the spi clock of the default device and save it
+ * @param[in] type is the chip type
+ * @return    status code
+ *            - 0 success
+ *            - 1 calibrate failed
+ * @note      none
+ */
+uint8_t w25qxx_calibrate_run(w25qxx_type_t type)
+{
+    uint8_t res;
+    uint32_t freq;
+    w25qxx_handle_t handle;
+    
+    /* the spi hooks of this thread talk to the calibrated device */
+    if (w25qxx_interface_spi_qspi_set_bus(0, W25QXX_CALIBRATE_DEVICE) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: select %s failed.\n", W25QXX_CALIBRATE_DEVICE);
+        
+        return 1;
+    }
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&handle, w25qxx_interface_debug_print);
+    
+    /* chip init */
+    res = w25qxx_set_type(&handle, type);
+    res |= w25qxx_set_interface(&handle, W25QXX_INTERFACE_SPI);
+    res |= w25qxx_set_dual_quad_spi(&handle, W25QXX_BOOL_FALSE);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set chip failed.\n");
+        
+        return 1;
+    }
+    res = w25qxx_init(&handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+        
+        return 1;
+    }
+    
+    /* calibrate */
+    res = w25qxx_calibrate_spi(&handle, &freq);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: calibrate failed.\n");
+        (void)w25qxx_deinit(&handle);
+        
+        return 1;
+    }
+    if (w25qxx_calibrate_save(W25QXX_CALIBRATE_DEVICE, freq) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: save %s failed.\n", W25QXX_CALIBRATE_FILE);
+        (void)w25qxx_deinit(&handle);
+        
+        return 1;
+    }
+    w25qxx_interface_debug_print("w25qxx: use %uHz for %s, saved in %s.\n", freq,
+                                 W25QXX_CALIBRATE_DEVICE, W25QXX_CALIBRATE_FILE);
+    (void)w25qxx_deinit(&handle);
+    
+    return 0;
+}
@@ -0,0 +1,118 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      calibrate.h
+ * @brief     calibrate header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _CALIBRATE_H_
+#define _CALIBRATE_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief calibrate definition
+ */
+#define W25QXX_CALIBRATE_DEVICE          "/dev/spidev0.0"              /**< calibrated device */
+#define W25QXX_CALIBRATE_FILE            "/etc/w25qxx_spi.conf"        /**< saved clocks, one "board device freq" line each */
+#define W25QXX_CALIBRATE_DEFAULT_FREQ    1000000                       /**< clock before the calibration */
+#define W25QXX_CALIBRATE_LOOPS           16                            /**< pattern checks per clock step */
+#define W25QXX_CALIBRATE_MARGIN          75                            /**< used clock in percent of the highest passing one */
+
+/**
+ * @brief      calibrate load the saved clock of a device
+ * @param[in]  *device points to the spidev device
+ * @param[out] *freq points to a clock buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 no saved clock of this board and device
+ * @note       none
+ */
+uint8_t w25qxx_calibrate_load(char *device, uint32_t *freq);
+
+/**
+ * @brief     calibrate apply the saved clock of a device
+ * @param[in] *device points to the spidev device
+ * @return    status code
+ *            - 0 success
+ *            - 1 no saved clock of this board and device
+ * @note      sets the clock of the calling thread bus, call it after the bus is selected
+ */
+uint8_t w25qxx_calibrate_apply(char *device);
+
+/**
+ * @brief     calibrate save the clock of a device
+ * @param[in] *device points to the spidev device
+ * @param[in] freq is the spi clock
+ * @return    status code
+ *            - 0 success
+ *            - 1 save failed
+ * @note      replaces the line of this board and device in W25QXX_CALIBRATE_FILE
+ */
+uint8_t w25qxx_calibrate_save(char *device, uint32_t freq);
+
+/**
+ * @brief      calibrate find the highest reliable spi clock
+ * @param[in]  *handle points to an inited w25qxx handle structure
+ * @param[out] *freq points to a clock buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 calibrate failed
+ * @note       the jedec id, the sfdp table and the last page of the chip are read at
+ *             W25QXX_CALIBRATE_DEFAULT_FREQ as reference, an erased last page is programmed
+ *             with a test pattern first, so the last page is reserved for the calibration,
+ *             then the clock steps up through the divider clocks of the spi controller
+ *             and every step reads all of them W25QXX_CALIBRATE_LOOPS times with crc32 checks,
+ *             the first failing step ends the search and the result is the highest step not
+ *             above W25QXX_CALIBRATE_MARGIN percent of the last passing one, the bus is left at it
+ */
+uint8_t w25qxx_calibrate_spi(w25qxx_handle_t *handle, uint32_t *freq);
+
+/**
+ * @brief     calibrate the spi clock of the default device and save it
+ * @param[in] type is the chip type
+ * @return    status code
+ *            - 0 success
+ *            - 1 calibrate failed
+ * @note      none
+ */
+uint8_t w25qxx_calibrate_run(w25qxx_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
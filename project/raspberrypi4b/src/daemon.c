@@ -0,0 +1,866 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      daemon.c
+ * @brief     daemon source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#define _GNU_SOURCE
+#include "daemon.h"
+#include "driver_w25qxx_interface.h"
+#include "driver_w25qxx_sched.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <poll.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+
+/**
+ * @brief daemon connection structure definition
+ */
+typedef struct daemon_conn_s
+{
+    int fd;                                          /**< socket, -1 if the slot is free */
+    uint8_t *shm;                                    /**< attached shared memory */
+    uint32_t shm_size;                               /**< attached shared memory size */
+    uint8_t served;                                  /**< a response is pending */
+    uint8_t queued;                                  /**< the request waits in the scheduler */
+    w25qxx_daemon_request_t req;                     /**< current request */
+    w25qxx_daemon_response_t res;                    /**< current response */
+    uint8_t buf[W25QXX_DAEMON_INLINE_MAX];           /**< inline data */
+} daemon_conn_t;
+
+static w25qxx_handle_t gs_handle;                                   /**< w25qxx handle */
+static w25qxx_sched_t gs_sched;                                     /**< w25qxx scheduler */
+static w25qxx_sched_req_t gs_req[4 * W25QXX_DAEMON_CLIENT_MAX];     /**< scheduler requests */
+static uint8_t gs_pool[W25QXX_DAEMON_CLIENT_MAX * 4096];            /**< scheduler write data pool */
+static uint8_t gs_buf[4096];                                        /**< scheduler buffer */
+static daemon_conn_t gs_conn[W25QXX_DAEMON_CLIENT_MAX];             /**< connections */
+static volatile sig_atomic_t gs_stop;                               /**< stop flag */
+static const uint32_t gsc_size[] = {0x100000, 0x200000, 0x400000, 0x800000, 0x1000000, 0x2000000};        /**< flash size */
+
+/**
+ * @brief     daemon signal handler
+ * @param[in] sig is the signal
+ * @note      none
+ */
+static void a_daemon_signal(int sig)
+{
+    (void)sig;
+    gs_stop = 1;
+}
+
+/**
+ * @brief     daemon send all data
+ * @param[in] fd is the socket
+ * @param[in] *buf points to a data buffer
+ * @param[in] len is the data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 send failed
+ * @note      none
+ */
+static uint8_t a_daemon_send(int fd, const void *buf, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+    ssize_t n;
+    
+    while (len != 0)
+    {
+        n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            
+            return 1;
+        }
+        p += n;
+        len -= (uint32_t)n;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief      daemon receive all data
+ * @param[in]  fd is the socket
+ * @param[out] *buf points to a data buffer
+ * @param[in]  len is the data length
+ * @param[out] *pass_fd points to a passed fd buffer, it may be NULL
+ * @return     status code
+ *             - 0 success
+ *             - 1 receive failed or closed
+ * @note       a fd passed with SCM_RIGHTS is returned in pass_fd, otherwise it is set to -1
+ */
+static uint8_t a_daemon_recv(int fd, void *buf, uint32_t len, int *pass_fd)
+{
+    uint8_t *p = (uint8_t *)buf;
+    char control[CMSG_SPACE(sizeof(int))];
+    struct msghdr msg;
+    struct iovec iov;
+    struct cmsghdr *cmsg;
+    ssize_t n;
+    
+    if (pass_fd != NULL)
+    {
+        *pass_fd = -1;
+    }
+    while (len != 0)
+    {
+        memset(&msg, 0, sizeof(msg));
+        iov.iov_base = p;
+        iov.iov_len = len;
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        n = recvmsg(fd, &msg, 0);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            
+            return 1;
+        }
+        if (n == 0)
+        {
+            return 1;
+        }
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_RIGHTS))
+            {
+                if ((pass_fd != NULL) && (*pass_fd < 0))
+                {
+                    memcpy(pass_fd, CMSG_DATA(cmsg), sizeof(int));
+                }
+                else
+                {
+                    int extra;
+                    
+                    memcpy(&extra, CMSG_DATA(cmsg), sizeof(int));
+                    close(extra);
+                }
+            }
+        }
+        p += n;
+        len -= (uint32_t)n;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     daemon close a connection
+ * @param[in] *conn points to a connection
+ * @note      none
+ */
+static void a_daemon_close(daemon_conn_t *conn)
+{
+    if (conn->shm != NULL)
+    {
+        munmap(conn->shm, conn->shm_size);
+    }
+    close(conn->fd);
+    conn->fd = -1;
+    conn->shm = NULL;
+    conn->shm_size = 0;
+    conn->served = 0;
+    conn->queued = 0;
+}
+
+/**
+ * @brief  daemon flush the scheduler batch
+ * @return status code
+ *         - 0 success
+ *         - 1 flush failed
+ * @note   every connection queued in the batch is answered with the flush result
+ */
+static uint8_t a_daemon_flush(void)
+{
+    uint8_t res;
+    uint32_t i;
+    
+    res = w25qxx_sched_flush(&gs_sched);
+    for (i = 0; i < W25QXX_DAEMON_CLIENT_MAX; i++)
+    {
+        if ((gs_conn[i].fd >= 0) && (gs_conn[i].queued != 0))
+        {
+            if (res != 0)
+            {
+                gs_conn[i].res.status = 1;
+            }
+            gs_conn[i].queued = 0;
+        }
+    }
+    
+    return res;
+}
+
+/**
+ * @brief     daemon take one request
+ * @param[in] *conn points to a connection
+ * @param[in] size is the chip size
+ * @return    status code
+ *            - 0 success
+ *            - 1 connection closed
+ * @note      reads and writes are queued in the scheduler, the response is sent after the flush,
+ *            a request that does not arrive within W25QXX_DAEMON_TIMEOUT_MS closes the connection
+ */
+static uint8_t a_daemon_take(daemon_conn_t *conn, uint32_t size)
+{
+    w25qxx_daemon_request_t *req = &conn->req;
+    uint8_t *data;
+    int pass_fd;
+    
+    if (a_daemon_recv(conn->fd, req, sizeof(w25qxx_daemon_request_t), &pass_fd) != 0)
+    {
+        return 1;
+    }
+    memset(&conn->res, 0, sizeof(w25qxx_daemon_response_t));
+    conn->served = 1;
+    
+    /* attach the shared memory */
+    if (req->op == W25QXX_DAEMON_OP_ATTACH)
+    {
+        if (pass_fd < 0)
+        {
+            conn->res.status = 4;
+            
+            return 0;
+        }
+        if (conn->shm != NULL)
+        {
+            munmap(conn->shm, conn->shm_size);
+            conn->shm = NULL;
+            conn->shm_size = 0;
+        }
+        data = mmap(NULL, req->len, PROT_READ | PROT_WRITE, MAP_SHARED, pass_fd, 0);
+        close(pass_fd);
+        if (data == MAP_FAILED)
+        {
+            conn->res.status = 1;
+            
+            return 0;
+        }
+        conn->shm = data;
+        conn->shm_size = req->len;
+        
+        return 0;
+    }
+    if (pass_fd >= 0)
+    {
+        close(pass_fd);
+    }
+    
+    /* check the range */
+    if ((req->addr > size) || (req->len > size - req->addr))
+    {
+        conn->res.status = 4;
+    }
+    if ((req->flags & W25QXX_DAEMON_FLAG_SHM) != 0)
+    {
+        if ((conn->shm == NULL) || (req->shm_offset > conn->shm_size) || (req->len > conn->shm_size - req->shm_offset))
+        {
+            conn->res.status = 4;
+            data = NULL;
+        }
+        else
+        {
+            data = conn->shm + req->shm_offset;
+        }
+    }
+    else
+    {
+        if (req->len > W25QXX_DAEMON_INLINE_MAX)
+        {
+            return 1;
+        }
+        data = conn->buf;
+    }
+    
+    /* inline write data follows the request */
+    if ((req->op == W25QXX_DAEMON_OP_WRITE) && ((req->flags & W25QXX_DAEMON_FLAG_SHM) == 0))
+    {
+        if (a_daemon_recv(conn->fd, conn->buf, req->len, NULL) != 0)
+        {
+            return 1;
+        }
+    }
+    if (conn->res.status != 0)
+    {
+        return 0;
+    }
+    
+    switch (req->op)
+    {
+        case W25QXX_DAEMON_OP_INFO :
+        {
+            conn->res.len = size;
+            
+            break;
+        }
+        case W25QXX_DAEMON_OP_READ :
+        {
+            conn->res.status = w25qxx_sched_read(&gs_sched, req->addr, data, req->len);
+            conn->res.len = ((req->flags & W25QXX_DAEMON_FLAG_SHM) != 0) ? 0 : req->len;
+            conn->queued = 1;
+            
+            break;
+        }
+        case W25QXX_DAEMON_OP_WRITE :
+        {
+            conn->res.status = w25qxx_sched_write(&gs_sched, req->addr, data, req->len);
+            conn->queued = 1;
+            
+            break;
+        }
+        case W25QXX_DAEMON_OP_ERASE :
+        {
+            /* the queued writes go first */
+            (void)a_daemon_flush();
+            if (req->len == 4096)
+            {
+                conn->res.status = w25qxx_sector_erase_4k(&gs_handle, req->addr);
+            }
+            else if (req->len == 32768)
+            {
+                conn->res.status = w25qxx_block_erase_32k(&gs_handle, req->addr);
+            }
+            else if (req->len == 65536)
+            {
+                conn->res.status = w25qxx_block_erase_64k(&gs_handle, req->addr);
+            }
+            else
+            {
+                conn->res.status = 4;
+            }
+            
+            break;
+        }
+        default :
+        {
+            conn->res.status = 4;
+            
+            break;
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     run the daemon
+ * @param[in] *path points to the socket path
+ * @param[in] type is the chip type
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      none
+ */
+uint8_t w25qxx_daemon_run(char *path, w25qxx_type_t type)
+{
+    uint8_t res;
+    uint32_t i;
+    uint32_t n;
+    uint32_t size;
+    uint32_t requests;
+    uint32_t batches;
+    int listen_fd;
+    int fd;
+    struct sockaddr_un sa;
+    struct pollfd pfd[1 + W25QXX_DAEMON_CLIENT_MAX];
+    daemon_conn_t *map[1 + W25QXX_DAEMON_CLIENT_MAX];
+    struct sigaction act;
+    w25qxx_sched_stats_t stats;
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    
+    /* chip init once for all clients */
+    res = w25qxx_set_type(&gs_handle, type);
+    res |= w25qxx_set_interface(&gs_handle, W25QXX_INTERFACE_SPI);
+    res |= w25qxx_set_dual_quad_spi(&gs_handle, W25QXX_BOOL_FALSE);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set chip failed.\n");
+        
+        return 1;
+    }
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+        
+        return 1;
+    }
+    size = gsc_size[type - W25Q80];
+    res = w25qxx_sched_init(&gs_sched, &gs_handle, gs_req, sizeof(gs_req) / sizeof(gs_req[0]),
+                            gs_pool, sizeof(gs_pool), gs_buf, 0);
+    if (res)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* listen */
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+    {
+        perror("w25qxx: socket failed");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    strncpy(sa.sun_path, path, sizeof(sa.sun_path) - 1);
+    (void)unlink(path);
+    if ((bind(listen_fd, (struct sockaddr *)&sa, sizeof(sa)) != 0) || (listen(listen_fd, W25QXX_DAEMON_CLIENT_MAX) != 0))
+    {
+        perror("w25qxx: bind failed");
+        close(listen_fd);
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    for (i = 0; i < W25QXX_DAEMON_CLIENT_MAX; i++)
+    {
+        gs_conn[i].fd = -1;
+        gs_conn[i].shm = NULL;
+    }
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = a_daemon_signal;
+    (void)sigaction(SIGINT, &act, NULL);
+    (void)sigaction(SIGTERM, &act, NULL);
+    gs_stop = 0;
+    requests = 0;
+    batches = 0;
+    w25qxx_interface_debug_print("w25qxx: daemon listens on %s.\n", path);
+    
+    while (gs_stop == 0)
+    {
+        /* wait for the clients */
+        pfd[0].fd = listen_fd;
+        pfd[0].events = POLLIN;
+        n = 1;
+        for (i = 0; i < W25QXX_DAEMON_CLIENT_MAX; i++)
+        {
+            if (gs_conn[i].fd >= 0)
+            {
+                pfd[n].fd = gs_conn[i].fd;
+                pfd[n].events = POLLIN;
+                map[n] = &gs_conn[i];
+                n++;
+            }
+        }
+        if (poll(pfd, n, 100) <= 0)
+        {
+            continue;
+        }
+        if ((pfd[0].revents & POLLIN) != 0)
+        {
+            fd = accept(listen_fd, NULL, NULL);
+            if (fd >= 0)
+            {
+                struct timeval tv;
+                
+                /* a client that stops mid request is dropped instead of stalling the others */
+                tv.tv_sec = W25QXX_DAEMON_TIMEOUT_MS / 1000;
+                tv.tv_usec = (W25QXX_DAEMON_TIMEOUT_MS % 1000) * 1000;
+                if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) != 0)
+                {
+                    close(fd);
+                    fd = -1;
+                }
+            }
+            for (i = 0; (fd >= 0) && (i < W25QXX_DAEMON_CLIENT_MAX); i++)
+            {
+                if (gs_conn[i].fd < 0)
+                {
+                    gs_conn[i].fd = fd;
+                    fd = -1;
+                }
+            }
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+        
+        /* take one request of every ready client */
+        for (i = 1; i < n; i++)
+        {
+            if ((pfd[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0)
+            {
+                if (a_daemon_take(map[i], size) != 0)
+                {
+                    a_daemon_close(map[i]);
+                }
+                else
+                {
+                    requests++;
+                }
+            }
+        }
+        
+        /* one batch for all of them */
+        (void)a_daemon_flush();
+        batches++;
+        for (i = 0; i < W25QXX_DAEMON_CLIENT_MAX; i++)
+        {
+            daemon_conn_t *conn = &gs_conn[i];
+            
+            if ((conn->fd < 0) || (conn->served == 0))
+            {
+                continue;
+            }
+            conn->served = 0;
+            if (conn->res.status != 0)
+            {
+                conn->res.len = 0;
+            }
+            if ((a_daemon_send(conn->fd, &conn->res, sizeof(w25qxx_daemon_response_t)) != 0) ||
+                ((conn->req.op == W25QXX_DAEMON_OP_READ) && (conn->res.len != 0) &&
+                 (a_daemon_send(conn->fd, conn->buf, conn->res.len) != 0)))
+            {
+                a_daemon_close(conn);
+            }
+        }
+    }
+    
+    /* print the batching */
+    (void)w25qxx_sched_get_stats(&gs_sched, &stats);
+    w25qxx_interface_debug_print("w25qxx: daemon served %d requests in %d batches.\n", requests, batches);
+    w25qxx_interface_debug_print("w25qxx: %d writes in %d sector writes, %d reads in %d transactions.\n",
+                                 stats.writes, stats.sector_writes, stats.reads, stats.read_transactions);
+    for (i = 0; i < W25QXX_DAEMON_CLIENT_MAX; i++)
+    {
+        if (gs_conn[i].fd >= 0)
+        {
+            a_daemon_close(&gs_conn[i]);
+        }
+    }
+    close(listen_fd);
+    (void)unlink(path);
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+}
+
+/**
+ * @brief      daemon client request
+ * @param[in]  *client points to a client structure
+ * @param[in]  *req points to a request
+ * @param[in]  *out points to the inline write data, it may be NULL
+ * @param[out] *in points to the inline read data buffer, it may be NULL
+ * @param[out] *res points to a response buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 request failed
+ * @note       none
+ */
+static uint8_t a_daemon_client_request(w25qxx_daemon_client_t *client, w25qxx_daemon_request_t *req, 
+                                       uint8_t *out, uint8_t *in, w25qxx_daemon_response_t *res)
+{
+    if (a_daemon_send(client->fd, req, sizeof(w25qxx_daemon_request_t)) != 0)
+    {
+        return 1;
+    }
+    if ((out != NULL) && (a_daemon_send(client->fd, out, req->len) != 0))
+    {
+        return 1;
+    }
+    if (a_daemon_recv(client->fd, res, sizeof(w25qxx_daemon_response_t), NULL) != 0)
+    {
+        return 1;
+    }
+    if ((in != NULL) && (res->len != 0) && 
+        ((res->len > req->len) || (a_daemon_recv(client->fd, in, res->len, NULL) != 0)))
+    {
+        return 1;
+    }
+    
+    return (res->status != 0) ? 1 : 0;
+}
+
+/**
+ * @brief      connect to the daemon
+ * @param[out] *client points to a client structure
+ * @param[in]  *path points to the socket path
+ * @param[in]  shm_size is the shared memory size, 0 for none
+ * @return     status code
+ *             - 0 success
+ *             - 1 connect failed
+ * @note       none
+ */
+uint8_t w25qxx_daemon_client_open(w25qxx_daemon_client_t *client, char *path, uint32_t shm_size)
+{
+    struct sockaddr_un sa;
+    w25qxx_daemon_request_t req;
+    w25qxx_daemon_response_t res;
+    char control[CMSG_SPACE(sizeof(int))];
+    struct msghdr msg;
+    struct iovec iov;
+    struct cmsghdr *cmsg;
+    int mfd;
+    
+    memset(client, 0, sizeof(w25qxx_daemon_client_t));
+    client->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (client->fd < 0)
+    {
+        return 1;
+    }
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    strncpy(sa.sun_path, path, sizeof(sa.sun_path) - 1);
+    if (connect(client->fd, (struct sockaddr *)&sa, sizeof(sa)) != 0)
+    {
+        close(client->fd);
+        
+        return 1;
+    }
+    if (shm_size == 0)
+    {
+        return 0;
+    }
+    
+    /* the shared memory goes to the daemon with SCM_RIGHTS */
+    mfd = memfd_create("w25qxx", 0);
+    if ((mfd < 0) || (ftruncate(mfd, shm_size) != 0))
+    {
+        goto failed;
+    }
+    client->shm = mmap(NULL, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, mfd, 0);
+    if (client->shm == MAP_FAILED)
+    {
+        client->shm = NULL;
+        
+        goto failed;
+    }
+    client->shm_size = shm_size;
+    memset(&req, 0, sizeof(req));
+    req.op = W25QXX_DAEMON_OP_ATTACH;
+    req.len = shm_size;
+    memset(&msg, 0, sizeof(msg));
+    memset(control, 0, sizeof(control));
+    iov.iov_base = &req;
+    iov.iov_len = sizeof(req);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &mfd, sizeof(int));
+    if ((sendmsg(client->fd, &msg, MSG_NOSIGNAL) != (ssize_t)sizeof(req)) ||
+        (a_daemon_recv(client->fd, &res, sizeof(res), NULL) != 0) || (res.status != 0))
+    {
+        goto failed;
+    }
+    close(mfd);
+    
+    return 0;
+    
+    failed:
+    
+    if (mfd >= 0)
+    {
+        close(mfd);
+    }
+    w25qxx_daemon_client_close(client);
+    
+    return 1;
+}
+
+/**
+ * @brief     disconnect from the daemon
+ * @param[in] *client points to a client structure
+ * @note      none
+ */
+void w25qxx_daemon_client_close(w25qxx_daemon_client_t *client)
+{
+    if (client->shm != NULL)
+    {
+        munmap(client->shm, client->shm_size);
+        client->shm = NULL;
+    }
+    if (client->fd >= 0)
+    {
+        close(client->fd);
+        client->fd = -1;
+    }
+}
+
+/**
+ * @brief      get the chip size
+ * @param[in]  *client points to a client structure
+ * @param[out] *size points to a size buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 request failed
+ * @note       none
+ */
+uint8_t w25qxx_daemon_client_info(w25qxx_daemon_client_t *client, uint32_t *size)
+{
+    w25qxx_daemon_request_t req;
+    w25qxx_daemon_response_t res;
+    
+    memset(&req, 0, sizeof(req));
+    req.op = W25QXX_DAEMON_OP_INFO;
+    if (a_daemon_client_request(client, &req, NULL, NULL, &res) != 0)
+    {
+        return 1;
+    }
+    *size = res.len;
+    
+    return 0;
+}
+
+/**
+ * @brief      daemon client transfer
+ * @param[in]  *client points to a client structure
+ * @param[in]  op is the operation
+ * @param[in]  addr is the flash address
+ * @param[in]  *data points to a data buffer
+ * @param[in]  len is the data length
+ * @return     status code
+ *             - 0 success
+ *             - 1 request failed
+ * @note       a buffer inside the shared memory is passed by its offset, others go inline in chunks
+ */
+static uint8_t a_daemon_client_transfer(w25qxx_daemon_client_t *client, uint8_t op, uint32_t addr, uint8_t *data, uint32_t len)
+{
+    w25qxx_daemon_request_t req;
+    w25qxx_daemon_response_t res;
+    uint32_t n;
+    
+    memset(&req, 0, sizeof(req));
+    req.op = op;
+    if ((client->shm != NULL) && (data >= client->shm) && (data + len <= client->shm + client->shm_size))
+    {
+        req.flags = W25QXX_DAEMON_FLAG_SHM;
+        req.addr = addr;
+        req.len = len;
+        req.shm_offset = (uint32_t)(data - client->shm);
+        
+        return a_daemon_client_request(client, &req, NULL, NULL, &res);
+    }
+    while (len != 0)
+    {
+        n = (len > W25QXX_DAEMON_INLINE_MAX) ? W25QXX_DAEMON_INLINE_MAX : len;
+        req.addr = addr;
+        req.len = n;
+        if (a_daemon_client_request(client, &req, (op == W25QXX_DAEMON_OP_WRITE) ? data : NULL,
+                                    (op == W25QXX_DAEMON_OP_READ) ? data : NULL, &res) != 0)
+        {
+            return 1;
+        }
+        addr += n;
+        data += n;
+        len -= n;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief      read through the daemon
+ * @param[in]  *client points to a client structure
+ * @param[in]  addr is the read address
+ * @param[out] *data points to a data buffer
+ * @param[in]  len is the data length
+ * @return     status code
+ *             - 0 success
+ *             - 1 request failed
+ * @note       none
+ */
+uint8_t w25qxx_daemon_client_read(w25qxx_daemon_client_t *client, uint32_t addr, uint8_t *data, uint32_t len)
+{
+    return a_daemon_client_transfer(client, W25QXX_DAEMON_OP_READ, addr, data, len);
+}
+
+/**
+ * @brief     write through the daemon
+ * @param[in] *client points to a client structure
+ * @param[in] addr is the write address
+ * @param[in] *data points to a data buffer
+ * @param[in] len is the data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 request failed
+ * @note      none
+ */
+uint8_t w25qxx_daemon_client_write(w25qxx_daemon_client_t *client, uint32_t addr, uint8_t *data, uint32_t len)
+{
+    return a_daemon_client_transfer(client, W25QXX_DAEMON_OP_WRITE, addr, data, len);
+}
+
+/**
+ * @brief     erase through the daemon
+ * @param[in] *client points to a client structure
+ * @param[in] addr is the erase address
+ * @param[in] len is the erase size, 4096, 32768 or 65536
+ * @return    status code
+ *            - 0 success
+ *            - 1 request failed
+ * @note      none
+ */
+uint8_t w25qxx_daemon_client_erase(w25qxx_daemon_client_t *client, uint32_t addr, uint32_t len)
+{
+    w25qxx_daemon_request_t req;
+    w25qxx_daemon_response_t res;
+    
+    memset(&req, 0, sizeof(req));
+    req.op = W25QXX_DAEMON_OP_ERASE;
+    req.addr = addr;
+    req.len = len;
+    
+    return a_daemon_client_request(client, &req, NULL, NULL, &res);
+}
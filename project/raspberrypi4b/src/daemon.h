@@ -0,0 +1,185 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      daemon.h
+ * @brief     daemon header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DAEMON_H_
+#define _DAEMON_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief daemon protocol definition
+ */
+#define W25QXX_DAEMON_CLIENT_MAX        16                   /**< served clients */
+#define W25QXX_DAEMON_INLINE_MAX        4096                 /**< largest data sent through the socket */
+#define W25QXX_DAEMON_FLAG_SHM          (1 << 0)             /**< data lives in the attached shared memory */
+#define W25QXX_DAEMON_TIMEOUT_MS        100                  /**< longest wait for the rest of a request */
+
+/**
+ * @brief daemon operation enumeration definition
+ */
+typedef enum
+{
+    W25QXX_DAEMON_OP_INFO   = 0x00,        /**< returns the chip size in len */
+    W25QXX_DAEMON_OP_READ   = 0x01,        /**< read len bytes from addr */
+    W25QXX_DAEMON_OP_WRITE  = 0x02,        /**< write len bytes to addr with the read modify write */
+    W25QXX_DAEMON_OP_ERASE  = 0x03,        /**< erase 4096, 32768 or 65536 bytes at addr */
+    W25QXX_DAEMON_OP_ATTACH = 0x04,        /**< attach a len bytes shared memory fd passed with SCM_RIGHTS */
+} w25qxx_daemon_op_t;
+
+/**
+ * @brief daemon request structure definition
+ * @note  inline write data follows the request
+ */
+typedef struct w25qxx_daemon_request_s
+{
+    uint8_t op;                 /**< w25qxx_daemon_op_t */
+    uint8_t flags;              /**< W25QXX_DAEMON_FLAG_SHM */
+    uint16_t reserved;          /**< 0 */
+    uint32_t addr;              /**< flash address */
+    uint32_t len;               /**< length */
+    uint32_t shm_offset;        /**< data offset in the shared memory */
+} w25qxx_daemon_request_t;
+
+/**
+ * @brief daemon response structure definition
+ * @note  inline read data follows the response
+ */
+typedef struct w25qxx_daemon_response_s
+{
+    uint8_t status;             /**< driver status code, 4 for an invalid request */
+    uint8_t reserved[3];        /**< 0 */
+    uint32_t len;               /**< inline data length or the chip size */
+} w25qxx_daemon_response_t;
+
+/**
+ * @brief daemon client structure definition
+ */
+typedef struct w25qxx_daemon_client_s
+{
+    int fd;                     /**< socket */
+    uint8_t *shm;               /**< attached shared memory */
+    uint32_t shm_size;          /**< attached shared memory size */
+} w25qxx_daemon_client_t;
+
+/**
+ * @brief     run the daemon
+ * @param[in] *path points to the socket path
+ * @param[in] type is the chip type
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      it owns the chip until SIGINT or SIGTERM, the requests of one poll round
+ *            are merged by the w25qxx scheduler and sent as one batch
+ */
+uint8_t w25qxx_daemon_run(char *path, w25qxx_type_t type);
+
+/**
+ * @brief      connect to the daemon
+ * @param[out] *client points to a client structure
+ * @param[in]  *path points to the socket path
+ * @param[in]  shm_size is the shared memory size, 0 for none
+ * @return     status code
+ *             - 0 success
+ *             - 1 connect failed
+ * @note       buffers inside client->shm are passed without a copy
+ */
+uint8_t w25qxx_daemon_client_open(w25qxx_daemon_client_t *client, char *path, uint32_t shm_size);
+
+/**
+ * @brief     disconnect from the daemon
+ * @param[in] *client points to a client structure
+ * @note      none
+ */
+void w25qxx_daemon_client_close(w25qxx_daemon_client_t *client);
+
+/**
+ * @brief      get the chip size
+ * @param[in]  *client points to a client structure
+ * @param[out] *size points to a size buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 request failed
+ * @note       none
+ */
+uint8_t w25qxx_daemon_client_info(w25qxx_daemon_client_t *client, uint32_t *size);
+
+/**
+ * @brief      read through the daemon
+ * @param[in]  *client points to a client structure
+ * @param[in]  addr is the read address
+ * @param[out] *data points to a data buffer
+ * @param[in]  len is the data length
+ * @return     status code
+ *             - 0 success
+ *             - 1 request failed
+ * @note       none
+ */
+uint8_t w25qxx_daemon_client_read(w25qxx_daemon_client_t *client, uint32_t addr, uint8_t *data, uint32_t len);
+
+/**
+ * @brief     write through the daemon
+ * @param[in] *client points to a client structure
+ * @param[in] addr is the write address
+ * @param[in] *data points to a data buffer
+ * @param[in] len is the data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 request failed
+ * @note      none
+ */
+uint8_t w25qxx_daemon_client_write(w25qxx_daemon_client_t *client, uint32_t addr, uint8_t *data, uint32_t len);
+
+/**
+ * @brief     erase through the daemon
+ * @param[in] *client points to a client structure
+ * @param[in] addr is the erase address
+ * @param[in] len is the erase size, 4096, 32768 or 65536
+ * @return    status code
+ *            - 0 success
+ *            - 1 request failed
+ * @note      none
+ */
+uint8_t w25qxx_daemon_client_erase(w25qxx_daemon_client_t *client, uint32_t addr, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
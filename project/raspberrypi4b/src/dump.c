@@ -0,0 +1,417 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      dump.c
+ * @brief     dump source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "dump.h"
+#include "driver_w25qxx_interface.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * @brief dump context structure definition
+ */
+typedef struct dump_s
+{
+    w25qxx_handle_t *handle;                                          /**< w25qxx handle */
+    int fd;                                                           /**< output file */
+    uint32_t chunks;                                                  /**< chunk number */
+    uint8_t *buf[W25QXX_DUMP_RING];                                   /**< chunk buffers */
+    uint8_t *blank;                                                   /**< erased chunk */
+    uint32_t head;                                                    /**< chunks read */
+    uint32_t tail;                                                    /**< chunks written */
+    uint32_t erased;                                                  /**< erased chunks */
+    uint32_t reader_stalls;                                           /**< reader stalls */
+    uint32_t writer_stalls;                                           /**< writer stalls */
+    uint8_t error;                                                    /**< read or write error */
+    pthread_mutex_t mutex;                                            /**< ring mutex */
+    pthread_cond_t cond;                                              /**< ring condition */
+} dump_t;
+
+/**
+ * @brief  dump get the monotonic time
+ * @return time in s
+ * @note   none
+ */
+static double a_dump_now(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief     dump check an erased chunk
+ * @param[in] *buf points to a chunk
+ * @return    1 if the chunk is 0xFF, otherwise 0
+ * @note      none
+ */
+static uint8_t a_dump_erased(const uint8_t *buf)
+{
+    const uint64_t *p = (const uint64_t *)buf;
+    uint32_t i;
+    
+    for (i = 0; i < W25QXX_DUMP_CHUNK / 8; i++)
+    {
+        if (p[i] != 0xFFFFFFFFFFFFFFFFULL)
+        {
+            return 0;
+        }
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief     dump set the error flag
+ * @param[in] *d points to a dump context
+ * @note      none
+ */
+static void a_dump_fail(dump_t *d)
+{
+    pthread_mutex_lock(&d->mutex);
+    d->error = 1;
+    pthread_cond_broadcast(&d->cond);
+    pthread_mutex_unlock(&d->mutex);
+}
+
+/**
+ * @brief     dump reader thread
+ * @param[in] *arg points to a dump context
+ * @return    NULL
+ * @note      keeps the bus busy while a buffer is free
+ */
+static void *a_dump_reader(void *arg)
+{
+    dump_t *d = (dump_t *)arg;
+    uint32_t c;
+    uint32_t i;
+    uint8_t *buf;
+    
+    for (c = 0; c < d->chunks; c++)
+    {
+        pthread_mutex_lock(&d->mutex);
+        if ((c - d->tail >= W25QXX_DUMP_RING) && (d->error == 0))
+        {
+            d->reader_stalls++;
+        }
+        while ((c - d->tail >= W25QXX_DUMP_RING) && (d->error == 0))
+        {
+            pthread_cond_wait(&d->cond, &d->mutex);
+        }
+        if (d->error != 0)
+        {
+            pthread_mutex_unlock(&d->mutex);
+            
+            return NULL;
+        }
+        pthread_mutex_unlock(&d->mutex);
+        buf = d->buf[c % W25QXX_DUMP_RING];
+        for (i = 0; i < W25QXX_DUMP_CHUNK; i += W25QXX_DUMP_READ)
+        {
+            if (w25qxx_read(d->handle, c * W25QXX_DUMP_CHUNK + i, buf + i, W25QXX_DUMP_READ) != 0)
+            {
+                a_dump_fail(d);
+                
+                return NULL;
+            }
+        }
+        pthread_mutex_lock(&d->mutex);
+        d->head = c + 1;
+        pthread_cond_broadcast(&d->cond);
+        pthread_mutex_unlock(&d->mutex);
+    }
+    
+    return NULL;
+}
+
+/**
+ * @brief     dump writer thread
+ * @param[in] *arg points to a dump context
+ * @return    NULL
+ * @note      writes every chunk at its chunk aligned file offset
+ */
+static void *a_dump_writer(void *arg)
+{
+    dump_t *d = (dump_t *)arg;
+    uint32_t c;
+    uint8_t *buf;
+    
+    for (c = 0; c < d->chunks; c++)
+    {
+        pthread_mutex_lock(&d->mutex);
+        if ((d->head <= c) && (d->error == 0))
+        {
+            d->writer_stalls++;
+        }
+        while ((d->head <= c) && (d->error == 0))
+        {
+            pthread_cond_wait(&d->cond, &d->mutex);
+        }
+        if (d->error != 0)
+        {
+            pthread_mutex_unlock(&d->mutex);
+            
+            return NULL;
+        }
+        pthread_mutex_unlock(&d->mutex);
+        buf = d->buf[c % W25QXX_DUMP_RING];
+        if (a_dump_erased(buf) != 0)
+        {
+            /* hand the buffer back before the write */
+            buf = d->blank;
+            pthread_mutex_lock(&d->mutex);
+            d->erased++;
+            d->tail = c + 1;
+            pthread_cond_broadcast(&d->cond);
+            pthread_mutex_unlock(&d->mutex);
+        }
+        if (pwrite(d->fd, buf, W25QXX_DUMP_CHUNK, (off_t)c * W25QXX_DUMP_CHUNK) != W25QXX_DUMP_CHUNK)
+        {
+            a_dump_fail(d);
+            
+            return NULL;
+        }
+        pthread_mutex_lock(&d->mutex);
+        d->tail = c + 1;
+        pthread_cond_broadcast(&d->cond);
+        pthread_mutex_unlock(&d->mutex);
+    }
+    
+    return NULL;
+}
+
+/**
+ * @brief      dump the chip into a file
+ * @param[in]  *handle points to an inited w25qxx handle structure
+ * @param[in]  fd is the output file
+ * @param[in]  len is the dumped length from address 0, a multiple of W25QXX_DUMP_CHUNK
+ * @param[out] *report points to a report buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 dump failed
+ * @note       none
+ */
+uint8_t w25qxx_dump_image(w25qxx_handle_t *handle, int fd, uint32_t len, w25qxx_dump_report_t *report)
+{
+    dump_t *d;
+    pthread_t reader;
+    pthread_t writer;
+    struct timespec ts;
+    uint8_t res;
+    uint32_t i;
+    uint32_t tail;
+    uint32_t last;
+    double start;
+    double now;
+    double mark;
+    
+    memset(report, 0, sizeof(w25qxx_dump_report_t));
+    d = (dump_t *)calloc(1, sizeof(dump_t));
+    if (d == NULL)
+    {
+        return 1;
+    }
+    d->handle = handle;
+    d->fd = fd;
+    d->chunks = len / W25QXX_DUMP_CHUNK;
+    res = 1;
+    for (i = 0; i < W25QXX_DUMP_RING; i++)
+    {
+        /* page aligned buffers for the file writes */
+        if (posix_memalign((void **)&d->buf[i], 4096, W25QXX_DUMP_CHUNK) != 0)
+        {
+            goto exit;
+        }
+    }
+    if (posix_memalign((void **)&d->blank, 4096, W25QXX_DUMP_CHUNK) != 0)
+    {
+        goto exit;
+    }
+    memset(d->blank, 0xFF, W25QXX_DUMP_CHUNK);
+    pthread_mutex_init(&d->mutex, NULL);
+    pthread_cond_init(&d->cond, NULL);
+    
+    /* run the pipeline and print the speed every second */
+    start = a_dump_now();
+    if (pthread_create(&reader, NULL, a_dump_reader, d) != 0)
+    {
+        goto exit;
+    }
+    if (pthread_create(&writer, NULL, a_dump_writer, d) != 0)
+    {
+        a_dump_fail(d);
+        pthread_join(reader, NULL);
+        
+        goto exit;
+    }
+    mark = start;
+    last = 0;
+    pthread_mutex_lock(&d->mutex);
+    while ((d->tail < d->chunks) && (d->error == 0))
+    {
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec++;
+        (void)pthread_cond_timedwait(&d->cond, &d->mutex, &ts);
+        now = a_dump_now();
+        if (now - mark >= 1.0)
+        {
+            tail = d->tail;
+            pthread_mutex_unlock(&d->mutex);
+            printf("\rw25qxx: %0.2f/%0.2fMB, %0.2fMB/s.", (double)tail * W25QXX_DUMP_CHUNK / 1048576.0,
+                   (double)len / 1048576.0, (double)(tail - last) * W25QXX_DUMP_CHUNK / 1048576.0 / (now - mark));
+            (void)fflush(stdout);
+            last = tail;
+            mark = now;
+            pthread_mutex_lock(&d->mutex);
+        }
+    }
+    pthread_mutex_unlock(&d->mutex);
+    pthread_join(reader, NULL);
+    pthread_join(writer, NULL);
+    if (mark != start)
+    {
+        printf("\n");
+    }
+    if ((d->error != 0) || (fsync(fd) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: dump failed at 0x%08X.\n", d->tail * W25QXX_DUMP_CHUNK);
+        
+        goto exit;
+    }
+    report->bytes = d->chunks * W25QXX_DUMP_CHUNK;
+    report->chunks = d->chunks;
+    report->erased = d->erased;
+    report->reader_stalls = d->reader_stalls;
+    report->writer_stalls = d->writer_stalls;
+    report->seconds = a_dump_now() - start;
+    res = 0;
+    
+    exit:
+    
+    for (i = 0; i < W25QXX_DUMP_RING; i++)
+    {
+        free(d->buf[i]);
+    }
+    free(d->blank);
+    free(d);
+    
+    return res;
+}
+
+/**
+ * @brief     dump the whole chip into a file
+ * @param[in] *path points to the output file
+ * @param[in] type is the chip type
+ * @return    status code
+ *            - 0 success
+ *            - 1 dump failed
+ * @note      none
+ */
+uint8_t w25qxx_dump_run(char *path, w25qxx_type_t type)
+{
+    const uint32_t size[] = {0x100000, 0x200000, 0x400000, 0x800000, 0x1000000, 0x2000000};
+    uint8_t res;
+    int fd;
+    w25qxx_handle_t handle;
+    w25qxx_dump_report_t report;
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&handle, w25qxx_interface_debug_print);
+    
+    /* chip init */
+    res = w25qxx_set_type(&handle, type);
+    res |= w25qxx_set_interface(&handle, W25QXX_INTERFACE_SPI);
+    res |= w25qxx_set_dual_quad_spi(&handle, W25QXX_BOOL_FALSE);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set chip failed.\n");
+        
+        return 1;
+    }
+    res = w25qxx_init(&handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+        
+        return 1;
+    }
+    if (type >= W25Q256)
+    {
+        /* one read command per transfer without the extended address register */
+        res = w25qxx_set_address_mode(&handle, W25QXX_ADDRESS_MODE_4_BYTE);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: set address mode failed.\n");
+            (void)w25qxx_deinit(&handle);
+            
+            return 1;
+        }
+    }
+    
+    /* dump */
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: open %s failed.\n", path);
+        (void)w25qxx_deinit(&handle);
+        
+        return 1;
+    }
+    res = w25qxx_dump_image(&handle, fd, size[type - W25Q80], &report);
+    (void)close(fd);
+    if (res == 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: dumped %d bytes in %0.2fs(%0.2fMB/s), %d of %d chunks erased.\n",
+                                     report.bytes, report.seconds, (double)report.bytes / report.seconds / 1048576.0,
+                                     report.erased, report.chunks);
+        w25qxx_interface_debug_print("w25qxx: reader waited %d times, writer waited %d times.\n",
+                                     report.reader_stalls, report.writer_stalls);
+    }
+    (void)w25qxx_deinit(&handle);
+    
+    return res;
+}
@@ -0,0 +1,97 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      dump.h
+ * @brief     dump header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DUMP_H_
+#define _DUMP_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief dump definition
+ */
+#define W25QXX_DUMP_CHUNK        65536        /**< bytes of one file write */
+#define W25QXX_DUMP_RING         8            /**< chunk buffers between the reader and the writer */
+#define W25QXX_DUMP_READ         4096         /**< largest transfer of the spi backend */
+
+/**
+ * @brief dump report structure definition
+ */
+typedef struct w25qxx_dump_report_s
+{
+    uint32_t bytes;              /**< dumped bytes */
+    uint32_t chunks;             /**< written chunks */
+    uint32_t erased;             /**< fully erased chunks */
+    uint32_t reader_stalls;      /**< times the reader waited for a free buffer */
+    uint32_t writer_stalls;      /**< times the writer waited for a full buffer */
+    double seconds;              /**< elapsed time */
+} w25qxx_dump_report_t;
+
+/**
+ * @brief      dump the chip into a file
+ * @param[in]  *handle points to an inited w25qxx handle structure
+ * @param[in]  fd is the output file
+ * @param[in]  len is the dumped length from address 0, a multiple of W25QXX_DUMP_CHUNK
+ * @param[out] *report points to a report buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 dump failed
+ * @note       a reader thread fills a ring of W25QXX_DUMP_RING chunks with back to back reads
+ *             while a writer thread stores every chunk with one aligned pwrite,
+ *             fully erased chunks are written from one shared 0xFF chunk and release their
+ *             buffer at once, the speed is printed every second
+ */
+uint8_t w25qxx_dump_image(w25qxx_handle_t *handle, int fd, uint32_t len, w25qxx_dump_report_t *report);
+
+/**
+ * @brief     dump the whole chip into a file
+ * @param[in] *path points to the output file
+ * @param[in] type is the chip type
+ * @return    status code
+ *            - 0 success
+ *            - 1 dump failed
+ * @note      none
+ */
+uint8_t w25qxx_dump_run(char *path, w25qxx_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,489 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      gang.c
+ * @brief     gang source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "gang.h"
+#include "calibrate.h"
+#include "driver_w25qxx_crc.h"
+#include "driver_w25qxx_interface.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/**
+ * @brief gang poll definition
+ */
+#define GANG_POLL_MAX        10000        /**< max busy polls of one command */
+
+/**
+ * @brief gang context structure definition
+ */
+typedef struct gang_s
+{
+    char **name;                                   /**< spidev devices */
+    uint8_t num;                                   /**< device number */
+    w25qxx_type_t type;                            /**< chip type */
+    const uint8_t *image;                          /**< shared image */
+    uint32_t len;                                  /**< image length */
+    uint32_t crc;                                  /**< image crc32 */
+    w25qxx_gang_report_t *report;                  /**< device reports */
+    pthread_barrier_t barrier;                     /**< lockstep barrier */
+    pthread_mutex_t mutex;                         /**< start mutex */
+    pthread_cond_t cond;                           /**< start condition */
+    uint8_t go;                                    /**< 0 wait, 1 run, 2 abort */
+} gang_t;
+
+/**
+ * @brief gang thread structure definition
+ */
+typedef struct gang_thread_s
+{
+    gang_t *gang;                                  /**< gang context */
+    uint8_t index;                                 /**< device index */
+    pthread_t thread;                              /**< thread */
+} gang_thread_t;
+
+/**
+ * @brief  gang get the monotonic time
+ * @return time in s
+ * @note   none
+ */
+static double a_gang_now(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief     gang wait for the end of a command
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] us is the poll interval
+ * @return    status code
+ *            - 0 success
+ *            - 1 wait failed
+ * @note      none
+ */
+static uint8_t a_gang_wait(w25qxx_handle_t *handle, uint32_t us)
+{
+    w25qxx_bool_t busy;
+    uint32_t i;
+    
+    for (i = 0; i < GANG_POLL_MAX; i++)
+    {
+        if (w25qxx_get_busy(handle, &busy) != 0)
+        {
+            return 1;
+        }
+        if (busy == W25QXX_BOOL_FALSE)
+        {
+            return 0;
+        }
+        w25qxx_interface_delay_us(us);
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief         gang erase one 64k block of the image
+ * @param[in]     *g points to a gang context
+ * @param[in]     *handle points to a w25qxx handle structure
+ * @param[in]     addr is the block address
+ * @param[in,out] *report points to a device report
+ * @return        status code
+ *                - 0 success
+ *                - 1 erase failed
+ * @note          a partial last block only erases the sectors the image covers
+ */
+static uint8_t a_gang_erase(gang_t *g, w25qxx_handle_t *handle, uint32_t addr, w25qxx_gang_report_t *report)
+{
+    uint32_t a;
+    
+    if (addr + 65536 <= g->len)
+    {
+        if ((w25qxx_erase_start(handle, addr, 65536) != 0) || (a_gang_wait(handle, 1000) != 0) ||
+            (w25qxx_erase_finish(handle, addr, 65536) != 0))
+        {
+            return 1;
+        }
+        report->erases++;
+        
+        return 0;
+    }
+    for (a = addr; a < g->len; a += 4096)
+    {
+        if ((w25qxx_erase_start(handle, a, 4096) != 0) || (a_gang_wait(handle, 1000) != 0) ||
+            (w25qxx_erase_finish(handle, a, 4096) != 0))
+        {
+            return 1;
+        }
+        report->erases++;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief         gang program the pages of one 64k block
+ * @param[in]     *g points to a gang context
+ * @param[in]     *handle points to a w25qxx handle structure
+ * @param[in]     addr is the block address
+ * @param[in,out] *report points to a device report
+ * @return        status code
+ *                - 0 success
+ *                - 1 program failed
+ * @note          blank pages are skipped
+ */
+static uint8_t a_gang_program(gang_t *g, w25qxx_handle_t *handle, uint32_t addr, w25qxx_gang_report_t *report)
+{
+    uint32_t a;
+    uint32_t i;
+    uint32_t n;
+    
+    for (a = addr; (a < addr + 65536) && (a < g->len); a += 256)
+    {
+        n = (g->len - a > 256) ? 256 : (g->len - a);
+        for (i = 0; (i < n) && (g->image[a + i] == 0xFF); i++)
+        {
+            
+        }
+        if (i == n)
+        {
+            continue;
+        }
+        if ((w25qxx_page_program_start(handle, a, (uint8_t *)&g->image[a], (uint16_t)n) != 0) ||
+            (a_gang_wait(handle, 10) != 0))
+        {
+            return 1;
+        }
+        report->pages++;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     gang device thread
+ * @param[in] *arg points to a gang thread
+ * @return    NULL
+ * @note      none
+ */
+static void *a_gang_thread(void *arg)
+{
+    gang_thread_t *t = (gang_thread_t *)arg;
+    gang_t *g = t->gang;
+    w25qxx_gang_report_t *report = &g->report[t->index];
+    w25qxx_handle_t handle;
+    uint32_t addr;
+    uint8_t inited;
+    uint8_t res;
+    double start;
+    
+    /* wait until every device thread exists */
+    pthread_mutex_lock(&g->mutex);
+    while (g->go == 0)
+    {
+        pthread_cond_wait(&g->cond, &g->mutex);
+    }
+    pthread_mutex_unlock(&g->mutex);
+    if (g->go != 1)
+    {
+        return NULL;
+    }
+    
+    /* the spi hooks of this thread talk to this device */
+    res = w25qxx_interface_spi_qspi_set_bus(t->index, g->name[t->index]);
+    if (res == 0)
+    {
+        /* use the calibrated clock of this board and device if there is one */
+        (void)w25qxx_calibrate_apply(g->name[t->index]);
+    }
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&handle, w25qxx_interface_debug_print);
+    
+    /* chip init */
+    res |= w25qxx_set_type(&handle, g->type);
+    res |= w25qxx_set_interface(&handle, W25QXX_INTERFACE_SPI);
+    res |= w25qxx_set_dual_quad_spi(&handle, W25QXX_BOOL_FALSE);
+    inited = 0;
+    if ((res == 0) && (w25qxx_init(&handle) == 0))
+    {
+        inited = 1;
+        if (g->type >= W25Q256)
+        {
+            res = w25qxx_set_address_mode(&handle, W25QXX_ADDRESS_MODE_4_BYTE);
+        }
+    }
+    report->res = ((inited == 0) || (res != 0)) ? 1 : 0;
+    
+    /* erase and program every block in lockstep with the other devices */
+    start = a_gang_now();
+    for (addr = 0; addr < g->len; addr += 65536)
+    {
+        (void)pthread_barrier_wait(&g->barrier);
+        if ((report->res == 0) && (a_gang_erase(g, &handle, addr, report) != 0))
+        {
+            w25qxx_interface_debug_print("w25qxx: %s erase 0x%08X failed.\n", report->name, addr);
+            report->res = 1;
+        }
+        (void)pthread_barrier_wait(&g->barrier);
+        if ((report->res == 0) && (a_gang_program(g, &handle, addr, report) != 0))
+        {
+            w25qxx_interface_debug_print("w25qxx: %s program 0x%08X failed.\n", report->name, addr);
+            report->res = 1;
+        }
+    }
+    
+    /* verify */
+    if (report->res == 0)
+    {
+        if (w25qxx_crc32_range(&handle, 0, g->len, &report->crc) != 0)
+        {
+            report->res = 1;
+        }
+        else if (report->crc != g->crc)
+        {
+            report->res = 5;
+        }
+        else
+        {
+            
+        }
+    }
+    report->seconds = a_gang_now() - start;
+    if (inited != 0)
+    {
+        (void)w25qxx_deinit(&handle);
+    }
+    
+    return NULL;
+}
+
+/**
+ * @brief      program one image into several devices at the same time
+ * @param[in]  **name points to the spidev devices
+ * @param[in]  num is the device number
+ * @param[in]  type is the chip type
+ * @param[in]  *image points to the image, shared read only by every device thread
+ * @param[in]  len is the image length, the image starts at address 0
+ * @param[out] *report points to num report buffers
+ * @return     status code
+ *             - 0 success
+ *             - 1 a device failed
+ *             - 4 num or len is invalid
+ * @note       none
+ */
+uint8_t w25qxx_gang_program(char **name, uint8_t num, w25qxx_type_t type, const uint8_t *image, uint32_t len,
+                            w25qxx_gang_report_t *report)
+{
+    gang_t g;
+    gang_thread_t t[W25QXX_GANG_MAX];
+    uint8_t started;
+    uint8_t i;
+    uint8_t res;
+    
+    if ((num == 0) || (num > W25QXX_GANG_MAX) || (len == 0))
+    {
+        return 4;
+    }
+    g.name = name;
+    g.num = num;
+    g.type = type;
+    g.image = image;
+    g.len = len;
+    g.crc = w25qxx_crc32(0, image, len);
+    g.report = report;
+    memset(report, 0, sizeof(w25qxx_gang_report_t) * num);
+    for (i = 0; i < num; i++)
+    {
+        report[i].name = name[i];
+        report[i].res = 1;
+    }
+    if (pthread_barrier_init(&g.barrier, NULL, num) != 0)
+    {
+        return 1;
+    }
+    pthread_mutex_init(&g.mutex, NULL);
+    pthread_cond_init(&g.cond, NULL);
+    g.go = 0;
+    
+    /* one thread per device */
+    for (started = 0; started < num; started++)
+    {
+        t[started].gang = &g;
+        t[started].index = started;
+        if (pthread_create(&t[started].thread, NULL, a_gang_thread, &t[started]) != 0)
+        {
+            w25qxx_interface_debug_print("w25qxx: create thread failed.\n");
+            
+            break;
+        }
+    }
+    
+    /* the barrier only opens with all threads, so start all or none */
+    pthread_mutex_lock(&g.mutex);
+    g.go = (started == num) ? 1 : 2;
+    pthread_cond_broadcast(&g.cond);
+    pthread_mutex_unlock(&g.mutex);
+    for (i = 0; i < started; i++)
+    {
+        (void)pthread_join(t[i].thread, NULL);
+    }
+    (void)pthread_barrier_destroy(&g.barrier);
+    (void)pthread_mutex_destroy(&g.mutex);
+    (void)pthread_cond_destroy(&g.cond);
+    res = 0;
+    for (i = 0; i < num; i++)
+    {
+        if (report[i].res != 0)
+        {
+            res = 1;
+        }
+    }
+    
+    return res;
+}
+
+/**
+ * @brief     program an image file into several devices at the same time
+ * @param[in] *path points to the image file
+ * @param[in] *devices points to a comma separated spidev device list
+ * @param[in] type is the chip type
+ * @return    status code
+ *            - 0 success
+ *            - 1 a device failed
+ *            - 4 image or device list is invalid
+ * @note      none
+ */
+uint8_t w25qxx_gang_run(char *path, char *devices, w25qxx_type_t type)
+{
+    const uint32_t size[] = {0x100000, 0x200000, 0x400000, 0x800000, 0x1000000, 0x2000000};
+    char *name[W25QXX_GANG_MAX];
+    w25qxx_gang_report_t report[W25QXX_GANG_MAX];
+    uint8_t num;
+    uint8_t res;
+    uint8_t ok;
+    uint8_t i;
+    char *p;
+    int fd;
+    off_t len;
+    uint8_t *image;
+    double start;
+    double seconds;
+    
+    /* split the device list */
+    num = 0;
+    for (p = strtok(devices, ","); p != NULL; p = strtok(NULL, ","))
+    {
+        if (num == W25QXX_GANG_MAX)
+        {
+            w25qxx_interface_debug_print("w25qxx: more than %d devices.\n", W25QXX_GANG_MAX);
+            
+            return 4;
+        }
+        name[num++] = p;
+    }
+    if (num == 0)
+    {
+        return 4;
+    }
+    
+    /* map the image once for all device threads */
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: open %s failed.\n", path);
+        
+        return 1;
+    }
+    len = lseek(fd, 0, SEEK_END);
+    if ((len <= 0) || ((uint32_t)len > size[type - W25Q80]))
+    {
+        w25qxx_interface_debug_print("w25qxx: image size %ld is invalid.\n", (long)len);
+        (void)close(fd);
+        
+        return 4;
+    }
+    image = (uint8_t *)mmap(NULL, len, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    (void)close(fd);
+    if (image == MAP_FAILED)
+    {
+        w25qxx_interface_debug_print("w25qxx: map %s failed.\n", path);
+        
+        return 1;
+    }
+    
+    /* program */
+    start = a_gang_now();
+    res = w25qxx_gang_program(name, num, type, image, (uint32_t)len, report);
+    seconds = a_gang_now() - start;
+    ok = 0;
+    for (i = 0; i < num; i++)
+    {
+        if (report[i].res == 0)
+        {
+            ok++;
+            w25qxx_interface_debug_print("w25qxx: %s ok, crc 0x%08X, %d erases, %d pages, %0.2fs.\n", report[i].name,
+                                         report[i].crc, report[i].erases, report[i].pages, report[i].seconds);
+        }
+        else if (report[i].res == 5)
+        {
+            w25qxx_interface_debug_print("w25qxx: %s verification failed, crc 0x%08X.\n", report[i].name, report[i].crc);
+        }
+        else
+        {
+            w25qxx_interface_debug_print("w25qxx: %s failed.\n", report[i].name);
+        }
+    }
+    w25qxx_interface_debug_print("w25qxx: %d of %d devices ok, %d bytes each in %0.2fs, aggregate %0.2fKB/s.\n",
+                                 ok, num, (uint32_t)len, seconds, (double)len * ok / seconds / 1024.0);
+    (void)munmap(image, len);
+    
+    return res;
+}
@@ -0,0 +1,101 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      gang.h
+ * @brief     gang header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _GANG_H_
+#define _GANG_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief gang definition
+ */
+#define W25QXX_GANG_MAX        8        /**< max devices */
+
+/**
+ * @brief gang device report structure definition
+ */
+typedef struct w25qxx_gang_report_s
+{
+    char *name;             /**< spidev device */
+    uint8_t res;            /**< 0 ok, 1 failed, 5 verification failed */
+    uint32_t erases;        /**< sent erases */
+    uint32_t pages;         /**< programmed pages */
+    uint32_t crc;           /**< crc32 read back from the device */
+    double seconds;         /**< device time */
+} w25qxx_gang_report_t;
+
+/**
+ * @brief      program one image into several devices at the same time
+ * @param[in]  **name points to the spidev devices
+ * @param[in]  num is the device number
+ * @param[in]  type is the chip type
+ * @param[in]  *image points to the image, shared read only by every device thread
+ * @param[in]  len is the image length, the image starts at address 0
+ * @param[out] *report points to num report buffers
+ * @return     status code
+ *             - 0 success
+ *             - 1 a device failed
+ *             - 4 num or len is invalid
+ * @note       one thread per device, the threads meet at a barrier before every 64k block,
+ *             start its erase together and program its pages together so the busy times of
+ *             all devices overlap, a failed device leaves the work but keeps the lockstep,
+ *             every device is verified with the crc32 of the image
+ */
+uint8_t w25qxx_gang_program(char **name, uint8_t num, w25qxx_type_t type, const uint8_t *image, uint32_t len,
+                            w25qxx_gang_report_t *report);
+
+/**
+ * @brief     program an image file into several devices at the same time
+ * @param[in] *path points to the image file
+ * @param[in] *devices points to a comma separated spidev device list
+ * @param[in] type is the chip type
+ * @return    status code
+ *            - 0 success
+ *            - 1 a device failed
+ *            - 4 image or device list is invalid
+ * @note      none
+ */
+uint8_t w25qxx_gang_run(char *path, char *devices, w25qxx_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -38,6 +38,13 @@
 #include "driver_w25qxx_advance.h"
 #include "driver_w25qxx_read_test.h"
 #include "driver_w25qxx_register_test.h"
+#include "driver_w25qxx_benchmark_test.h"
+#include "daemon.h"
+#include "program.h"
+#include "dump.h"
+#include "gang.h"
+#include "delay.h"
+#include "calibrate.h"
 #include <stdlib.h>
 
 /**
@@ -94,6 +101,19 @@ uint8_t w25qxx(uint8_t argc, char **argv)
             w25qxx_interface_debug_print("w25qxx -i\n\tshow w25qxx chip and driver information.\n");
             w25qxx_interface_debug_print("w25qxx -h\n\tshow w25qxx help.\n");
             w25qxx_interface_debug_print("w25qxx -p\n\tshow w25qxx pin connections of the current board.\n");
+            w25qxx_interface_debug_print("w25qxx -rt <command>\n\trun any command with SCHED_FIFO and locked memory.\n");
+            w25qxx_interface_debug_print("w25qxx -c calibrate -type <type> -spi\n\tfind the highest reliable spi clock and save it for this board.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t benchmark -type <type> (-spi| -qspi)\n\trun w25qxx benchmark test and print json lines.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -d <path> -type <type> -spi\n\trun w25qxx daemon on a unix socket.");
+            w25qxx_interface_debug_print("path is the socket path.type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -w <file> -type <type> -spi\n\tprogram an image file and only rewrite the changed sectors.");
+            w25qxx_interface_debug_print("file is the image file.type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -r <file> -type <type> -spi\n\tdump the whole chip into an image file.");
+            w25qxx_interface_debug_print("file is the image file.type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -g <file> -type <type> <devices> -spi\n\tprogram an image file into several chips at the same time.");
+            w25qxx_interface_debug_print("file is the image file.type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.devices is a comma separated spidev list.\n");
             w25qxx_interface_debug_print("w25qxx -c basic -type <type> power_down (-spi| -qspi)\n\trun w25qxx basic power down function.");
             w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
             w25qxx_interface_debug_print("w25qxx -c basic -type <type> wake_up (-spi| -qspi)\n\trun w25qxx basic wake up function.");
@@ -352,6 +372,73 @@ uint8_t w25qxx(uint8_t argc, char **argv)
                     return 5;
                 }
             }
+            else if (strcmp("benchmark", argv[2]) == 0)
+            {
+                if (strcmp("-type", argv[3]) == 0)
+                {
+                    volatile uint8_t res;
+                    w25qxx_type_t type;
+                    w25qxx_interface_t interface;
+                    
+                    if (strcmp("W25Q80", argv[4]) == 0)
+                    {
+                        type = W25Q80;
+                    }
+                    else if (strcmp("W25Q16", argv[4]) == 0)
+                    {
+                        type = W25Q16;
+                    }
+                    else if (strcmp("W25Q32", argv[4]) == 0)
+                    {
+                        type = W25Q32;
+                    }
+                    else if (strcmp("W25Q64", argv[4]) == 0)
+                    {
+                        type = W25Q64;
+                    }
+                    else if (strcmp("W25Q128", argv[4]) == 0)
+                    {
+                        type = W25Q128;
+                    }
+                    else if (strcmp("W25Q256", argv[4]) == 0)
+                    {
+                        type = W25Q256;
+                    }
+                    else
+                    {
+                        return 5;
+                    }
+                    
+                    if (strcmp("-spi", argv[5]) == 0)
+                    {
+                        interface = W25QXX_INTERFACE_SPI;
+                    }
+                    else if (strcmp("-qspi", argv[5]) == 0)
+                    {
+                        w25qxx_interface_debug_print("w25qxx: this chip can't use qspi interface.\n");
+                        
+                        return 5;
+                    }
+                    else
+                    {
+                        return 5;
+                    }
+                    
+                    res = w25qxx_benchmark_test(type, interface, W25QXX_BOOL_FALSE);
+                    if (res)
+                    {
+                        return 1;
+                    }
+                    else
+                    {
+                        return 0;
+                    }
+                }
+                else
+                {
+                    return 5;
+                }
+            }
             else
             {
                 return 5;
@@ -449,6 +536,206 @@ uint8_t w25qxx(uint8_t argc, char **argv)
                     return 5;
                 }
             }
+            else if (strcmp("calibrate", argv[2]) == 0)
+            {
+                if (strcmp("-type", argv[3]) == 0)
+                {
+                    w25qxx_type_t type;
+                    
+                    if (strcmp("W25Q80", argv[4]) == 0)
+                    {
+                        type = W25Q80;
+                    }
+                    else if (strcmp("W25Q16", argv[4]) == 0)
+                    {
+                        type = W25Q16;
+                    }
+                    else if (strcmp("W25Q32", argv[4]) == 0)
+                    {
+                        type = W25Q32;
+                    }
+                    else if (strcmp("W25Q64", argv[4]) == 0)
+                    {
+                        type = W25Q64;
+                    }
+                    else if (strcmp("W25Q128", argv[4]) == 0)
+                    {
+                        type = W25Q128;
+                    }
+                    else if (strcmp("W25Q256", argv[4]) == 0)
+                    {
+                        type = W25Q256;
+                    }
+                    else
+                    {
+                        return 5;
+                    }
+                    
+                    if (strcmp("-spi", argv[5]) != 0)
+                    {
+                        w25qxx_interface_debug_print("w25qxx: this chip can't use qspi interface.\n");
+                        
+                        return 5;
+                    }
+                    
+                    /* find and save the highest reliable clock */
+                    return w25qxx_calibrate_run(type);
+                }
+                else
+                {
+                    return 5;
+                }
+            }
+            else
+            {
+                return 5;
+            }
+        }
+        else if (strcmp("-d", argv[1]) == 0)
+        {
+            if (strcmp("-type", argv[3]) == 0)
+            {
+                w25qxx_type_t type;
+                
+                if (strcmp("W25Q80", argv[4]) == 0)
+                {
+                    type = W25Q80;
+                }
+                else if (strcmp("W25Q16", argv[4]) == 0)
+                {
+                    type = W25Q16;
+                }
+                else if (strcmp("W25Q32", argv[4]) == 0)
+                {
+                    type = W25Q32;
+                }
+                else if (strcmp("W25Q64", argv[4]) == 0)
+                {
+                    type = W25Q64;
+                }
+                else if (strcmp("W25Q128", argv[4]) == 0)
+                {
+                    type = W25Q128;
+                }
+                else if (strcmp("W25Q256", argv[4]) == 0)
+                {
+                    type = W25Q256;
+                }
+                else
+                {
+                    return 5;
+                }
+                
+                if (strcmp("-spi", argv[5]) != 0)
+                {
+                    w25qxx_interface_debug_print("w25qxx: this chip can't use qspi interface.\n");
+                    
+                    return 5;
+                }
+                
+                /* serve the clients until SIGINT or SIGTERM */
+                return w25qxx_daemon_run(argv[2], type);
+            }
+            else
+            {
+                return 5;
+            }
+        }
+        else if (strcmp("-w", argv[1]) == 0)
+        {
+            if (strcmp("-type", argv[3]) == 0)
+            {
+                w25qxx_type_t type;
+                
+                if (strcmp("W25Q80", argv[4]) == 0)
+                {
+                    type = W25Q80;
+                }
+                else if (strcmp("W25Q16", argv[4]) == 0)
+                {
+                    type = W25Q16;
+                }
+                else if (strcmp("W25Q32", argv[4]) == 0)
+                {
+                    type = W25Q32;
+                }
+                else if (strcmp("W25Q64", argv[4]) == 0)
+                {
+                    type = W25Q64;
+                }
+                else if (strcmp("W25Q128", argv[4]) == 0)
+                {
+                    type = W25Q128;
+                }
+                else if (strcmp("W25Q256", argv[4]) == 0)
+                {
+                    type = W25Q256;
+                }
+                else
+                {
+                    return 5;
+                }
+                
+                if (strcmp("-spi", argv[5]) != 0)
+                {
+                    w25qxx_interface_debug_print("w25qxx: this chip can't use qspi interface.\n");
+                    
+                    return 5;
+                }
+                
+                /* rewrite the changed sectors only */
+                return w25qxx_program_run(argv[2], type);
+            }
+            else
+            {
+                return 5;
+            }
+        }
+        else if (strcmp("-r", argv[1]) == 0)
+        {
+            if (strcmp("-type", argv[3]) == 0)
+            {
+                w25qxx_type_t type;
+                
+                if (strcmp("W25Q80", argv[4]) == 0)
+                {
+                    type = W25Q80;
+                }
+                else if (strcmp("W25Q16", argv[4]) == 0)
+                {
+                    type = W25Q16;
+                }
+                else if (strcmp("W25Q32", argv[4]) == 0)
+                {
+                    type = W25Q32;
+                }
+                else if (strcmp("W25Q64", argv[4]) == 0)
+                {
+                    type = W25Q64;
+                }
+                else if (strcmp("W25Q128", argv[4]) == 0)
+                {
+                    type = W25Q128;
+                }
+                else if (strcmp("W25Q256", argv[4]) == 0)
+                {
+                    type = W25Q256;
+                }
+                else
+                {
+                    return 5;
+                }
+                
+                if (strcmp("-spi", argv[5]) != 0)
+                {
+                    w25qxx_interface_debug_print("w25qxx: this chip can't use qspi interface.\n");
+                    
+                    return 5;
+                }
+                
+                /* read the whole chip into the file */
+                return w25qxx_dump_run(argv[2], type);
+            }
             else
             {
                 return 5;
@@ -1126,6 +1413,56 @@ uint8_t w25qxx(uint8_t argc, char **argv)
                 return 5;
             }
         }
+        else if (strcmp("-g", argv[1]) == 0)
+        {
+            if (strcmp("-type", argv[3]) == 0)
+            {
+                w25qxx_type_t type;
+                
+                if (strcmp("W25Q80", argv[4]) == 0)
+                {
+                    type = W25Q80;
+                }
+                else if (strcmp("W25Q16", argv[4]) == 0)
+                {
+                    type = W25Q16;
+                }
+                else if (strcmp("W25Q32", argv[4]) == 0)
+                {
+                    type = W25Q32;
+                }
+                else if (strcmp("W25Q64", argv[4]) == 0)
+                {
+                    type = W25Q64;
+                }
+                else if (strcmp("W25Q128", argv[4]) == 0)
+                {
+                    type = W25Q128;
+                }
+                else if (strcmp("W25Q256", argv[4]) == 0)
+                {
+                    type = W25Q256;
+                }
+                else
+                {
+                    return 5;
+                }
+                
+                if (strcmp("-spi", argv[6]) != 0)
+                {
+                    w25qxx_interface_debug_print("w25qxx: this chip can't use qspi interface.\n");
+                    
+                    return 5;
+                }
+                
+                /* program all devices in lockstep */
+                return w25qxx_gang_run(argv[2], argv[5], type);
+            }
+            else
+            {
+                return 5;
+            }
+        }
         else
         {
             return 5;
@@ -1880,6 +2217,20 @@ int main(uint8_t argc, char **argv)
 {
     uint8_t res;
 
+    /* optional realtime prefix for all commands */
+    if ((argc > 1) && (strcmp("-rt", argv[1]) == 0))
+    {
+        if (delay_realtime_init(DELAY_REALTIME_PRIORITY) != 0)
+        {
+            w25qxx_interface_debug_print("w25qxx: realtime init failed.\n");
+        }
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+    }
+
+    /* use the calibrated clock of this board and device if there is one */
+    (void)w25qxx_calibrate_apply(W25QXX_CALIBRATE_DEVICE);
     res = w25qxx(argc, argv);
     if (res == 0)
     {
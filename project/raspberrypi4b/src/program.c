@@ -0,0 +1,565 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      program.c
+ * @brief     program source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "program.h"
+#include "driver_w25qxx_crc.h"
+#include "driver_w25qxx_interface.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @brief program sector state definition
+ */
+#define PROGRAM_SAME         0        /**< sector is equal */
+#define PROGRAM_ONLY         1        /**< sector only needs 1 to 0 changes */
+#define PROGRAM_ERASE        2        /**< sector needs an erase */
+
+/**
+ * @brief program context structure definition
+ */
+typedef struct program_s
+{
+    w25qxx_handle_t *handle;                                           /**< w25qxx handle */
+    const uint8_t *image;                                              /**< image */
+    uint32_t len;                                                      /**< image length */
+    uint32_t sectors;                                                  /**< covered sectors */
+    uint8_t *state;                                                    /**< sector states */
+    uint8_t *dirty;                                                    /**< changed pages */
+    uint8_t tail[4096];                                                /**< last sector merged with the old tail */
+    uint8_t *buf[W25QXX_PROGRAM_RING];                                 /**< read buffers */
+    uint32_t head;                                                     /**< chunks read */
+    uint32_t tail_chunk;                                               /**< chunks compared */
+    uint8_t error;                                                     /**< read error */
+    pthread_mutex_t mutex;                                             /**< ring mutex */
+    pthread_cond_t cond;                                               /**< ring condition */
+} program_t;
+
+/**
+ * @brief  program get the monotonic time
+ * @return time in s
+ * @note   none
+ */
+static double a_program_now(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief     program get the image of a sector
+ * @param[in] *p points to a program context
+ * @param[in] s is the sector
+ * @return    pointer to 4096 bytes
+ * @note      none
+ */
+static const uint8_t *a_program_sector(program_t *p, uint32_t s)
+{
+    if ((s + 1) * 4096 > p->len)
+    {
+        return p->tail;
+    }
+    
+    return p->image + s * 4096;
+}
+
+/**
+ * @brief     program reader thread
+ * @param[in] *arg points to a program context
+ * @return    NULL
+ * @note      reads the chip chunk by chunk into the free ring buffers
+ */
+static void *a_program_reader(void *arg)
+{
+    program_t *p = (program_t *)arg;
+    uint32_t chunks;
+    uint32_t c;
+    uint32_t addr;
+    uint32_t n;
+    uint32_t i;
+    
+    chunks = (p->sectors * 4096 + W25QXX_PROGRAM_CHUNK - 1) / W25QXX_PROGRAM_CHUNK;
+    for (c = 0; c < chunks; c++)
+    {
+        pthread_mutex_lock(&p->mutex);
+        while (c - p->tail_chunk >= W25QXX_PROGRAM_RING)
+        {
+            pthread_cond_wait(&p->cond, &p->mutex);
+        }
+        pthread_mutex_unlock(&p->mutex);
+        addr = c * W25QXX_PROGRAM_CHUNK;
+        n = p->sectors * 4096 - addr;
+        n = (n > W25QXX_PROGRAM_CHUNK) ? W25QXX_PROGRAM_CHUNK : n;
+        for (i = 0; i < n; i += 4096)
+        {
+            /* the spi backend moves at most 4096 bytes per transfer */
+            if (w25qxx_read(p->handle, addr + i, p->buf[c % W25QXX_PROGRAM_RING] + i, 4096) != 0)
+            {
+                pthread_mutex_lock(&p->mutex);
+                p->error = 1;
+                pthread_cond_broadcast(&p->cond);
+                pthread_mutex_unlock(&p->mutex);
+                
+                return NULL;
+            }
+        }
+        pthread_mutex_lock(&p->mutex);
+        p->head = c + 1;
+        pthread_cond_broadcast(&p->cond);
+        pthread_mutex_unlock(&p->mutex);
+    }
+    
+    return NULL;
+}
+
+/**
+ * @brief     program compare one sector
+ * @param[in] *p points to a program context
+ * @param[in] s is the sector
+ * @param[in] *chip points to the sector read from the chip
+ * @note      none
+ */
+static void a_program_compare(program_t *p, uint32_t s, const uint8_t *chip)
+{
+    const uint8_t *img;
+    uint32_t i;
+    uint32_t j;
+    uint8_t state;
+    
+    if ((s + 1) * 4096 > p->len)
+    {
+        /* keep the old bytes behind the image */
+        memcpy(p->tail, chip, 4096);
+        memcpy(p->tail, p->image + s * 4096, p->len - s * 4096);
+    }
+    img = a_program_sector(p, s);
+    state = PROGRAM_SAME;
+    for (i = 0; i < 4096; i += 256)
+    {
+        if (memcmp(&chip[i], &img[i], 256) == 0)
+        {
+            continue;
+        }
+        p->dirty[s * 16 + i / 256] = 1;
+        if (state == PROGRAM_SAME)
+        {
+            state = PROGRAM_ONLY;
+        }
+        for (j = i; (j < i + 256) && (state != PROGRAM_ERASE); j++)
+        {
+            if ((chip[j] & img[j]) != img[j])
+            {
+                state = PROGRAM_ERASE;
+            }
+        }
+    }
+    p->state[s] = state;
+}
+
+/**
+ * @brief     program check a sector run
+ * @param[in] *p points to a program context
+ * @param[in] first is the first sector
+ * @param[in] num is the sector number
+ * @return    1 if every sector of the run exists and needs an erase, otherwise 0
+ * @note      none
+ */
+static uint8_t a_program_erase_run(program_t *p, uint32_t first, uint32_t num)
+{
+    uint32_t s;
+    
+    if (first + num > p->sectors)
+    {
+        return 0;
+    }
+    for (s = first; s < first + num; s++)
+    {
+        if (p->state[s] != PROGRAM_ERASE)
+        {
+            return 0;
+        }
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief     program check a blank page
+ * @param[in] *buf points to a page
+ * @return    1 if the page is 0xFF, otherwise 0
+ * @note      none
+ */
+static uint8_t a_program_blank(const uint8_t *buf)
+{
+    uint32_t i;
+    
+    for (i = 0; i < 256; i++)
+    {
+        if (buf[i] != 0xFF)
+        {
+            return 0;
+        }
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief      program an image and only rewrite the changed sectors
+ * @param[in]  *handle points to an inited w25qxx handle structure
+ * @param[in]  *image points to the image
+ * @param[in]  len is the image length, the image starts at address 0
+ * @param[out] *report points to a report buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 program failed
+ *             - 5 verification failed
+ * @note       none
+ */
+uint8_t w25qxx_program_image(w25qxx_handle_t *handle, const uint8_t *image, uint32_t len, w25qxx_program_report_t *report)
+{
+    program_t *p;
+    pthread_t reader;
+    uint8_t ready;
+    uint8_t res;
+    uint32_t c;
+    uint32_t s;
+    uint32_t i;
+    uint32_t n;
+    uint32_t addr;
+    const uint8_t *img;
+    double t;
+    
+    memset(report, 0, sizeof(w25qxx_program_report_t));
+    p = (program_t *)calloc(1, sizeof(program_t));
+    if (p == NULL)
+    {
+        return 1;
+    }
+    p->handle = handle;
+    p->image = image;
+    p->len = len;
+    p->sectors = (len + 4095) / 4096;
+    p->state = (uint8_t *)calloc(p->sectors, 1);
+    p->dirty = (uint8_t *)calloc(p->sectors * 16, 1);
+    for (i = 0; i < W25QXX_PROGRAM_RING; i++)
+    {
+        p->buf[i] = (uint8_t *)malloc(W25QXX_PROGRAM_CHUNK);
+    }
+    res = 1;
+    if ((p->state == NULL) || (p->dirty == NULL) || (len == 0))
+    {
+        goto exit;
+    }
+    for (i = 0; i < W25QXX_PROGRAM_RING; i++)
+    {
+        if (p->buf[i] == NULL)
+        {
+            goto exit;
+        }
+    }
+    report->sectors = p->sectors;
+    pthread_mutex_init(&p->mutex, NULL);
+    pthread_cond_init(&p->cond, NULL);
+    
+    /* compare while the next chunks are read */
+    t = a_program_now();
+    if (pthread_create(&reader, NULL, a_program_reader, p) != 0)
+    {
+        goto exit;
+    }
+    for (c = 0; c * W25QXX_PROGRAM_CHUNK < p->sectors * 4096; c++)
+    {
+        pthread_mutex_lock(&p->mutex);
+        while ((p->head <= c) && (p->error == 0))
+        {
+            pthread_cond_wait(&p->cond, &p->mutex);
+        }
+        ready = (p->head > c) ? 1 : 0;
+        pthread_mutex_unlock(&p->mutex);
+        if (ready == 0)
+        {
+            break;
+        }
+        n = p->sectors * 4096 - c * W25QXX_PROGRAM_CHUNK;
+        n = (n > W25QXX_PROGRAM_CHUNK) ? W25QXX_PROGRAM_CHUNK : n;
+        for (i = 0; i < n; i += 4096)
+        {
+            a_program_compare(p, (c * W25QXX_PROGRAM_CHUNK + i) / 4096, p->buf[c % W25QXX_PROGRAM_RING] + i);
+        }
+        pthread_mutex_lock(&p->mutex);
+        p->tail_chunk = c + 1;
+        pthread_cond_broadcast(&p->cond);
+        pthread_mutex_unlock(&p->mutex);
+    }
+    pthread_join(reader, NULL);
+    if (p->error != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: read failed.\n");
+        
+        goto exit;
+    }
+    report->compare_s = a_program_now() - t;
+    
+    /* erase with the largest blocks */
+    t = a_program_now();
+    s = 0;
+    while (s < p->sectors)
+    {
+        if (((s % 16) == 0) && (a_program_erase_run(p, s, 16) != 0))
+        {
+            if (w25qxx_block_erase_64k(handle, s * 4096) != 0)
+            {
+                goto exit;
+            }
+            report->erase_64k++;
+            s += 16;
+        }
+        else if (((s % 8) == 0) && (a_program_erase_run(p, s, 8) != 0))
+        {
+            if (w25qxx_block_erase_32k(handle, s * 4096) != 0)
+            {
+                goto exit;
+            }
+            report->erase_32k++;
+            s += 8;
+        }
+        else
+        {
+            if (p->state[s] == PROGRAM_ERASE)
+            {
+                if (w25qxx_sector_erase_4k(handle, s * 4096) != 0)
+                {
+                    goto exit;
+                }
+                report->erase_4k++;
+            }
+            s++;
+        }
+    }
+    
+    /* program the changed pages */
+    for (s = 0; s < p->sectors; s++)
+    {
+        if (p->state[s] == PROGRAM_SAME)
+        {
+            report->same++;
+            
+            continue;
+        }
+        if (p->state[s] == PROGRAM_ERASE)
+        {
+            report->erased++;
+        }
+        else
+        {
+            report->program_only++;
+        }
+        img = a_program_sector(p, s);
+        for (i = 0; i < 16; i++)
+        {
+            addr = s * 4096 + i * 256;
+            if (((p->state[s] == PROGRAM_ERASE) && (a_program_blank(&img[i * 256]) == 0)) ||
+                ((p->state[s] == PROGRAM_ONLY) && (p->dirty[s * 16 + i] != 0)))
+            {
+                if (w25qxx_page_program(handle, addr, (uint8_t *)&img[i * 256], 256) != 0)
+                {
+                    goto exit;
+                }
+                report->pages++;
+            }
+        }
+    }
+    report->write_s = a_program_now() - t;
+    
+    /* verify the rewritten sectors */
+    t = a_program_now();
+    for (s = 0; s < p->sectors; s++)
+    {
+        if (p->state[s] == PROGRAM_SAME)
+        {
+            continue;
+        }
+        if (w25qxx_verify_range(handle, s * 4096, 4096, w25qxx_crc32(0, a_program_sector(p, s), 4096)) != 0)
+        {
+            report->failed++;
+        }
+    }
+    report->verify_s = a_program_now() - t;
+    res = (report->failed != 0) ? 5 : 0;
+    
+    exit:
+    
+    free(p->state);
+    free(p->dirty);
+    for (i = 0; i < W25QXX_PROGRAM_RING; i++)
+    {
+        free(p->buf[i]);
+    }
+    free(p);
+    
+    return res;
+}
+
+/**
+ * @brief     program an image file into the chip
+ * @param[in] *path points to the image file
+ * @param[in] type is the chip type
+ * @return    status code
+ *            - 0 success
+ *            - 1 program failed
+ *            - 4 image is too large
+ *            - 5 verification failed
+ * @note      none
+ */
+uint8_t w25qxx_program_run(char *path, w25qxx_type_t type)
+{
+    const uint32_t size[] = {0x100000, 0x200000, 0x400000, 0x800000, 0x1000000, 0x2000000};
+    uint8_t res;
+    uint8_t *image;
+    long len;
+    FILE *fp;
+    double total;
+    w25qxx_handle_t handle;
+    w25qxx_program_report_t report;
+    
+    /* load the image */
+    fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        w25qxx_interface_debug_print("w25qxx: open %s failed.\n", path);
+        
+        return 1;
+    }
+    (void)fseek(fp, 0, SEEK_END);
+    len = ftell(fp);
+    (void)fseek(fp, 0, SEEK_SET);
+    if ((len <= 0) || ((uint32_t)len > size[type - W25Q80]))
+    {
+        w25qxx_interface_debug_print("w25qxx: image size %ld is invalid.\n", len);
+        (void)fclose(fp);
+        
+        return 4;
+    }
+    image = (uint8_t *)malloc(len);
+    if (image == NULL)
+    {
+        (void)fclose(fp);
+        
+        return 1;
+    }
+    if (fread(image, 1, len, fp) != (size_t)len)
+    {
+        w25qxx_interface_debug_print("w25qxx: read %s failed.\n", path);
+        (void)fclose(fp);
+        free(image);
+        
+        return 1;
+    }
+    (void)fclose(fp);
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&handle, w25qxx_interface_debug_print);
+    
+    /* chip init */
+    res = w25qxx_set_type(&handle, type);
+    res |= w25qxx_set_interface(&handle, W25QXX_INTERFACE_SPI);
+    res |= w25qxx_set_dual_quad_spi(&handle, W25QXX_BOOL_FALSE);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set chip failed.\n");
+        free(image);
+        
+        return 1;
+    }
+    res = w25qxx_init(&handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+        free(image);
+        
+        return 1;
+    }
+    if (type >= W25Q256)
+    {
+        res = w25qxx_set_address_mode(&handle, W25QXX_ADDRESS_MODE_4_BYTE);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: set address mode failed.\n");
+            (void)w25qxx_deinit(&handle);
+            free(image);
+            
+            return 1;
+        }
+    }
+    
+    /* program */
+    res = w25qxx_program_image(&handle, image, (uint32_t)len, &report);
+    total = report.compare_s + report.write_s + report.verify_s;
+    w25qxx_interface_debug_print("w25qxx: %d sectors, %d same, %d programmed, %d erased and programmed.\n",
+                                 report.sectors, report.same, report.program_only, report.erased);
+    w25qxx_interface_debug_print("w25qxx: %d 64k erases, %d 32k erases, %d 4k erases, %d pages.\n",
+                                 report.erase_64k, report.erase_32k, report.erase_4k, report.pages);
+    w25qxx_interface_debug_print("w25qxx: compare %0.2fs(%0.2fMB/s), write %0.2fs, verify %0.2fs, total %0.2fs.\n",
+                                 report.compare_s, report.compare_s > 0 ? (double)len / report.compare_s / 1048576.0 : 0.0,
+                                 report.write_s, report.verify_s, total);
+    if (res == 5)
+    {
+        w25qxx_interface_debug_print("w25qxx: %d sectors failed the verification.\n", report.failed);
+    }
+    else if (res != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: program failed.\n");
+    }
+    else
+    {
+        w25qxx_interface_debug_print("w25qxx: program ok.\n");
+    }
+    (void)w25qxx_deinit(&handle);
+    free(image);
+    
+    return res;
+}
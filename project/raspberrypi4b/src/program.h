@@ -0,0 +1,106 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      program.h
+ * @brief     program header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _PROGRAM_H_
+#define _PROGRAM_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief program definition
+ */
+#define W25QXX_PROGRAM_CHUNK        65536        /**< bytes of one pipelined chunk */
+#define W25QXX_PROGRAM_RING         4            /**< pipelined read buffers */
+
+/**
+ * @brief program report structure definition
+ */
+typedef struct w25qxx_program_report_s
+{
+    uint32_t sectors;             /**< sectors covered by the image */
+    uint32_t same;                /**< sectors already equal */
+    uint32_t program_only;        /**< sectors programmed without an erase */
+    uint32_t erased;              /**< sectors erased and programmed */
+    uint32_t erase_64k;           /**< 64k block erases */
+    uint32_t erase_32k;           /**< 32k block erases */
+    uint32_t erase_4k;            /**< 4k sector erases */
+    uint32_t pages;               /**< programmed pages */
+    uint32_t failed;              /**< sectors failing the crc verification */
+    double compare_s;             /**< compare time */
+    double write_s;               /**< erase and program time */
+    double verify_s;              /**< verification time */
+} w25qxx_program_report_t;
+
+/**
+ * @brief      program an image and only rewrite the changed sectors
+ * @param[in]  *handle points to an inited w25qxx handle structure
+ * @param[in]  *image points to the image
+ * @param[in]  len is the image length, the image starts at address 0
+ * @param[out] *report points to a report buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 program failed
+ *             - 5 verification failed
+ * @note       the chip is read in W25QXX_PROGRAM_CHUNK chunks by a reader thread while the
+ *             sectors are compared, a sector whose new bits only go from 1 to 0 is programmed
+ *             without an erase, whole 64k and 32k blocks use the block erases, blank pages are
+ *             skipped and every rewritten sector is verified with its crc32,
+ *             the bytes after a partial last sector keep their old content
+ */
+uint8_t w25qxx_program_image(w25qxx_handle_t *handle, const uint8_t *image, uint32_t len, w25qxx_program_report_t *report);
+
+/**
+ * @brief     program an image file into the chip
+ * @param[in] *path points to the image file
+ * @param[in] type is the chip type
+ * @return    status code
+ *            - 0 success
+ *            - 1 program failed
+ *            - 4 image is too large
+ *            - 5 verification failed
+ * @note      none
+ */
+uint8_t w25qxx_program_run(char *path, w25qxx_type_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      simulator_driver_w25qxx_interface.c
+ * @brief     simulator driver w25qxx interface source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_interface.h"
+#include "driver_w25qxx_benchmark_test.h"
+#include "sim_flash.h"
+#include <stdarg.h>
+
+/**
+ * @brief  interface spi qspi bus init
+ * @return status code
+ *         - 0 success
+ *         - 1 spi qspi init failed
+ * @note   none
+ */
+uint8_t w25qxx_interface_spi_qspi_init(void)
+{
+    return sim_flash_init();
+}
+
+/**
+ * @brief  interface spi qspi bus deinit
+ * @return status code
+ *         - 0 success
+ *         - 1 spi qspi deinit failed
+ * @note   none
+ */
+uint8_t w25qxx_interface_spi_qspi_deinit(void)
+{
+    return sim_flash_deinit();
+}
+
+/**
+ * @brief      interface spi qspi bus write read
+ * @param[in]  instruction is the sent instruction
+ * @param[in]  instruction_line is the instruction phy lines
+ * @param[in]  address is the register address
+ * @param[in]  address_line is the address phy lines
+ * @param[in]  address_len is the address length
+ * @param[in]  alternate is the register address
+ * @param[in]  alternate_line is the alternate phy lines
+ * @param[in]  alternate_len is the alternate length
+ * @param[in]  dummy is the dummy cycle
+ * @param[in]  *in_buf points to a input buffer
+ * @param[in]  in_len is the input length
+ * @param[out] *out_buf points to a output buffer
+ * @param[in]  out_len is the output length
+ * @param[in]  data_line is the data phy lines
+ * @return     status code
+ *             - 0 success
+ *             - 1 write read failed
+ * @note       none
+ */
+uint8_t w25qxx_interface_spi_qspi_write_read(uint8_t instruction, uint8_t instruction_line,
+                                             uint32_t address, uint8_t address_line, uint8_t address_len,
+                                             uint32_t alternate, uint8_t alternate_line, uint8_t alternate_len,
+                                             uint8_t dummy, uint8_t *in_buf, uint32_t in_len,
+                                             uint8_t *out_buf, uint32_t out_len, uint8_t data_line)
+{
+    return sim_flash_write_read(instruction, instruction_line,
+                                address, address_line, address_len,
+                                alternate, alternate_line, alternate_len,
+                                dummy, in_buf, in_len,
+                                out_buf, out_len, data_line);
+}
+
+/**
+ * @brief     interface delay ms
+ * @param[in] ms
+ * @note      advances the simulated clock
+ */
+void w25qxx_interface_delay_ms(uint32_t ms)
+{
+    sim_flash_delay_us(1000 * ms);
+}
+
+/**
+ * @brief     interface delay us
+ * @param[in] us
+ * @note      advances the simulated clock
+ */
+void w25qxx_interface_delay_us(uint32_t us)
+{
+    sim_flash_delay_us(us);
+}
+
+/**
+ * @brief     interface print format data
+ * @param[in] fmt is the format data
+ * @return    length of the send data
+ * @note      none
+ */
+uint16_t w25qxx_interface_debug_print(char *fmt, ...)
+{
+    char str[256];
+    uint16_t len;
+    va_list args;
+    
+    memset((char *)str, 0, sizeof(char) * 256); 
+    va_start(args, fmt);
+    vsnprintf((char *)str, 256, (char const *)fmt, args);
+    va_end(args);
+    
+    len = strlen((char *)str);
+    if (fputs(str, stdout) < 0)
+    {
+        return 0;
+    }
+    else
+    { 
+        return len;
+    }
+}
+
+/**
+ * @brief  benchmark test interface timestamp
+ * @return simulated time in us
+ * @note   none
+ */
+uint64_t w25qxx_benchmark_test_interface_timestamp_us(void)
+{
+    return sim_flash_get_time_ns() / 1000;
+}
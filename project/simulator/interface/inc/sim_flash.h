@@ -0,0 +1,152 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      sim_flash.h
+ * @brief     simulated flash header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _SIM_FLASH_H_
+#define _SIM_FLASH_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief sim flash default bus frequency definition
+ */
+#define SIM_FLASH_DEFAULT_FREQ        (1000 * 1000)        /**< 1 MHz, the same as the raspberrypi4b backend */
+
+/**
+ * @brief     sim flash set the chip id
+ * @param[in] id is the manufacturer device id, such as 0xEF16 for w25q64
+ * @note      call it before sim_flash_init, a different id drops the old flash array
+ */
+void sim_flash_set_id(uint16_t id);
+
+/**
+ * @brief  sim flash init
+ * @return status code
+ *         - 0 success
+ *         - 1 init failed
+ * @note   the flash array keeps its content until sim_flash_destroy is called,
+ *         so a deinit and init sequence behaves like a power cycle
+ */
+uint8_t sim_flash_init(void);
+
+/**
+ * @brief  sim flash deinit
+ * @return status code
+ *         - 0 success
+ *         - 1 deinit failed
+ * @note   the flash array is kept
+ */
+uint8_t sim_flash_deinit(void);
+
+/**
+ * @brief  sim flash destroy
+ * @note   frees the flash array, the next init starts from an erased chip
+ */
+void sim_flash_destroy(void);
+
+/**
+ * @brief      sim flash bus write read
+ * @param[in]  instruction is the sent instruction
+ * @param[in]  instruction_line is the instruction phy lines
+ * @param[in]  address is the register address
+ * @param[in]  address_line is the address phy lines
+ * @param[in]  address_len is the address length
+ * @param[in]  alternate is the register address
+ * @param[in]  alternate_line is the alternate phy lines
+ * @param[in]  alternate_len is the alternate length
+ * @param[in]  dummy is the dummy cycle
+ * @param[in]  *in_buf points to a input buffer
+ * @param[in]  in_len is the input length
+ * @param[out] *out_buf points to a output buffer
+ * @param[in]  out_len is the output length
+ * @param[in]  data_line is the data phy lines
+ * @return     status code
+ *             - 0 success
+ *             - 1 write read failed
+ * @note       instruction_line == 0 means a raw spi frame whose first byte is the command
+ */
+uint8_t sim_flash_write_read(uint8_t instruction, uint8_t instruction_line,
+                             uint32_t address, uint8_t address_line, uint8_t address_len,
+                             uint32_t alternate, uint8_t alternate_line, uint8_t alternate_len,
+                             uint8_t dummy, uint8_t *in_buf, uint32_t in_len,
+                             uint8_t *out_buf, uint32_t out_len, uint8_t data_line);
+
+/**
+ * @brief     sim flash advance the virtual clock
+ * @param[in] us is the elapsed time in us
+ * @note      none
+ */
+void sim_flash_delay_us(uint32_t us);
+
+/**
+ * @brief  sim flash get the virtual clock
+ * @return virtual time in ns since the first init
+ * @note   none
+ */
+uint64_t sim_flash_get_time_ns(void);
+
+/**
+ * @brief     sim flash set the bus frequence
+ * @param[in] freq is the simulated bus frequence
+ * @note      none
+ */
+void sim_flash_set_freq(uint32_t freq);
+
+/**
+ * @brief  sim flash get the bus frequence
+ * @return simulated bus frequence
+ * @note   none
+ */
+uint32_t sim_flash_get_freq(void);
+
+/**
+ * @brief     sim flash set the transaction overhead
+ * @param[in] ns is the fixed cost of one bus transaction in ns
+ * @note      models the chip select and driver call overhead
+ */
+void sim_flash_set_transaction_overhead(uint32_t ns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
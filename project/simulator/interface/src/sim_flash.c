@@ -0,0 +1,1042 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      sim_flash.c
+ * @brief     simulated flash source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "sim_flash.h"
+
+/**
+ * @brief sim flash timing definition
+ * @note  typical values of the w25qxx datasheet
+ */
+#define SIM_FLASH_TIME_PAGE_PROGRAM_NS        (700ULL * 1000)                 /**< tPP 0.7 ms */
+#define SIM_FLASH_TIME_ERASE_4K_NS            (45ULL * 1000 * 1000)           /**< tSE 45 ms */
+#define SIM_FLASH_TIME_ERASE_32K_NS           (120ULL * 1000 * 1000)          /**< tBE1 120 ms */
+#define SIM_FLASH_TIME_ERASE_64K_NS           (150ULL * 1000 * 1000)          /**< tBE2 150 ms */
+#define SIM_FLASH_TIME_CHIP_ERASE_MB_NS       (2500ULL * 1000 * 1000)         /**< tCE 2.5 s per MByte */
+#define SIM_FLASH_TIME_WRITE_STATUS_NS        (10ULL * 1000 * 1000)           /**< tW 10 ms */
+
+/**
+ * @brief sim flash structure definition
+ */
+typedef struct sim_flash_s
+{
+    uint8_t *mem;                    /**< flash array */
+    uint8_t *lock;                   /**< individual lock bit of each 4k sector */
+    uint32_t size;                   /**< flash size */
+    uint16_t id;                     /**< manufacturer device id */
+    uint8_t inited;                  /**< inited flag */
+    uint8_t sr1;                     /**< status register 1 */
+    uint8_t sr2;                     /**< status register 2 */
+    uint8_t sr3;                     /**< status register 3 */
+    uint8_t wel;                     /**< write enable latch */
+    uint8_t volatile_sr;             /**< volatile status register write enable */
+    uint8_t ext_addr;                /**< extended address register */
+    uint8_t addr4;                   /**< 4 byte address mode */
+    uint8_t qpi;                     /**< qpi mode */
+    uint8_t power_down;              /**< power down flag */
+    uint8_t reset_enable;            /**< reset enable flag */
+    uint8_t read_param;              /**< qpi read parameters */
+    uint8_t wrap;                    /**< burst wrap */
+    uint8_t suspended;               /**< suspend flag */
+    uint64_t suspend_left;           /**< remaining busy time of the suspended operation */
+    uint64_t busy_until;             /**< busy end time */
+    uint64_t time_ns;                /**< virtual clock */
+    uint32_t freq;                   /**< bus frequence */
+    uint32_t overhead_ns;            /**< transaction overhead */
+    uint8_t security[4][256];        /**< security registers */
+    uint8_t sfdp[256];               /**< sfdp table */
+} sim_flash_t;
+
+static sim_flash_t gs_flash = {.freq = SIM_FLASH_DEFAULT_FREQ};        /**< simulated chip */
+
+/**
+ * @brief     get the chip size from the id
+ * @param[in] id is the manufacturer device id
+ * @return    chip size in bytes, 0 if the id is unknown
+ * @note      none
+ */
+static uint32_t a_sim_flash_size(uint16_t id)
+{
+    if ((id < 0xEF13) || (id > 0xEF18))
+    {
+        return 0;
+    }
+
+    return 0x100000U << (id - 0xEF13);
+}
+
+/**
+ * @brief     power up the volatile state
+ * @note      none
+ */
+static void a_sim_flash_power_up(void)
+{
+    gs_flash.sr1 &= 0xFC;
+    gs_flash.wel = 0;
+    gs_flash.volatile_sr = 0;
+    gs_flash.ext_addr = 0;
+    gs_flash.addr4 = (gs_flash.sr3 >> 1) & 0x01;
+    gs_flash.qpi = 0;
+    gs_flash.power_down = 0;
+    gs_flash.reset_enable = 0;
+    gs_flash.read_param = 0;
+    gs_flash.wrap = 0x10;
+    gs_flash.suspended = 0;
+    gs_flash.suspend_left = 0;
+    gs_flash.busy_until = gs_flash.time_ns;
+}
+
+/**
+ * @brief     set the chip id
+ * @param[in] id is the manufacturer device id, such as 0xEF16 for w25q64
+ * @note      call it before sim_flash_init, a different id drops the old flash array
+ */
+void sim_flash_set_id(uint16_t id)
+{
+    if (id != gs_flash.id)
+    {
+        sim_flash_destroy();
+        gs_flash.id = id;
+    }
+}
+
+/**
+ * @brief  sim flash init
+ * @return status code
+ *         - 0 success
+ *         - 1 init failed
+ * @note   the flash array keeps its content until sim_flash_destroy is called,
+ *         so a deinit and init sequence behaves like a power cycle
+ */
+uint8_t sim_flash_init(void)
+{
+    uint32_t i;
+
+    if (gs_flash.mem == NULL)
+    {
+        gs_flash.size = a_sim_flash_size(gs_flash.id);
+        if (gs_flash.size == 0)
+        {
+            fprintf(stderr, "sim_flash: id 0x%04X is invalid.\n", gs_flash.id);
+
+            return 1;
+        }
+        gs_flash.mem = (uint8_t *)malloc(gs_flash.size);
+        gs_flash.lock = (uint8_t *)malloc(gs_flash.size / 4096);
+        if ((gs_flash.mem == NULL) || (gs_flash.lock == NULL))
+        {
+            fprintf(stderr, "sim_flash: malloc failed.\n");
+            sim_flash_destroy();
+
+            return 1;
+        }
+        memset(gs_flash.mem, 0xFF, gs_flash.size);
+        memset(gs_flash.lock, 0x01, gs_flash.size / 4096);
+        memset(gs_flash.security, 0xFF, sizeof(gs_flash.security));
+        memset(gs_flash.sfdp, 0xFF, sizeof(gs_flash.sfdp));
+        gs_flash.sfdp[0] = 'S';
+        gs_flash.sfdp[1] = 'F';
+        gs_flash.sfdp[2] = 'D';
+        gs_flash.sfdp[3] = 'P';
+        gs_flash.sfdp[4] = 0x05;
+        gs_flash.sfdp[5] = 0x01;
+        gs_flash.sfdp[6] = 0x00;
+        gs_flash.sfdp[7] = 0xFF;
+        for (i = 0; i < 8; i++)
+        {
+            gs_flash.sfdp[0x80 + i] = (uint8_t)(gs_flash.id >> ((i & 1) * 8)) ^ (uint8_t)(i * 0x11);
+        }
+        gs_flash.sr1 = 0x00;
+        gs_flash.sr2 = 0x02;                            /* quad enable is set by default like the iq parts */
+        gs_flash.sr3 = 0x60;
+    }
+    a_sim_flash_power_up();
+    gs_flash.inited = 1;
+
+    return 0;
+}
+
+/**
+ * @brief  sim flash deinit
+ * @return status code
+ *         - 0 success
+ *         - 1 deinit failed
+ * @note   the flash array is kept
+ */
+uint8_t sim_flash_deinit(void)
+{
+    if (gs_flash.inited != 1)
+    {
+        return 1;
+    }
+    gs_flash.inited = 0;
+
+    return 0;
+}
+
+/**
+ * @brief  sim flash destroy
+ * @note   frees the flash array, the next init starts from an erased chip
+ */
+void sim_flash_destroy(void)
+{
+    free(gs_flash.mem);
+    free(gs_flash.lock);
+    gs_flash.mem = NULL;
+    gs_flash.lock = NULL;
+    gs_flash.size = 0;
+    gs_flash.inited = 0;
+}
+
+/**
+ * @brief  check the busy status
+ * @return 1 if busy
+ * @note   none
+ */
+static uint8_t a_sim_flash_busy(void)
+{
+    return (gs_flash.time_ns < gs_flash.busy_until) ? 1 : 0;
+}
+
+/**
+ * @brief     start a busy period
+ * @param[in] ns is the busy time
+ * @note      none
+ */
+static void a_sim_flash_set_busy(uint64_t ns)
+{
+    gs_flash.busy_until = gs_flash.time_ns + ns;
+    gs_flash.wel = 0;
+}
+
+/**
+ * @brief     map a command address to the flash array
+ * @param[in] addr is the command address
+ * @return    array offset
+ * @note      none
+ */
+static uint32_t a_sim_flash_map(uint32_t addr)
+{
+    if ((gs_flash.addr4 == 0) && (gs_flash.size > 0x1000000))
+    {
+        addr = ((uint32_t)gs_flash.ext_addr << 24) | (addr & 0xFFFFFF);
+    }
+
+    return addr % gs_flash.size;
+}
+
+/**
+ * @brief     check the individual lock of a range
+ * @param[in] addr is the array offset
+ * @param[in] len is the range length
+ * @return    1 if any sector of the range is locked
+ * @note      only valid when wps is set
+ */
+static uint8_t a_sim_flash_locked(uint32_t addr, uint32_t len)
+{
+    uint32_t i;
+
+    if ((gs_flash.sr3 & 0x04) == 0)
+    {
+        return 0;
+    }
+    for (i = addr / 4096; i <= (addr + len - 1) / 4096; i++)
+    {
+        if (gs_flash.lock[i])
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     erase a range
+ * @param[in] addr is the command address
+ * @param[in] size is the erase size
+ * @param[in] ns is the erase time
+ * @note      none
+ */
+static void a_sim_flash_erase(uint32_t addr, uint32_t size, uint64_t ns)
+{
+    addr = a_sim_flash_map(addr) & ~(size - 1);
+    if ((gs_flash.wel == 0) || a_sim_flash_locked(addr, size))
+    {
+        gs_flash.wel = 0;
+
+        return;
+    }
+    memset(&gs_flash.mem[addr], 0xFF, size);
+    a_sim_flash_set_busy(ns);
+}
+
+/**
+ * @brief     program a page
+ * @param[in] addr is the command address
+ * @param[in] *data points to a data buffer
+ * @param[in] len is the data length
+ * @note      only 1 to 0 transitions are possible and the address wraps inside the page
+ */
+static void a_sim_flash_program(uint32_t addr, uint8_t *data, uint32_t len)
+{
+    uint32_t base;
+    uint32_t i;
+
+    addr = a_sim_flash_map(addr);
+    base = addr & ~0xFFU;
+    if ((gs_flash.wel == 0) || a_sim_flash_locked(base, 256) || (data == NULL))
+    {
+        gs_flash.wel = 0;
+
+        return;
+    }
+    for (i = 0; i < len; i++)
+    {
+        gs_flash.mem[base + ((addr + i) & 0xFF)] &= data[i];
+    }
+    a_sim_flash_set_busy(SIM_FLASH_TIME_PAGE_PROGRAM_NS);
+}
+
+/**
+ * @brief      read the array
+ * @param[in]  addr is the command address
+ * @param[out] *out points to a output buffer
+ * @param[in]  len is the output length
+ * @param[in]  wrap is the burst wrap length, 0 means linear
+ * @note       none
+ */
+static void a_sim_flash_read(uint32_t addr, uint8_t *out, uint32_t len, uint32_t wrap)
+{
+    uint32_t i;
+
+    addr = a_sim_flash_map(addr);
+    for (i = 0; i < len; i++)
+    {
+        if (wrap != 0)
+        {
+            out[i] = gs_flash.mem[(addr & ~(wrap - 1)) + ((addr + i) & (wrap - 1))];
+        }
+        else
+        {
+            out[i] = gs_flash.mem[(addr + i) % gs_flash.size];
+        }
+    }
+}
+
+/**
+ * @brief     set the lock of a block or a sector
+ * @param[in] addr is the command address
+ * @param[in] value is the lock value
+ * @note      the top and bottom blocks are locked by sector, the others by 64k block
+ */
+static void a_sim_flash_set_lock(uint32_t addr, uint8_t value)
+{
+    uint32_t block;
+
+    addr = a_sim_flash_map(addr);
+    block = addr / 65536;
+    if ((block == 0) || (block == gs_flash.size / 65536 - 1))
+    {
+        gs_flash.lock[addr / 4096] = value;
+    }
+    else
+    {
+        memset(&gs_flash.lock[block * 16], value, 16);
+    }
+}
+
+/**
+ * @brief     check whether a command carries an address
+ * @param[in] cmd is the command
+ * @return    address length in bytes of a raw spi frame
+ * @note      none
+ */
+static uint8_t a_sim_flash_raw_address_len(uint8_t cmd)
+{
+    switch (cmd)
+    {
+        case 0x03 :
+        case 0x0B :
+        case 0x02 :
+        case 0x20 :
+        case 0x52 :
+        case 0xD8 :
+        case 0x36 :
+        case 0x39 :
+        case 0x3D :
+        case 0x44 :
+        case 0x42 :
+        case 0x48 :
+        {
+            return gs_flash.addr4 ? 4 : 3;
+        }
+        case 0x5A :
+        case 0x90 :
+        {
+            return 3;
+        }
+        default :
+        {
+            return 0;
+        }
+    }
+}
+
+/**
+ * @brief         apply the qpi read dummy timing
+ * @param[in]     dummy is the dummy clocks sent by the host
+ * @param[in,out] *out points to the data phase read by the host
+ * @param[in]     out_len is the read data length
+ * @note          the data is shifted when the host dummy clocks differ from the read parameters
+ *                and damaged when the read parameters are too short for the bus frequence,
+ *                the limits are 2 dummy up to 33 MHz, 4 up to 55 MHz and 6 up to 80 MHz
+ */
+static void a_sim_flash_qpi_dummy(uint8_t dummy, uint8_t *out, uint32_t out_len)
+{
+    uint8_t param;
+    uint8_t need;
+    uint32_t shift;
+    uint32_t i;
+
+    param = (uint8_t)(((gs_flash.read_param >> 4) & 0x03) * 2 + 2);
+    if (gs_flash.freq <= 33000000)
+    {
+        need = 2;
+    }
+    else if (gs_flash.freq <= 55000000)
+    {
+        need = 4;
+    }
+    else if (gs_flash.freq <= 80000000)
+    {
+        need = 6;
+    }
+    else
+    {
+        need = 8;
+    }
+    if (dummy != param)                                                                          /* two clocks per qpi byte */
+    {
+        shift = (uint32_t)((dummy > param) ? (dummy - param) : (param - dummy)) / 2;
+        shift = (shift > out_len) ? out_len : shift;
+        memmove(out, out + shift, out_len - shift);
+        memset(out + out_len - shift, 0xFF, shift);
+    }
+    if (param < need)                                                                            /* sampled too early */
+    {
+        for (i = 0; i < out_len; i++)
+        {
+            out[i] ^= (uint8_t)(1 << (i & 0x07));
+        }
+    }
+}
+
+/**
+ * @brief      execute one command
+ * @param[in]  cmd is the command
+ * @param[in]  addr is the command address
+ * @param[in]  *in points to the data phase written by the host
+ * @param[in]  in_len is the written data length
+ * @param[out] *out points to the data phase read by the host
+ * @param[in]  out_len is the read data length
+ * @note       none
+ */
+static void a_sim_flash_command(uint8_t cmd, uint32_t addr, uint8_t *in, uint32_t in_len, uint8_t *out, uint32_t out_len)
+{
+    uint32_t i;
+
+    if (out_len != 0)
+    {
+        memset(out, 0xFF, out_len);
+    }
+    if (gs_flash.power_down && (cmd != 0xAB))
+    {
+        return;
+    }
+    if (a_sim_flash_busy() && (cmd != 0x05) && (cmd != 0x35) && (cmd != 0x15) &&
+        (cmd != 0x75) && (cmd != 0x66) && (cmd != 0x99))
+    {
+        return;
+    }
+    if ((gs_flash.reset_enable != 0) && (cmd != 0x99))
+    {
+        gs_flash.reset_enable = 0;
+    }
+    switch (cmd)
+    {
+        case 0x06 :
+        {
+            gs_flash.wel = 1;
+
+            break;
+        }
+        case 0x04 :
+        {
+            gs_flash.wel = 0;
+
+            break;
+        }
+        case 0x50 :
+        {
+            gs_flash.volatile_sr = 1;
+
+            break;
+        }
+        case 0x05 :
+        {
+            for (i = 0; i < out_len; i++)
+            {
+                out[i] = (gs_flash.sr1 & 0xFC) | (gs_flash.wel << 1) | a_sim_flash_busy();
+            }
+
+            break;
+        }
+        case 0x35 :
+        {
+            for (i = 0; i < out_len; i++)
+            {
+                out[i] = (gs_flash.sr2 & 0x7F) | (gs_flash.suspended << 7);
+            }
+
+            break;
+        }
+        case 0x15 :
+        {
+            for (i = 0; i < out_len; i++)
+            {
+                out[i] = (gs_flash.sr3 & 0xFE) | gs_flash.addr4;
+            }
+
+            break;
+        }
+        case 0x01 :
+        case 0x31 :
+        case 0x11 :
+        {
+            if ((in_len == 0) || ((gs_flash.wel == 0) && (gs_flash.volatile_sr == 0)))
+            {
+                gs_flash.volatile_sr = 0;
+
+                break;
+            }
+            if (cmd == 0x01)
+            {
+                gs_flash.sr1 = in[0] & 0xFC;
+            }
+            else if (cmd == 0x31)
+            {
+                gs_flash.sr2 = (in[0] & 0x43) | (gs_flash.sr2 & 0x38) | (in[0] & 0x38);
+            }
+            else
+            {
+                gs_flash.sr3 = in[0] & 0xE6;
+            }
+            if (gs_flash.wel)
+            {
+                a_sim_flash_set_busy(SIM_FLASH_TIME_WRITE_STATUS_NS);
+            }
+            gs_flash.volatile_sr = 0;
+
+            break;
+        }
+        case 0x02 :
+        case 0x32 :
+        {
+            a_sim_flash_program(addr, in, in_len);
+
+            break;
+        }
+        case 0x20 :
+        {
+            a_sim_flash_erase(addr, 4096, SIM_FLASH_TIME_ERASE_4K_NS);
+
+            break;
+        }
+        case 0x52 :
+        {
+            a_sim_flash_erase(addr, 32768, SIM_FLASH_TIME_ERASE_32K_NS);
+
+            break;
+        }
+        case 0xD8 :
+        {
+            a_sim_flash_erase(addr, 65536, SIM_FLASH_TIME_ERASE_64K_NS);
+
+            break;
+        }
+        case 0xC7 :
+        case 0x60 :
+        {
+            if ((gs_flash.wel == 0) || a_sim_flash_locked(0, gs_flash.size))
+            {
+                gs_flash.wel = 0;
+
+                break;
+            }
+            memset(gs_flash.mem, 0xFF, gs_flash.size);
+            a_sim_flash_set_busy(SIM_FLASH_TIME_CHIP_ERASE_MB_NS * (gs_flash.size / 0x100000));
+
+            break;
+        }
+        case 0x03 :
+        case 0x0B :
+        case 0x3B :
+        case 0x6B :
+        case 0xBB :
+        {
+            a_sim_flash_read(addr, out, out_len, 0);
+
+            break;
+        }
+        case 0xEB :
+        case 0xE7 :
+        case 0xE3 :
+        {
+            if ((gs_flash.qpi == 0) && ((gs_flash.wrap & 0x10) == 0) && (cmd != 0xE3))
+            {
+                a_sim_flash_read(addr, out, out_len, 8U << ((gs_flash.wrap >> 5) & 0x03));
+            }
+            else
+            {
+                a_sim_flash_read(addr, out, out_len, 0);
+            }
+
+            break;
+        }
+        case 0x5A :
+        {
+            for (i = 0; i < out_len; i++)
+            {
+                out[i] = gs_flash.sfdp[(addr + i) & 0xFF];
+            }
+
+            break;
+        }
+        case 0x4B :
+        {
+            for (i = 0; i < out_len; i++)
+            {
+                out[i] = (uint8_t)(0xD0 + i) ^ (uint8_t)gs_flash.id;
+            }
+
+            break;
+        }
+        case 0x90 :
+        case 0x92 :
+        case 0x94 :
+        {
+            for (i = 0; i < out_len; i++)
+            {
+                if (((i + (addr & 0x01)) % 2) == 0)
+                {
+                    out[i] = (gs_flash.id >> 8) & 0xFF;
+                }
+                else
+                {
+                    out[i] = gs_flash.id & 0xFF;
+                }
+            }
+
+            break;
+        }
+        case 0x9F :
+        {
+            uint8_t jedec[3];
+
+            jedec[0] = (gs_flash.id >> 8) & 0xFF;
+            jedec[1] = 0x40;
+            jedec[2] = (gs_flash.id & 0xFF) + 1;
+            for (i = 0; i < out_len; i++)
+            {
+                out[i] = (i < 3) ? jedec[i] : 0xFF;
+            }
+
+            break;
+        }
+        case 0xAB :
+        {
+            gs_flash.power_down = 0;
+            for (i = 0; i < out_len; i++)
+            {
+                out[i] = gs_flash.id & 0xFF;
+            }
+
+            break;
+        }
+        case 0xB9 :
+        {
+            gs_flash.power_down = 1;
+
+            break;
+        }
+        case 0x7E :
+        {
+            memset(gs_flash.lock, 0x01, gs_flash.size / 4096);
+
+            break;
+        }
+        case 0x98 :
+        {
+            memset(gs_flash.lock, 0x00, gs_flash.size / 4096);
+
+            break;
+        }
+        case 0x36 :
+        {
+            a_sim_flash_set_lock(addr, 1);
+
+            break;
+        }
+        case 0x39 :
+        {
+            a_sim_flash_set_lock(addr, 0);
+
+            break;
+        }
+        case 0x3D :
+        {
+            for (i = 0; i < out_len; i++)
+            {
+                out[i] = gs_flash.lock[a_sim_flash_map(addr) / 4096];
+            }
+
+            break;
+        }
+        case 0x75 :
+        {
+            if (a_sim_flash_busy())
+            {
+                gs_flash.suspend_left = gs_flash.busy_until - gs_flash.time_ns;
+                gs_flash.busy_until = gs_flash.time_ns;
+                gs_flash.suspended = 1;
+            }
+
+            break;
+        }
+        case 0x7A :
+        {
+            if (gs_flash.suspended)
+            {
+                gs_flash.busy_until = gs_flash.time_ns + gs_flash.suspend_left;
+                gs_flash.suspend_left = 0;
+                gs_flash.suspended = 0;
+            }
+
+            break;
+        }
+        case 0x66 :
+        {
+            gs_flash.reset_enable = 1;
+
+            break;
+        }
+        case 0x99 :
+        {
+            if (gs_flash.reset_enable)
+            {
+                a_sim_flash_power_up();
+            }
+
+            break;
+        }
+        case 0x38 :
+        {
+            if (gs_flash.sr2 & 0x02)
+            {
+                gs_flash.qpi = 1;
+            }
+
+            break;
+        }
+        case 0xFF :
+        {
+            gs_flash.qpi = 0;
+
+            break;
+        }
+        case 0xC0 :
+        {
+            if (in_len != 0)
+            {
+                gs_flash.read_param = in[0];
+            }
+
+            break;
+        }
+        case 0x77 :
+        {
+            if (in_len != 0)
+            {
+                gs_flash.wrap = in[in_len - 1];
+            }
+
+            break;
+        }
+        case 0xC5 :
+        {
+            if ((in_len != 0) && gs_flash.wel)
+            {
+                gs_flash.ext_addr = in[0];
+            }
+            gs_flash.wel = 0;
+
+            break;
+        }
+        case 0xC8 :
+        {
+            for (i = 0; i < out_len; i++)
+            {
+                out[i] = gs_flash.ext_addr;
+            }
+
+            break;
+        }
+        case 0xB7 :
+        {
+            gs_flash.addr4 = 1;
+
+            break;
+        }
+        case 0xE9 :
+        {
+            gs_flash.addr4 = 0;
+
+            break;
+        }
+        case 0x44 :
+        {
+            uint8_t num = (addr >> 12) & 0x03;
+
+            if ((gs_flash.wel != 0) && ((num == 0) || ((gs_flash.sr2 & (1 << (2 + num))) == 0)))
+            {
+                memset(gs_flash.security[num], 0xFF, 256);
+                a_sim_flash_set_busy(SIM_FLASH_TIME_ERASE_4K_NS);
+            }
+            gs_flash.wel = 0;
+
+            break;
+        }
+        case 0x42 :
+        {
+            uint8_t num = (addr >> 12) & 0x03;
+
+            if ((gs_flash.wel != 0) && ((num == 0) || ((gs_flash.sr2 & (1 << (2 + num))) == 0)))
+            {
+                for (i = 0; i < in_len; i++)
+                {
+                    gs_flash.security[num][(addr + i) & 0xFF] &= in[i];
+                }
+                a_sim_flash_set_busy(SIM_FLASH_TIME_PAGE_PROGRAM_NS);
+            }
+            gs_flash.wel = 0;
+
+            break;
+        }
+        case 0x48 :
+        {
+            uint8_t num = (addr >> 12) & 0x03;
+
+            for (i = 0; i < out_len; i++)
+            {
+                out[i] = gs_flash.security[num][(addr + i) & 0xFF];
+            }
+
+            break;
+        }
+        default :
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief      sim flash bus write read
+ * @param[in]  instruction is the sent instruction
+ * @param[in]  instruction_line is the instruction phy lines
+ * @param[in]  address is the register address
+ * @param[in]  address_line is the address phy lines
+ * @param[in]  address_len is the address length
+ * @param[in]  alternate is the register address
+ * @param[in]  alternate_line is the alternate phy lines
+ * @param[in]  alternate_len is the alternate length
+ * @param[in]  dummy is the dummy cycle
+ * @param[in]  *in_buf points to a input buffer
+ * @param[in]  in_len is the input length
+ * @param[out] *out_buf points to a output buffer
+ * @param[in]  out_len is the output length
+ * @param[in]  data_line is the data phy lines
+ * @return     status code
+ *             - 0 success
+ *             - 1 write read failed
+ * @note       instruction_line == 0 means a raw spi frame whose first byte is the command
+ */
+uint8_t sim_flash_write_read(uint8_t instruction, uint8_t instruction_line,
+                             uint32_t address, uint8_t address_line, uint8_t address_len,
+                             uint32_t alternate, uint8_t alternate_line, uint8_t alternate_len,
+                             uint8_t dummy, uint8_t *in_buf, uint32_t in_len,
+                             uint8_t *out_buf, uint32_t out_len, uint8_t data_line)
+{
+    uint64_t clocks;
+
+    (void)alternate;
+    if (gs_flash.inited != 1)
+    {
+        return 1;
+    }
+
+    if (instruction_line == 0)                                                                   /* raw spi frame */
+    {
+        uint8_t len;
+        uint32_t addr;
+        uint32_t i;
+
+        if ((in_buf == NULL) || (in_len == 0))
+        {
+            return 1;
+        }
+        clocks = (uint64_t)(in_len + out_len) * 8;
+        gs_flash.time_ns += gs_flash.overhead_ns + clocks * 1000000000ULL / gs_flash.freq;
+        if (gs_flash.qpi)                                                                        /* ignored in the qpi mode */
+        {
+            if (out_len != 0)
+            {
+                memset(out_buf, 0xFF, out_len);
+            }
+
+            return 0;
+        }
+        len = a_sim_flash_raw_address_len(in_buf[0]);
+        if (in_len < (uint32_t)(1 + len))
+        {
+            len = 0;
+        }
+        addr = 0;
+        for (i = 0; i < len; i++)
+        {
+            addr = (addr << 8) | in_buf[1 + i];
+        }
+        a_sim_flash_command(in_buf[0], addr, in_buf + 1 + len, in_len - 1 - len, out_buf, out_len);
+    }
+    else
+    {
+        clocks = 8 / instruction_line;
+        if (address_line != 0)
+        {
+            clocks += (uint64_t)address_len * 8 / address_line;
+        }
+        if (alternate_line != 0)
+        {
+            clocks += (uint64_t)alternate_len * 8 / alternate_line;
+        }
+        clocks += dummy;
+        if (data_line != 0)
+        {
+            clocks += (uint64_t)(in_len + out_len) * 8 / data_line;
+        }
+        gs_flash.time_ns += gs_flash.overhead_ns + clocks * 1000000000ULL / gs_flash.freq;
+        if ((gs_flash.qpi != 0) != (instruction_line == 4))                                      /* wrong instruction lines */
+        {
+            if (out_len != 0)
+            {
+                memset(out_buf, 0xFF, out_len);
+            }
+
+            return 0;
+        }
+        a_sim_flash_command(instruction, (address_line != 0) ? address : 0, in_buf, in_len, out_buf, out_len);
+        if ((gs_flash.qpi != 0) && (out_len != 0) &&
+            ((instruction == 0x0B) || (instruction == 0xEB) || (instruction == 0x0C)))                /* qpi reads with dummy */
+        {
+            a_sim_flash_qpi_dummy(dummy, out_buf, out_len);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     sim flash advance the virtual clock
+ * @param[in] us is the elapsed time in us
+ * @note      none
+ */
+void sim_flash_delay_us(uint32_t us)
+{
+    gs_flash.time_ns += (uint64_t)us * 1000;
+}
+
+/**
+ * @brief  sim flash get the virtual clock
+ * @return virtual time in ns since the first init
+ * @note   none
+ */
+uint64_t sim_flash_get_time_ns(void)
+{
+    return gs_flash.time_ns;
+}
+
+/**
+ * @brief     sim flash set the bus frequence
+ * @param[in] freq is the simulated bus frequence
+ * @note      none
+ */
+void sim_flash_set_freq(uint32_t freq)
+{
+    if (freq != 0)
+    {
+        gs_flash.freq = freq;
+    }
+}
+
+/**
+ * @brief  sim flash get the bus frequence
+ * @return simulated bus frequence
+ * @note   none
+ */
+uint32_t sim_flash_get_freq(void)
+{
+    return gs_flash.freq;
+}
+
+/**
+ * @brief     sim flash set the transaction overhead
+ * @param[in] ns is the fixed cost of one bus transaction in ns
+ * @note      models the chip select and driver call overhead
+ */
+void sim_flash_set_transaction_overhead(uint32_t ns)
+{
+    gs_flash.overhead_ns = ns;
+}
@@ -0,0 +1,369 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      main.c
+ * @brief     main source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_read_test.h"
+#include "driver_w25qxx_register_test.h"
+#include "driver_w25qxx_benchmark_test.h"
+#include "driver_w25qxx_wear_test.h"
+#include "driver_w25qxx_erase_map_test.h"
+#include "driver_w25qxx_cpp_test.h"
+#include "driver_w25qxx_coroutine_test.h"
+#include "driver_w25qxx_async_test.h"
+#include "driver_w25qxx_ftl_test.h"
+#include "driver_w25qxx_kv_test.h"
+#include "driver_w25qxx_log_test.h"
+#include "driver_w25qxx_ts_test.h"
+#include "driver_w25qxx_atomic_test.h"
+#include "driver_w25qxx_crc_test.h"
+#include "driver_w25qxx_shared_test.h"
+#include "driver_w25qxx_ring_test.h"
+#include "driver_w25qxx_sched_test.h"
+#include "driver_w25qxx_tune_test.h"
+#include "sim_flash.h"
+#include <stdlib.h>
+
+/**
+ * @brief      parse the chip type and the interface
+ * @param[in]  *type_name points to the type name
+ * @param[in]  *interface_name points to the interface name
+ * @param[out] *type points to a type buffer
+ * @param[out] *interface points to an interface buffer
+ * @param[out] *dual_quad_spi_enable points to a bool buffer
+ * @return     status code
+ *             - 0 success
+ *             - 5 param is invalid
+ * @note       none
+ */
+static uint8_t a_w25qxx_parse(char *type_name, char *interface_name, w25qxx_type_t *type,
+                              w25qxx_interface_t *interface, w25qxx_bool_t *dual_quad_spi_enable)
+{
+    if (strcmp("W25Q80", type_name) == 0)
+    {
+        *type = W25Q80;
+    }
+    else if (strcmp("W25Q16", type_name) == 0)
+    {
+        *type = W25Q16;
+    }
+    else if (strcmp("W25Q32", type_name) == 0)
+    {
+        *type = W25Q32;
+    }
+    else if (strcmp("W25Q64", type_name) == 0)
+    {
+        *type = W25Q64;
+    }
+    else if (strcmp("W25Q128", type_name) == 0)
+    {
+        *type = W25Q128;
+    }
+    else if (strcmp("W25Q256", type_name) == 0)
+    {
+        *type = W25Q256;
+    }
+    else
+    {
+        return 5;
+    }
+    
+    if (strcmp("-spi", interface_name) == 0)
+    {
+        *interface = W25QXX_INTERFACE_SPI;
+        *dual_quad_spi_enable = W25QXX_BOOL_FALSE;
+    }
+    else if (strcmp("-dual_quad_spi", interface_name) == 0)
+    {
+        *interface = W25QXX_INTERFACE_SPI;
+        *dual_quad_spi_enable = W25QXX_BOOL_TRUE;
+    }
+    else if (strcmp("-qspi", interface_name) == 0)
+    {
+        *interface = W25QXX_INTERFACE_QSPI;
+        *dual_quad_spi_enable = W25QXX_BOOL_FALSE;
+    }
+    else
+    {
+        return 5;
+    }
+    
+    /* a new chip for every run */
+    sim_flash_destroy();
+    sim_flash_set_id((uint16_t)(*type));
+    
+    return 0;
+}
+
+/**
+ * @brief     w25qxx full function
+ * @param[in] argc is arg numbers
+ * @param[in] **argv is the arg address
+ * @return    status code
+ *             - 0 success
+ *             - 1 run failed
+ *             - 5 param is invalid
+ * @note      none
+ */
+uint8_t w25qxx(uint8_t argc, char **argv)
+{
+    if (argc == 1)
+    {
+        goto help;
+    }
+    else if (argc == 2)
+    {
+        if (strcmp("-i", argv[1]) == 0)
+        {
+            w25qxx_info_t info;
+            
+            /* print w25qxx info */
+            w25qxx_info(&info);
+            w25qxx_interface_debug_print("w25qxx: chip is %s.\n", info.chip_name);
+            w25qxx_interface_debug_print("w25qxx: manufacturer is %s.\n", info.manufacturer_name);
+            w25qxx_interface_debug_print("w25qxx: interface is %s.\n", info.interface);
+            w25qxx_interface_debug_print("w25qxx: driver version is %d.%d.\n", info.driver_version / 1000, (info.driver_version % 1000) / 100);
+            w25qxx_interface_debug_print("w25qxx: min supply voltage is %0.1fV.\n", info.supply_voltage_min_v);
+            w25qxx_interface_debug_print("w25qxx: max supply voltage is %0.1fV.\n", info.supply_voltage_max_v);
+            w25qxx_interface_debug_print("w25qxx: max current is %0.2fmA.\n", info.max_current_ma);
+            w25qxx_interface_debug_print("w25qxx: max temperature is %0.1fC.\n", info.temperature_max);
+            w25qxx_interface_debug_print("w25qxx: min temperature is %0.1fC.\n", info.temperature_min);
+            
+            return 0;
+        }
+        else if (strcmp("-h", argv[1]) == 0)
+        {
+            /* show w25qxx help */
+            help:
+            
+            w25qxx_interface_debug_print("w25qxx -i\n\tshow w25qxx chip and driver information.\n");
+            w25qxx_interface_debug_print("w25qxx -h\n\tshow w25qxx help.\n");
+            w25qxx_interface_debug_print("w25qxx -t reg -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx register test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t read -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx read test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t async -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx async test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t wear -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx wear test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t erase_map -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx erase map test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t cpp -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx c++ test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t coroutine -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx coroutine test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t ftl -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx ftl test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t kv -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx kv test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t log -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx log test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t ts -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx ts test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t atomic -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx atomic test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t crc -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx crc test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t shared -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx shared test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t ring -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx ring test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t sched -type <type> (-spi| -dual_quad_spi| -qspi)\n\trun w25qxx sched test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256.\n");
+            w25qxx_interface_debug_print("w25qxx -t tune -type <type> (-spi| -dual_quad_spi| -qspi) [<freq>]\n\trun w25qxx tune test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256."
+                                         "freq is the simulated bus frequence in Hz.\n");
+            w25qxx_interface_debug_print("w25qxx -t benchmark -type <type> (-spi| -dual_quad_spi| -qspi) [<freq>]\n\trun w25qxx benchmark test on the simulated chip.");
+            w25qxx_interface_debug_print("type is the chip type and type can be W25Q80, W25Q16, W25Q32, W25Q64, W25Q128 or W25Q256."
+                                         "freq is the simulated bus frequence in Hz.\n");
+            
+            return 0;
+        }
+        else
+        {
+            return 5;
+        }
+    }
+    else if ((argc == 6) || (argc == 7))
+    {
+        if ((strcmp("-t", argv[1]) == 0) && (strcmp("-type", argv[3]) == 0))
+        {
+            uint8_t res;
+            w25qxx_type_t type;
+            w25qxx_interface_t interface;
+            w25qxx_bool_t dual_quad_spi_enable;
+            
+            res = a_w25qxx_parse(argv[4], argv[5], &type, &interface, &dual_quad_spi_enable);
+            if (res)
+            {
+                return res;
+            }
+            if (argc == 7)
+            {
+                sim_flash_set_freq((uint32_t)atoi(argv[6]));
+            }
+            
+            if (strcmp("reg", argv[2]) == 0)
+            {
+                res = w25qxx_register_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("read", argv[2]) == 0)
+            {
+                res = w25qxx_read_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("async", argv[2]) == 0)
+            {
+                res = w25qxx_async_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("wear", argv[2]) == 0)
+            {
+                res = w25qxx_wear_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("erase_map", argv[2]) == 0)
+            {
+                res = w25qxx_erase_map_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("cpp", argv[2]) == 0)
+            {
+                res = w25qxx_cpp_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("coroutine", argv[2]) == 0)
+            {
+                res = w25qxx_coroutine_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("ftl", argv[2]) == 0)
+            {
+                res = w25qxx_ftl_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("kv", argv[2]) == 0)
+            {
+                res = w25qxx_kv_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("log", argv[2]) == 0)
+            {
+                res = w25qxx_log_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("ts", argv[2]) == 0)
+            {
+                res = w25qxx_ts_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("atomic", argv[2]) == 0)
+            {
+                res = w25qxx_atomic_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("crc", argv[2]) == 0)
+            {
+                res = w25qxx_crc_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("shared", argv[2]) == 0)
+            {
+                res = w25qxx_shared_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("ring", argv[2]) == 0)
+            {
+                res = w25qxx_ring_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("sched", argv[2]) == 0)
+            {
+                res = w25qxx_sched_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("tune", argv[2]) == 0)
+            {
+                res = w25qxx_tune_test(type, interface, dual_quad_spi_enable);
+            }
+            else if (strcmp("benchmark", argv[2]) == 0)
+            {
+                res = w25qxx_benchmark_test(type, interface, dual_quad_spi_enable);
+            }
+            else
+            {
+                return 5;
+            }
+            w25qxx_interface_debug_print("w25qxx: simulated time is %0.3fs.\n", (double)sim_flash_get_time_ns() / 1e9);
+            sim_flash_destroy();
+            if (res)
+            {
+                return 1;
+            }
+            else
+            {
+                return 0;
+            }
+        }
+        else
+        {
+            return 5;
+        }
+    }
+    
+    /* param is invalid */
+    else
+    {
+        return 5;
+    }
+}
+
+/**
+ * @brief     main function
+ * @param[in] argc is arg numbers
+ * @param[in] **argv is the arg address
+ * @return    status code
+ *             - 0 success
+ *             - 1 run failed
+ * @note      none
+ */
+int main(int argc, char **argv)
+{
+    uint8_t res;
+
+    res = w25qxx((uint8_t)argc, argv);
+    if (res == 0)
+    {
+        /* run success */
+    }
+    else if (res == 1)
+    {
+        w25qxx_interface_debug_print("w25qxx: run failed.\n");
+    }
+    else if (res == 5)
+    {
+        w25qxx_interface_debug_print("w25qxx: param is invalid.\n");
+    }
+    else
+    {
+        w25qxx_interface_debug_print("w25qxx: unknow status code.\n");
+    }
+
+    return (res == 0) ? 0 : 1;
+}
@@ -36,6 +36,10 @@
 
 #include "driver_w25qxx.h"
 
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
+
 /**
  * @brief chip information definition
  */
@@ -97,6 +101,379 @@
 #define W25QXX_COMMAND_OCTAL_WORD_READ_QUAD_IO           0xE3        /**< octal word read quad I/O */
 #define W25QXX_COMMAND_DEVICE_ID_QUAD_IO                 0x94        /**< device id quad I/O */
 
+/**
+ * @brief chip path definition
+ * @note  the paths folded to a constant by the compiled configuration are removed
+ *        by the compiler, the others test the handle at runtime
+ */
+#if (W25QXX_CONFIG_INTERFACE == W25QXX_CONFIG_INTERFACE_SPI)
+    #define W25QXX_IS_SPI(handle)        1
+#elif (W25QXX_CONFIG_INTERFACE == W25QXX_CONFIG_INTERFACE_QSPI)
+    #define W25QXX_IS_SPI(handle)        0
+#else
+    #define W25QXX_IS_SPI(handle)        ((handle)->spi_qspi == W25QXX_INTERFACE_SPI)
+#endif
+#define W25QXX_IS_QSPI(handle)           (!W25QXX_IS_SPI(handle))
+#if (W25QXX_CONFIG_DUAL_QUAD_SPI == 0) || ((W25QXX_CONFIG_INTERFACE & W25QXX_CONFIG_INTERFACE_SPI) == 0)
+    #define W25QXX_IS_DQSPI(handle)      0
+#else
+    #define W25QXX_IS_DQSPI(handle)      ((handle)->dual_quad_spi_enable)
+#endif
+#if (W25QXX_CONFIG_MAX_TYPE < 0xEF18)
+    #define W25QXX_IS_256(handle)        0
+#else
+    #define W25QXX_IS_256(handle)        ((handle)->type >= W25Q256)
+#endif
+#if (W25QXX_CONFIG_ADDRESS_4_BYTE == 0) || (W25QXX_CONFIG_MAX_TYPE < 0xEF18)
+    #define W25QXX_IS_ADDR4(handle)      0
+#else
+    #define W25QXX_IS_ADDR4(handle)      ((handle)->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE)
+#endif
+#define W25QXX_IS_ADDR3(handle)          (!W25QXX_IS_ADDR4(handle))
+
+#if (W25QXX_ENABLE_STATS == 1)
+
+/**
+ * @brief      statistics count one command
+ * @param[in]  *handle points to a w25qxx handle structure
+ * @param[in]  instruction is the sent instruction
+ * @param[in]  data_len is the data length of the command
+ * @param[in]  out_len is the output length
+ * @note       none
+ */
+static void _w25qxx_stats_command(w25qxx_handle_t *handle, uint8_t instruction, uint32_t data_len, uint32_t out_len)
+{
+    switch (instruction)
+    {
+        case W25QXX_COMMAND_WRITE_ENABLE :
+        {
+            handle->stats.write_enable++;                                                      /* write enable */
+            
+            break;
+        }
+        case 0xC5 :
+        {
+            handle->stats.extended_address++;                                                  /* extended address register */
+            
+            break;
+        }
+        case W25QXX_COMMAND_READ_STATUS_REG1 :
+        {
+            handle->stats.status_poll++;                                                       /* status poll */
+            
+            break;
+        }
+        case W25QXX_COMMAND_PAGE_PROGRAM :
+        case W25QXX_COMMAND_QUAD_PAGE_PROGRAM :
+        {
+            handle->stats.page_program++;                                                      /* page program */
+            handle->stats.program_bytes += data_len;                                           /* programmed bytes */
+            
+            break;
+        }
+        case W25QXX_COMMAND_SECTOR_ERASE_4K :
+        {
+            handle->stats.erase_4k++;                                                          /* erase 4k */
+            
+            break;
+        }
+        case W25QXX_COMMAND_BLOCK_ERASE_32K :
+        {
+            handle->stats.erase_32k++;                                                         /* erase 32k */
+            
+            break;
+        }
+        case W25QXX_COMMAND_BLOCK_ERASE_64K :
+        {
+            handle->stats.erase_64k++;                                                         /* erase 64k */
+            
+            break;
+        }
+        case W25QXX_COMMAND_CHIP_ERASE :
+        {
+            handle->stats.chip_erase++;                                                        /* chip erase */
+            
+            break;
+        }
+        case W25QXX_COMMAND_READ_DATA :
+        case W25QXX_COMMAND_FAST_READ :
+        case W25QXX_COMMAND_FAST_READ_DUAL_OUTPUT :
+        case W25QXX_COMMAND_FAST_READ_QUAD_OUTPUT :
+        case W25QXX_COMMAND_FAST_READ_DUAL_IO :
+        case W25QXX_COMMAND_FAST_READ_QUAD_IO :
+        case W25QXX_COMMAND_WORD_READ_QUAD_IO :
+        case W25QXX_COMMAND_OCTAL_WORD_READ_QUAD_IO :
+        {
+            handle->stats.read_bytes += out_len;                                               /* read bytes */
+            
+            break;
+        }
+        default :
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief     statistics get the current time
+ * @param[in] *handle points to a w25qxx handle structure
+ * @return    current time in us
+ * @note      the time spent in the driver delays is used without a timestamp function
+ */
+static uint64_t _w25qxx_stats_now(w25qxx_handle_t *handle)
+{
+    if (handle->timestamp_us != NULL)                                                          /* check timestamp */
+    {
+        return handle->timestamp_us();                                                         /* return timestamp */
+    }
+    else
+    {
+        return handle->stats.busy_wait_us;                                                     /* return busy wait time */
+    }
+}
+
+/**
+ * @brief     statistics start one operation
+ * @param[in] *handle points to a w25qxx handle structure
+ * @note      none
+ */
+static void _w25qxx_stats_start(w25qxx_handle_t *handle)
+{
+    handle->stats_start = _w25qxx_stats_now(handle);                                           /* save start time */
+}
+
+/**
+ * @brief     statistics finish one operation
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] operation is the finished operation
+ * @note      none
+ */
+static void _w25qxx_stats_latency(w25qxx_handle_t *handle, w25qxx_stats_operation_t operation)
+{
+    uint64_t t;
+    uint8_t bin;
+    
+    t = _w25qxx_stats_now(handle) - handle->stats_start;                                       /* get latency */
+    bin = 0;                                                                                   /* init 0 */
+    while (((t >> 1) != 0) && (bin < (W25QXX_STATS_LATENCY_BINS - 1)))                         /* log2 */
+    {
+        t >>= 1;                                                                               /* right shift 1 */
+        bin++;                                                                                 /* bin++ */
+    }
+    handle->stats.latency[operation][bin]++;                                                   /* add to the histogram */
+}
+
+/**
+ * @brief     delay ms and count the busy wait time
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] ms is the delay time
+ * @note      none
+ */
+static void _w25qxx_delay_ms(w25qxx_handle_t *handle, uint32_t ms)
+{
+    handle->stats.busy_wait_us += (uint64_t)ms * 1000;                                         /* add busy wait time */
+    handle->delay_ms(ms);                                                                      /* delay ms */
+}
+
+/**
+ * @brief     delay us and count the busy wait time
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] us is the delay time
+ * @note      none
+ */
+static void _w25qxx_delay_us(w25qxx_handle_t *handle, uint32_t us)
+{
+    handle->stats.busy_wait_us += us;                                                          /* add busy wait time */
+    handle->delay_us(us);                                                                      /* delay us */
+}
+
+/**
+ * @brief statistics add definition
+ */
+#define _w25qxx_stats_add(handle, member, value)        (handle)->stats.member += (value)
+
+#else
+
+/**
+ * @brief statistics hook definition
+ * @note  the hooks compile to nothing when the statistics is disabled
+ */
+#define _w25qxx_stats_command(handle, instruction, data_len, out_len)
+#define _w25qxx_stats_start(handle)
+#define _w25qxx_stats_latency(handle, operation)
+#define _w25qxx_stats_add(handle, member, value)
+#define _w25qxx_delay_ms(handle, ms)                    (handle)->delay_ms(ms)
+#define _w25qxx_delay_us(handle, us)                    (handle)->delay_us(us)
+
+#endif
+
+#if (W25QXX_ENABLE_WEAR == 1)
+
+/**
+ * @brief     count the erase of the tracked 4k sectors
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the erase address
+ * @param[in] len is the erase length, 0xFFFFFFFF means the whole chip
+ * @note      a 4k erase costs one increment
+ */
+static void _w25qxx_wear_erase(w25qxx_handle_t *handle, uint32_t addr, uint32_t len)
+{
+    uint32_t first;
+    uint32_t last;
+    
+    if (handle->wear_count == NULL)                                                            /* check the table */
+    {
+        return;                                                                                /* return */
+    }
+    if (len == 0xFFFFFFFF)                                                                     /* whole chip */
+    {
+        first = handle->wear_first;                                                            /* first tracked sector */
+        last = handle->wear_first + handle->wear_num - 1;                                      /* last tracked sector */
+    }
+    else
+    {
+        first = (addr & ~(len - 1)) / 4096;                                                    /* first erased sector */
+        last = first + len / 4096 - 1;                                                         /* last erased sector */
+        if (first < handle->wear_first)                                                        /* check the range */
+        {
+            first = handle->wear_first;                                                        /* set the first */
+        }
+        if (last > handle->wear_first + handle->wear_num - 1)                                  /* check the range */
+        {
+            last = handle->wear_first + handle->wear_num - 1;                                  /* set the last */
+        }
+    }
+    while (first <= last)                                                                      /* all erased sectors */
+    {
+        handle->wear_count[first - handle->wear_first]++;                                      /* count++ */
+        handle->wear_dirty++;                                                                  /* dirty++ */
+        first++;                                                                               /* next sector */
+    }
+}
+
+#else
+
+/**
+ * @brief wear hook definition
+ * @note  the hook compiles to nothing when the wear tracking is disabled
+ */
+#define _w25qxx_wear_erase(handle, addr, len)
+
+#endif
+
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+
+/**
+ * @brief erase map discard flag definition
+ * @note  set on the entry of a sector whose content is no longer needed and that waits
+ *        for the background erase, the erase hooks clear it
+ */
+#define W25QXX_ERASE_MAP_DISCARD 0x8000
+
+/**
+ * @brief     mark the erased 4k sectors in the erase map
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the erase address
+ * @param[in] len is the erase length, 0xFFFFFFFF means the whole chip
+ * @note      call it after the erase finished
+ */
+static void _w25qxx_map_erase(w25qxx_handle_t *handle, uint32_t addr, uint32_t len)
+{
+    uint32_t first;
+    uint32_t last;
+    
+    if (handle->erase_map == NULL)                                                             /* check the table */
+    {
+        return;                                                                                /* return */
+    }
+    if (len == 0xFFFFFFFF)                                                                     /* whole chip */
+    {
+        first = handle->erase_map_first;                                                       /* first mapped sector */
+        last = handle->erase_map_first + handle->erase_map_num - 1;                            /* last mapped sector */
+    }
+    else
+    {
+        first = (addr & ~(len - 1)) / 4096;                                                    /* first erased sector */
+        last = first + len / 4096 - 1;                                                         /* last erased sector */
+        if (first < handle->erase_map_first)                                                   /* check the range */
+        {
+            first = handle->erase_map_first;                                                   /* set the first */
+        }
+        if (last > handle->erase_map_first + handle->erase_map_num - 1)                        /* check the range */
+        {
+            last = handle->erase_map_first + handle->erase_map_num - 1;                        /* set the last */
+        }
+    }
+    while (first <= last)                                                                      /* all erased sectors */
+    {
+        handle->erase_map[first - handle->erase_map_first] = 0;                                /* erased from 0 */
+        first++;                                                                               /* next sector */
+    }
+}
+
+/**
+ * @brief     raise the erased mark of a programmed 4k sector
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the programming address
+ * @param[in] len is the data length
+ * @note      call it before the program starts so a failed program stays marked,
+ *            a page program never crosses a sector
+ */
+static void _w25qxx_map_program(w25qxx_handle_t *handle, uint32_t addr, uint32_t len)
+{
+    uint32_t s;
+    uint32_t end;
+    
+    s = addr / 4096;                                                                           /* get sector */
+    if ((handle->erase_map == NULL) || (s < handle->erase_map_first) || 
+        (s >= handle->erase_map_first + handle->erase_map_num))                                /* check the range */
+    {
+        return;                                                                                /* return */
+    }
+    end = addr % 4096 + len;                                                                   /* end offset */
+    end = (end > 4096) ? 4096 : end;                                                           /* clamp */
+    if ((handle->erase_map[s - handle->erase_map_first] & W25QXX_ERASE_MAP_DISCARD) != 0)      /* discarded */
+    {
+        handle->erase_map[s - handle->erase_map_first] = 4096;                                 /* cancel the discard */
+    }
+    if (handle->erase_map[s - handle->erase_map_first] < end)                                  /* raise the mark */
+    {
+        handle->erase_map[s - handle->erase_map_first] = (uint16_t)end;                        /* set the mark */
+    }
+}
+
+/**
+ * @brief     check the erase map
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] s is the 4k sector
+ * @param[in] off is the sector offset
+ * @return    1 if the sector is known erased from off on, otherwise 0
+ * @note      none
+ */
+static uint8_t _w25qxx_map_erased(w25qxx_handle_t *handle, uint32_t s, uint32_t off)
+{
+    if ((handle->erase_map == NULL) || (s < handle->erase_map_first) || 
+        (s >= handle->erase_map_first + handle->erase_map_num))                                /* check the range */
+    {
+        return 0;                                                                              /* unknown */
+    }
+    
+    return (uint8_t)(handle->erase_map[s - handle->erase_map_first] <= off);                   /* check the mark */
+}
+
+#else
+
+/**
+ * @brief erase map hook definition
+ * @note  the hooks compile to nothing when the erase map is disabled
+ */
+#define _w25qxx_map_erase(handle, addr, len)
+#define _w25qxx_map_program(handle, addr, len)
+#define _w25qxx_map_erased(handle, s, off)        0
+
+#endif
+
 /**
  * @brief      spi interface write read bytes
  * @param[in]  *handle points to a w25qxx handle structure
@@ -119,6 +496,10 @@ static uint8_t _w25qxx_spi_write_read(w25qxx_handle_t *handle, uint8_t *in_buf,
     }
     else
     {
+        _w25qxx_stats_command(handle, in_buf[0],
+                              (in_len > 4) ? (in_len - (((W25QXX_IS_ADDR4(handle)) && 
+                              (W25QXX_IS_256(handle))) ? 5 : 4)) : 0, out_len);                /* count the command */
+        
         return 0;                                                                      /* success return 0 */
     }
 }
@@ -159,6 +540,8 @@ static uint8_t _w25qxx_qspi_write_read(w25qxx_handle_t *handle, uint8_t instruct
     }
     else
     {
+        _w25qxx_stats_command(handle, instruction, in_len, out_len);                                          /* count the command */
+        
         return 0;                                                                                             /* success return 0 */
     }
 }
@@ -170,6 +553,7 @@ static uint8_t _w25qxx_qspi_write_read(w25qxx_handle_t *handle, uint8_t instruct
  * @return    status code
  *            - 0 success
  *            - 2 handle is NULL
+ *            - 4 dual quad spi is not compiled
  * @note      none
  */
 uint8_t w25qxx_set_dual_quad_spi(w25qxx_handle_t *handle, w25qxx_bool_t enable)
@@ -178,6 +562,12 @@ uint8_t w25qxx_set_dual_quad_spi(w25qxx_handle_t *handle, w25qxx_bool_t enable)
     {
         return 2;                                 /* return error */
     }
+#if (W25QXX_CONFIG_DUAL_QUAD_SPI == 0)
+    if (enable != W25QXX_BOOL_FALSE)              /* check the configuration */
+    {
+        return 4;                                 /* return error */
+    }
+#endif
 
     handle->dual_quad_spi_enable = enable;        /* set enable */
     
@@ -205,6 +595,55 @@ uint8_t w25qxx_get_dual_quad_spi(w25qxx_handle_t *handle, w25qxx_bool_t *enable)
     return 0;                                                       /* success return 0 */
 }
 
+/**
+ * @brief     set the qspi read dummy sent by the init
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] dummy is the qspi read dummy
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ * @note      call it before w25qxx_init, w25qxx_init uses W25QXX_QSPI_READ_DUMMY_8_80MHZ by default
+ */
+uint8_t w25qxx_set_init_read_dummy(w25qxx_handle_t *handle, w25qxx_qspi_read_dummy_t dummy)
+{
+    if (handle == NULL)                                         /* check handle */
+    {
+        return 2;                                               /* return error */
+    }
+    
+    handle->init_dummy = (uint8_t)((dummy & 0x03) + 1);         /* set init dummy */
+    
+    return 0;                                                   /* success return 0 */
+}
+
+/**
+ * @brief      get the qspi read dummy sent by the init
+ * @param[in]  *handle points to a w25qxx handle structure
+ * @param[out] *dummy points to a qspi read dummy buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ * @note       none
+ */
+uint8_t w25qxx_get_init_read_dummy(w25qxx_handle_t *handle, w25qxx_qspi_read_dummy_t *dummy)
+{
+    if (handle == NULL)                                                              /* check handle */
+    {
+        return 2;                                                                    /* return error */
+    }
+    
+    if (handle->init_dummy == 0)                                                     /* default */
+    {
+        *dummy = W25QXX_QSPI_READ_DUMMY_8_80MHZ;                                     /* 8 dummy */
+    }
+    else
+    {
+        *dummy = (w25qxx_qspi_read_dummy_t)(handle->init_dummy - 1);                 /* get init dummy */
+    }
+    
+    return 0;                                                                        /* success return 0 */
+}
+
 /**
  * @brief     set the chip type
  * @param[in] *handle points to a w25qxx handle structure
@@ -212,6 +651,7 @@ uint8_t w25qxx_get_dual_quad_spi(w25qxx_handle_t *handle, w25qxx_bool_t *enable)
  * @return    status code
  *            - 0 success
  *            - 2 handle is NULL
+ *            - 4 type is not compiled
  * @note      none
  */
 uint8_t w25qxx_set_type(w25qxx_handle_t *handle, w25qxx_type_t type)
@@ -220,6 +660,10 @@ uint8_t w25qxx_set_type(w25qxx_handle_t *handle, w25qxx_type_t type)
     {
         return 2;               /* return error */
     }
+    if ((uint32_t)type > W25QXX_CONFIG_MAX_TYPE)        /* check the configuration */
+    {
+        return 4;               /* return error */
+    }
 
     handle->type = type;        /* set type */
     
@@ -254,6 +698,7 @@ uint8_t w25qxx_get_type(w25qxx_handle_t *handle, w25qxx_type_t *type)
  * @return    status code
  *            - 0 success
  *            - 2 handle is NULL
+ *            - 4 interface is not compiled
  * @note      none
  */
 uint8_t w25qxx_set_interface(w25qxx_handle_t *handle, w25qxx_interface_t interface)
@@ -262,6 +707,11 @@ uint8_t w25qxx_set_interface(w25qxx_handle_t *handle, w25qxx_interface_t interfa
     {
         return 2;                        /* return error */
     }
+    if ((W25QXX_CONFIG_INTERFACE & ((interface == W25QXX_INTERFACE_SPI) ? W25QXX_CONFIG_INTERFACE_SPI : 
+         W25QXX_CONFIG_INTERFACE_QSPI)) == 0)                                          /* check the configuration */
+    {
+        return 4;                        /* return error */
+    }
 
     handle->spi_qspi = interface;        /* set interface */
     
@@ -314,16 +764,24 @@ uint8_t w25qxx_set_address_mode(w25qxx_handle_t *handle, w25qxx_address_mode_t m
     {
         return 3;                                                                     /* return error */
     }
-    if (handle->type < W25Q256)                                                       /* check type */
+    if (W25QXX_IS_256(handle) == 0)                                                   /* check type */
     {
         handle->debug_print("w25qxx: current type can't use this function.\n");       /* current type can't use this function */
        
         return 4;                                                                     /* return error */
     }
+#if (W25QXX_CONFIG_ADDRESS_4_BYTE == 0)
+    if (mode == W25QXX_ADDRESS_MODE_4_BYTE)                                           /* check the configuration */
+    {
+        handle->debug_print("w25qxx: 4 byte address mode is not compiled.\n");        /* 4 byte address mode is not compiled */
+       
+        return 4;                                                                     /* return error */
+    }
+#endif
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                     /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                        /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                             /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                  /* enable dual quad spi */
         {
             if (mode == W25QXX_ADDRESS_MODE_3_BYTE)                                   /* address 3 mode byte */
             {
@@ -442,9 +900,9 @@ uint8_t w25qxx_enable_write(w25qxx_handle_t *handle)
         return 3;                                                                     /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                     /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                        /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                             /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                  /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                           0x00000000, 0x00, 0x00,
@@ -512,9 +970,9 @@ uint8_t w25qxx_enable_volatile_sr_write(w25qxx_handle_t *handle)
         return 3;                                                                            /* return error */
     }
 
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                            /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                               /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                    /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                         /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, 
                                           W25QXX_COMMAND_VOLATILE_SR_WRITE_ENABLE, 1,
@@ -583,9 +1041,9 @@ uint8_t w25qxx_disable_write(w25qxx_handle_t *handle)
         return 3;                                                                     /* return error */
     }
 
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                     /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                        /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                             /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                  /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_DISABLE, 1,
                                           0x00000000, 0x00, 0x00,
@@ -654,9 +1112,9 @@ uint8_t w25qxx_get_status1(w25qxx_handle_t *handle, uint8_t *status)
         return 3;                                                                  /* return error */
     }
 
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                  /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                     /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                          /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                               /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle,
                                           W25QXX_COMMAND_READ_STATUS_REG1, 1,
@@ -727,9 +1185,9 @@ uint8_t w25qxx_get_status2(w25qxx_handle_t *handle, uint8_t *status)
         return 3;                                                                  /* return error */
     }
 
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                  /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                     /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                          /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                               /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, 
                                           W25QXX_COMMAND_READ_STATUS_REG2, 1,
@@ -800,9 +1258,9 @@ uint8_t w25qxx_get_status3(w25qxx_handle_t *handle, uint8_t *status)
         return 3;                                                                  /* return error */
     }
 
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                  /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                     /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                          /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                               /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle,
                                           W25QXX_COMMAND_READ_STATUS_REG3, 1,
@@ -876,9 +1334,9 @@ uint8_t w25qxx_set_status1(w25qxx_handle_t *handle, uint8_t status)
         return 3;                                                                                        /* return error */
     }
 
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                        /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                           /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                     /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_VOLATILE_SR_WRITE_ENABLE, 1,
                                           0x00000000, 0x00, 0x00,
@@ -923,7 +1381,7 @@ uint8_t w25qxx_set_status1(w25qxx_handle_t *handle, uint8_t status)
                     break;                                                                               /* break */
                 }
                 timeout--;                                                                               /* timeout-- */
-                handle->delay_ms(1);                                                                     /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                             /* delay 1 ms */
             }
             if (timeout == 0)                                                                            /* check timeout */
             {
@@ -973,7 +1431,7 @@ uint8_t w25qxx_set_status1(w25qxx_handle_t *handle, uint8_t status)
                     break;                                                                               /* break */
                 }
                 timeout--;                                                                               /* timeout-- */
-                handle->delay_ms(1);                                                                     /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                             /* delay 1 ms */
             }
             if (timeout == 0)                                                                            /* check timeout */
             {
@@ -1032,7 +1490,7 @@ uint8_t w25qxx_set_status1(w25qxx_handle_t *handle, uint8_t status)
                 break;                                                                                   /* break */
             }
             timeout--;                                                                                   /* timeout-- */
-            handle->delay_ms(1);                                                                         /* delay 1 ms */
+            _w25qxx_delay_ms(handle, 1);                                                                 /* delay 1 ms */
         }
         if (timeout == 0)                                                                                /* check timeout */
         {
@@ -1075,9 +1533,9 @@ uint8_t w25qxx_set_status2(w25qxx_handle_t *handle, uint8_t status)
         return 3;                                                                                        /* return error */
     }
 
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                        /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                           /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                     /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_VOLATILE_SR_WRITE_ENABLE, 1,
                                           0x00000000, 0x00, 0x00,
@@ -1122,7 +1580,7 @@ uint8_t w25qxx_set_status2(w25qxx_handle_t *handle, uint8_t status)
                     break;                                                                               /* break */
                 }
                 timeout--;                                                                               /* timeout-- */
-                handle->delay_ms(1);                                                                     /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                             /* delay 1 ms */
             }
             if (timeout == 0)                                                                            /* check timeout */
             {
@@ -1172,7 +1630,7 @@ uint8_t w25qxx_set_status2(w25qxx_handle_t *handle, uint8_t status)
                     break;                                                                               /* break */
                 }
                 timeout--;                                                                               /* timeout-- */
-                handle->delay_ms(1);                                                                     /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                             /* delay 1 ms */
             }
             if (timeout == 0)                                                                            /* check timeout */
             {
@@ -1231,7 +1689,7 @@ uint8_t w25qxx_set_status2(w25qxx_handle_t *handle, uint8_t status)
                 break;                                                                                   /* break */
             }
             timeout--;                                                                                   /* timeout-- */
-            handle->delay_ms(1);                                                                         /* delay 1 ms */
+            _w25qxx_delay_ms(handle, 1);                                                                 /* delay 1 ms */
         }
         if (timeout == 0)                                                                                /* check timeout */
         {
@@ -1274,9 +1732,9 @@ uint8_t w25qxx_set_status3(w25qxx_handle_t *handle, uint8_t status)
         return 3;                                                                                        /* return error */
     }
 
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                        /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                           /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                     /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_VOLATILE_SR_WRITE_ENABLE, 1,
                                           0x00000000, 0x00, 0x00,
@@ -1321,7 +1779,7 @@ uint8_t w25qxx_set_status3(w25qxx_handle_t *handle, uint8_t status)
                     break;                                                                               /* break */
                 }
                 timeout--;                                                                               /* timeout-- */
-                handle->delay_ms(1);                                                                     /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                             /* delay 1 ms */
             }
             if (timeout == 0)                                                                            /* check timeout */
             {
@@ -1371,7 +1829,7 @@ uint8_t w25qxx_set_status3(w25qxx_handle_t *handle, uint8_t status)
                     break;                                                                               /* break */
                 }
                 timeout--;                                                                               /* timeout-- */
-                handle->delay_ms(1);                                                                     /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                             /* delay 1 ms */
             }
             if (timeout == 0)                                                                            /* check timeout */
             {
@@ -1430,7 +1888,7 @@ uint8_t w25qxx_set_status3(w25qxx_handle_t *handle, uint8_t status)
                 break;                                                                                   /* break */
             }
             timeout--;                                                                                   /* timeout-- */
-            handle->delay_ms(1);                                                                         /* delay 1 ms */
+            _w25qxx_delay_ms(handle, 1);                                                                 /* delay 1 ms */
         }
         if (timeout == 0)                                                                                /* check timeout */
         {
@@ -1471,10 +1929,11 @@ uint8_t w25qxx_chip_erase(w25qxx_handle_t *handle)
     {
         return 3;                                                                                  /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                   /* start the statistics */
 
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                  /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                     /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                          /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                               /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                           0x00000000, 0x00, 0x00,
@@ -1517,7 +1976,7 @@ uint8_t w25qxx_chip_erase(w25qxx_handle_t *handle)
                     break;                                                                         /* break */
                 }
                 timeout--;                                                                         /* timeout-- */
-                handle->delay_ms(1);                                                               /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                       /* delay 1 ms */
             }
             if (timeout == 0)                                                                      /* check timeout */
             {
@@ -1527,6 +1986,9 @@ uint8_t w25qxx_chip_erase(w25qxx_handle_t *handle)
             }
             else
             {
+                _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_CHIP_ERASE);                  /* count the latency */
+                _w25qxx_wear_erase(handle, 0x00000000, 0xFFFFFFFF);                                /* count the wear */
+                _w25qxx_map_erase(handle, 0x00000000, 0xFFFFFFFF);                                 /* mark the erase map */
                 return 0;                                                                          /* success return 0 */
             }
         }
@@ -1565,7 +2027,7 @@ uint8_t w25qxx_chip_erase(w25qxx_handle_t *handle)
                     break;                                                                         /* break */
                 }
                 timeout--;                                                                         /* timeout-- */
-                handle->delay_ms(1);                                                               /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                       /* delay 1 ms */
             }
             if (timeout == 0)                                                                      /* check timeout */
             {
@@ -1575,6 +2037,9 @@ uint8_t w25qxx_chip_erase(w25qxx_handle_t *handle)
             }
             else
             {
+                _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_CHIP_ERASE);                  /* count the latency */
+                _w25qxx_wear_erase(handle, 0x00000000, 0xFFFFFFFF);                                /* count the wear */
+                _w25qxx_map_erase(handle, 0x00000000, 0xFFFFFFFF);                                 /* mark the erase map */
                 return 0;                                                                          /* success return 0 */
             }
         }
@@ -1622,7 +2087,7 @@ uint8_t w25qxx_chip_erase(w25qxx_handle_t *handle)
                 break;                                                                             /* break */
             }
             timeout--;                                                                             /* timeout-- */
-            handle->delay_ms(1);                                                                   /* delay 1 ms */
+            _w25qxx_delay_ms(handle, 1);                                                           /* delay 1 ms */
         }
         if (timeout == 0)                                                                          /* check timeout */
         {
@@ -1632,6 +2097,9 @@ uint8_t w25qxx_chip_erase(w25qxx_handle_t *handle)
         }
         else
         {
+            _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_CHIP_ERASE);                      /* count the latency */
+            _w25qxx_wear_erase(handle, 0x00000000, 0xFFFFFFFF);                                    /* count the wear */
+            _w25qxx_map_erase(handle, 0x00000000, 0xFFFFFFFF);                                     /* mark the erase map */
             return 0;                                                                              /* success return 0 */
         }
     }
@@ -1661,9 +2129,9 @@ uint8_t w25qxx_erase_program_suspend(w25qxx_handle_t *handle)
         return 3;                                                                             /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                             /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                     /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                          /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_ERASE_PROGRAM_SUSPEND, 1,
                                           0x00000000, 0x00, 0x00,
@@ -1733,9 +2201,9 @@ uint8_t w25qxx_erase_program_resume(w25qxx_handle_t *handle)
         return 3;                                                                             /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                             /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                     /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                          /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_ERASE_PROGRAM_RESUME, 1,
                                           0x00000000, 0x00, 0x00,
@@ -1803,9 +2271,9 @@ uint8_t w25qxx_power_down(w25qxx_handle_t *handle)
         return 3;                                                                  /* return error */
     }
 
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                  /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                     /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                          /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                               /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_POWER_DOWN, 1,
                                           0x00000000, 0x00, 0x00,
@@ -1845,7 +2313,7 @@ uint8_t w25qxx_power_down(w25qxx_handle_t *handle)
            
             return 1;                                                              /* return error */
         }
-        handle->delay_ms(10);                                                      /* delay 10 ms */
+        _w25qxx_delay_ms(handle, 10);                                              /* delay 10 ms */
         res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_POWER_DOWN, 4,
                                       0x00000000, 0x00, 0x00,
                                       0x00000000, 0x00, 0x00,
@@ -1887,9 +2355,9 @@ uint8_t w25qxx_release_power_down(w25qxx_handle_t *handle)
         return 3;                                                                          /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                          /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                             /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                  /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                       /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle,
                                           W25QXX_COMMAND_RELEASE_POWER_DOWN, 1,
@@ -1964,9 +2432,9 @@ uint8_t w25qxx_get_manufacturer_device_id(w25qxx_handle_t *handle, uint8_t *manu
         return 3;                                                                          /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                          /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                             /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                  /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                       /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_READ_MANUFACTURER, 1,
                                           0x00000000, 1, 3,
@@ -2049,15 +2517,15 @@ uint8_t w25qxx_get_manufacturer_device_id_dual_io(w25qxx_handle_t *handle, uint8
         return 3;                                                                                   /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                   /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                      /* spi interface */
     {
-        if (handle->dual_quad_spi_enable == 0)                                                      /* check spi */
+        if (W25QXX_IS_DQSPI(handle) == 0)                                                           /* check spi */
         {
             handle->debug_print("w25qxx: standard spi can't use this function failed.\n");          /* standard spi can't use this function failed */
            
             return 6;                                                                               /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                      /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                /* 3 address mode */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_DEVICE_ID_DUAL_IO, 1,
                                           0x00000000, 2, 3,
@@ -2071,7 +2539,7 @@ uint8_t w25qxx_get_manufacturer_device_id_dual_io(w25qxx_handle_t *handle, uint8
                 return 1;                                                                           /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_DEVICE_ID_DUAL_IO, 1,
                                           0x00000000, 2, 4,
@@ -2133,15 +2601,15 @@ uint8_t w25qxx_get_manufacturer_device_id_quad_io(w25qxx_handle_t *handle, uint8
         return 3;                                                                                   /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                   /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                      /* spi interface */
     {
-        if (handle->dual_quad_spi_enable == 0)                                                      /* check spi */
+        if (W25QXX_IS_DQSPI(handle) == 0)                                                           /* check spi */
         {
             handle->debug_print("w25qxx: standard spi can't use this function failed.\n");          /* standard spi can't use this function failed */
            
             return 6;                                                                               /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                      /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                /* 3 address mode */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_DEVICE_ID_QUAD_IO, 1,
                                           0x00000000, 4, 3,
@@ -2155,7 +2623,7 @@ uint8_t w25qxx_get_manufacturer_device_id_quad_io(w25qxx_handle_t *handle, uint8
                 return 1;                                                                           /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_DEVICE_ID_QUAD_IO, 1,
                                           0x00000000, 4, 4,
@@ -2215,9 +2683,9 @@ uint8_t w25qxx_get_jedec_id(w25qxx_handle_t *handle, uint8_t *manufacturer, uint
         return 3;                                                                          /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                          /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                             /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                  /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                       /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_JEDEC_ID, 1,
                                           0x00000000, 0x00, 0x00,
@@ -2295,9 +2763,9 @@ uint8_t w25qxx_global_block_lock(w25qxx_handle_t *handle)
         return 3;                                                                                /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                   /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                        /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                             /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_GLOBAL_BLOCK_SECTOR_LOCK, 1,
                                           0x00000000, 0x00, 0x00,
@@ -2365,9 +2833,9 @@ uint8_t w25qxx_global_block_unlock(w25qxx_handle_t *handle)
         return 3;                                                                                /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                   /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                        /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                             /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_GLOBAL_BLOCK_SECTOR_UNLOCK, 1,
                                           0x00000000, 0x00, 0x00,
@@ -2438,7 +2906,7 @@ uint8_t w25qxx_set_read_parameters(w25qxx_handle_t *handle, w25qxx_qspi_read_dum
         return 3;                                                                       /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                       /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                          /* spi interface */
     {
         handle->debug_print("w25qxx: spi interface can't use this function.\n");        /* spi interface can't use this function */
        
@@ -2505,7 +2973,7 @@ uint8_t w25qxx_enter_qspi_mode(w25qxx_handle_t *handle)
         return 3;                                                                       /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_QSPI)                                      /* qspi interface */
+    if (W25QXX_IS_QSPI(handle))                                                         /* qspi interface */
     {
         handle->debug_print("w25qxx: qspi interface can't use this function.\n");       /* qspi interface can't use this function */
        
@@ -2524,7 +2992,7 @@ uint8_t w25qxx_enter_qspi_mode(w25qxx_handle_t *handle)
            
             return 1;                                                                   /* return error */
         }
-        handle->delay_ms(10);                                                           /* delay 10 ms */
+        _w25qxx_delay_ms(handle, 10);                                                   /* delay 10 ms */
         buf[0] = handle->param;                                                         /* set param */
         res = _w25qxx_qspi_write_read(handle, 0xC0, 4,
                                       0x00000000, 0x00, 0x00,
@@ -2583,7 +3051,7 @@ uint8_t w25qxx_exit_qspi_mode(w25qxx_handle_t *handle)
         return 3;                                                                       /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                       /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                          /* spi interface */
     {
         handle->debug_print("w25qxx: spi interface can't use this function.\n");        /* spi interface can't use this function */
        
@@ -2631,9 +3099,9 @@ uint8_t w25qxx_enable_reset(w25qxx_handle_t *handle)
         return 3;                                                                    /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                    /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                       /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                            /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                 /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_ENABLE_RESET, 1,
                                           0x00000000, 0x00, 0x00,
@@ -2702,9 +3170,9 @@ uint8_t w25qxx_reset_device(w25qxx_handle_t *handle)
         return 3;                                                                    /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                    /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                       /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                            /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                 /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_RESET_DEVICE, 1,
                                           0x00000000, 0x00, 0x00,
@@ -2776,11 +3244,11 @@ uint8_t w25qxx_get_unique_id(w25qxx_handle_t *handle, uint8_t id[8])
         return 3;                                                                                                 /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                                 /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                                    /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                         /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                              /* enable dual quad spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                                /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                          /* 3 address mode */
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_READ_UNIQUE_ID, 1,
                                               0x00000000, 0x00, 0x00,
@@ -2794,7 +3262,7 @@ uint8_t w25qxx_get_unique_id(w25qxx_handle_t *handle, uint8_t id[8])
                     return 1;                                                                                     /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_READ_UNIQUE_ID, 1,
                                               0x00000000, 0x00, 0x00,
@@ -2817,7 +3285,7 @@ uint8_t w25qxx_get_unique_id(w25qxx_handle_t *handle, uint8_t id[8])
         }
         else                                                                                                      /* single spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                                /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                          /* 3 address mode */
             {
                 buf[0] = W25QXX_COMMAND_READ_UNIQUE_ID;                                                           /* read unique id command */
                 buf[1] = 0x00;                                                                                    /* dummy */
@@ -2832,7 +3300,7 @@ uint8_t w25qxx_get_unique_id(w25qxx_handle_t *handle, uint8_t id[8])
                     return 1;                                                                                     /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 buf[0] = W25QXX_COMMAND_READ_UNIQUE_ID;                                                           /* read unique id command */
                 buf[1] = 0x00;                                                                                    /* dummy */
@@ -2892,9 +3360,9 @@ uint8_t w25qxx_get_sfdp(w25qxx_handle_t *handle, uint8_t sfdp[256])
         return 3;                                                                             /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                             /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                     /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                          /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle,
                                           W25QXX_COMMAND_READ_SFDP_REGISTER, 1,
@@ -2966,9 +3434,9 @@ uint8_t w25qxx_erase_security_register(w25qxx_handle_t *handle, w25qxx_security_
         return 3;                                                                                             /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                             /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                                /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                     /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                          /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle,
                                           W25QXX_COMMAND_WRITE_ENABLE, 1,
@@ -2982,7 +3450,7 @@ uint8_t w25qxx_erase_security_register(w25qxx_handle_t *handle, w25qxx_security_
                
                 return 1;                                                                                     /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
             {
                 res = _w25qxx_qspi_write_read(handle,
                                               W25QXX_COMMAND_ERASE_SECURITY_REGISTER, 1,
@@ -2997,7 +3465,7 @@ uint8_t w25qxx_erase_security_register(w25qxx_handle_t *handle, w25qxx_security_
                     return 1;                                                                                 /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle,
                                               W25QXX_COMMAND_ERASE_SECURITY_REGISTER, 1,
@@ -3039,7 +3507,7 @@ uint8_t w25qxx_erase_security_register(w25qxx_handle_t *handle, w25qxx_security_
                     break;                                                                                    /* break */
                 }
                 timeout--;                                                                                    /* timeout-- */
-                handle->delay_us(10);                                                                         /* delay 10 us */
+                _w25qxx_delay_us(handle, 10);                                                                 /* delay 10 us */
             }
             if (timeout == 0)
             {
@@ -3058,7 +3526,7 @@ uint8_t w25qxx_erase_security_register(w25qxx_handle_t *handle, w25qxx_security_
                
                 return 1;                                                                                     /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
             {
                 buf[0] = W25QXX_COMMAND_ERASE_SECURITY_REGISTER;                                              /* erase security register command */
                 buf[1] = 0x00;                                                                                /* 0x00 */
@@ -3072,7 +3540,7 @@ uint8_t w25qxx_erase_security_register(w25qxx_handle_t *handle, w25qxx_security_
                     return 1;                                                                                 /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 buf[0] = W25QXX_COMMAND_ERASE_SECURITY_REGISTER;                                              /* erase security register command */
                 buf[1] = 0x00;                                                                                /* 0x00 */
@@ -3110,7 +3578,7 @@ uint8_t w25qxx_erase_security_register(w25qxx_handle_t *handle, w25qxx_security_
                     break;                                                                                    /* break */
                 }
                 timeout--;                                                                                    /* timeout-- */
-                handle->delay_us(10);                                                                         /* delay 10 us */
+                _w25qxx_delay_us(handle, 10);                                                                 /* delay 10 us */
             }
             if (timeout == 0)
             {
@@ -3161,9 +3629,9 @@ uint8_t w25qxx_program_security_register(w25qxx_handle_t *handle, w25qxx_securit
         return 3;                                                                                             /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                             /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                                /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                     /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                          /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle,
                                           W25QXX_COMMAND_WRITE_ENABLE, 1,
@@ -3177,7 +3645,7 @@ uint8_t w25qxx_program_security_register(w25qxx_handle_t *handle, w25qxx_securit
                
                 return 1;                                                                                     /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
             {
                 res = _w25qxx_qspi_write_read(handle,
                                               W25QXX_COMMAND_PROGRAM_SECURITY_REGISTER, 1,
@@ -3192,7 +3660,7 @@ uint8_t w25qxx_program_security_register(w25qxx_handle_t *handle, w25qxx_securit
                     return 1;                                                                                 /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle,
                                               W25QXX_COMMAND_PROGRAM_SECURITY_REGISTER, 1,
@@ -3234,7 +3702,7 @@ uint8_t w25qxx_program_security_register(w25qxx_handle_t *handle, w25qxx_securit
                     break;                                                                                    /* break */
                 }
                 timeout--;                                                                                    /* timeout-- */
-                handle->delay_us(10);                                                                         /* delay 10 us */
+                _w25qxx_delay_us(handle, 10);                                                                 /* delay 10 us */
             }
             if (timeout == 0)
             {
@@ -3253,7 +3721,7 @@ uint8_t w25qxx_program_security_register(w25qxx_handle_t *handle, w25qxx_securit
                
                 return 1;                                                                                     /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
             {
                 handle->buf[0] = W25QXX_COMMAND_PROGRAM_SECURITY_REGISTER;                                    /* program security register command */
                 handle->buf[1] = 0x00;                                                                        /* 0x00 */
@@ -3268,7 +3736,7 @@ uint8_t w25qxx_program_security_register(w25qxx_handle_t *handle, w25qxx_securit
                     return 1;                                                                                 /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 handle->buf[0] = W25QXX_COMMAND_PROGRAM_SECURITY_REGISTER;                                    /* program security register command */
                 handle->buf[1] = 0x00;                                                                        /* 0x00 */
@@ -3307,7 +3775,7 @@ uint8_t w25qxx_program_security_register(w25qxx_handle_t *handle, w25qxx_securit
                     break;                                                                                    /* break */
                 }
                 timeout--;                                                                                    /* timeout-- */
-                handle->delay_us(10);                                                                         /* delay 10 us */
+                _w25qxx_delay_us(handle, 10);                                                                 /* delay 10 us */
             }
             if (timeout == 0)
             {
@@ -3356,11 +3824,11 @@ uint8_t w25qxx_read_security_register(w25qxx_handle_t *handle, w25qxx_security_r
         return 3;                                                                                             /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                             /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                                /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                     /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                          /* enable dual quad spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
             {
                 res = _w25qxx_qspi_write_read(handle,
                                               W25QXX_COMMAND_READ_SECURITY_REGISTER, 1,
@@ -3375,7 +3843,7 @@ uint8_t w25qxx_read_security_register(w25qxx_handle_t *handle, w25qxx_security_r
                     return 1;                                                                                 /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))        /* 4 address mode */
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))                                    /* 4 address mode */
             {
                 res = _w25qxx_qspi_write_read(handle,
                                               W25QXX_COMMAND_READ_SECURITY_REGISTER, 1,
@@ -3399,7 +3867,7 @@ uint8_t w25qxx_read_security_register(w25qxx_handle_t *handle, w25qxx_security_r
         }
         else                                                                                                  /* single spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
             {
                 buf[0] = W25QXX_COMMAND_READ_SECURITY_REGISTER;                                               /* read security register command */
                 buf[1] = 0x00;                                                                                /* 0x00 */
@@ -3414,7 +3882,7 @@ uint8_t w25qxx_read_security_register(w25qxx_handle_t *handle, w25qxx_security_r
                     return 1;                                                                                 /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 buf[0] = W25QXX_COMMAND_READ_SECURITY_REGISTER;                                               /* read security register command */
                 buf[1] = 0x00;                                                                                /* 0x00 */
@@ -3476,14 +3944,15 @@ uint8_t w25qxx_only_spi_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
     {
         return 3;                                                                                         /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                          /* start the statistics */
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                         /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                            /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                 /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                      /* enable dual quad spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                        /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                  /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                              /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                /* >128Mb */
                 {
                     res = _w25qxx_qspi_write_read(handle,
                                                   W25QXX_COMMAND_WRITE_ENABLE, 1,
@@ -3525,8 +3994,8 @@ uint8_t w25qxx_only_spi_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
                     return 1;                                                                             /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && 
-                     (handle->type >= W25Q256))                                                           /* check address mode */
+            else if ((W25QXX_IS_ADDR4(handle)) && 
+                     (W25QXX_IS_256(handle)))                                                             /* check address mode */
             {
                 res = _w25qxx_qspi_write_read(handle,
                                               W25QXX_COMMAND_READ_DATA, 1,
@@ -3550,9 +4019,9 @@ uint8_t w25qxx_only_spi_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
         }
         else                                                                                              /* single spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                        /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                  /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                              /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                /* >128Mb */
                 {
                     buf[0] = W25QXX_COMMAND_WRITE_ENABLE;                                                 /* write enable command */
                     res = _w25qxx_spi_write_read(handle, (uint8_t *)buf, 1, NULL, 0);                     /* spi write read */
@@ -3584,8 +4053,8 @@ uint8_t w25qxx_only_spi_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
                     return 1;                                                                             /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && 
-                     (handle->type >= W25Q256))                                                           /* check address mode */
+            else if ((W25QXX_IS_ADDR4(handle)) && 
+                     (W25QXX_IS_256(handle)))                                                             /* check address mode */
             {
                 buf[0] = W25QXX_COMMAND_READ_DATA;                                                        /* only spi read command */
                 buf[1] = (addr >> 24) & 0xFF;                                                             /* 31 - 24 bits */
@@ -3615,6 +4084,7 @@ uint8_t w25qxx_only_spi_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
         return 5;                                                                                         /* return error */
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_READ);                                           /* count the latency */
     return 0;                                                                                             /* success return 0 */
 }
 
@@ -3645,14 +4115,15 @@ uint8_t w25qxx_fast_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data,
     {
         return 3;                                                                                         /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                          /* start the statistics */
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                         /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                            /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                 /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                      /* enable dual quad spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                        /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                  /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                              /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                /* >128Mb */
                 {
                     res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                                   0x00000000, 0x00, 0x00,
@@ -3690,7 +4161,7 @@ uint8_t w25qxx_fast_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data,
                     return 1;                                                                             /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_FAST_READ, 1,
                                               addr, 1, 4,
@@ -3713,9 +4184,9 @@ uint8_t w25qxx_fast_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data,
         }
         else                                                                                              /* single spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                        /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                  /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                              /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                /* >128Mb */
                 {
                     buf[0] = W25QXX_COMMAND_WRITE_ENABLE;                                                 /* write enable command */
                     res = _w25qxx_spi_write_read(handle, (uint8_t *)buf, 1, NULL, 0);                     /* spi write read */
@@ -3748,8 +4219,8 @@ uint8_t w25qxx_fast_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data,
                     return 1;                                                                             /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE)
-                     && (handle->type >= W25Q256))                                                        /* check address mode */
+            else if ((W25QXX_IS_ADDR4(handle))
+                     && (W25QXX_IS_256(handle)))                                                          /* check address mode */
             {
                 buf[0] = W25QXX_COMMAND_FAST_READ;                                                        /* fast read command */
                 buf[1] = (addr >> 24) & 0xFF;                                                             /* 31 - 24 bits */
@@ -3775,9 +4246,9 @@ uint8_t w25qxx_fast_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data,
     }
     else                                                                                                  /* qspi interface */
     {
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                  /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                    /* >128Mb */
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 4,
                                               0x00000000, 0x00, 0x00,
@@ -3815,7 +4286,7 @@ uint8_t w25qxx_fast_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data,
                 return 1;                                                                                 /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_FAST_READ, 4,
                                           addr, 4, 4,
@@ -3837,6 +4308,7 @@ uint8_t w25qxx_fast_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data,
         }
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_READ);                                           /* count the latency */
     return 0;                                                                                             /* success return 0 */
 }
 
@@ -3869,18 +4341,19 @@ uint8_t w25qxx_fast_read_dual_output(w25qxx_handle_t *handle, uint32_t addr, uin
     {
         return 3;                                                                                         /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                          /* start the statistics */
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                         /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                            /* spi interface */
     {
-        if (handle->dual_quad_spi_enable == 0)                                                            /* check spi */
+        if (W25QXX_IS_DQSPI(handle) == 0)                                                                 /* check spi */
         {
             handle->debug_print("w25qxx: standard spi can't use this function failed.\n");                /* standard spi can't use this function failed */
            
             return 6;                                                                                     /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                  /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                    /* >128Mb */
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                               0x00000000, 0x00, 0x00,
@@ -3918,7 +4391,7 @@ uint8_t w25qxx_fast_read_dual_output(w25qxx_handle_t *handle, uint32_t addr, uin
                 return 1;                                                                                 /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_FAST_READ_DUAL_OUTPUT, 1,
                                           addr, 1, 4,
@@ -3946,6 +4419,7 @@ uint8_t w25qxx_fast_read_dual_output(w25qxx_handle_t *handle, uint32_t addr, uin
         return 5;                                                                                         /* return error */
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_READ);                                           /* count the latency */
     return 0;                                                                                             /* success return 0 */
 }
 
@@ -3978,18 +4452,19 @@ uint8_t w25qxx_fast_read_quad_output(w25qxx_handle_t *handle, uint32_t addr, uin
     {
         return 3;                                                                                         /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                          /* start the statistics */
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                         /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                            /* spi interface */
     {
-        if (handle->dual_quad_spi_enable == 0)                                                            /* check spi */
+        if (W25QXX_IS_DQSPI(handle) == 0)                                                                 /* check spi */
         {
             handle->debug_print("w25qxx: standard spi can't use this function failed.\n");                /* standard spi can't use this function failed */
            
             return 6;                                                                                     /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                  /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                    /* >128Mb */
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                               0x00000000, 0x00, 0x00,
@@ -4027,7 +4502,7 @@ uint8_t w25qxx_fast_read_quad_output(w25qxx_handle_t *handle, uint32_t addr, uin
                 return 1;                                                                                 /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_FAST_READ_QUAD_OUTPUT, 1,
                                           addr, 1, 4,
@@ -4055,6 +4530,7 @@ uint8_t w25qxx_fast_read_quad_output(w25qxx_handle_t *handle, uint32_t addr, uin
         return 5;                                                                                         /* return error */
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_READ);                                           /* count the latency */
     return 0;                                                                                             /* success return 0 */
 }
 
@@ -4087,18 +4563,19 @@ uint8_t w25qxx_fast_read_dual_io(w25qxx_handle_t *handle, uint32_t addr, uint8_t
     {
         return 3;                                                                                         /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                          /* start the statistics */
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                         /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                            /* spi interface */
     {
-        if (handle->dual_quad_spi_enable == 0)                                                            /* check spi */
+        if (W25QXX_IS_DQSPI(handle) == 0)                                                                 /* check spi */
         {
             handle->debug_print("w25qxx: standard spi can't use this function failed.\n");                /* standard spi can't use this function failed */
            
             return 6;                                                                                     /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                  /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                    /* >128Mb */
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                               0x00000000, 0x00, 0x00,
@@ -4136,7 +4613,7 @@ uint8_t w25qxx_fast_read_dual_io(w25qxx_handle_t *handle, uint32_t addr, uint8_t
                 return 1;                                                                                 /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_FAST_READ_DUAL_IO, 1,
                                           addr, 2, 4,
@@ -4164,6 +4641,7 @@ uint8_t w25qxx_fast_read_dual_io(w25qxx_handle_t *handle, uint32_t addr, uint8_t
         return 5;                                                                                         /* return error */
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_READ);                                           /* count the latency */
     return 0;                                                                                             /* success return 0 */
 }
 
@@ -4195,18 +4673,19 @@ uint8_t w25qxx_fast_read_quad_io(w25qxx_handle_t *handle, uint32_t addr, uint8_t
     {
         return 3;                                                                                         /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                          /* start the statistics */
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                         /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                            /* spi interface */
     {
-        if (handle->dual_quad_spi_enable == 0)                                                            /* check spi */
+        if (W25QXX_IS_DQSPI(handle) == 0)                                                                 /* check spi */
         {
             handle->debug_print("w25qxx: standard spi can't use this function failed.\n");                /* standard spi can't use this function failed */
            
             return 6;                                                                                     /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                  /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                    /* >128Mb */
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                               0x00000000, 0x00, 0x00,
@@ -4244,7 +4723,7 @@ uint8_t w25qxx_fast_read_quad_io(w25qxx_handle_t *handle, uint32_t addr, uint8_t
                 return 1;                                                                                 /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_FAST_READ_QUAD_IO, 1,
                                           addr, 4, 4,
@@ -4267,9 +4746,9 @@ uint8_t w25qxx_fast_read_quad_io(w25qxx_handle_t *handle, uint32_t addr, uint8_t
     }
     else
     {
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                  /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                    /* >128Mb */
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 4,
                                               0x00000000, 0x00, 0x00,
@@ -4307,7 +4786,7 @@ uint8_t w25qxx_fast_read_quad_io(w25qxx_handle_t *handle, uint32_t addr, uint8_t
                 return 1;                                                                                 /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_FAST_READ_QUAD_IO, 4,
                                           addr, 4, 4,
@@ -4329,6 +4808,7 @@ uint8_t w25qxx_fast_read_quad_io(w25qxx_handle_t *handle, uint32_t addr, uint8_t
         }
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_READ);                                           /* count the latency */
     return 0;                                                                                             /* success return 0 */
 }
 
@@ -4361,18 +4841,19 @@ uint8_t w25qxx_word_read_quad_io(w25qxx_handle_t *handle, uint32_t addr, uint8_t
     {
         return 3;                                                                                         /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                          /* start the statistics */
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                         /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                            /* spi interface */
     {
-        if (handle->dual_quad_spi_enable == 0)                                                            /* check spi */
+        if (W25QXX_IS_DQSPI(handle) == 0)                                                                 /* check spi */
         {
             handle->debug_print("w25qxx: standard spi can't use this function failed.\n");                /* standard spi can't use this function failed */
            
             return 6;                                                                                     /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                  /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                    /* >128Mb */
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                               0x00000000, 0x00, 0x00,
@@ -4410,7 +4891,7 @@ uint8_t w25qxx_word_read_quad_io(w25qxx_handle_t *handle, uint32_t addr, uint8_t
                 return 1;                                                                                 /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WORD_READ_QUAD_IO, 1,
                                           addr, 4, 4,
@@ -4438,6 +4919,7 @@ uint8_t w25qxx_word_read_quad_io(w25qxx_handle_t *handle, uint32_t addr, uint8_t
         return 5;                                                                                         /* return error */
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_READ);                                           /* count the latency */
     return 0;                                                                                             /* success return 0 */
 }
 
@@ -4470,18 +4952,19 @@ uint8_t w25qxx_octal_word_read_quad_io(w25qxx_handle_t *handle, uint32_t addr, u
     {
         return 3;                                                                                         /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                          /* start the statistics */
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                         /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                            /* spi interface */
     {
-        if (handle->dual_quad_spi_enable == 0)                                                            /* check spi */
+        if (W25QXX_IS_DQSPI(handle) == 0)                                                                 /* check spi */
         {
             handle->debug_print("w25qxx: standard spi can't use this function failed.\n");                /* standard spi can't use this function failed */
            
             return 6;                                                                                     /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                  /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                    /* >128Mb */
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                               0x00000000, 0x00, 0x00,
@@ -4519,7 +5002,7 @@ uint8_t w25qxx_octal_word_read_quad_io(w25qxx_handle_t *handle, uint32_t addr, u
                 return 1;                                                                                 /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_OCTAL_WORD_READ_QUAD_IO, 1,
                                           addr, 4, 4,
@@ -4547,6 +5030,7 @@ uint8_t w25qxx_octal_word_read_quad_io(w25qxx_handle_t *handle, uint32_t addr, u
         return 5;                                                                                         /* return error */
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_READ);                                           /* count the latency */
     return 0;                                                                                             /* success return 0 */
 }
 
@@ -4582,6 +5066,7 @@ uint8_t w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
     {
         return 3;                                                                                           /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                            /* start the statistics */
     if (addr % 256)                                                                                         /* check address */
     {
         handle->debug_print("w25qxx: addr is invalid.\n");                                                  /* addr is invalid */
@@ -4594,10 +5079,11 @@ uint8_t w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
        
         return 7;                                                                                           /* return error */
     }
+    _w25qxx_map_program(handle, addr, len);                                                                 /* raise the erased mark */
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                           /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                              /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                   /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                        /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                           0x00000000, 0x00, 0x00,
@@ -4610,9 +5096,9 @@ uint8_t w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
                
                 return 1;                                                                                   /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = (addr >> 24) & 0xFF;                                                           /* 31 - 24 bits */
                     res = _w25qxx_qspi_write_read(handle, 0xC5, 1,
@@ -4650,7 +5136,7 @@ uint8_t w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
                       return 1;                                                                             /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_PAGE_PROGRAM, 1,
                                               addr, 1, 4,
@@ -4690,7 +5176,7 @@ uint8_t w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
                     break;                                                                                  /* break */
                 }
                 timeout--;                                                                                  /* timeout-- */
-                handle->delay_us(10);                                                                       /* delay 10 us */
+                _w25qxx_delay_us(handle, 10);                                                               /* delay 10 us */
             }
             if (timeout == 0)
             {
@@ -4709,9 +5195,9 @@ uint8_t w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
                
                 return 1;                                                                                   /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = 0xC5;                                                                          /* write extended addr register command */
                     buf[1] = (addr >> 24) & 0xFF;                                                           /* 31 - 24 bits */
@@ -4744,8 +5230,8 @@ uint8_t w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE)
-                     && (handle->type >= W25Q256))                                                          /* 4 address mode */
+            else if ((W25QXX_IS_ADDR4(handle))
+                     && (W25QXX_IS_256(handle)))                                                            /* 4 address mode */
             {
                 handle->buf[0] = W25QXX_COMMAND_PAGE_PROGRAM;                                               /* page program command */
                 handle->buf[1] = (addr >> 24) & 0xFF;                                                       /* 31 - 24 bits */
@@ -4784,7 +5270,7 @@ uint8_t w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
                     break;                                                                                  /* break */
                 }
                 timeout--;                                                                                  /* timeout-- */
-                handle->delay_us(10);                                                                       /* delay 10 us */
+                _w25qxx_delay_us(handle, 10);                                                               /* delay 10 us */
             }
             if (timeout == 0)
             {
@@ -4807,9 +5293,9 @@ uint8_t w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
            
             return 1;                                                                                       /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                              /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                        /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                    /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                      /* >128Mb */
             {
                 buf[0] = (addr >> 24) & 0xFF;                                                               /* 31 - 24 bits */
                 res = _w25qxx_qspi_write_read(handle, 0xC5, 4,
@@ -4847,7 +5333,7 @@ uint8_t w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
                   return 1;                                                                                 /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_PAGE_PROGRAM, 4,
                                           addr, 4, 4,
@@ -4887,7 +5373,7 @@ uint8_t w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
                 break;                                                                                      /* break */
             }
             timeout--;                                                                                      /* timeout-- */
-            handle->delay_us(10);                                                                           /* delay 10 us */
+            _w25qxx_delay_us(handle, 10);                                                                   /* delay 10 us */
         }
         if (timeout == 0)
         {
@@ -4897,6 +5383,7 @@ uint8_t w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
         }
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_PAGE_PROGRAM);                                     /* count the latency */
     return 0;                                                                                               /* success return 0 */
 }
 
@@ -4933,6 +5420,7 @@ uint8_t w25qxx_page_program_quad_input(w25qxx_handle_t *handle, uint32_t addr, u
     {
         return 3;                                                                                           /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                            /* start the statistics */
     if (addr % 256)                                                                                         /* check address */
     {
         handle->debug_print("w25qxx: addr is invalid.\n");                                                  /* addr is invalid */
@@ -4945,8 +5433,9 @@ uint8_t w25qxx_page_program_quad_input(w25qxx_handle_t *handle, uint32_t addr, u
        
         return 7;                                                                                           /* return error */
     }
+    _w25qxx_map_program(handle, addr, len);                                                                 /* raise the erased mark */
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_QSPI)                                                          /* qspi interface */
+    if (W25QXX_IS_QSPI(handle))                                                                             /* qspi interface */
     {
         handle->debug_print("w25qxx: qspi can't use this function.\n");                                     /* qspi can't use this function */
        
@@ -4954,7 +5443,7 @@ uint8_t w25qxx_page_program_quad_input(w25qxx_handle_t *handle, uint32_t addr, u
     }
     else
     {
-        if (handle->dual_quad_spi_enable == 0)                                                              /* check spi */
+        if (W25QXX_IS_DQSPI(handle) == 0)                                                                   /* check spi */
         {
             handle->debug_print("w25qxx: standard spi can't use this function failed.\n");                  /* standard spi can't use this function failed */
            
@@ -4971,9 +5460,9 @@ uint8_t w25qxx_page_program_quad_input(w25qxx_handle_t *handle, uint32_t addr, u
            
             return 1;                                                                                       /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                              /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                        /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                    /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                      /* >128Mb */
             {
                 buf[0] = (addr >> 24) & 0xFF;                                                               /* 31 - 24 bits */
                 res = _w25qxx_qspi_write_read(handle, 0xC5, 1,
@@ -5011,7 +5500,7 @@ uint8_t w25qxx_page_program_quad_input(w25qxx_handle_t *handle, uint32_t addr, u
                   return 1;                                                                                 /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_QUAD_PAGE_PROGRAM, 1,
                                           addr, 1, 4,
@@ -5051,7 +5540,7 @@ uint8_t w25qxx_page_program_quad_input(w25qxx_handle_t *handle, uint32_t addr, u
                 break;                                                                                      /* break */
             }
             timeout--;                                                                                      /* timeout-- */
-            handle->delay_us(10);                                                                           /* delay 10 us */
+            _w25qxx_delay_us(handle, 10);                                                                   /* delay 10 us */
         }
         if (timeout == 0)
         {
@@ -5061,6 +5550,7 @@ uint8_t w25qxx_page_program_quad_input(w25qxx_handle_t *handle, uint32_t addr, u
         }
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_PAGE_PROGRAM);                                     /* count the latency */
     return 0;                                                                                               /* success return 0 */
 }
 
@@ -5093,6 +5583,7 @@ uint8_t w25qxx_sector_erase_4k(w25qxx_handle_t *handle, uint32_t addr)
     {
         return 3;                                                                                           /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                            /* start the statistics */
     if (addr % 4096)                                                                                        /* check address */
     {
         handle->debug_print("w25qxx: addr is invalid.\n");                                                  /* addr is invalid */
@@ -5100,9 +5591,9 @@ uint8_t w25qxx_sector_erase_4k(w25qxx_handle_t *handle, uint32_t addr)
         return 4;                                                                                           /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                           /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                              /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                   /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                        /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                           0x00000000, 0x00, 0x00,
@@ -5115,9 +5606,9 @@ uint8_t w25qxx_sector_erase_4k(w25qxx_handle_t *handle, uint32_t addr)
                
                 return 1;                                                                                   /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = (addr >> 24) & 0xFF;                                                           /* 31 - 24 bits */
                     res = _w25qxx_qspi_write_read(handle, 0xC5, 1,
@@ -5155,7 +5646,7 @@ uint8_t w25qxx_sector_erase_4k(w25qxx_handle_t *handle, uint32_t addr)
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_SECTOR_ERASE_4K, 1,
                                               addr, 1, 4,
@@ -5195,7 +5686,7 @@ uint8_t w25qxx_sector_erase_4k(w25qxx_handle_t *handle, uint32_t addr)
                     break;                                                                                  /* break */
                 }
                 timeout--;                                                                                  /* timeout-- */
-                handle->delay_ms(1);                                                                        /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                                /* delay 1 ms */
             }
             if (timeout == 0)
             {
@@ -5214,9 +5705,9 @@ uint8_t w25qxx_sector_erase_4k(w25qxx_handle_t *handle, uint32_t addr)
                
                 return 1;                                                                                   /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = 0xC5;                                                                          /* write extended addr register command */
                     buf[1] = (addr >> 24) & 0xFF;                                                           /* 31 - 24 bits */
@@ -5248,8 +5739,8 @@ uint8_t w25qxx_sector_erase_4k(w25qxx_handle_t *handle, uint32_t addr)
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE)
-                     && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle))
+                     && (W25QXX_IS_256(handle)))
             {
                 buf[0] = W25QXX_COMMAND_SECTOR_ERASE_4K;                                                    /* sector erase 4k command */
                 buf[1] = (addr >> 24) & 0xFF;                                                               /* 31 - 24 bits */
@@ -5287,7 +5778,7 @@ uint8_t w25qxx_sector_erase_4k(w25qxx_handle_t *handle, uint32_t addr)
                     break;                                                                                  /* break */
                 }
                 timeout--;                                                                                  /* timeout-- */
-                handle->delay_ms(1);                                                                        /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                                /* delay 1 ms */
             }
             if (timeout == 0)
             {
@@ -5310,9 +5801,9 @@ uint8_t w25qxx_sector_erase_4k(w25qxx_handle_t *handle, uint32_t addr)
            
             return 1;                                                                                       /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                              /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                        /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                    /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                      /* >128Mb */
             {
                 buf[0] = (addr >> 24) & 0xFF;                                                               /* 31 - 24 bits */
                 res = _w25qxx_qspi_write_read(handle, 0xC5, 4,
@@ -5350,7 +5841,7 @@ uint8_t w25qxx_sector_erase_4k(w25qxx_handle_t *handle, uint32_t addr)
                 return 1;                                                                                   /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_SECTOR_ERASE_4K, 4,
                                           addr, 4, 4,
@@ -5390,7 +5881,7 @@ uint8_t w25qxx_sector_erase_4k(w25qxx_handle_t *handle, uint32_t addr)
                 break;                                                                                      /* break */
             }
             timeout--;                                                                                      /* timeout-- */
-            handle->delay_ms(1);                                                                            /* delay 1 ms */
+            _w25qxx_delay_ms(handle, 1);                                                                    /* delay 1 ms */
         }
         if (timeout == 0)
         {
@@ -5400,6 +5891,9 @@ uint8_t w25qxx_sector_erase_4k(w25qxx_handle_t *handle, uint32_t addr)
         }
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_ERASE_4K);                                         /* count the latency */
+    _w25qxx_wear_erase(handle, addr, 4096);                                                                 /* count the wear */
+    _w25qxx_map_erase(handle, addr, 4096);                                                                  /* mark the erase map */
     return 0;                                                                                               /* success return 0 */
 }
 
@@ -5432,6 +5926,7 @@ uint8_t w25qxx_block_erase_32k(w25qxx_handle_t *handle, uint32_t addr)
     {
         return 3;                                                                                           /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                            /* start the statistics */
     if (addr % (32 * 1024))                                                                                 /* check address */
     {
         handle->debug_print("w25qxx: addr is invalid.\n");                                                  /* addr is invalid */
@@ -5439,9 +5934,9 @@ uint8_t w25qxx_block_erase_32k(w25qxx_handle_t *handle, uint32_t addr)
         return 4;                                                                                           /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                           /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                              /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                   /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                        /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                           0x00000000, 0x00, 0x00,
@@ -5454,9 +5949,9 @@ uint8_t w25qxx_block_erase_32k(w25qxx_handle_t *handle, uint32_t addr)
                
                 return 1;                                                                                   /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = (addr >> 24) & 0xFF;                                                           /* 31 - 24 bits */
                     res = _w25qxx_qspi_write_read(handle, 0xC5, 1,
@@ -5494,7 +5989,7 @@ uint8_t w25qxx_block_erase_32k(w25qxx_handle_t *handle, uint32_t addr)
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_BLOCK_ERASE_32K, 1,
                                               addr, 1, 4,
@@ -5534,7 +6029,7 @@ uint8_t w25qxx_block_erase_32k(w25qxx_handle_t *handle, uint32_t addr)
                     break;                                                                                  /* break */
                 }
                 timeout--;                                                                                  /* timeout-- */
-                handle->delay_ms(1);                                                                        /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                                /* delay 1 ms */
             }
             if (timeout == 0)
             {
@@ -5553,9 +6048,9 @@ uint8_t w25qxx_block_erase_32k(w25qxx_handle_t *handle, uint32_t addr)
                
                 return 1;                                                                                   /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = 0xC5;                                                                          /* write extended addr register command */
                     buf[1] = (addr >> 24) & 0xFF;                                                           /* 31 - 24 bits */
@@ -5587,8 +6082,8 @@ uint8_t w25qxx_block_erase_32k(w25qxx_handle_t *handle, uint32_t addr)
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE)
-                     && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle))
+                     && (W25QXX_IS_256(handle)))
             {
                 buf[0] = W25QXX_COMMAND_BLOCK_ERASE_32K;                                                    /* block erase 32k command */
                 buf[1] = (addr >> 24) & 0xFF;                                                               /* 31 - 24 bits */
@@ -5626,7 +6121,7 @@ uint8_t w25qxx_block_erase_32k(w25qxx_handle_t *handle, uint32_t addr)
                     break;                                                                                  /* break */
                 }
                 timeout--;                                                                                  /* timeout-- */
-                handle->delay_ms(1);                                                                        /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                                /* delay 1 ms */
             }
             if (timeout == 0)
             {
@@ -5649,9 +6144,9 @@ uint8_t w25qxx_block_erase_32k(w25qxx_handle_t *handle, uint32_t addr)
            
             return 1;                                                                                       /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                              /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                        /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                    /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                      /* >128Mb */
             {
                 buf[0] = (addr >> 24) & 0xFF;                                                               /* 31 - 24 bits */
                 res = _w25qxx_qspi_write_read(handle, 0xC5, 4,
@@ -5689,7 +6184,7 @@ uint8_t w25qxx_block_erase_32k(w25qxx_handle_t *handle, uint32_t addr)
                 return 1;                                                                                   /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_BLOCK_ERASE_32K, 4,
                                           addr, 4, 4,
@@ -5729,7 +6224,7 @@ uint8_t w25qxx_block_erase_32k(w25qxx_handle_t *handle, uint32_t addr)
                 break;                                                                                      /* break */
             }
             timeout--;                                                                                      /* timeout-- */
-            handle->delay_ms(1);                                                                            /* delay 1 ms */
+            _w25qxx_delay_ms(handle, 1);                                                                    /* delay 1 ms */
         }
         if (timeout == 0)
         {
@@ -5739,6 +6234,9 @@ uint8_t w25qxx_block_erase_32k(w25qxx_handle_t *handle, uint32_t addr)
         }
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_ERASE_32K);                                        /* count the latency */
+    _w25qxx_wear_erase(handle, addr, 32768);                                                                /* count the wear */
+    _w25qxx_map_erase(handle, addr, 32768);                                                                 /* mark the erase map */
     return 0;                                                                                               /* success return 0 */
 }
 
@@ -5771,6 +6269,7 @@ uint8_t w25qxx_block_erase_64k(w25qxx_handle_t *handle, uint32_t addr)
     {
         return 3;                                                                                           /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                            /* start the statistics */
     if (addr % (64 * 1024))                                                                                 /* check address */
     {
         handle->debug_print("w25qxx: addr is invalid.\n");                                                  /* addr is invalid */
@@ -5778,9 +6277,9 @@ uint8_t w25qxx_block_erase_64k(w25qxx_handle_t *handle, uint32_t addr)
         return 4;                                                                                           /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                           /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                              /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                   /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                        /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                           0x00000000, 0x00, 0x00,
@@ -5793,9 +6292,9 @@ uint8_t w25qxx_block_erase_64k(w25qxx_handle_t *handle, uint32_t addr)
                
                 return 1;                                                                                   /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = (addr >> 24) & 0xFF;                                                           /* 31 - 24 bits */
                     res = _w25qxx_qspi_write_read(handle, 0xC5, 1,
@@ -5833,7 +6332,7 @@ uint8_t w25qxx_block_erase_64k(w25qxx_handle_t *handle, uint32_t addr)
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_BLOCK_ERASE_64K, 1,
                                               addr, 1, 4,
@@ -5873,7 +6372,7 @@ uint8_t w25qxx_block_erase_64k(w25qxx_handle_t *handle, uint32_t addr)
                     break;                                                                                  /* break */
                 }
                 timeout--;                                                                                  /* timeout-- */
-                handle->delay_ms(1);                                                                        /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                                /* delay 1 ms */
             }
             if (timeout == 0)
             {
@@ -5892,9 +6391,9 @@ uint8_t w25qxx_block_erase_64k(w25qxx_handle_t *handle, uint32_t addr)
                
                 return 1;                                                                                   /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = 0xC5;                                                                          /* write extended addr register command */
                     buf[1] = (addr >> 24) & 0xFF;                                                           /* 31 - 24 bits */
@@ -5926,7 +6425,7 @@ uint8_t w25qxx_block_erase_64k(w25qxx_handle_t *handle, uint32_t addr)
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 buf[0] = W25QXX_COMMAND_BLOCK_ERASE_64K;                                                    /* block erase 64k command */
                 buf[1] = (addr >> 24) & 0xFF;                                                               /* 31 - 24 bits */
@@ -5964,7 +6463,7 @@ uint8_t w25qxx_block_erase_64k(w25qxx_handle_t *handle, uint32_t addr)
                     break;                                                                                  /* break */
                 }
                 timeout--;                                                                                  /* timeout-- */
-                handle->delay_ms(1);                                                                        /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                                /* delay 1 ms */
             }
             if (timeout == 0)
             {
@@ -5987,9 +6486,9 @@ uint8_t w25qxx_block_erase_64k(w25qxx_handle_t *handle, uint32_t addr)
            
             return 1;                                                                                       /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                              /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                        /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                    /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                      /* >128Mb */
             {
                 buf[0] = (addr >> 24) & 0xFF;                                                               /* 31 - 24 bits */
                 res = _w25qxx_qspi_write_read(handle, 0xC5, 4,
@@ -6027,7 +6526,7 @@ uint8_t w25qxx_block_erase_64k(w25qxx_handle_t *handle, uint32_t addr)
                 return 1;                                                                                   /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_BLOCK_ERASE_64K, 4,
                                           addr, 4, 4,
@@ -6067,7 +6566,7 @@ uint8_t w25qxx_block_erase_64k(w25qxx_handle_t *handle, uint32_t addr)
                 break;                                                                                      /* break */
             }
             timeout--;                                                                                      /* timeout-- */
-            handle->delay_ms(1);                                                                            /* delay 1 ms */
+            _w25qxx_delay_ms(handle, 1);                                                                    /* delay 1 ms */
         }
         if (timeout == 0)
         {
@@ -6077,6 +6576,9 @@ uint8_t w25qxx_block_erase_64k(w25qxx_handle_t *handle, uint32_t addr)
         }
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_ERASE_64K);                                        /* count the latency */
+    _w25qxx_wear_erase(handle, addr, 65536);                                                                /* count the wear */
+    _w25qxx_map_erase(handle, addr, 65536);                                                                 /* mark the erase map */
     return 0;                                                                                               /* success return 0 */
 }
 
@@ -6106,13 +6608,13 @@ uint8_t w25qxx_individual_block_lock(w25qxx_handle_t *handle, uint32_t addr)
         return 3;                                                                                           /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                           /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                              /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                   /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                        /* enable dual quad spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                                   0x00000000, 0x00, 0x00,
@@ -6150,7 +6652,7 @@ uint8_t w25qxx_individual_block_lock(w25qxx_handle_t *handle, uint32_t addr)
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_INDIVIDUAL_BLOCK_LOCK, 1,
                                               addr, 1, 4,
@@ -6173,9 +6675,9 @@ uint8_t w25qxx_individual_block_lock(w25qxx_handle_t *handle, uint32_t addr)
         }
         else                                                                                                /* single spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = W25QXX_COMMAND_WRITE_ENABLE;                                                   /* write enable command */
                     res = _w25qxx_spi_write_read(handle, (uint8_t *)buf, 1, NULL, 0);                       /* spi write read */
@@ -6207,7 +6709,7 @@ uint8_t w25qxx_individual_block_lock(w25qxx_handle_t *handle, uint32_t addr)
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 buf[0] = W25QXX_COMMAND_INDIVIDUAL_BLOCK_LOCK;                                              /* individual block lock command */
                 buf[1] = (addr >> 24) & 0xFF;                                                               /* 31 - 24 bits */
@@ -6232,9 +6734,9 @@ uint8_t w25qxx_individual_block_lock(w25qxx_handle_t *handle, uint32_t addr)
     }
     else
     {
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                              /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                        /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                    /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                      /* >128Mb */
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 4,
                                               0x00000000, 0x00, 0x00,
@@ -6272,7 +6774,7 @@ uint8_t w25qxx_individual_block_lock(w25qxx_handle_t *handle, uint32_t addr)
                 return 1;                                                                                   /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_INDIVIDUAL_BLOCK_LOCK, 4,
                                           addr, 4, 4,
@@ -6323,13 +6825,13 @@ uint8_t w25qxx_individual_block_unlock(w25qxx_handle_t *handle, uint32_t addr)
         return 3;                                                                                           /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                           /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                              /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                   /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                        /* enable dual quad spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                                   0x00000000, 0x00, 0x00,
@@ -6367,7 +6869,7 @@ uint8_t w25qxx_individual_block_unlock(w25qxx_handle_t *handle, uint32_t addr)
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_INDIVIDUAL_BLOCK_UNLOCK, 1,
                                               addr, 1, 4,
@@ -6390,9 +6892,9 @@ uint8_t w25qxx_individual_block_unlock(w25qxx_handle_t *handle, uint32_t addr)
         }
         else                                                                                                /* single spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = W25QXX_COMMAND_WRITE_ENABLE;                                                   /* write enable command */
                     res = _w25qxx_spi_write_read(handle, (uint8_t *)buf, 1, NULL, 0);                       /* spi write read */
@@ -6424,7 +6926,7 @@ uint8_t w25qxx_individual_block_unlock(w25qxx_handle_t *handle, uint32_t addr)
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 buf[0] = W25QXX_COMMAND_INDIVIDUAL_BLOCK_UNLOCK;                                            /* individual block unlock command */
                 buf[1] = (addr >> 24) & 0xFF;                                                               /* 31 - 24 bits */
@@ -6449,9 +6951,9 @@ uint8_t w25qxx_individual_block_unlock(w25qxx_handle_t *handle, uint32_t addr)
     }
     else
     {
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                              /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                        /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                    /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                      /* >128Mb */
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 4,
                                               0x00000000, 0x00, 0x00,
@@ -6489,7 +6991,7 @@ uint8_t w25qxx_individual_block_unlock(w25qxx_handle_t *handle, uint32_t addr)
                 return 1;                                                                                   /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_INDIVIDUAL_BLOCK_UNLOCK, 4,
                                           addr, 4, 4,
@@ -6541,13 +7043,13 @@ uint8_t w25qxx_read_block_lock(w25qxx_handle_t *handle, uint32_t addr, uint8_t *
         return 3;                                                                                           /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                           /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                              /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                   /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                        /* enable dual quad spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                                   0x00000000, 0x00, 0x00,
@@ -6585,7 +7087,7 @@ uint8_t w25qxx_read_block_lock(w25qxx_handle_t *handle, uint32_t addr, uint8_t *
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_READ_BLOCK_LOCK, 1,
                                               addr, 1, 4,
@@ -6608,9 +7110,9 @@ uint8_t w25qxx_read_block_lock(w25qxx_handle_t *handle, uint32_t addr, uint8_t *
         }
         else                                                                                                /* single spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = W25QXX_COMMAND_WRITE_ENABLE;                                                   /* write enable command */
                     res = _w25qxx_spi_write_read(handle, (uint8_t *)buf, 1, NULL, 0);                       /* spi write read */
@@ -6642,7 +7144,7 @@ uint8_t w25qxx_read_block_lock(w25qxx_handle_t *handle, uint32_t addr, uint8_t *
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 buf[0] = W25QXX_COMMAND_READ_BLOCK_LOCK;                                                    /* read block lock command */
                 buf[1] = (addr >> 24) & 0xFF;                                                               /* 31 - 24 bits */
@@ -6667,9 +7169,9 @@ uint8_t w25qxx_read_block_lock(w25qxx_handle_t *handle, uint32_t addr, uint8_t *
     }
     else
     {
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                              /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                        /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                    /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                      /* >128Mb */
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 4,
                                               0x00000000, 0x00, 0x00,
@@ -6707,7 +7209,7 @@ uint8_t w25qxx_read_block_lock(w25qxx_handle_t *handle, uint32_t addr, uint8_t *
                 return 1;                                                                                   /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_READ_BLOCK_LOCK, 4,
                                           addr, 4, 4,
@@ -6758,9 +7260,9 @@ uint8_t w25qxx_set_burst_with_wrap(w25qxx_handle_t *handle, w25qxx_burst_wrap_t
         return 3;                                                                    /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                    /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                       /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                            /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                 /* enable dual quad spi */
         {
             buf[0] = wrap;
             res = _w25qxx_qspi_write_read(handle,
@@ -6864,7 +7366,7 @@ uint8_t w25qxx_init(w25qxx_handle_t *handle)
         return 3;                                                                          /* return error */
     }
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                          /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                             /* spi interface */
     {
         res = handle->spi_qspi_init();                                                     /* spi init */
         if (res)                                                                           /* check result */
@@ -6873,7 +7375,7 @@ uint8_t w25qxx_init(w25qxx_handle_t *handle)
            
             return 1;                                                                      /* return error */
         }
-        if (handle->dual_quad_spi_enable)                                                  /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                       /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle,
                                           W25QXX_COMMAND_RELEASE_POWER_DOWN, 1,
@@ -6911,7 +7413,7 @@ uint8_t w25qxx_init(w25qxx_handle_t *handle)
                
                 return 7;                                                                  /* return error */
             }
-            handle->delay_ms(10);                                                          /* delay 10 ms */
+            _w25qxx_delay_ms(handle, 10);                                                  /* delay 10 ms */
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_READ_MANUFACTURER, 1,
                                           0x00000000, 1, 3,
                                           0x00000000, 0x00, 0x00,
@@ -6930,7 +7432,7 @@ uint8_t w25qxx_init(w25qxx_handle_t *handle)
                
                 return 6;                                                                  /* return error */
             }
-            if (handle->type >= W25Q256)
+            if (W25QXX_IS_256(handle))
             {
                 res = _w25qxx_qspi_write_read(handle, 0xE9, 1,
                                               0x00000000, 0, 0,
@@ -6975,7 +7477,7 @@ uint8_t w25qxx_init(w25qxx_handle_t *handle)
                
                 return 7;                                                                  /* return error */
             }
-            handle->delay_ms(10);                                                          /* delay 10 ms */
+            _w25qxx_delay_ms(handle, 10);                                                  /* delay 10 ms */
             buf[0] = W25QXX_COMMAND_READ_MANUFACTURER;                                     /* read manufacturer command */
             buf[1] = 0x00;                                                                 /* dummy */
             buf[2] = 0x00;                                                                 /* dummy */
@@ -6995,7 +7497,7 @@ uint8_t w25qxx_init(w25qxx_handle_t *handle)
                
                 return 6;                                                                  /* return error */
             }
-            if (handle->type >= W25Q256)
+            if (W25QXX_IS_256(handle))
             {
                 buf[0] = 0xE9;                                                             /* 3 byte mode */
                 res = _w25qxx_spi_write_read(handle, (uint8_t *)buf, 1, NULL, 0);          /* spi write read */
@@ -7053,7 +7555,7 @@ uint8_t w25qxx_init(w25qxx_handle_t *handle)
            
             return 7;                                                                      /* return error */
         }
-        handle->delay_ms(10);                                                              /* delay 10 ms */
+        _w25qxx_delay_ms(handle, 10);                                                      /* delay 10 ms */
         res = _w25qxx_qspi_write_read(handle,
                                       W25QXX_COMMAND_READ_STATUS_REG2, 1,
                                       0x00000000, 0x00, 0x00,
@@ -7107,10 +7609,17 @@ uint8_t w25qxx_init(w25qxx_handle_t *handle)
            
             return 5;                                                                      /* return error */
         }
-        handle->delay_ms(10);                                                              /* delay 10 ms */
-        buf[0] = 3 << 4;                                                                   /* set 8 read dummy */
+        _w25qxx_delay_ms(handle, 10);                                                      /* delay 10 ms */
+        if (handle->init_dummy != 0)                                                       /* tuned read dummy */
+        {
+            buf[0] = (uint8_t)((handle->init_dummy - 1) << 4);                             /* set the tuned read dummy */
+        }
+        else
+        {
+            buf[0] = 3 << 4;                                                               /* set 8 read dummy */
+        }
         handle->param = buf[0];                                                            /* set param */
-        handle->dummy = 8;                                                                 /* set dummy */
+        handle->dummy = (uint8_t)(((buf[0] >> 4) & 0x03) * 2 + 2);                         /* set dummy */
         res = _w25qxx_qspi_write_read(handle, 0xC0, 4,
                                       0x00000000, 0x00, 0x00,
                                       0x00000000, 0x00, 0x00,
@@ -7140,7 +7649,7 @@ uint8_t w25qxx_init(w25qxx_handle_t *handle)
            
             return 6;                                                                      /* return error */
         }
-        if (handle->type >= W25Q256)
+        if (W25QXX_IS_256(handle))
         {
             res = _w25qxx_qspi_write_read(handle, 0xE9, 4,
                                           0x00000000, 0, 0,
@@ -7187,9 +7696,9 @@ uint8_t w25qxx_deinit(w25qxx_handle_t *handle)
         return 3;                                                                  /* return error */
     }
 
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                  /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                     /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                          /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                               /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_POWER_DOWN, 1,
                                           0x00000000, 0x00, 0x00,
@@ -7229,7 +7738,7 @@ uint8_t w25qxx_deinit(w25qxx_handle_t *handle)
            
             return 1;                                                              /* return error */
         }
-        handle->delay_ms(10);                                                      /* delay 10 ms */
+        _w25qxx_delay_ms(handle, 10);                                              /* delay 10 ms */
         res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_POWER_DOWN, 1,
                                       0x00000000, 0x00, 0x00,
                                       0x00000000, 0x00, 0x00,
@@ -7280,14 +7789,15 @@ uint8_t w25qxx_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint3
     {
         return 3;                                                                                         /* return error */
     }
+    _w25qxx_stats_start(handle);                                                                          /* start the statistics */
     
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                         /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                            /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                 /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                      /* enable dual quad spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                        /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                  /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                              /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                /* >128Mb */
                 {
                     res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                                   0x00000000, 0x00, 0x00,
@@ -7325,7 +7835,7 @@ uint8_t w25qxx_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint3
                     return 1;                                                                             /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_FAST_READ, 1,
                                               addr, 1, 4,
@@ -7348,9 +7858,9 @@ uint8_t w25qxx_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint3
         }
         else                                                                                              /* single spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                        /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                  /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                              /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                /* >128Mb */
                 {
                     buf[0] = W25QXX_COMMAND_WRITE_ENABLE;                                                 /* write enable command */
                     res = _w25qxx_spi_write_read(handle, (uint8_t *)buf, 1, NULL, 0);                     /* spi write read */
@@ -7383,8 +7893,8 @@ uint8_t w25qxx_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint3
                     return 1;                                                                             /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE)
-                    && (handle->type >= W25Q256))                                                         /* check address mode */
+            else if ((W25QXX_IS_ADDR4(handle))
+                    && (W25QXX_IS_256(handle)))                                                           /* check address mode */
             {
                 buf[0] = W25QXX_COMMAND_FAST_READ;                                                        /* fast read command */
                 buf[1] = (addr >> 24) & 0xFF;                                                             /* 31 - 24 bits */
@@ -7410,9 +7920,9 @@ uint8_t w25qxx_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint3
     }
     else                                                                                                  /* qspi interface */
     {
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                  /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                    /* >128Mb */
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 4,
                                               0x00000000, 0x00, 0x00,
@@ -7450,7 +7960,7 @@ uint8_t w25qxx_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint3
                 return 1;                                                                                 /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_FAST_READ, 4,
                                           addr, 4, 4,
@@ -7472,6 +7982,7 @@ uint8_t w25qxx_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint3
         }
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_READ);                                           /* count the latency */
     return 0;                                                                                             /* success return 0 */
 }
 
@@ -7491,13 +8002,13 @@ static uint8_t _w25qxx_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
     volatile uint8_t res;
     volatile uint8_t buf[6];
 
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                         /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                            /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                 /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                      /* enable dual quad spi */
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                        /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                  /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                              /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                /* >128Mb */
                 {
                     res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                                   0x00000000, 0x00, 0x00,
@@ -7535,7 +8046,7 @@ static uint8_t _w25qxx_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
                     return 1;                                                                             /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_FAST_READ, 1,
                                               addr, 1, 4,
@@ -7558,9 +8069,9 @@ static uint8_t _w25qxx_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
         }
         else
         {
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                        /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                  /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                              /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                /* >128Mb */
                 {
                     buf[0] = W25QXX_COMMAND_WRITE_ENABLE;                                                 /* write enable command */
                     res = _w25qxx_spi_write_read(handle, (uint8_t *)buf, 1, NULL, 0);                     /* spi write read */
@@ -7593,7 +8104,7 @@ static uint8_t _w25qxx_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
                     return 1;                                                                             /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))    /* check address mode */
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))                                /* check address mode */
             {
                 buf[0] = W25QXX_COMMAND_FAST_READ;                                                        /* fast read command */
                 buf[1] = (addr >> 24) & 0xFF;                                                             /* 31 - 24 bits */
@@ -7619,9 +8130,9 @@ static uint8_t _w25qxx_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
     }
     else                                                                                                  /* qspi interface */
     {
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                            /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                      /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                  /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                    /* >128Mb */
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 4,
                                               0x00000000, 0x00, 0x00,
@@ -7659,7 +8170,7 @@ static uint8_t _w25qxx_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *dat
                 return 1;                                                                                 /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_FAST_READ, 4,
                                           addr, 4, 4,
@@ -7700,9 +8211,9 @@ static uint8_t _w25qxx_erase_sector(w25qxx_handle_t *handle, uint32_t addr)
     volatile uint32_t timeout;
     volatile uint8_t buf[5];
 
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                           /* spi interface */
+    if (W25QXX_IS_SPI(handle))                                                                              /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                   /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                        /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                           0x00000000, 0x00, 0x00,
@@ -7715,9 +8226,9 @@ static uint8_t _w25qxx_erase_sector(w25qxx_handle_t *handle, uint32_t addr)
                
                 return 1;                                                                                   /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = (addr >> 24) & 0xFF;                                                           /* 31 - 24 bits */
                     res = _w25qxx_qspi_write_read(handle, 0xC5, 1,
@@ -7755,7 +8266,7 @@ static uint8_t _w25qxx_erase_sector(w25qxx_handle_t *handle, uint32_t addr)
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_SECTOR_ERASE_4K, 1,
                                               addr, 1, 4,
@@ -7795,7 +8306,7 @@ static uint8_t _w25qxx_erase_sector(w25qxx_handle_t *handle, uint32_t addr)
                     break;                                                                                  /* break */
                 }
                 timeout--;                                                                                  /* timeout-- */
-                handle->delay_ms(1);                                                                        /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                                /* delay 1 ms */
             }
             if (timeout == 0)
             {
@@ -7814,9 +8325,9 @@ static uint8_t _w25qxx_erase_sector(w25qxx_handle_t *handle, uint32_t addr)
                
                 return 1;                                                                                   /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = 0xC5;                                                                          /* write extended addr register command */
                     buf[1] = (addr >> 24) & 0xFF;                                                           /* 31 - 24 bits */
@@ -7848,7 +8359,7 @@ static uint8_t _w25qxx_erase_sector(w25qxx_handle_t *handle, uint32_t addr)
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 buf[0] = W25QXX_COMMAND_SECTOR_ERASE_4K;                                                    /* sector erase 4k command */
                 buf[1] = (addr >> 24) & 0xFF;                                                               /* 31 - 24 bits */
@@ -7886,7 +8397,7 @@ static uint8_t _w25qxx_erase_sector(w25qxx_handle_t *handle, uint32_t addr)
                     break;                                                                                  /* break */
                 }
                 timeout--;                                                                                  /* timeout-- */
-                handle->delay_ms(1);                                                                        /* delay 1 ms */
+                _w25qxx_delay_ms(handle, 1);                                                                /* delay 1 ms */
             }
             if (timeout == 0)
             {
@@ -7909,9 +8420,9 @@ static uint8_t _w25qxx_erase_sector(w25qxx_handle_t *handle, uint32_t addr)
            
             return 1;                                                                                       /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                              /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                        /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                    /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                      /* >128Mb */
             {
                 buf[0] = (addr >> 24) & 0xFF;                                                               /* 31 - 24 bits */
                 res = _w25qxx_qspi_write_read(handle, 0xC5, 4,
@@ -7949,7 +8460,7 @@ static uint8_t _w25qxx_erase_sector(w25qxx_handle_t *handle, uint32_t addr)
                 return 1;                                                                                   /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_SECTOR_ERASE_4K, 4,
                                           addr, 4, 4,
@@ -7989,7 +8500,7 @@ static uint8_t _w25qxx_erase_sector(w25qxx_handle_t *handle, uint32_t addr)
                 break;                                                                                      /* break */
             }
             timeout--;                                                                                      /* timeout-- */
-            handle->delay_ms(1);                                                                            /* delay 1 ms */
+            _w25qxx_delay_ms(handle, 1);                                                                    /* delay 1 ms */
         }
         if (timeout == 0)
         {
@@ -7999,6 +8510,8 @@ static uint8_t _w25qxx_erase_sector(w25qxx_handle_t *handle, uint32_t addr)
         }
     }
     
+    _w25qxx_wear_erase(handle, addr, 4096);                                                                 /* count the wear */
+    _w25qxx_map_erase(handle, addr, 4096);                                                                  /* mark the erase map */
     return 0;                                                                                               /* success return 0 */
 }
 
@@ -8020,9 +8533,10 @@ uint8_t _w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
     volatile uint32_t timeout;
     volatile uint8_t buf[2];
 
-    if (handle->spi_qspi == W25QXX_INTERFACE_SPI)                                                           /* spi interface */
+    _w25qxx_map_program(handle, addr, len);                                                                 /* raise the erased mark */
+    if (W25QXX_IS_SPI(handle))                                                                              /* spi interface */
     {
-        if (handle->dual_quad_spi_enable)                                                                   /* enable dual quad spi */
+        if (W25QXX_IS_DQSPI(handle))                                                                        /* enable dual quad spi */
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, 1,
                                           0x00000000, 0x00, 0x00,
@@ -8035,9 +8549,9 @@ uint8_t _w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
                
                 return 1;                                                                                   /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = (addr >> 24) & 0xFF;                                                           /* 31 - 24 bits */
                     res = _w25qxx_qspi_write_read(handle, 0xC5, 1,
@@ -8075,7 +8589,7 @@ uint8_t _w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
                       return 1;                                                                             /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+            else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
             {
                 res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_PAGE_PROGRAM, 1,
                                               addr, 1, 4,
@@ -8115,7 +8629,7 @@ uint8_t _w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
                     break;                                                                                  /* break */
                 }
                 timeout--;                                                                                  /* timeout-- */
-                handle->delay_us(10);                                                                       /* delay 10 us */
+                _w25qxx_delay_us(handle, 10);                                                               /* delay 10 us */
             }
             if (timeout == 0)
             {
@@ -8134,9 +8648,9 @@ uint8_t _w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
                
                 return 1;                                                                                   /* return error */
             }
-            if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                          /* 3 address mode */
+            if (W25QXX_IS_ADDR3(handle))                                                                    /* 3 address mode */
             {
-                if (handle->type >= W25Q256)                                                                /* >128Mb */
+                if (W25QXX_IS_256(handle))                                                                  /* >128Mb */
                 {
                     buf[0] = 0xC5;                                                                          /* write extended addr register command */
                     buf[1] = (addr >> 24) & 0xFF;                                                           /* 31 - 24 bits */
@@ -8169,8 +8683,8 @@ uint8_t _w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
                     return 1;                                                                               /* return error */
                 }
             }
-            else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE)
-                     && (handle->type >= W25Q256))                                                          /* 4 address mode */
+            else if ((W25QXX_IS_ADDR4(handle))
+                     && (W25QXX_IS_256(handle)))                                                            /* 4 address mode */
             {
                 handle->buf[0] = W25QXX_COMMAND_PAGE_PROGRAM;                                               /* page program command */
                 handle->buf[1] = (addr >> 24) & 0xFF;                                                       /* 31 - 24 bits */
@@ -8209,7 +8723,7 @@ uint8_t _w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
                     break;                                                                                  /* break */
                 }
                 timeout--;                                                                                  /* timeout-- */
-                handle->delay_us(10);                                                                       /* delay 10 us */
+                _w25qxx_delay_us(handle, 10);                                                               /* delay 10 us */
             }
             if (timeout == 0)
             {
@@ -8232,9 +8746,9 @@ uint8_t _w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
            
             return 1;                                                                                       /* return error */
         }
-        if (handle->adress_mode == W25QXX_ADDRESS_MODE_3_BYTE)                                              /* 3 address mode */
+        if (W25QXX_IS_ADDR3(handle))                                                                        /* 3 address mode */
         {
-            if (handle->type >= W25Q256)                                                                    /* >128Mb */
+            if (W25QXX_IS_256(handle))                                                                      /* >128Mb */
             {
                 buf[0] = (addr >> 24) & 0xFF;                                                               /* 31 - 24 bits */
                 res = _w25qxx_qspi_write_read(handle, 0xC5, 4,
@@ -8272,7 +8786,7 @@ uint8_t _w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
                   return 1;                                                                                 /* return error */
             }
         }
-        else if ((handle->adress_mode == W25QXX_ADDRESS_MODE_4_BYTE) && (handle->type >= W25Q256))
+        else if ((W25QXX_IS_ADDR4(handle)) && (W25QXX_IS_256(handle)))
         {
             res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_PAGE_PROGRAM, 4,
                                           addr, 4, 4,
@@ -8312,7 +8826,7 @@ uint8_t _w25qxx_page_program(w25qxx_handle_t *handle, uint32_t addr, uint8_t *da
                 break;                                                                                      /* break */
             }
             timeout--;                                                                                      /* timeout-- */
-            handle->delay_us(10);                                                                           /* delay 10 us */
+            _w25qxx_delay_us(handle, 10);                                                                   /* delay 10 us */
         }
         if (timeout == 0)
         {
@@ -8379,27 +8893,203 @@ static uint8_t _w25qxx_write_no_check(w25qxx_handle_t *handle, uint32_t addr, ui
 }
 
 /**
- * @brief     write data
- * @param[in] *handle points to a w25qxx handle structure
- * @param[in] addr is the write address
- * @param[in] *data points to a data buffer
+ * @brief     load a 32 bits word
+ * @param[in] *buf points to a data buffer
+ * @return    word
+ * @note      memcpy keeps unaligned buffers safe and compiles to a plain load
+ */
+static inline uint32_t _w25qxx_load32(const uint8_t *buf)
+{
+    uint32_t w;
+    
+    memcpy(&w, buf, 4);                                                                        /* load word */
+    
+    return w;                                                                                  /* return word */
+}
+
+/**
+ * @brief     find the first byte that is not erased
+ * @param[in] *buf points to a data buffer
  * @param[in] len is the data length
- * @return    status code
- *            - 0 success
- *            - 1 write failed
- *            - 2 handle is NULL
- *            - 3 handle is not initialized
- *            - 4 read failed
- *            - 5 erase sector failed
- * @note      none
+ * @return    offset of the first byte not 0xFF, len if all are erased
+ * @note      16 bytes per step with neon on aarch64 or four words otherwise
  */
-uint8_t w25qxx_write(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint32_t len)
+static uint32_t _w25qxx_first_not_erased(const uint8_t *buf, uint32_t len)
 {
-    volatile uint8_t res;
-    volatile uint32_t sec_pos;
-    volatile uint32_t sec_off;
-    volatile uint32_t sec_remain;
-    volatile uint32_t i;
+    uint32_t i;
+    
+    i = 0;                                                                                     /* init 0 */
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 16 <= len; i += 16)                                                             /* 16 bytes per step */
+    {
+        if (vminvq_u8(vld1q_u8(&buf[i])) != 0xFF)                                              /* any byte not 0xFF */
+        {
+            break;                                                                             /* break */
+        }
+    }
+#else
+    for (; i + 16 <= len; i += 16)                                                             /* 16 bytes per step */
+    {
+        if ((_w25qxx_load32(&buf[i]) & _w25qxx_load32(&buf[i + 4]) & 
+             _w25qxx_load32(&buf[i + 8]) & _w25qxx_load32(&buf[i + 12])) != 0xFFFFFFFFU)       /* any byte not 0xFF */
+        {
+            break;                                                                             /* break */
+        }
+    }
+#endif
+    while ((i < len) && (buf[i] == 0xFF))                                                      /* locate the byte */
+    {
+        i++;                                                                                   /* next */
+    }
+    
+    return i;                                                                                  /* return offset */
+}
+
+/**
+ * @brief     find the first differing byte
+ * @param[in] *a points to a data buffer
+ * @param[in] *b points to a data buffer
+ * @param[in] len is the data length
+ * @return    offset of the first differing byte, len if both are equal
+ * @note      16 bytes per step with neon on aarch64 or four words otherwise
+ */
+static uint32_t _w25qxx_first_diff(const uint8_t *a, const uint8_t *b, uint32_t len)
+{
+    uint32_t i;
+    
+    i = 0;                                                                                     /* init 0 */
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 16 <= len; i += 16)                                                             /* 16 bytes per step */
+    {
+        if (vmaxvq_u8(veorq_u8(vld1q_u8(&a[i]), vld1q_u8(&b[i]))) != 0)                       /* any byte differs */
+        {
+            break;                                                                             /* break */
+        }
+    }
+#else
+    for (; i + 16 <= len; i += 16)                                                             /* 16 bytes per step */
+    {
+        if (((_w25qxx_load32(&a[i]) ^ _w25qxx_load32(&b[i])) | 
+             (_w25qxx_load32(&a[i + 4]) ^ _w25qxx_load32(&b[i + 4])) | 
+             (_w25qxx_load32(&a[i + 8]) ^ _w25qxx_load32(&b[i + 8])) | 
+             (_w25qxx_load32(&a[i + 12]) ^ _w25qxx_load32(&b[i + 12]))) != 0)                  /* any byte differs */
+        {
+            break;                                                                             /* break */
+        }
+    }
+#endif
+    while ((i < len) && (a[i] == b[i]))                                                        /* locate the byte */
+    {
+        i++;                                                                                   /* next */
+    }
+    
+    return i;                                                                                  /* return offset */
+}
+
+/**
+ * @brief     find the first byte that can not be programmed without an erase
+ * @param[in] *old points to the flash content
+ * @param[in] *data points to the new data
+ * @param[in] len is the data length
+ * @return    offset of the first byte needing a 0 to 1 bit change, len if none
+ * @note      programming only clears bits, so a byte fits when (old & new) == new
+ */
+static uint32_t _w25qxx_first_not_programmable(const uint8_t *old, const uint8_t *data, uint32_t len)
+{
+    uint32_t i;
+    
+    i = 0;                                                                                     /* init 0 */
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 16 <= len; i += 16)                                                             /* 16 bytes per step */
+    {
+        if (vmaxvq_u8(vbicq_u8(vld1q_u8(&data[i]), vld1q_u8(&old[i]))) != 0)                  /* new & ~old */
+        {
+            break;                                                                             /* break */
+        }
+    }
+#else
+    for (; i + 16 <= len; i += 16)                                                             /* 16 bytes per step */
+    {
+        if (((_w25qxx_load32(&data[i]) & ~_w25qxx_load32(&old[i])) | 
+             (_w25qxx_load32(&data[i + 4]) & ~_w25qxx_load32(&old[i + 4])) | 
+             (_w25qxx_load32(&data[i + 8]) & ~_w25qxx_load32(&old[i + 8])) | 
+             (_w25qxx_load32(&data[i + 12]) & ~_w25qxx_load32(&old[i + 12]))) != 0)            /* new & ~old */
+        {
+            break;                                                                             /* break */
+        }
+    }
+#endif
+    while ((i < len) && ((old[i] & data[i]) == data[i]))                                       /* locate the byte */
+    {
+        i++;                                                                                   /* next */
+    }
+    
+    return i;                                                                                  /* return offset */
+}
+
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+
+/**
+ * @brief     learn the erased mark of a sector from its content
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] s is the 4k sector
+ * @param[in] *buf points to the 4096 bytes sector content
+ * @note      the mark is set behind the last byte that is not 0xFF
+ */
+static void _w25qxx_map_learn(w25qxx_handle_t *handle, uint32_t s, const uint8_t *buf)
+{
+    uint32_t end;
+    
+    if ((handle->erase_map == NULL) || (s < handle->erase_map_first) || 
+        (s >= handle->erase_map_first + handle->erase_map_num))                                /* check the range */
+    {
+        return;                                                                                /* return */
+    }
+    end = 4096;                                                                                /* from the end */
+    while ((end != 0) && (_w25qxx_first_not_erased(&buf[end - 256], 256) == 256))              /* skip erased pages */
+    {
+        end -= 256;                                                                            /* previous page */
+    }
+    while ((end != 0) && (buf[end - 1] == 0xFF))                                               /* skip erased bytes */
+    {
+        end--;                                                                                 /* previous byte */
+    }
+    handle->erase_map[s - handle->erase_map_first] = (uint16_t)end;                            /* set the mark */
+}
+
+#else
+
+/**
+ * @brief erase map learn hook definition
+ * @note  the hook compiles to nothing when the erase map is disabled
+ */
+#define _w25qxx_map_learn(handle, s, buf)
+
+#endif
+
+/**
+ * @brief     write data
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the write address
+ * @param[in] *data points to a data buffer
+ * @param[in] len is the data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 read failed
+ *            - 5 erase sector failed
+ * @note      unchanged leading bytes are skipped and a sector is erased only when
+ *            a bit has to go from 0 to 1
+ */
+uint8_t w25qxx_write(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint32_t len)
+{
+    volatile uint8_t res;
+    volatile uint32_t sec_pos;
+    volatile uint32_t sec_off;
+    volatile uint32_t sec_remain;
+    volatile uint32_t i;
     
     if (handle == NULL)                                                                        /* check handle */
     {
@@ -8409,6 +9099,7 @@ uint8_t w25qxx_write(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint
     {
         return 3;                                                                              /* return error */
     }
+    _w25qxx_stats_start(handle);                                                               /* start the statistics */
 
     sec_pos = addr / 4096;                                                                     /* get sector posistion */
     sec_off = addr % 4096;                                                                     /* get sector offset */
@@ -8419,51 +9110,63 @@ uint8_t w25qxx_write(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint
     }
     while(1)                                                                                   /* loop */
     {    
-        res = _w25qxx_read(handle, sec_pos * 4096, handle->buf_4k, 4096);                      /* read 4k data */
-        if (res)
-        {
-            handle->debug_print("w25qxx: read failed.\n");                                     /* read failed */
-           
-            return 4;                                                                          /* return error */
-        }
-        for (i = 0; i< sec_remain; i++)                                                        /* sec_remain length */
+        if (_w25qxx_map_erased(handle, sec_pos, sec_off) != 0)                                 /* known erased tail */
         {
-            if (handle->buf_4k[sec_off + i] != 0xFF)                                           /* check 0xFF */
+            res = _w25qxx_write_no_check(handle, addr, data, sec_remain);                      /* program without read back */
+            if (res)
             {
-                break;                                                                         /* break loop */
+                handle->debug_print("w25qxx: write failed.\n");                                /* write failed */
+               
+                return 1;                                                                      /* return error */
             }
         }
-        if (i < sec_remain)                                                                    /* not all is 0xFF */
+        else
         {
-            res = _w25qxx_erase_sector(handle, sec_pos * 4096);                                /* erase sector */
+            res = _w25qxx_read(handle, sec_pos * 4096, handle->buf_4k, 4096);                  /* read 4k data */
             if (res)
             {
-                handle->debug_print("w25qxx: erase sector failed.\n");                         /* erase sector failed */
-               
-                return 5;                                                                      /* return error */
+                handle->debug_print("w25qxx: read failed.\n");                                 /* read failed */
+           
+                return 4;                                                                      /* return error */
             }
-            for (i = 0; i<sec_remain; i++)                                                     /* sec_remain length */
+            _w25qxx_stats_add(handle, write_read_back_bytes, 4096);                            /* count the read back */
+            _w25qxx_map_learn(handle, sec_pos, handle->buf_4k);                                /* learn the erased tail */
+            i = _w25qxx_first_diff(&handle->buf_4k[sec_off], data, sec_remain);                /* skip the unchanged head */
+            if (i == sec_remain)                                                               /* already written */
             {
-                handle->buf_4k[i + sec_off] = data[i];                                         /* copy data */
+                /* nothing to do */
             }
-            res = _w25qxx_write_no_check(handle, sec_pos * 4096, handle->buf_4k, 4096);        /* write data no check */
-            if (res)                                                                           /* check result */
+            else if (_w25qxx_first_not_programmable(&handle->buf_4k[sec_off + i], &data[i], 
+                                                    sec_remain - i) != sec_remain - i)         /* needs an erase */
             {
-                handle->debug_print("w25qxx: write failed.\n");                                /* write failed */
+                res = _w25qxx_erase_sector(handle, sec_pos * 4096);                            /* erase sector */
+                if (res)
+                {
+                    handle->debug_print("w25qxx: erase sector failed.\n");                     /* erase sector failed */
                
-                return 1;                                                                      /* return error */
+                    return 5;                                                                  /* return error */
+                }
+                _w25qxx_stats_add(handle, write_erase, 1);                                     /* count the erase */
+                memcpy(&handle->buf_4k[sec_off], data, sec_remain);                            /* copy data */
+                res = _w25qxx_write_no_check(handle, sec_pos * 4096, handle->buf_4k, 4096);    /* write data no check */
+                if (res)                                                                       /* check result */
+                {
+                    handle->debug_print("w25qxx: write failed.\n");                            /* write failed */
+               
+                    return 1;                                                                  /* return error */
+                }
             }
-        }
-        else
-        {
-            res = _w25qxx_write_no_check(handle, addr, data, sec_remain);                      /* write data */
-            if (res)
+            else
             {
-                handle->debug_print("w25qxx: write failed.\n");                                /* write failed */
+                res = _w25qxx_write_no_check(handle, addr + i, data + i, sec_remain - i);      /* program over the old bits */
+                if (res)
+                {
+                    handle->debug_print("w25qxx: write failed.\n");                            /* write failed */
                
-                return 1;                                                                      /* return error */
-            }
-        }    
+                    return 1;                                                                  /* return error */
+                }
+            }    
+        }
         if (len == sec_remain)                                                                 /* check length length*/
         {
             break;                                                                             /* break loop */
@@ -8486,6 +9189,834 @@ uint8_t w25qxx_write(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint
         }
     }
     
+    _w25qxx_stats_latency(handle, W25QXX_STATS_OPERATION_WRITE);                               /* count the latency */
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief     check that a range is erased
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the first address
+ * @param[in] len is the range length
+ * @return    status code
+ *            - 0 success
+ *            - 1 read failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 5 range is not erased
+ * @note      the range is streamed through handle->buf_4k in 4096 bytes reads
+ */
+uint8_t w25qxx_blank_check(w25qxx_handle_t *handle, uint32_t addr, uint32_t len)
+{
+    uint8_t res;
+    uint32_t n;
+    
+    if (handle == NULL)                                                                        /* check handle */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (handle->inited != 1)                                                                   /* check handle initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    
+    while (len != 0)                                                                           /* all chunks */
+    {
+        n = (len > 4096) ? 4096 : len;                                                         /* chunk length */
+        res = _w25qxx_read(handle, addr, handle->buf_4k, n);                                   /* read chunk */
+        if (res)
+        {
+            handle->debug_print("w25qxx: read failed.\n");                                     /* read failed */
+           
+            return 1;                                                                          /* return error */
+        }
+        if (_w25qxx_first_not_erased(handle->buf_4k, n) != n)                                  /* check 0xFF */
+        {
+            return 5;                                                                          /* not erased */
+        }
+        addr += n;                                                                             /* next */
+        len -= n;                                                                              /* remain */
+    }
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief      get the statistics
+ * @param[in]  *handle points to a w25qxx handle structure
+ * @param[out] *stats points to a w25qxx stats structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 4 statistics is disabled
+ * @note       W25QXX_ENABLE_STATS must be 1
+ */
+uint8_t w25qxx_get_stats(w25qxx_handle_t *handle, w25qxx_stats_t *stats)
+{
+    if ((handle == NULL) || (stats == NULL))                                                   /* check handle */
+    {
+        return 2;                                                                              /* return error */
+    }
+    
+#if (W25QXX_ENABLE_STATS == 1)
+    memcpy(stats, &handle->stats, sizeof(w25qxx_stats_t));                                     /* copy the statistics */
+    
+    return 0;                                                                                  /* success return 0 */
+#else
+    handle->debug_print("w25qxx: statistics is disabled.\n");                                  /* statistics is disabled */
+    
+    return 4;                                                                                  /* return error */
+#endif
+}
+
+/**
+ * @brief     clear the statistics
+ * @param[in] *handle points to a w25qxx handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 4 statistics is disabled
+ * @note      W25QXX_ENABLE_STATS must be 1
+ */
+uint8_t w25qxx_clear_stats(w25qxx_handle_t *handle)
+{
+    if (handle == NULL)                                                                        /* check handle */
+    {
+        return 2;                                                                              /* return error */
+    }
+    
+#if (W25QXX_ENABLE_STATS == 1)
+    memset(&handle->stats, 0, sizeof(w25qxx_stats_t));                                         /* clear the statistics */
+    
+    return 0;                                                                                  /* success return 0 */
+#else
+    handle->debug_print("w25qxx: statistics is disabled.\n");                                  /* statistics is disabled */
+    
+    return 4;                                                                                  /* return error */
+#endif
+}
+
+/**
+ * @brief     link the erase map
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] *map points to a table of num entries
+ * @param[in] first is the first mapped 4k sector
+ * @param[in] num is the mapped sector number
+ * @param[in] keep is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 4 erase map is disabled
+ *            - 5 param is invalid
+ * @note      none
+ */
+uint8_t w25qxx_erase_map_init(w25qxx_handle_t *handle, uint16_t *map, uint32_t first, uint32_t num, w25qxx_bool_t keep)
+{
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    uint32_t i;
+#endif
+    
+    if (handle == NULL)                                                                        /* check handle */
+    {
+        return 2;                                                                              /* return error */
+    }
+    
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    if ((map == NULL) && (num != 0))                                                           /* check the table */
+    {
+        handle->debug_print("w25qxx: map is null.\n");                                         /* map is null */
+        
+        return 5;                                                                              /* return error */
+    }
+    if (num > 0x100000 - first)                                                                /* check the range */
+    {
+        handle->debug_print("w25qxx: range is invalid.\n");                                    /* range is invalid */
+        
+        return 5;                                                                              /* return error */
+    }
+    if (keep == W25QXX_BOOL_FALSE)                                                             /* start unknown */
+    {
+        for (i = 0; i < num; i++)                                                              /* all entries */
+        {
+            map[i] = 4096;                                                                     /* unknown */
+        }
+    }
+    else
+    {
+        for (i = 0; i < num; i++)                                                              /* all entries */
+        {
+            if ((map[i] & ~W25QXX_ERASE_MAP_DISCARD) > 4096)                                   /* check the entry */
+            {
+                map[i] = 4096;                                                                 /* unknown */
+            }
+        }
+    }
+    handle->erase_map = (num != 0) ? map : NULL;                                               /* link the table */
+    handle->erase_map_first = first;                                                           /* set the first sector */
+    handle->erase_map_num = num;                                                               /* set the sector number */
+    
+    return 0;                                                                                  /* success return 0 */
+#else
+    (void)map;                                                                                 /* not used */
+    (void)first;                                                                               /* not used */
+    (void)num;                                                                                 /* not used */
+    (void)keep;                                                                                /* not used */
+    handle->debug_print("w25qxx: erase map is disabled.\n");                                   /* erase map is disabled */
+    
+    return 4;                                                                                  /* return error */
+#endif
+}
+
+/**
+ * @brief     build the erase map from the chip
+ * @param[in] *handle points to a w25qxx handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 read failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 erase map is disabled
+ *            - 5 erase map is not linked
+ * @note      none
+ */
+uint8_t w25qxx_erase_map_scan(w25qxx_handle_t *handle)
+{
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    uint8_t res;
+    uint32_t i;
+#endif
+    
+    if (handle == NULL)                                                                        /* check handle */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (handle->inited != 1)                                                                   /* check handle initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    if (handle->erase_map == NULL)                                                             /* check the table */
+    {
+        handle->debug_print("w25qxx: erase map is not linked.\n");                             /* erase map is not linked */
+        
+        return 5;                                                                              /* return error */
+    }
+    for (i = 0; i < handle->erase_map_num; i++)                                                /* all mapped sectors */
+    {
+        res = _w25qxx_read(handle, (handle->erase_map_first + i) * 4096, handle->buf_4k, 4096);/* read 4k data */
+        if (res)
+        {
+            handle->debug_print("w25qxx: read failed.\n");                                     /* read failed */
+           
+            return 1;                                                                          /* return error */
+        }
+        _w25qxx_map_learn(handle, handle->erase_map_first + i, handle->buf_4k);                /* learn the erased tail */
+    }
+    
+    return 0;                                                                                  /* success return 0 */
+#else
+    handle->debug_print("w25qxx: erase map is disabled.\n");                                   /* erase map is disabled */
+    
+    return 4;                                                                                  /* return error */
+#endif
+}
+
+/**
+ * @brief     declare a range erased or dirty
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the first address
+ * @param[in] len is the range length
+ * @param[in] erased is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 4 erase map is disabled
+ *            - 5 erase map is not linked
+ * @note      none
+ */
+uint8_t w25qxx_erase_map_declare(w25qxx_handle_t *handle, uint32_t addr, uint32_t len, w25qxx_bool_t erased)
+{
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    uint32_t s;
+    uint32_t off;
+    uint32_t end;
+    uint16_t *entry;
+#endif
+    
+    if (handle == NULL)                                                                        /* check handle */
+    {
+        return 2;                                                                              /* return error */
+    }
+    
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    if (handle->erase_map == NULL)                                                             /* check the table */
+    {
+        handle->debug_print("w25qxx: erase map is not linked.\n");                             /* erase map is not linked */
+        
+        return 5;                                                                              /* return error */
+    }
+    while (len != 0)                                                                           /* all sectors */
+    {
+        s = addr / 4096;                                                                       /* get sector */
+        off = addr % 4096;                                                                     /* get sector offset */
+        end = ((4096 - off) > len) ? (off + len) : 4096;                                       /* end offset */
+        if ((s >= handle->erase_map_first) && (s - handle->erase_map_first < handle->erase_map_num))
+        {
+            entry = &handle->erase_map[s - handle->erase_map_first];                           /* get the entry */
+            if (erased == W25QXX_BOOL_FALSE)                                                   /* dirty */
+            {
+                *entry = 4096;                                                                 /* unknown */
+            }
+            else if ((end >= *entry) && (off < *entry))                                        /* reaches the tail */
+            {
+                *entry = (uint16_t)off;                                                        /* lower the mark */
+            }
+            else
+            {
+                /* the bytes in between are unknown */
+            }
+        }
+        addr += end - off;                                                                     /* next sector */
+        len -= end - off;                                                                      /* len - done */
+    }
+    
+    return 0;                                                                                  /* success return 0 */
+#else
+    (void)addr;                                                                                /* not used */
+    (void)len;                                                                                 /* not used */
+    (void)erased;                                                                              /* not used */
+    handle->debug_print("w25qxx: erase map is disabled.\n");                                   /* erase map is disabled */
+    
+    return 4;                                                                                  /* return error */
+#endif
+}
+
+/**
+ * @brief     discard a range
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the first address
+ * @param[in] len is the range length
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 4 erase map is disabled
+ *            - 5 erase map is not linked
+ * @note      none
+ */
+uint8_t w25qxx_discard(w25qxx_handle_t *handle, uint32_t addr, uint32_t len)
+{
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    uint32_t s;
+    uint32_t last;
+    uint16_t *entry;
+#endif
+    
+    if (handle == NULL)                                                                        /* check handle */
+    {
+        return 2;                                                                              /* return error */
+    }
+    
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    if (handle->erase_map == NULL)                                                             /* check the table */
+    {
+        handle->debug_print("w25qxx: erase map is not linked.\n");                             /* erase map is not linked */
+        
+        return 5;                                                                              /* return error */
+    }
+    if (len < 4096)                                                                            /* no whole sector */
+    {
+        return 0;                                                                              /* success return 0 */
+    }
+    s = (addr + 4095) / 4096;                                                                  /* first whole sector */
+    last = (addr + len) / 4096;                                                                /* behind the last whole sector */
+    for (; s < last; s++)                                                                      /* all whole sectors */
+    {
+        if ((s >= handle->erase_map_first) && (s - handle->erase_map_first < handle->erase_map_num))
+        {
+            entry = &handle->erase_map[s - handle->erase_map_first];                           /* get the entry */
+            if (*entry != 0)                                                                   /* not erased yet */
+            {
+                *entry |= W25QXX_ERASE_MAP_DISCARD;                                            /* queue the erase */
+            }
+        }
+    }
+    
+    return 0;                                                                                  /* success return 0 */
+#else
+    (void)addr;                                                                                /* not used */
+    (void)len;                                                                                 /* not used */
+    handle->debug_print("w25qxx: erase map is disabled.\n");                                   /* erase map is disabled */
+    
+    return 4;                                                                                  /* return error */
+#endif
+}
+
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+/**
+ * @brief      erase the first discarded run
+ * @param[in]  *handle points to a w25qxx handle structure
+ * @param[in]  max is the largest erase in sectors, 16, 8 or 1
+ * @param[out] *erased points to an erased length buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 erase failed
+ *             - 5 erase map is not linked
+ * @note       none
+ */
+static uint8_t _w25qxx_discard_erase(w25qxx_handle_t *handle, uint32_t max, uint32_t *erased)
+{
+    uint8_t res;
+    uint32_t i;
+    uint32_t s;
+    uint32_t n;
+    uint32_t k;
+    
+    if (handle->erase_map == NULL)                                                             /* check the table */
+    {
+        handle->debug_print("w25qxx: erase map is not linked.\n");                             /* erase map is not linked */
+        
+        return 5;                                                                              /* return error */
+    }
+    *erased = 0;                                                                               /* nothing erased */
+    for (i = 0; i < handle->erase_map_num; i++)                                                /* find the first discard */
+    {
+        if ((handle->erase_map[i] & W25QXX_ERASE_MAP_DISCARD) != 0)                            /* discarded */
+        {
+            break;                                                                             /* break */
+        }
+    }
+    if (i == handle->erase_map_num)                                                            /* nothing queued */
+    {
+        return 0;                                                                              /* success return 0 */
+    }
+    s = handle->erase_map_first + i;                                                           /* get sector */
+    n = 1;                                                                                     /* one sector */
+    if ((max >= 16) && (s % 16 == 0) && (i + 16 <= handle->erase_map_num))                     /* 64k aligned */
+    {
+        n = 16;                                                                                /* try a 64k block */
+    }
+    else if ((max >= 8) && (s % 8 == 0) && (i + 8 <= handle->erase_map_num))                   /* 32k aligned */
+    {
+        n = 8;                                                                                 /* try a 32k block */
+    }
+    else
+    {
+        /* single sector */
+    }
+    while (n > 1)                                                                              /* shrink to the discarded run */
+    {
+        for (k = 0; k < n; k++)                                                                /* check the block */
+        {
+            if ((handle->erase_map[i + k] & W25QXX_ERASE_MAP_DISCARD) == 0)                    /* still in use */
+            {
+                break;                                                                         /* break */
+            }
+        }
+        if (k == n)                                                                            /* whole block */
+        {
+            break;                                                                             /* break */
+        }
+        n = (n == 16) ? 8 : 1;                                                                 /* next smaller erase */
+    }
+    if (n == 16)                                                                               /* 64k */
+    {
+        res = w25qxx_block_erase_64k(handle, s * 4096);                                        /* block erase 64k */
+    }
+    else if (n == 8)                                                                           /* 32k */
+    {
+        res = w25qxx_block_erase_32k(handle, s * 4096);                                        /* block erase 32k */
+    }
+    else
+    {
+        res = w25qxx_sector_erase_4k(handle, s * 4096);                                        /* sector erase 4k */
+    }
+    if (res)                                                                                   /* check result */
+    {
+        handle->debug_print("w25qxx: discard erase failed.\n");                                /* discard erase failed */
+        
+        return 1;                                                                              /* return error */
+    }
+    *erased = n * 4096;                                                                        /* set the erased length */
+    
+    return 0;                                                                                  /* success return 0 */
+}
+#endif
+
+/**
+ * @brief      run one background erase step
+ * @param[in]  *handle points to a w25qxx handle structure
+ * @param[out] *erased points to an erased length buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 erase failed
+ *             - 2 handle or erased is NULL
+ *             - 3 handle is not initialized
+ *             - 4 erase map is disabled
+ *             - 5 erase map is not linked
+ * @note       none
+ */
+uint8_t w25qxx_discard_step(w25qxx_handle_t *handle, uint32_t *erased)
+{
+    if ((handle == NULL) || (erased == NULL))                                                  /* check handle */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (handle->inited != 1)                                                                   /* check handle initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    return _w25qxx_discard_erase(handle, 16, erased);                                          /* erase with any block */
+#else
+    handle->debug_print("w25qxx: erase map is disabled.\n");                                   /* erase map is disabled */
+    
+    return 4;                                                                                  /* return error */
+#endif
+}
+
+/**
+ * @brief     run the background erase from an idle hook
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] max_len is the largest erase, 4096, 32768 or 65536
+ * @return    status code
+ *            - 0 success
+ *            - 1 erase failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 max_len is invalid or erase map is disabled
+ *            - 5 erase map is not linked
+ * @note      none
+ */
+uint8_t w25qxx_discard_idle(w25qxx_handle_t *handle, uint32_t max_len)
+{
+    uint32_t erased;
+    
+    if (handle == NULL)                                                                        /* check handle */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (handle->inited != 1)                                                                   /* check handle initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    if ((max_len != 4096) && (max_len != 32768) && (max_len != 65536))                         /* check the size */
+    {
+        handle->debug_print("w25qxx: max len is invalid.\n");                                  /* max len is invalid */
+        
+        return 4;                                                                              /* return error */
+    }
+    
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    return _w25qxx_discard_erase(handle, max_len / 4096, &erased);                             /* erase one run */
+#else
+    (void)erased;                                                                              /* not used */
+    handle->debug_print("w25qxx: erase map is disabled.\n");                                   /* erase map is disabled */
+    
+    return 4;                                                                                  /* return error */
+#endif
+}
+
+/**
+ * @brief      get the pre-erased pool
+ * @param[in]  *handle points to a w25qxx handle structure
+ * @param[out] *pool points to a known erased bytes buffer
+ * @param[out] *backlog points to a discarded bytes buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle, pool or backlog is NULL
+ *             - 4 erase map is disabled
+ *             - 5 erase map is not linked
+ * @note       none
+ */
+uint8_t w25qxx_discard_get_pool(w25qxx_handle_t *handle, uint32_t *pool, uint32_t *backlog)
+{
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    uint32_t i;
+#endif
+    
+    if ((handle == NULL) || (pool == NULL) || (backlog == NULL))                               /* check handle */
+    {
+        return 2;                                                                              /* return error */
+    }
+    
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    if (handle->erase_map == NULL)                                                             /* check the table */
+    {
+        handle->debug_print("w25qxx: erase map is not linked.\n");                             /* erase map is not linked */
+        
+        return 5;                                                                              /* return error */
+    }
+    *pool = 0;                                                                                 /* init 0 */
+    *backlog = 0;                                                                              /* init 0 */
+    for (i = 0; i < handle->erase_map_num; i++)                                                /* all mapped sectors */
+    {
+        if ((handle->erase_map[i] & W25QXX_ERASE_MAP_DISCARD) != 0)                            /* discarded */
+        {
+            *backlog += 4096;                                                                  /* waits for the erase */
+        }
+        else
+        {
+            *pool += 4096 - handle->erase_map[i];                                              /* erased tail */
+        }
+    }
+    
+    return 0;                                                                                  /* success return 0 */
+#else
+    handle->debug_print("w25qxx: erase map is disabled.\n");                                   /* erase map is disabled */
+    
+    return 4;                                                                                  /* return error */
+#endif
+}
+
+/**
+ * @brief     start a command that leaves the chip busy
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] command is the erase or program command
+ * @param[in] addr is the command address
+ * @param[in] *data points to a data buffer
+ * @param[in] len is the data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 command failed
+ * @note      sends write enable, the extended address and the command, but does not wait
+ */
+static uint8_t _w25qxx_start(w25qxx_handle_t *handle, uint8_t command, uint32_t addr, uint8_t *data, uint16_t len)
+{
+    uint8_t res;
+    uint8_t line;
+    uint8_t alen;
+    
+    line = W25QXX_IS_SPI(handle) ? 1 : 4;                                                      /* set the phy lines */
+    alen = (W25QXX_IS_ADDR4(handle) && W25QXX_IS_256(handle)) ? 4 : 3;                         /* set the address length */
+    if (W25QXX_IS_SPI(handle) && (W25QXX_IS_DQSPI(handle) == 0))                               /* single spi */
+    {
+        handle->buf[0] = W25QXX_COMMAND_WRITE_ENABLE;                                          /* write enable command */
+        res = _w25qxx_spi_write_read(handle, handle->buf, 1, NULL, 0);                         /* spi write read */
+        if ((res == 0) && (alen == 3) && W25QXX_IS_256(handle))                                /* >128Mb */
+        {
+            handle->buf[0] = 0xC5;                                                             /* write extended addr register command */
+            handle->buf[1] = (addr >> 24) & 0xFF;                                              /* 31 - 24 bits */
+            res = _w25qxx_spi_write_read(handle, handle->buf, 2, NULL, 0);                     /* spi write read */
+            if (res == 0)
+            {
+                handle->buf[0] = W25QXX_COMMAND_WRITE_ENABLE;                                  /* write enable command */
+                res = _w25qxx_spi_write_read(handle, handle->buf, 1, NULL, 0);                 /* spi write read */
+            }
+        }
+        if (res == 0)
+        {
+            handle->buf[0] = command;                                                          /* set the command */
+            if (alen == 4)                                                                     /* 4 byte address */
+            {
+                handle->buf[1] = (addr >> 24) & 0xFF;                                          /* 31 - 24 bits */
+            }
+            handle->buf[alen - 2] = (addr >> 16) & 0xFF;                                       /* 23 - 16 bits */
+            handle->buf[alen - 1] = (addr >> 8) & 0xFF;                                        /* 15 - 8  bits */
+            handle->buf[alen - 0] = (addr >> 0) & 0xFF;                                        /* 7 - 0 bits */
+            if (len != 0)                                                                      /* program data */
+            {
+                memcpy(&handle->buf[1 + alen], data, len);                                     /* copy data */
+            }
+            res = _w25qxx_spi_write_read(handle, handle->buf, (uint16_t)(1 + alen + len), NULL, 0);/* spi write read */
+        }
+    }
+    else
+    {
+        res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, line,
+                                      0x00000000, 0x00, 0x00,
+                                      0x00000000, 0x00, 0x00,
+                                      0x00, NULL, 0x00,
+                                      NULL, 0x00, 0x00);                                       /* qspi write read */
+        if ((res == 0) && (alen == 3) && W25QXX_IS_256(handle))                                /* >128Mb */
+        {
+            handle->buf[0] = (addr >> 24) & 0xFF;                                              /* 31 - 24 bits */
+            res = _w25qxx_qspi_write_read(handle, 0xC5, line,
+                                          0x00000000, 0x00, 0x00,
+                                          0x00000000, 0x00, 0x00,
+                                          0, handle->buf, 0x01,
+                                          NULL, 0x00, line);                                   /* qspi write read */
+            if (res == 0)
+            {
+                res = _w25qxx_qspi_write_read(handle, W25QXX_COMMAND_WRITE_ENABLE, line,
+                                              0x00000000, 0x00, 0x00,
+                                              0x00000000, 0x00, 0x00,
+                                              0x00, NULL, 0x00,
+                                              NULL, 0x00, 0x00);                               /* qspi write read */
+            }
+        }
+        if (res == 0)
+        {
+            res = _w25qxx_qspi_write_read(handle, command, line,
+                                          addr, line, alen,
+                                          0x00000000, 0x00, 0x00,
+                                          0, data, len,
+                                          NULL, 0x00, (len != 0) ? line : 0);                  /* qspi write read */
+        }
+    }
+    if (res)                                                                                   /* check result */
+    {
+        handle->debug_print("w25qxx: start command failed.\n");                                /* start command failed */
+        
+        return 1;                                                                              /* return error */
+    }
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief     start an erase
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the erase address
+ * @param[in] len is the erase size
+ * @return    status code
+ *            - 0 success
+ *            - 1 erase start failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 len is invalid
+ * @note      none
+ */
+uint8_t w25qxx_erase_start(w25qxx_handle_t *handle, uint32_t addr, uint32_t len)
+{
+    uint8_t command;
+    
+    if (handle == NULL)                                                                        /* check handle */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (handle->inited != 1)                                                                   /* check handle initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    if (len == 4096)                                                                           /* 4k sector */
+    {
+        command = W25QXX_COMMAND_SECTOR_ERASE_4K;                                              /* sector erase 4k */
+    }
+    else if (len == 32768)                                                                     /* 32k block */
+    {
+        command = W25QXX_COMMAND_BLOCK_ERASE_32K;                                              /* block erase 32k */
+    }
+    else if (len == 65536)                                                                     /* 64k block */
+    {
+        command = W25QXX_COMMAND_BLOCK_ERASE_64K;                                              /* block erase 64k */
+    }
+    else
+    {
+        handle->debug_print("w25qxx: len is invalid.\n");                                      /* len is invalid */
+        
+        return 4;                                                                              /* return error */
+    }
+    
+    addr &= ~(len - 1);                                                                        /* align the address */
+    if (_w25qxx_start(handle, command, addr, NULL, 0) != 0)                                    /* start the erase */
+    {
+        return 1;                                                                              /* return error */
+    }
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief     finish an erase
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the erase address
+ * @param[in] len is the erase size
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 len is invalid
+ * @note      none
+ */
+uint8_t w25qxx_erase_finish(w25qxx_handle_t *handle, uint32_t addr, uint32_t len)
+{
+    if (handle == NULL)                                                                        /* check handle */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (handle->inited != 1)                                                                   /* check handle initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    if ((len != 4096) && (len != 32768) && (len != 65536))                                     /* check the length */
+    {
+        handle->debug_print("w25qxx: len is invalid.\n");                                      /* len is invalid */
+        
+        return 4;                                                                              /* return error */
+    }
+    
+    addr &= ~(len - 1);                                                                        /* align the address */
+    _w25qxx_wear_erase(handle, addr, len);                                                     /* count the wear */
+    _w25qxx_map_erase(handle, addr, len);                                                      /* mark the erase map */
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief     start a page program
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the programming address
+ * @param[in] *data points to a data buffer
+ * @param[in] len is the data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 page program start failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 data crosses a page
+ * @note      none
+ */
+uint8_t w25qxx_page_program_start(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint16_t len)
+{
+    if (handle == NULL)                                                                        /* check handle */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (handle->inited != 1)                                                                   /* check handle initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    if ((len == 0) || ((addr % 256) + len > 256))                                              /* check the page */
+    {
+        handle->debug_print("w25qxx: data crosses a page.\n");                                 /* data crosses a page */
+        
+        return 4;                                                                              /* return error */
+    }
+    
+    _w25qxx_map_program(handle, addr, len);                                                    /* raise the erased mark */
+    if (_w25qxx_start(handle, W25QXX_COMMAND_PAGE_PROGRAM, addr, data, len) != 0)              /* start the program */
+    {
+        return 1;                                                                              /* return error */
+    }
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief      get the busy status
+ * @param[in]  *handle points to a w25qxx handle structure
+ * @param[out] *busy points to a bool value buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 get busy failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       none
+ */
+uint8_t w25qxx_get_busy(w25qxx_handle_t *handle, w25qxx_bool_t *busy)
+{
+    uint8_t res;
+    uint8_t status;
+    
+    res = w25qxx_get_status1(handle, &status);                                                 /* get status1 */
+    if (res)                                                                                   /* check result */
+    {
+        return res;                                                                            /* return error */
+    }
+    *busy = (w25qxx_bool_t)(status & W25QXX_STATUS1_ERASE_WRITE_PROGRESS);                     /* get busy */
+    
     return 0;                                                                                  /* success return 0 */
 }
 
@@ -51,6 +51,77 @@ extern "C"{
  * @{
  */
 
+/**
+ * @brief w25qxx statistics enable definition
+ * @note  set it to 1 to count the bus and flash operations of every handle,
+ *        with 0 the counters and the hooks are not compiled
+ */
+#ifndef W25QXX_ENABLE_STATS
+    #define W25QXX_ENABLE_STATS 0
+#endif
+
+/**
+ * @brief w25qxx wear tracking enable definition
+ * @note  set it to 1 to count the erases of every 4k sector in a table linked by
+ *        driver_w25qxx_wear, with 0 the erase hook is not compiled
+ */
+#ifndef W25QXX_ENABLE_WEAR
+    #define W25QXX_ENABLE_WEAR 0
+#endif
+
+/**
+ * @brief w25qxx erase map enable definition
+ * @note  set it to 1 to track the erased tail of every 4k sector in a table linked by
+ *        w25qxx_erase_map_init, with 0 the hooks are not compiled
+ */
+#ifndef W25QXX_ENABLE_ERASE_MAP
+    #define W25QXX_ENABLE_ERASE_MAP 0
+#endif
+
+/**
+ * @brief w25qxx compiled interface definition
+ * @note  bit 0 keeps the spi paths and bit 1 the qspi paths, a build with one bit
+ *        drops the other paths at compile time
+ */
+#define W25QXX_CONFIG_INTERFACE_SPI         (1 << 0)
+#define W25QXX_CONFIG_INTERFACE_QSPI        (1 << 1)
+#ifndef W25QXX_CONFIG_INTERFACE
+    #define W25QXX_CONFIG_INTERFACE (W25QXX_CONFIG_INTERFACE_SPI | W25QXX_CONFIG_INTERFACE_QSPI)
+#endif
+
+/**
+ * @brief w25qxx compiled dual quad spi definition
+ * @note  set it to 0 to drop the dual and quad spi paths of the spi interface
+ */
+#ifndef W25QXX_CONFIG_DUAL_QUAD_SPI
+    #define W25QXX_CONFIG_DUAL_QUAD_SPI 1
+#endif
+
+/**
+ * @brief w25qxx compiled max type definition
+ * @note  the largest supported chip id, below 0xEF18 (w25q256) the extended address
+ *        and 4 byte address paths are dropped
+ */
+#ifndef W25QXX_CONFIG_MAX_TYPE
+    #define W25QXX_CONFIG_MAX_TYPE 0xEF18
+#endif
+
+/**
+ * @brief w25qxx compiled 4 byte address mode definition
+ * @note  set it to 0 to drop the 4 byte address mode paths, the chips above 128Mb
+ *        then use the extended address register in 3 byte mode
+ */
+#ifndef W25QXX_CONFIG_ADDRESS_4_BYTE
+    #define W25QXX_CONFIG_ADDRESS_4_BYTE 1
+#endif
+
+/**
+ * @brief w25qxx statistics latency histogram bins definition
+ * @note  bin i counts the operations whose latency is in [2^i, 2^(i + 1)) us,
+ *        the last bin also counts all the longer operations
+ */
+#define W25QXX_STATS_LATENCY_BINS 24
+
 /**
  * @addtogroup w25qxx_basic_driver
  * @{
@@ -194,6 +265,30 @@ typedef enum
     W25QXX_STATUS3_CURRENT_ADDRESS_MODE                  = (1 << 0),        /**< current address mode */
 } w25qxx_status3_t;
 
+/**
+ * @}
+ */
+
+/**
+ * @addtogroup w25qxx_stats_driver
+ * @{
+ */
+
+/**
+ * @brief w25qxx statistics operation enumeration definition
+ */
+typedef enum
+{
+    W25QXX_STATS_OPERATION_READ         = 0x00,        /**< read functions */
+    W25QXX_STATS_OPERATION_WRITE        = 0x01,        /**< w25qxx_write */
+    W25QXX_STATS_OPERATION_PAGE_PROGRAM = 0x02,        /**< page program functions */
+    W25QXX_STATS_OPERATION_ERASE_4K     = 0x03,        /**< sector erase 4k */
+    W25QXX_STATS_OPERATION_ERASE_32K    = 0x04,        /**< block erase 32k */
+    W25QXX_STATS_OPERATION_ERASE_64K    = 0x05,        /**< block erase 64k */
+    W25QXX_STATS_OPERATION_CHIP_ERASE   = 0x06,        /**< chip erase */
+    W25QXX_STATS_OPERATION_MAX          = 0x07,        /**< operation number */
+} w25qxx_stats_operation_t;
+
 /**
  * @}
  */
@@ -203,6 +298,27 @@ typedef enum
  * @{
  */
 
+/**
+ * @brief w25qxx statistics structure definition
+ */
+typedef struct w25qxx_stats_s
+{
+    uint64_t read_bytes;                                                              /**< array bytes read on the bus, including the read back */
+    uint64_t program_bytes;                                                           /**< bytes sent by the page program commands */
+    uint32_t page_program;                                                            /**< page program commands */
+    uint32_t erase_4k;                                                                /**< sector erase 4k commands */
+    uint32_t erase_32k;                                                               /**< block erase 32k commands */
+    uint32_t erase_64k;                                                               /**< block erase 64k commands */
+    uint32_t chip_erase;                                                              /**< chip erase commands */
+    uint32_t write_enable;                                                            /**< write enable commands */
+    uint32_t extended_address;                                                        /**< extended address register writes */
+    uint32_t status_poll;                                                             /**< status register 1 reads */
+    uint64_t busy_wait_us;                                                            /**< time spent in the driver delays */
+    uint64_t write_read_back_bytes;                                                   /**< bytes read back by w25qxx_write */
+    uint32_t write_erase;                                                             /**< sector erases triggered by w25qxx_write */
+    uint32_t latency[W25QXX_STATS_OPERATION_MAX][W25QXX_STATS_LATENCY_BINS];          /**< latency histogram of each operation */
+} w25qxx_stats_t;
+
 /**
  * @brief w25qxx handle structure definition
  */
@@ -223,10 +339,27 @@ typedef struct w25qxx_handle_s
     uint8_t adress_mode;                                                                               /**< address mode */
     uint8_t param;                                                                                     /**< param */
     uint8_t dummy;                                                                                     /**< dummy */
+    uint8_t init_dummy;                                                                                /**< qspi read dummy sent by init plus 1, 0 is the default */
     uint8_t dual_quad_spi_enable;                                                                      /**< dual spi and quad spi enable */
     uint8_t spi_qspi;                                                                                  /**< spi qspi interface type */
     uint8_t buf[256 + 6];                                                                              /**< inner buffer */
     uint8_t buf_4k[4096];                                                                              /**< 4k inner buffer */
+#if (W25QXX_ENABLE_STATS == 1)
+    uint64_t (*timestamp_us)(void);                                                                    /**< point to a timestamp_us function address */
+    uint64_t stats_start;                                                                              /**< start time of the current operation */
+    w25qxx_stats_t stats;                                                                              /**< statistics */
+#endif
+#if (W25QXX_ENABLE_WEAR == 1)
+    uint32_t *wear_count;                                                                              /**< erase count of the tracked 4k sectors */
+    uint32_t wear_first;                                                                               /**< first tracked sector */
+    uint32_t wear_num;                                                                                 /**< tracked sector number */
+    uint32_t wear_dirty;                                                                               /**< erases since the last save */
+#endif
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    uint16_t *erase_map;                                                                               /**< erased from this offset on, per mapped 4k sector */
+    uint32_t erase_map_first;                                                                          /**< first mapped sector */
+    uint32_t erase_map_num;                                                                            /**< mapped sector number */
+#endif
 } w25qxx_handle_t;
 
 /**
@@ -312,6 +445,19 @@ typedef struct w25qxx_info_s
  */
 #define DRIVER_W25QXX_LINK_DEBUG_PRINT(HANDLE, FUC)               (HANDLE)->debug_print = FUC
 
+/**
+ * @brief     link timestamp_us function
+ * @param[in] HANDLE points to a w25qxx handle structure
+ * @param[in] FUC points to a timestamp_us function address
+ * @note      optional, only used by the statistics latency histogram,
+ *            without it the latency is the time spent in the driver delays
+ */
+#if (W25QXX_ENABLE_STATS == 1)
+#define DRIVER_W25QXX_LINK_TIMESTAMP_US(HANDLE, FUC)              (HANDLE)->timestamp_us = FUC
+#else
+#define DRIVER_W25QXX_LINK_TIMESTAMP_US(HANDLE, FUC)              (void)(FUC)
+#endif
+
 /**
  * @}
  */
@@ -340,6 +486,7 @@ uint8_t w25qxx_info(w25qxx_info_t *info);
  * @return    status code
  *            - 0 success
  *            - 2 handle is NULL
+ *            - 4 dual quad spi is not compiled
  * @note      none
  */
 uint8_t w25qxx_set_dual_quad_spi(w25qxx_handle_t *handle, w25qxx_bool_t enable);
@@ -355,6 +502,28 @@ uint8_t w25qxx_set_dual_quad_spi(w25qxx_handle_t *handle, w25qxx_bool_t enable);
  */
 uint8_t w25qxx_get_dual_quad_spi(w25qxx_handle_t *handle, w25qxx_bool_t *enable);
 
+/**
+ * @brief     set the qspi read dummy sent by the init
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] dummy is the qspi read dummy
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ * @note      call it before w25qxx_init, w25qxx_init uses W25QXX_QSPI_READ_DUMMY_8_80MHZ by default
+ */
+uint8_t w25qxx_set_init_read_dummy(w25qxx_handle_t *handle, w25qxx_qspi_read_dummy_t dummy);
+
+/**
+ * @brief      get the qspi read dummy sent by the init
+ * @param[in]  *handle points to a w25qxx handle structure
+ * @param[out] *dummy points to a qspi read dummy buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ * @note       none
+ */
+uint8_t w25qxx_get_init_read_dummy(w25qxx_handle_t *handle, w25qxx_qspi_read_dummy_t *dummy);
+
 /**
  * @brief     set the chip type
  * @param[in] *handle points to a w25qxx handle structure
@@ -362,6 +531,7 @@ uint8_t w25qxx_get_dual_quad_spi(w25qxx_handle_t *handle, w25qxx_bool_t *enable)
  * @return    status code
  *            - 0 success
  *            - 2 handle is NULL
+ *            - 4 type is not compiled
  * @note      none
  */
 uint8_t w25qxx_set_type(w25qxx_handle_t *handle, w25qxx_type_t type);
@@ -384,6 +554,7 @@ uint8_t w25qxx_get_type(w25qxx_handle_t *handle, w25qxx_type_t *type);
  * @return    status code
  *            - 0 success
  *            - 2 handle is NULL
+ *            - 4 interface is not compiled
  * @note      none
  */
 uint8_t w25qxx_set_interface(w25qxx_handle_t *handle, w25qxx_interface_t interface);
@@ -484,10 +655,26 @@ uint8_t w25qxx_read(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint3
  *            - 3 handle is not initialized
  *            - 4 read failed
  *            - 5 erase sector failed
- * @note      none
+ * @note      unchanged leading bytes are skipped and a sector is erased only when
+ *            a bit has to go from 0 to 1
  */
 uint8_t w25qxx_write(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint32_t len);
 
+/**
+ * @brief     check that a range is erased
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the first address
+ * @param[in] len is the range length
+ * @return    status code
+ *            - 0 success
+ *            - 1 read failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 5 range is not erased
+ * @note      the range is streamed through handle->buf_4k in 4096 bytes reads
+ */
+uint8_t w25qxx_blank_check(w25qxx_handle_t *handle, uint32_t addr, uint32_t len);
+
 /**
  * @brief      read only in the spi interface
  * @param[in]  *handle points to a w25qxx handle structure
@@ -1191,6 +1378,236 @@ uint8_t w25qxx_read_block_lock(w25qxx_handle_t *handle, uint32_t addr, uint8_t *
  */
 uint8_t w25qxx_set_burst_with_wrap(w25qxx_handle_t *handle, w25qxx_burst_wrap_t wrap);
 
+/**
+ * @}
+ */
+
+/**
+ * @defgroup w25qxx_stats_driver w25qxx stats driver function
+ * @brief    w25qxx stats driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+/**
+ * @brief      get the statistics
+ * @param[in]  *handle points to a w25qxx handle structure
+ * @param[out] *stats points to a w25qxx stats structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 4 statistics is disabled
+ * @note       W25QXX_ENABLE_STATS must be 1
+ */
+uint8_t w25qxx_get_stats(w25qxx_handle_t *handle, w25qxx_stats_t *stats);
+
+/**
+ * @brief     clear the statistics
+ * @param[in] *handle points to a w25qxx handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 4 statistics is disabled
+ * @note      W25QXX_ENABLE_STATS must be 1
+ */
+uint8_t w25qxx_clear_stats(w25qxx_handle_t *handle);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup w25qxx_erase_map_driver w25qxx erase map driver function
+ * @brief    w25qxx erase map driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+/**
+ * @brief     link the erase map
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] *map points to a table of num entries
+ * @param[in] first is the first mapped 4k sector
+ * @param[in] num is the mapped sector number
+ * @param[in] keep is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 4 erase map is disabled
+ *            - 5 param is invalid
+ * @note      entry i means sector first + i is erased from that offset to its end, 4096 knows nothing,
+ *            keep uses the table as a snapshot saved while nothing else wrote the chip,
+ *            otherwise every entry starts at 4096, W25QXX_ENABLE_ERASE_MAP must be 1
+ */
+uint8_t w25qxx_erase_map_init(w25qxx_handle_t *handle, uint16_t *map, uint32_t first, uint32_t num, w25qxx_bool_t keep);
+
+/**
+ * @brief     build the erase map from the chip
+ * @param[in] *handle points to a w25qxx handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 read failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 erase map is disabled
+ *            - 5 erase map is not linked
+ * @note      reads every mapped sector once
+ */
+uint8_t w25qxx_erase_map_scan(w25qxx_handle_t *handle);
+
+/**
+ * @brief     declare a range erased or dirty
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the first address
+ * @param[in] len is the range length
+ * @param[in] erased is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 4 erase map is disabled
+ *            - 5 erase map is not linked
+ * @note      an erased range lowers the mark of a sector only when it reaches the erased tail,
+ *            a dirty range makes its sectors unknown
+ */
+uint8_t w25qxx_erase_map_declare(w25qxx_handle_t *handle, uint32_t addr, uint32_t len, w25qxx_bool_t erased);
+
+/**
+ * @brief     discard a range
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the first address
+ * @param[in] len is the range length
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 4 erase map is disabled
+ *            - 5 erase map is not linked
+ * @note      the whole mapped sectors in the range are queued for w25qxx_discard_step,
+ *            a later write into a queued sector cancels its discard
+ */
+uint8_t w25qxx_discard(w25qxx_handle_t *handle, uint32_t addr, uint32_t len);
+
+/**
+ * @brief      run one background erase step
+ * @param[in]  *handle points to a w25qxx handle structure
+ * @param[out] *erased points to an erased length buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 erase failed
+ *             - 2 handle or erased is NULL
+ *             - 3 handle is not initialized
+ *             - 4 erase map is disabled
+ *             - 5 erase map is not linked
+ * @note       erases the first queued run with the largest aligned block erase, *erased is 0 when
+ *             nothing is queued, with threads run it through w25qxx_shared_discard_worker so the
+ *             reads and writes keep the chip first, without threads call w25qxx_discard_idle
+ */
+uint8_t w25qxx_discard_step(w25qxx_handle_t *handle, uint32_t *erased);
+
+/**
+ * @brief     run the background erase from an idle hook
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] max_len is the largest erase, 4096, 32768 or 65536
+ * @return    status code
+ *            - 0 success
+ *            - 1 erase failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 max_len is invalid or erase map is disabled
+ *            - 5 erase map is not linked
+ * @note      for a mcu without threads, call it from the idle hook or the main loop when no other
+ *            driver call runs, every call erases at most one queued run of max_len and blocks until
+ *            it is done, so max_len bounds the time the loop is held, 4096 keeps it to one sector
+ *            erase, nothing is sent when no discard is queued
+ */
+uint8_t w25qxx_discard_idle(w25qxx_handle_t *handle, uint32_t max_len);
+
+/**
+ * @brief      get the pre-erased pool
+ * @param[in]  *handle points to a w25qxx handle structure
+ * @param[out] *pool points to a known erased bytes buffer
+ * @param[out] *backlog points to a discarded bytes buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle, pool or backlog is NULL
+ *             - 4 erase map is disabled
+ *             - 5 erase map is not linked
+ * @note       pool counts the bytes writes can take at program speed, backlog the bytes
+ *             still waiting for the background erase
+ */
+uint8_t w25qxx_discard_get_pool(w25qxx_handle_t *handle, uint32_t *pool, uint32_t *backlog);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup w25qxx_async_driver w25qxx async driver function
+ * @brief    w25qxx async driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+/**
+ * @brief     start an erase
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the erase address
+ * @param[in] len is the erase size, 4096, 32768 or 65536
+ * @return    status code
+ *            - 0 success
+ *            - 1 erase start failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 len is invalid
+ * @note      returns as soon as the command is sent, poll w25qxx_get_busy before the next command
+ *            and call w25qxx_erase_finish when it finished
+ */
+uint8_t w25qxx_erase_start(w25qxx_handle_t *handle, uint32_t addr, uint32_t len);
+
+/**
+ * @brief     finish an erase
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the erase address
+ * @param[in] len is the erase size, 4096, 32768 or 65536
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 len is invalid
+ * @note      call it once w25qxx_get_busy reported the erase started by w25qxx_erase_start finished
+ *            without error, it counts the wear and marks the erase map, a failed erase is never finished
+ */
+uint8_t w25qxx_erase_finish(w25qxx_handle_t *handle, uint32_t addr, uint32_t len);
+
+/**
+ * @brief     start a page program
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the programming address
+ * @param[in] *data points to a data buffer
+ * @param[in] len is the data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 page program start failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 data crosses a page
+ * @note      addr need not be page aligned, but the data must stay inside one page,
+ *            returns as soon as the command is sent, poll w25qxx_get_busy before the next command
+ */
+uint8_t w25qxx_page_program_start(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint16_t len);
+
+/**
+ * @brief      get the busy status
+ * @param[in]  *handle points to a w25qxx handle structure
+ * @param[out] *busy points to a bool value buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 get busy failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       one status register 1 read, it never waits
+ */
+uint8_t w25qxx_get_busy(w25qxx_handle_t *handle, w25qxx_bool_t *busy);
+
 /**
  * @}
  */
@@ -0,0 +1,363 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx.hpp
+ * @brief     driver w25qxx c++ header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_W25QXX_HPP
+#define DRIVER_W25QXX_HPP
+
+#include "driver_w25qxx.h"
+#include "driver_w25qxx_interface.h"
+
+#include <cstddef>
+#include <cstdint>
+#if (__cplusplus >= 202002L) && __has_include(<span>)
+    #include <span>
+    #include <type_traits>
+#endif
+
+/**
+ * @defgroup w25qxx_cpp_driver w25qxx c++ driver function
+ * @brief    w25qxx c++ driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+namespace w25qxx
+{
+
+/**
+ * @brief chip traits definition
+ * @note  everything a chip type fixes, known at compile time
+ */
+template <w25qxx_type_t Type>
+struct chip_traits
+{
+    static_assert((Type >= W25Q80) && (Type <= W25Q256), "unknown chip type");
+    
+    static constexpr w25qxx_type_t type = Type;                                                     /**< chip type */
+    static constexpr uint32_t capacity = 0x100000UL << (Type - W25Q80);                              /**< size in bytes */
+    static constexpr uint32_t page_size = 256;                                                      /**< page size */
+    static constexpr uint32_t sector_size = 4096;                                                   /**< erase sector size */
+    static constexpr uint32_t block_32k_size = 32768;                                               /**< 32k block size */
+    static constexpr uint32_t block_64k_size = 65536;                                               /**< 64k block size */
+    static constexpr uint32_t pages = capacity / page_size;                                         /**< page number */
+    static constexpr uint32_t sectors = capacity / sector_size;                                     /**< sector number */
+    static constexpr uint8_t address_bytes = (Type >= W25Q256) ? 4 : 3;                             /**< address width */
+    static constexpr bool extended_address = (Type >= W25Q256);                                     /**< needs the bank register or 4 byte mode */
+};
+
+/**
+ * @brief interface bus policy definition
+ * @note  links the w25qxx_interface_* functions of driver_w25qxx_interface.h,
+ *        a custom bus policy provides the same static members
+ */
+struct interface_bus
+{
+    static constexpr w25qxx_interface_t interface = W25QXX_INTERFACE_SPI;                           /**< chip interface */
+    static constexpr bool dual_quad_spi = false;                                                    /**< dual quad spi */
+    
+    static uint8_t spi_qspi_init(void) { return w25qxx_interface_spi_qspi_init(); }
+    static uint8_t spi_qspi_deinit(void) { return w25qxx_interface_spi_qspi_deinit(); }
+    static constexpr auto spi_qspi_write_read = w25qxx_interface_spi_qspi_write_read;
+    static constexpr auto delay_ms = w25qxx_interface_delay_ms;
+    static constexpr auto delay_us = w25qxx_interface_delay_us;
+    static constexpr auto debug_print = w25qxx_interface_debug_print;
+};
+
+/**
+ * @brief flash class template definition
+ * @note  every member forwards to the c function with the same name and returns its status code,
+ *        the class adds nothing but the handle; build driver_w25qxx.c with W25QXX_CONFIG_MAX_TYPE
+ *        and W25QXX_CONFIG_INTERFACE matching the template arguments so the address mode, bank
+ *        switch and interface branches the chip never takes are removed from the c code too
+ */
+template <w25qxx_type_t Type, typename Bus = interface_bus>
+class flash
+{
+  public:
+    using traits = chip_traits<Type>;                                                              /**< chip traits */
+    
+    static_assert(static_cast<uint32_t>(Type) <= W25QXX_CONFIG_MAX_TYPE,
+                  "chip type is above W25QXX_CONFIG_MAX_TYPE");
+    static_assert((W25QXX_CONFIG_INTERFACE & ((Bus::interface == W25QXX_INTERFACE_SPI) ?
+                   W25QXX_CONFIG_INTERFACE_SPI : W25QXX_CONFIG_INTERFACE_QSPI)) != 0,
+                  "bus interface is not in W25QXX_CONFIG_INTERFACE");
+    static_assert((!Bus::dual_quad_spi) || (W25QXX_CONFIG_DUAL_QUAD_SPI != 0),
+                  "dual quad spi is not compiled");
+    
+    /**
+     * @brief constructor
+     * @note  links the bus policy, the chip is not touched until init
+     */
+    flash() noexcept
+    {
+        DRIVER_W25QXX_LINK_INIT(&m_handle, w25qxx_handle_t);
+        DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&m_handle, Bus::spi_qspi_init);
+        DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&m_handle, Bus::spi_qspi_deinit);
+        DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&m_handle, Bus::spi_qspi_write_read);
+        DRIVER_W25QXX_LINK_DELAY_MS(&m_handle, Bus::delay_ms);
+        DRIVER_W25QXX_LINK_DELAY_US(&m_handle, Bus::delay_us);
+        DRIVER_W25QXX_LINK_DEBUG_PRINT(&m_handle, Bus::debug_print);
+        m_handle.type = static_cast<uint16_t>(Type);
+        m_handle.spi_qspi = static_cast<uint8_t>(Bus::interface);
+        m_handle.dual_quad_spi_enable = Bus::dual_quad_spi ? 1 : 0;
+    }
+    
+    flash(const flash &) = delete;
+    flash &operator=(const flash &) = delete;
+    
+    /**
+     * @brief destructor
+     * @note  deinits the chip if it is still inited
+     */
+    ~flash()
+    {
+        if (m_handle.inited == 1)
+        {
+            (void)w25qxx_deinit(&m_handle);
+        }
+    }
+    
+    /**
+     * @brief  get the c handle
+     * @return pointer to the handle for the functions without a member
+     */
+    w25qxx_handle_t *handle() noexcept { return &m_handle; }
+    
+    /**
+     * @brief  init the chip
+     * @return status code of w25qxx_init
+     */
+    uint8_t init() noexcept { return w25qxx_init(&m_handle); }
+    
+    /**
+     * @brief  deinit the chip
+     * @return status code of w25qxx_deinit
+     * @note   w25qxx_deinit keeps the inited flag, it is cleared here so the destructor
+     *         does not power down the chip a second time
+     */
+    uint8_t deinit() noexcept
+    {
+        uint8_t res = w25qxx_deinit(&m_handle);
+        
+        if (res == 0)
+        {
+            m_handle.inited = 0;
+        }
+        
+        return res;
+    }
+    
+    /**
+     * @brief      read data
+     * @param[in]  addr is the read address
+     * @param[out] *data points to a data buffer
+     * @param[in]  len is the data length
+     * @return     status code of w25qxx_read
+     */
+    uint8_t read(uint32_t addr, uint8_t *data, uint32_t len) noexcept
+    {
+        return w25qxx_read(&m_handle, addr, data, len);
+    }
+    
+    /**
+     * @brief     write data
+     * @param[in] addr is the write address
+     * @param[in] *data points to a data buffer
+     * @param[in] len is the data length
+     * @return    status code of w25qxx_write
+     * @note      the c function does not modify the data
+     */
+    uint8_t write(uint32_t addr, const uint8_t *data, uint32_t len) noexcept
+    {
+        return w25qxx_write(&m_handle, addr, const_cast<uint8_t *>(data), len);
+    }
+    
+    /**
+     * @brief     program a page
+     * @param[in] addr is the page address
+     * @param[in] *data points to a data buffer
+     * @param[in] len is the data length, at most one page
+     * @return    status code of w25qxx_page_program
+     */
+    uint8_t page_program(uint32_t addr, const uint8_t *data, uint16_t len) noexcept
+    {
+        return w25qxx_page_program(&m_handle, addr, const_cast<uint8_t *>(data), len);
+    }
+    
+#if defined(__cpp_lib_span)
+    /**
+     * @brief      read data
+     * @param[in]  addr is the read address
+     * @param[out] data is the destination span
+     * @return     status code of w25qxx_read
+     * @note       arrays, std::array, std::vector and spans convert to it implicitly
+     */
+    uint8_t read(uint32_t addr, std::span<uint8_t> data) noexcept
+    {
+        return w25qxx_read(&m_handle, addr, data.data(), static_cast<uint32_t>(data.size()));
+    }
+    
+    /**
+     * @brief      read data into a fixed extent span
+     * @param[in]  addr is the read address
+     * @param[out] data is the destination span
+     * @return     status code of w25qxx_read
+     * @note       an extent larger than the chip is a compile error
+     */
+    template <std::size_t N>
+        requires (N != std::dynamic_extent)
+    uint8_t read(uint32_t addr, std::span<uint8_t, N> data) noexcept
+    {
+        static_assert(N <= traits::capacity, "span is larger than the chip");
+        
+        return read(addr, std::span<uint8_t>(data));
+    }
+    
+    /**
+     * @brief     write data
+     * @param[in] addr is the write address
+     * @param[in] data is the source span
+     * @return    status code of w25qxx_write
+     * @note      mutable and const arrays, std::array, std::vector and spans convert to it implicitly
+     */
+    uint8_t write(uint32_t addr, std::span<const uint8_t> data) noexcept
+    {
+        return w25qxx_write(&m_handle, addr, const_cast<uint8_t *>(data.data()), static_cast<uint32_t>(data.size()));
+    }
+    
+    /**
+     * @brief     write data from a fixed extent span
+     * @param[in] addr is the write address
+     * @param[in] data is the source span
+     * @return    status code of w25qxx_write
+     * @note      an extent larger than the chip is a compile error
+     */
+    template <typename T, std::size_t N>
+        requires ((N != std::dynamic_extent) && std::is_same_v<std::remove_const_t<T>, uint8_t>)
+    uint8_t write(uint32_t addr, std::span<T, N> data) noexcept
+    {
+        static_assert(N <= traits::capacity, "span is larger than the chip");
+        
+        return write(addr, std::span<const uint8_t>(data));
+    }
+    
+    /**
+     * @brief     program a page
+     * @param[in] addr is the page address
+     * @param[in] data is the source span, at most one page
+     * @return    status code of w25qxx_page_program
+     */
+    uint8_t page_program(uint32_t addr, std::span<const uint8_t> data) noexcept
+    {
+        return w25qxx_page_program(&m_handle, addr, const_cast<uint8_t *>(data.data()), static_cast<uint16_t>(data.size()));
+    }
+    
+    /**
+     * @brief     program a page from a fixed extent span
+     * @param[in] addr is the page address
+     * @param[in] data is the source span
+     * @return    status code of w25qxx_page_program
+     * @note      an extent larger than a page is a compile error
+     */
+    template <typename T, std::size_t N>
+        requires ((N != std::dynamic_extent) && std::is_same_v<std::remove_const_t<T>, uint8_t>)
+    uint8_t page_program(uint32_t addr, std::span<T, N> data) noexcept
+    {
+        static_assert(N <= traits::page_size, "span is larger than a page");
+        
+        return page_program(addr, std::span<const uint8_t>(data));
+    }
+#endif
+    
+    /**
+     * @brief     erase a 4k sector
+     * @param[in] addr is the sector address
+     * @return    status code of w25qxx_sector_erase_4k
+     */
+    uint8_t erase_sector(uint32_t addr) noexcept { return w25qxx_sector_erase_4k(&m_handle, addr); }
+    
+    /**
+     * @brief     erase a 32k block
+     * @param[in] addr is the block address
+     * @return    status code of w25qxx_block_erase_32k
+     */
+    uint8_t erase_block_32k(uint32_t addr) noexcept { return w25qxx_block_erase_32k(&m_handle, addr); }
+    
+    /**
+     * @brief     erase a 64k block
+     * @param[in] addr is the block address
+     * @return    status code of w25qxx_block_erase_64k
+     */
+    uint8_t erase_block_64k(uint32_t addr) noexcept { return w25qxx_block_erase_64k(&m_handle, addr); }
+    
+    /**
+     * @brief  erase the chip
+     * @return status code of w25qxx_chip_erase
+     */
+    uint8_t erase_chip() noexcept { return w25qxx_chip_erase(&m_handle); }
+    
+    /**
+     * @brief     check that a range is erased
+     * @param[in] addr is the first address
+     * @param[in] len is the range length
+     * @return    status code of w25qxx_blank_check
+     */
+    uint8_t blank_check(uint32_t addr, uint32_t len) noexcept { return w25qxx_blank_check(&m_handle, addr, len); }
+    
+    /**
+     * @brief     set the address mode
+     * @param[in] mode is the address mode
+     * @return    status code of w25qxx_set_address_mode
+     * @note      only the chips above 128Mb have it, for the others the call does not compile
+     */
+    uint8_t set_address_mode(w25qxx_address_mode_t mode) noexcept
+    {
+        static_assert(traits::extended_address, "the chip has only 3 byte addresses");
+        
+        return w25qxx_set_address_mode(&m_handle, mode);
+    }
+    
+  private:
+    w25qxx_handle_t m_handle;                                                                      /**< c handle */
+};
+
+}
+
+/**
+ * @}
+ */
+
+#endif
@@ -0,0 +1,461 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_atomic.c
+ * @brief     driver w25qxx atomic source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_atomic.h"
+#include "driver_w25qxx_crc.h"
+#include "driver_w25qxx_endian.h"
+
+/**
+ * @brief atomic commit record layout definition
+ * @note  magic[4] seq[4] count[4] entries[16 * 12] ... crc32[4] at 240, done[4] at 248
+ */
+#define W25QXX_ATOMIC_MAGIC           0x314D5441U        /**< "ATM1" */
+#define W25QXX_ATOMIC_RECORD_ENTRY    12                 /**< entries offset */
+#define W25QXX_ATOMIC_RECORD_CRC      240                /**< crc offset */
+#define W25QXX_ATOMIC_RECORD_DONE     248                /**< done mark offset */
+
+/**
+ * @brief     get the address of a journal page
+ * @param[in] *atomic points to a w25qxx atomic structure
+ * @param[in] journal is the journal sector
+ * @param[in] page is the page index
+ * @return    flash address
+ * @note      none
+ */
+static uint32_t _w25qxx_atomic_journal_addr(w25qxx_atomic_t *atomic, uint32_t journal, uint32_t page)
+{
+    return (atomic->first + journal) * 4096 + page * 256;                              /* get address */
+}
+
+/**
+ * @brief     copy the staged images to their targets and mark the record done
+ * @param[in] *atomic points to a w25qxx atomic structure
+ * @param[in] journal is the journal sector of the record
+ * @param[in] page is the journal page of the record
+ * @return    status code
+ *            - 0 success
+ *            - 1 apply failed
+ * @note      the staged images are never changed before the record is done, so the copy can be repeated,
+ *            the crc32 of every image is checked on the pages read for the copy
+ */
+static uint8_t _w25qxx_atomic_apply(w25qxx_atomic_t *atomic, uint32_t journal, uint32_t page)
+{
+    uint32_t i;
+    uint32_t p;
+    uint32_t crc;
+    w25qxx_atomic_entry_t *e;
+    
+    for (i = 0; i < atomic->count; i++)                                                /* all entries */
+    {
+        e = &atomic->entry[i];                                                         /* get entry */
+        if (w25qxx_sector_erase_4k(atomic->handle, e->target * 4096) != 0)             /* erase the target */
+        {
+            atomic->handle->debug_print("w25qxx: atomic erase failed.\n");             /* atomic erase failed */
+            
+            return 1;                                                                  /* return error */
+        }
+        crc = 0;                                                                       /* init crc */
+        for (p = 0; p < 16; p++)                                                       /* all pages */
+        {
+            if (w25qxx_read(atomic->handle, e->stage * 4096 + p * 256, atomic->page, 256) != 0)   /* read the image */
+            {
+                atomic->handle->debug_print("w25qxx: atomic read failed.\n");          /* atomic read failed */
+                
+                return 1;                                                              /* return error */
+            }
+            crc = w25qxx_crc32(crc, atomic->page, 256);                                /* update crc */
+            if (w25qxx_page_program(atomic->handle, e->target * 4096 + p * 256, atomic->page, 256) != 0)     /* copy */
+            {
+                atomic->handle->debug_print("w25qxx: atomic program failed.\n");       /* atomic program failed */
+                
+                return 1;                                                              /* return error */
+            }
+        }
+        if (crc != e->crc)                                                             /* check the image */
+        {
+            atomic->handle->debug_print("w25qxx: atomic image is damaged.\n");         /* atomic image is damaged */
+            
+            return 1;                                                                  /* return error */
+        }
+    }
+    memset(atomic->page, 0xFF, W25QXX_ATOMIC_RECORD_DONE);                             /* keep the record */
+    _w25qxx_put32(&atomic->page[W25QXX_ATOMIC_RECORD_DONE], 0);                        /* done mark */
+    if (w25qxx_page_program(atomic->handle, _w25qxx_atomic_journal_addr(atomic, journal, page), 
+                            atomic->page, W25QXX_ATOMIC_RECORD_DONE + 4) != 0)         /* mark the record done */
+    {
+        atomic->handle->debug_print("w25qxx: atomic program failed.\n");               /* atomic program failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     mount the atomic update area and recover the last transaction
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *atomic points to a w25qxx atomic structure
+ * @param[in] first is the first 4k sector of the area
+ * @param[in] num is the sector number of the area
+ * @return    status code
+ *            - 0 success
+ *            - 1 mount failed
+ *            - 2 handle or atomic is NULL
+ *            - 3 handle is not initialized
+ *            - 4 param is invalid
+ * @note      a committed transaction whose copy did not finish is rolled forward,
+ *            images staged without a valid commit record are ignored so the targets roll back
+ */
+uint8_t w25qxx_atomic_mount(w25qxx_handle_t *handle, w25qxx_atomic_t *atomic, uint32_t first, uint32_t num)
+{
+    uint32_t j;
+    uint32_t p;
+    uint32_t i;
+    uint32_t seq;
+    uint32_t count;
+    uint32_t best_journal;
+    uint32_t best_page;
+    uint32_t best_seq;
+    uint32_t used[2];
+    uint32_t torn[2];
+    uint8_t found;
+    uint8_t done;
+    
+    if ((handle == NULL) || (atomic == NULL))                                          /* check handle */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if (handle->inited != 1)                                                           /* check handle initialization */
+    {
+        return 3;                                                                      /* return error */
+    }
+    if (num < 3)                                                                       /* check param */
+    {
+        handle->debug_print("w25qxx: atomic param is invalid.\n");                     /* atomic param is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    memset(atomic, 0, sizeof(w25qxx_atomic_t));                                        /* clear the structure */
+    atomic->handle = handle;                                                           /* set handle */
+    atomic->first = first;                                                             /* set first */
+    atomic->num = num;                                                                 /* set number */
+    
+    /* find the newest valid commit record */
+    found = 0;                                                                         /* init 0 */
+    done = 1;                                                                          /* init 1 */
+    best_journal = 0;                                                                  /* init 0 */
+    best_page = 0;                                                                     /* init 0 */
+    best_seq = 0;                                                                      /* init 0 */
+    for (j = 0; j < 2; j++)                                                            /* both journal sectors */
+    {
+        used[j] = 0;                                                                   /* init 0 */
+        torn[j] = 0;                                                                   /* init 0 */
+        for (p = 0; p < 16; p++)                                                       /* all pages */
+        {
+            if (w25qxx_read(handle, _w25qxx_atomic_journal_addr(atomic, j, p), atomic->page, 256) != 0)      /* read page */
+            {
+                handle->debug_print("w25qxx: atomic read failed.\n");                  /* atomic read failed */
+                
+                return 1;                                                              /* return error */
+            }
+            for (i = 0; (i < 256) && (atomic->page[i] == 0xFF); i++)                   /* check erased */
+            {
+            }
+            if (i == 256)                                                              /* erased */
+            {
+                continue;                                                              /* skip */
+            }
+            used[j] = p + 1;                                                           /* used */
+            seq = _w25qxx_get32(&atomic->page[4]);                                     /* get sequence */
+            count = _w25qxx_get32(&atomic->page[8]);                                   /* get count */
+            if ((_w25qxx_get32(atomic->page) != W25QXX_ATOMIC_MAGIC) || 
+                (count == 0) || (count > W25QXX_ATOMIC_MAX_SECTORS) || 
+                (_w25qxx_get32(&atomic->page[W25QXX_ATOMIC_RECORD_CRC]) != 
+                 w25qxx_crc32(0, atomic->page, W25QXX_ATOMIC_RECORD_CRC)))                      /* check record */
+            {
+                torn[j] = p + 1;                                                       /* torn record */
+                
+                continue;                                                              /* skip */
+            }
+            if ((found != 0) && (seq <= best_seq))                                     /* older */
+            {
+                continue;                                                              /* skip */
+            }
+            found = 1;                                                                 /* found */
+            best_journal = j;                                                          /* save journal */
+            best_page = p;                                                             /* save page */
+            best_seq = seq;                                                            /* save sequence */
+            done = (uint8_t)(_w25qxx_get32(&atomic->page[W25QXX_ATOMIC_RECORD_DONE]) == 0);              /* get done */
+            atomic->count = count;                                                     /* set count */
+            for (i = 0; i < count; i++)                                                /* all entries */
+            {
+                atomic->entry[i].target = _w25qxx_get32(&atomic->page[W25QXX_ATOMIC_RECORD_ENTRY + i * 12 + 0]);
+                atomic->entry[i].stage = _w25qxx_get32(&atomic->page[W25QXX_ATOMIC_RECORD_ENTRY + i * 12 + 4]);
+                atomic->entry[i].crc = _w25qxx_get32(&atomic->page[W25QXX_ATOMIC_RECORD_ENTRY + i * 12 + 8]);
+            }
+        }
+    }
+    if (found == 0)                                                                    /* fresh area */
+    {
+        atomic->roll_back = (uint32_t)((torn[0] != 0) || (torn[1] != 0));             /* torn records only */
+        atomic->count = 0;                                                             /* nothing staged */
+        atomic->seq = 1;                                                               /* first sequence */
+        atomic->journal = 1;                                                           /* the first commit */
+        atomic->journal_page = 16;                                                     /* erases journal 0 */
+        
+        return 0;                                                                      /* success return 0 */
+    }
+    atomic->roll_back = (uint32_t)(torn[best_journal] > best_page + 1);                /* torn after the newest record */
+    atomic->seq = best_seq + 1;                                                        /* next sequence */
+    atomic->journal = (uint8_t)best_journal;                                           /* set journal */
+    atomic->journal_page = (uint8_t)used[best_journal];                                /* next free page */
+    atomic->next_stage = (atomic->entry[atomic->count - 1].stage + 1 - first - 2) % (num - 2);     /* next staging sector */
+    if (done == 0)                                                                     /* copy not finished */
+    {
+        if (_w25qxx_atomic_apply(atomic, best_journal, best_page) != 0)                /* roll forward */
+        {
+            return 1;                                                                  /* return error */
+        }
+        atomic->roll_forward = 1;                                                      /* rolled forward */
+    }
+    atomic->count = 0;                                                                 /* nothing staged */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     begin a transaction
+ * @param[in] *atomic points to a w25qxx atomic structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 begin failed
+ *            - 2 atomic is NULL
+ * @note      finishes a committed transaction whose copy failed and
+ *            drops the sectors staged by an uncommitted one
+ */
+uint8_t w25qxx_atomic_begin(w25qxx_atomic_t *atomic)
+{
+    if ((atomic == NULL) || (atomic->handle == NULL))                                  /* check atomic */
+    {
+        return 2;                                                                      /* return error */
+    }
+    
+    if (atomic->pending != 0)                                                          /* a commit did not finish */
+    {
+        if (_w25qxx_atomic_apply(atomic, atomic->journal, atomic->journal_page - 1) != 0)     /* roll forward */
+        {
+            return 1;                                                                  /* return error */
+        }
+        atomic->pending = 0;                                                           /* finished */
+    }
+    atomic->count = 0;                                                                 /* nothing staged */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     stage the new image of a sector
+ * @param[in] *atomic points to a w25qxx atomic structure
+ * @param[in] addr is the target sector address
+ * @param[in] *data points to a 4096 bytes image
+ * @return    status code
+ *            - 0 success
+ *            - 1 stage failed
+ *            - 2 atomic is NULL
+ *            - 4 param is invalid
+ *            - 5 transaction is full
+ * @note      addr must be 4k aligned and outside the area, the target is not touched until commit,
+ *            staging a target again replaces its image
+ */
+uint8_t w25qxx_atomic_stage(w25qxx_atomic_t *atomic, uint32_t addr, const uint8_t *data)
+{
+    uint32_t i;
+    uint32_t k;
+    uint32_t p;
+    uint32_t s;
+    uint32_t target;
+    w25qxx_atomic_entry_t *e;
+    
+    if ((atomic == NULL) || (atomic->handle == NULL))                                  /* check atomic */
+    {
+        return 2;                                                                      /* return error */
+    }
+    target = addr / 4096;                                                              /* get target sector */
+    if ((data == NULL) || ((addr % 4096) != 0) || 
+        ((target >= atomic->first) && (target < atomic->first + atomic->num)))         /* check param */
+    {
+        atomic->handle->debug_print("w25qxx: atomic param is invalid.\n");             /* atomic param is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    for (i = 0; (i < atomic->count) && (atomic->entry[i].target != target); i++)       /* find the target */
+    {
+    }
+    if ((i == atomic->count) && (atomic->count == W25QXX_ATOMIC_MAX_SECTORS))          /* check room */
+    {
+        atomic->handle->debug_print("w25qxx: atomic transaction is full.\n");          /* atomic transaction is full */
+        
+        return 5;                                                                      /* return error */
+    }
+    
+    /* take the next staging sector not used by this transaction */
+    for (k = 0; k < atomic->num - 2; k++)                                              /* all staging sectors */
+    {
+        s = atomic->first + 2 + (atomic->next_stage + k) % (atomic->num - 2);          /* get sector */
+        for (p = 0; (p < atomic->count) && (atomic->entry[p].stage != s); p++)         /* check use */
+        {
+        }
+        if (p == atomic->count)                                                        /* free */
+        {
+            break;                                                                     /* break */
+        }
+    }
+    if (k == atomic->num - 2)                                                          /* no free sector */
+    {
+        atomic->handle->debug_print("w25qxx: atomic transaction is full.\n");          /* atomic transaction is full */
+        
+        return 5;                                                                      /* return error */
+    }
+    atomic->next_stage = (atomic->next_stage + k + 1) % (atomic->num - 2);             /* round robin */
+    if (w25qxx_sector_erase_4k(atomic->handle, s * 4096) != 0)                         /* erase the staging sector */
+    {
+        atomic->handle->debug_print("w25qxx: atomic erase failed.\n");                 /* atomic erase failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    for (p = 0; p < 16; p++)                                                           /* all pages */
+    {
+        memcpy(atomic->page, &data[p * 256], 256);                                     /* copy page */
+        if (w25qxx_page_program(atomic->handle, s * 4096 + p * 256, atomic->page, 256) != 0)      /* program page */
+        {
+            atomic->handle->debug_print("w25qxx: atomic program failed.\n");           /* atomic program failed */
+            
+            return 1;                                                                  /* return error */
+        }
+    }
+    e = &atomic->entry[i];                                                             /* get entry */
+    e->target = target;                                                                /* set target */
+    e->stage = s;                                                                      /* set staging sector */
+    e->crc = w25qxx_crc32(0, data, 4096);                                              /* set crc */
+    if (i == atomic->count)                                                            /* new target */
+    {
+        atomic->count++;                                                               /* count++ */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     commit the staged sectors
+ * @param[in] *atomic points to a w25qxx atomic structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 commit failed
+ *            - 2 atomic is NULL
+ * @note      one page program of the commit record makes the transaction durable,
+ *            the images are then copied back to the targets and the record is marked done,
+ *            after a failure begin or mount finishes the copy, the copy back erases and programs
+ *            every target once more so the targets keep their addresses and plain reads see them
+ */
+uint8_t w25qxx_atomic_commit(w25qxx_atomic_t *atomic)
+{
+    uint8_t res;
+    uint32_t i;
+    
+    if ((atomic == NULL) || (atomic->handle == NULL))                                  /* check atomic */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if (atomic->pending != 0)                                                          /* the copy is retried by begin */
+    {
+        atomic->handle->debug_print("w25qxx: atomic commit is pending.\n");           /* atomic commit is pending */
+        
+        return 1;                                                                      /* return error */
+    }
+    if (atomic->count == 0)                                                            /* nothing staged */
+    {
+        return 0;                                                                      /* success return 0 */
+    }
+    
+    if (atomic->journal_page == 16)                                                    /* journal sector full */
+    {
+        /* every record in the other sector is done, so it can go */
+        if (w25qxx_sector_erase_4k(atomic->handle, _w25qxx_atomic_journal_addr(atomic, atomic->journal ^ 1, 0)) != 0)  /* erase */
+        {
+            atomic->handle->debug_print("w25qxx: atomic erase failed.\n");             /* atomic erase failed */
+            
+            return 1;                                                                  /* return error */
+        }
+        atomic->journal ^= 1;                                                          /* switch journal */
+        atomic->journal_page = 0;                                                      /* first page */
+    }
+    memset(atomic->page, 0xFF, 256);                                                   /* done mark stays erased */
+    _w25qxx_put32(&atomic->page[0], W25QXX_ATOMIC_MAGIC);                              /* set magic */
+    _w25qxx_put32(&atomic->page[4], atomic->seq);                                      /* set sequence */
+    _w25qxx_put32(&atomic->page[8], atomic->count);                                    /* set count */
+    for (i = 0; i < atomic->count; i++)                                                /* all entries */
+    {
+        _w25qxx_put32(&atomic->page[W25QXX_ATOMIC_RECORD_ENTRY + i * 12 + 0], atomic->entry[i].target);
+        _w25qxx_put32(&atomic->page[W25QXX_ATOMIC_RECORD_ENTRY + i * 12 + 4], atomic->entry[i].stage);
+        _w25qxx_put32(&atomic->page[W25QXX_ATOMIC_RECORD_ENTRY + i * 12 + 8], atomic->entry[i].crc);
+    }
+    _w25qxx_put32(&atomic->page[W25QXX_ATOMIC_RECORD_CRC], 
+                         w25qxx_crc32(0, atomic->page, W25QXX_ATOMIC_RECORD_CRC));      /* set crc */
+    if (w25qxx_page_program(atomic->handle, _w25qxx_atomic_journal_addr(atomic, atomic->journal, atomic->journal_page), 
+                            atomic->page, 256) != 0)                                   /* program the commit record */
+    {
+        atomic->handle->debug_print("w25qxx: atomic program failed.\n");               /* atomic program failed */
+        atomic->journal_page++;                                                        /* never reuse a torn page */
+        
+        return 1;                                                                      /* return error */
+    }
+    atomic->journal_page++;                                                            /* next page */
+    atomic->seq++;                                                                     /* sequence++ */
+    atomic->commit++;                                                                  /* commit++ */
+    atomic->pending = 1;                                                               /* durable, not copied */
+    
+    res = _w25qxx_atomic_apply(atomic, atomic->journal, atomic->journal_page - 1);     /* copy the images */
+    if (res != 0)
+    {
+        return res;                                                                    /* return error */
+    }
+    atomic->pending = 0;                                                               /* copied */
+    atomic->count = 0;                                                                 /* nothing staged */
+    
+    return 0;                                                                          /* success return 0 */
+}
@@ -0,0 +1,157 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_atomic.h
+ * @brief     driver w25qxx atomic header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DRIVER_W25QXX_ATOMIC_H_
+#define _DRIVER_W25QXX_ATOMIC_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup w25qxx_atomic_driver w25qxx atomic driver function
+ * @brief    w25qxx atomic driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+/**
+ * @brief w25qxx atomic max sectors of a transaction definition
+ */
+#define W25QXX_ATOMIC_MAX_SECTORS        16        /**< 16 sectors */
+
+/**
+ * @brief w25qxx atomic entry structure definition
+ */
+typedef struct w25qxx_atomic_entry_s
+{
+    uint32_t target;        /**< target 4k sector */
+    uint32_t stage;         /**< staging 4k sector */
+    uint32_t crc;           /**< crc32 of the new image */
+} w25qxx_atomic_entry_t;
+
+/**
+ * @brief w25qxx atomic structure definition
+ * @note  the first two sectors of the area hold the commit records, the others stage the images
+ */
+typedef struct w25qxx_atomic_s
+{
+    w25qxx_handle_t *handle;                                     /**< w25qxx handle */
+    uint32_t first;                                              /**< first 4k sector of the area */
+    uint32_t num;                                                /**< sector number of the area */
+    uint32_t seq;                                                /**< next commit sequence */
+    uint8_t journal;                                             /**< current journal sector, 0 or 1 */
+    uint8_t journal_page;                                        /**< next free journal page */
+    uint32_t next_stage;                                         /**< next staging sector */
+    uint32_t count;                                              /**< staged sectors */
+    uint8_t pending;                                             /**< committed but not copied */
+    w25qxx_atomic_entry_t entry[W25QXX_ATOMIC_MAX_SECTORS];      /**< staged sectors */
+    uint32_t commit;                                             /**< commit counter */
+    uint32_t roll_forward;                                       /**< transactions finished at mount */
+    uint32_t roll_back;                                          /**< torn commit records dropped at mount */
+    uint8_t page[256];                                           /**< page buffer */
+} w25qxx_atomic_t;
+
+/**
+ * @brief     mount the atomic update area and recover the last transaction
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *atomic points to a w25qxx atomic structure
+ * @param[in] first is the first 4k sector of the area
+ * @param[in] num is the sector number of the area
+ * @return    status code
+ *            - 0 success
+ *            - 1 mount failed
+ *            - 2 handle or atomic is NULL
+ *            - 3 handle is not initialized
+ *            - 4 param is invalid
+ * @note      a committed transaction whose copy did not finish is rolled forward,
+ *            images staged without a valid commit record are ignored so the targets roll back
+ */
+uint8_t w25qxx_atomic_mount(w25qxx_handle_t *handle, w25qxx_atomic_t *atomic, uint32_t first, uint32_t num);
+
+/**
+ * @brief     begin a transaction
+ * @param[in] *atomic points to a w25qxx atomic structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 begin failed
+ *            - 2 atomic is NULL
+ * @note      finishes a committed transaction whose copy failed and
+ *            drops the sectors staged by an uncommitted one
+ */
+uint8_t w25qxx_atomic_begin(w25qxx_atomic_t *atomic);
+
+/**
+ * @brief     stage the new image of a sector
+ * @param[in] *atomic points to a w25qxx atomic structure
+ * @param[in] addr is the target sector address
+ * @param[in] *data points to a 4096 bytes image
+ * @return    status code
+ *            - 0 success
+ *            - 1 stage failed
+ *            - 2 atomic is NULL
+ *            - 4 param is invalid
+ *            - 5 transaction is full
+ * @note      addr must be 4k aligned and outside the area, the target is not touched until commit,
+ *            staging a target again replaces its image
+ */
+uint8_t w25qxx_atomic_stage(w25qxx_atomic_t *atomic, uint32_t addr, const uint8_t *data);
+
+/**
+ * @brief     commit the staged sectors
+ * @param[in] *atomic points to a w25qxx atomic structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 commit failed
+ *            - 2 atomic is NULL
+ * @note      one page program of the commit record makes the transaction durable,
+ *            the images are then copied back to the targets and the record is marked done,
+ *            after a failure begin or mount finishes the copy, the copy back erases and programs
+ *            every target once more so the targets keep their addresses and plain reads see them
+ */
+uint8_t w25qxx_atomic_commit(w25qxx_atomic_t *atomic);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
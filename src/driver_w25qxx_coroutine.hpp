@@ -0,0 +1,552 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_coroutine.hpp
+ * @brief     driver w25qxx c++ coroutine header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_W25QXX_COROUTINE_HPP
+#define DRIVER_W25QXX_COROUTINE_HPP
+
+#include "driver_w25qxx.hpp"
+
+#include <array>
+#include <chrono>
+#include <coroutine>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @defgroup w25qxx_coroutine_driver w25qxx coroutine driver function
+ * @brief    w25qxx coroutine driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+namespace w25qxx
+{
+
+/**
+ * @brief task class definition
+ * @note  a lazy coroutine returning a driver status code, it starts when it is awaited
+ *        or when start is called and resumes its awaiter when it finishes
+ */
+class task
+{
+  public:
+    /**
+     * @brief promise type definition
+     */
+    struct promise_type
+    {
+        uint8_t status = 0;                                                                        /**< status code */
+        std::coroutine_handle<> continuation;                                                      /**< awaiting coroutine */
+        
+        /**
+         * @brief final awaiter definition
+         * @note  transfers to the awaiting coroutine without growing the stack
+         */
+        struct final_awaiter
+        {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+            {
+                std::coroutine_handle<> c = h.promise().continuation;
+                
+                return c ? c : std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+        
+        task get_return_object() noexcept { return task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        final_awaiter final_suspend() const noexcept { return {}; }
+        void return_value(uint8_t res) noexcept { status = res; }
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+    
+    task(task &&other) noexcept : m_coro(std::exchange(other.m_coro, nullptr)) {}
+    task(const task &) = delete;
+    task &operator=(const task &) = delete;
+    ~task()
+    {
+        if (m_coro)
+        {
+            m_coro.destroy();
+        }
+    }
+    
+    /**
+     * @brief awaiter definition
+     */
+    struct awaiter
+    {
+        std::coroutine_handle<promise_type> coro;                                                  /**< awaited task */
+        
+        bool await_ready() const noexcept { return coro.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> c) noexcept
+        {
+            coro.promise().continuation = c;
+            
+            return coro;
+        }
+        uint8_t await_resume() const noexcept { return coro.promise().status; }
+    };
+    
+    awaiter operator co_await() const noexcept { return awaiter{m_coro}; }
+    
+    /**
+     * @brief start a top level task
+     * @note  it runs until its first suspension, the poller resumes it later
+     */
+    void start() noexcept { m_coro.resume(); }
+    
+    /**
+     * @brief  check the task
+     * @return true if the task finished
+     */
+    bool done() const noexcept { return m_coro.done(); }
+    
+    /**
+     * @brief  get the result
+     * @return status code of a finished task
+     */
+    uint8_t status() const noexcept { return m_coro.promise().status; }
+    
+  private:
+    explicit task(std::coroutine_handle<promise_type> coro) noexcept : m_coro(coro) {}
+    
+    std::coroutine_handle<promise_type> m_coro;                                                    /**< coroutine */
+};
+
+/**
+ * @brief poller class definition
+ * @note  resumes the coroutines waiting for a busy chip, one thread drives every chip
+ *        linked to the same poller and their busy times overlap
+ */
+class poller
+{
+  public:
+    using clock = std::chrono::steady_clock;                                                      /**< poll clock */
+    
+    /**
+     * @brief busy awaiter definition
+     */
+    struct busy_awaiter
+    {
+        poller *owner;                                                                             /**< poller */
+        w25qxx_handle_t *handle;                                                                   /**< busy chip */
+        std::chrono::microseconds interval;                                                        /**< poll interval */
+        uint8_t status;                                                                            /**< poll status code */
+        
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> c)
+        {
+            owner->m_waiting.push_back(entry{handle, c, &status, interval, clock::now() + interval});
+        }
+        uint8_t await_resume() const noexcept { return status; }
+    };
+    
+    /**
+     * @brief     wait until a chip is idle
+     * @param[in] *handle points to a w25qxx handle structure
+     * @param[in] interval is the poll interval
+     * @return    awaiter whose result is the status code of the last w25qxx_get_busy
+     */
+    busy_awaiter idle(w25qxx_handle_t *handle, std::chrono::microseconds interval) noexcept
+    {
+        return busy_awaiter{this, handle, interval, 0};
+    }
+    
+    /**
+     * @brief  check the poller
+     * @return true if no coroutine waits
+     */
+    bool empty() const noexcept { return m_waiting.empty(); }
+    
+    /**
+     * @brief  get the next poll time
+     * @return earliest deadline, for the timeout of an event loop
+     */
+    clock::time_point next_deadline() const noexcept
+    {
+        clock::time_point t = clock::time_point::max();
+        
+        for (const entry &e : m_waiting)
+        {
+            t = (e.deadline < t) ? e.deadline : t;
+        }
+        
+        return t;
+    }
+    
+    /**
+     * @brief poll the due chips once
+     * @note  call it from the event loop when next_deadline has passed,
+     *        the coroutines of the idle chips are resumed from here
+     */
+    void poll()
+    {
+        std::vector<std::coroutine_handle<>> ready;
+        clock::time_point now = clock::now();
+        std::size_t i = 0;
+        
+        while (i < m_waiting.size())
+        {
+            entry &e = m_waiting[i];
+            w25qxx_bool_t busy = W25QXX_BOOL_FALSE;
+            
+            if (e.deadline <= now)
+            {
+                *e.status = w25qxx_get_busy(e.handle, &busy);
+                if ((*e.status != 0) || (busy == W25QXX_BOOL_FALSE))
+                {
+                    ready.push_back(e.coro);
+                    e = m_waiting.back();
+                    m_waiting.pop_back();
+                    
+                    continue;
+                }
+                e.deadline = now + e.interval;
+            }
+            i++;
+        }
+        for (std::coroutine_handle<> c : ready)
+        {
+            c.resume();
+        }
+    }
+    
+    /**
+     * @brief run until no coroutine waits
+     * @note  sleeps until the next deadline between the polls
+     */
+    void run()
+    {
+        while (!m_waiting.empty())
+        {
+            std::this_thread::sleep_until(next_deadline());
+            poll();
+        }
+    }
+    
+  private:
+    /**
+     * @brief waiting entry definition
+     */
+    struct entry
+    {
+        w25qxx_handle_t *handle;                                                                   /**< busy chip */
+        std::coroutine_handle<> coro;                                                              /**< waiting coroutine */
+        uint8_t *status;                                                                           /**< poll status code */
+        std::chrono::microseconds interval;                                                        /**< poll interval */
+        clock::time_point deadline;                                                                /**< next poll */
+    };
+    
+    std::vector<entry> m_waiting;                                                                  /**< waiting coroutines */
+};
+
+/**
+ * @brief async flash class template definition
+ * @note  the erase and program commands return at once and the coroutine is suspended on the
+ *        poller during the busy time, reads are plain bus transfers and finish without suspending;
+ *        a chip runs one command at a time, so the operations of one async flash queue up in call
+ *        order and each one owns the chip until it finishes, use one async flash per chip
+ */
+template <w25qxx_type_t Type, typename Bus = interface_bus>
+class async_flash
+{
+  public:
+    using traits = chip_traits<Type>;                                                              /**< chip traits */
+    
+    static constexpr std::chrono::microseconds erase_poll{1000};                                   /**< erase poll interval */
+    static constexpr std::chrono::microseconds program_poll{100};                                  /**< program poll interval */
+    
+    /**
+     * @brief     constructor
+     * @param[in] &chip is an inited flash
+     * @param[in] &loop is the poller resuming the busy waits
+     */
+    async_flash(flash<Type, Bus> &chip, poller &loop) noexcept : m_chip(chip), m_loop(loop) {}
+    
+    async_flash(const async_flash &) = delete;
+    async_flash &operator=(const async_flash &) = delete;
+    
+    /**
+     * @brief  check the chip
+     * @return true if an operation owns the chip
+     */
+    bool busy() const noexcept { return m_locked; }
+    
+    /**
+     * @brief      read data
+     * @param[in]  addr is the read address
+     * @param[out] data is the destination span
+     * @return     task with the status code of w25qxx_read
+     */
+    task read(uint32_t addr, std::span<uint8_t> data)
+    {
+        guard g = co_await lock();
+        
+        co_return m_chip.read(addr, data);
+    }
+    
+    /**
+     * @brief     erase a sector or a block
+     * @param[in] addr is the erase address
+     * @param[in] len is the erase size, 4096, 32768 or 65536
+     * @return    task with the status code of w25qxx_erase_start, w25qxx_get_busy or w25qxx_erase_finish
+     */
+    task erase(uint32_t addr, uint32_t len = traits::sector_size)
+    {
+        guard g = co_await lock();
+        
+        co_return co_await erase_owned(addr, len);
+    }
+    
+    /**
+     * @brief     program data into erased space
+     * @param[in] addr is the programming address
+     * @param[in] data is the source span
+     * @return    task with the status code of w25qxx_page_program_start or w25qxx_get_busy
+     * @note      splits the data at the page borders
+     */
+    task program(uint32_t addr, std::span<const uint8_t> data)
+    {
+        guard g = co_await lock();
+        
+        co_return co_await program_owned(addr, data);
+    }
+    
+    /**
+     * @brief     write data
+     * @param[in] addr is the write address
+     * @param[in] data is the source span
+     * @return    task with the first failing status code
+     * @note      like w25qxx_write, a sector is erased only when a bit has to go from 0 to 1,
+     *            the data must stay valid until the task finishes
+     */
+    task write(uint32_t addr, std::span<const uint8_t> data)
+    {
+        guard g = co_await lock();
+        std::array<uint8_t, traits::sector_size> sector;
+        uint8_t res;
+        
+        while (!data.empty())
+        {
+            uint32_t base = addr - (addr % traits::sector_size);
+            uint32_t off = addr - base;
+            std::size_t n = traits::sector_size - off;
+            bool erase_needed = false;
+            
+            n = (data.size() < n) ? data.size() : n;
+            res = m_chip.read(base, sector.data(), traits::sector_size);
+            if (res != 0)
+            {
+                co_return res;
+            }
+            for (std::size_t i = 0; i < n; i++)
+            {
+                if ((sector[off + i] & data[i]) != data[i])
+                {
+                    erase_needed = true;
+                    
+                    break;
+                }
+            }
+            if (erase_needed)
+            {
+                std::memcpy(&sector[off], data.data(), n);
+                res = co_await erase_owned(base, traits::sector_size);
+                if (res == 0)
+                {
+                    res = co_await program_owned(base, std::span<const uint8_t>(sector));
+                }
+            }
+            else if (std::memcmp(&sector[off], data.data(), n) != 0)
+            {
+                res = co_await program_owned(addr, data.first(n));
+            }
+            if (res != 0)
+            {
+                co_return res;
+            }
+            addr += static_cast<uint32_t>(n);
+            data = data.subspan(n);
+        }
+        
+        co_return 0;
+    }
+    
+  private:
+    /**
+     * @brief guard class definition
+     * @note  owns the chip and hands it to the next queued operation when destroyed
+     */
+    class guard
+    {
+      public:
+        explicit guard(async_flash *owner) noexcept : m_owner(owner) {}
+        guard(guard &&other) noexcept : m_owner(std::exchange(other.m_owner, nullptr)) {}
+        guard(const guard &) = delete;
+        guard &operator=(const guard &) = delete;
+        ~guard()
+        {
+            if (m_owner != nullptr)
+            {
+                m_owner->unlock();
+            }
+        }
+        
+      private:
+        async_flash *m_owner;                                                                      /**< locked async flash */
+    };
+    
+    /**
+     * @brief lock awaiter definition
+     * @note  takes a free chip at once, otherwise queues the coroutine behind the owner
+     */
+    struct lock_awaiter
+    {
+        async_flash *owner;                                                                        /**< async flash */
+        
+        bool await_ready() noexcept
+        {
+            if (!owner->m_locked)
+            {
+                owner->m_locked = true;
+                
+                return true;
+            }
+            
+            return false;
+        }
+        void await_suspend(std::coroutine_handle<> c) { owner->m_queue.push_back(c); }
+        guard await_resume() noexcept { return guard(owner); }
+    };
+    
+    /**
+     * @brief  lock the chip
+     * @return awaiter whose result is the guard of the chip
+     */
+    lock_awaiter lock() noexcept { return lock_awaiter{this}; }
+    
+    /**
+     * @brief unlock the chip
+     * @note  the chip goes straight to the first queued operation, which runs until it suspends
+     */
+    void unlock() noexcept
+    {
+        if (m_queue.empty())
+        {
+            m_locked = false;
+            
+            return;
+        }
+        std::coroutine_handle<> c = m_queue.front();
+        
+        m_queue.pop_front();
+        c.resume();
+    }
+    
+    /**
+     * @brief     erase with the chip owned
+     * @param[in] addr is the erase address
+     * @param[in] len is the erase size
+     * @return    task with the status code of w25qxx_erase_start, w25qxx_get_busy or w25qxx_erase_finish
+     */
+    task erase_owned(uint32_t addr, uint32_t len)
+    {
+        uint8_t res;
+        
+        res = w25qxx_erase_start(m_chip.handle(), addr, len);
+        if (res == 0)
+        {
+            res = co_await m_loop.idle(m_chip.handle(), erase_poll);
+        }
+        if (res != 0)
+        {
+            co_return res;
+        }
+        
+        co_return w25qxx_erase_finish(m_chip.handle(), addr, len);
+    }
+    
+    /**
+     * @brief     program with the chip owned
+     * @param[in] addr is the programming address
+     * @param[in] data is the source span
+     * @return    task with the status code of w25qxx_page_program_start or w25qxx_get_busy
+     */
+    task program_owned(uint32_t addr, std::span<const uint8_t> data)
+    {
+        uint8_t res;
+        
+        while (!data.empty())
+        {
+            uint16_t n = static_cast<uint16_t>(traits::page_size - (addr % traits::page_size));
+            
+            n = (data.size() < n) ? static_cast<uint16_t>(data.size()) : n;
+            res = w25qxx_page_program_start(m_chip.handle(), addr, const_cast<uint8_t *>(data.data()), n);
+            if (res == 0)
+            {
+                res = co_await m_loop.idle(m_chip.handle(), program_poll);
+            }
+            if (res != 0)
+            {
+                co_return res;
+            }
+            addr += n;
+            data = data.subspan(n);
+        }
+        
+        co_return 0;
+    }
+    
+    flash<Type, Bus> &m_chip;                                                                      /**< chip */
+    poller &m_loop;                                                                                /**< poller */
+    bool m_locked = false;                                                                         /**< an operation owns the chip */
+    std::deque<std::coroutine_handle<>> m_queue;                                                   /**< operations waiting for the chip */
+};
+
+}
+
+/**
+ * @}
+ */
+
+#endif
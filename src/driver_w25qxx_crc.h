@@ -0,0 +1,125 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_crc.h
+ * @brief     driver w25qxx crc header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DRIVER_W25QXX_CRC_H_
+#define _DRIVER_W25QXX_CRC_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup w25qxx_crc_driver w25qxx crc driver function
+ * @brief    w25qxx crc driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+/**
+ * @brief w25qxx crc chunk definition
+ * @note  each w25qxx_read of a range covers one chunk of handle->buf_4k
+ */
+#ifndef W25QXX_CRC_CHUNK
+    #define W25QXX_CRC_CHUNK    4096        /**< 4096 bytes, at most 4096 */
+#endif
+
+/**
+ * @brief w25qxx crc32 hook definition
+ * @note  the hook gets the zlib style crc and returns the updated one, such as a wrapper
+ *        of the stm32 crc peripheral configured for the reflected 0x04C11DB7 polynomial
+ */
+typedef uint32_t (*w25qxx_crc32_hook_t)(uint32_t crc, const uint8_t *buf, uint32_t len);
+
+/**
+ * @brief     set the crc32 hook
+ * @param[in] hook is the hardware crc32 function, NULL selects the software one
+ * @note      the software one uses the armv8 crc32 instructions when the compiler
+ *            targets them (__ARM_FEATURE_CRC32) and slicing-by-8 tables otherwise
+ */
+void w25qxx_crc32_set_hook(w25qxx_crc32_hook_t hook);
+
+/**
+ * @brief     update a crc32
+ * @param[in] crc is the current crc, 0 for the first call
+ * @param[in] *buf points to a data buffer
+ * @param[in] len is the data length
+ * @return    updated crc
+ * @note      ieee 802.3 crc32, the same as zlib crc32
+ */
+uint32_t w25qxx_crc32(uint32_t crc, const uint8_t *buf, uint32_t len);
+
+/**
+ * @brief      get the crc32 of a flash range
+ * @param[in]  *handle points to a w25qxx handle structure
+ * @param[in]  addr is the first address
+ * @param[in]  len is the range length
+ * @param[out] *crc points to a crc buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 handle or crc is NULL
+ *             - 3 handle is not initialized
+ * @note       the range is streamed through handle->buf_4k in W25QXX_CRC_CHUNK chunks
+ */
+uint8_t w25qxx_crc32_range(w25qxx_handle_t *handle, uint32_t addr, uint32_t len, uint32_t *crc);
+
+/**
+ * @brief     verify a flash range against a crc32
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the first address
+ * @param[in] len is the range length
+ * @param[in] crc is the expected crc
+ * @return    status code
+ *            - 0 success
+ *            - 1 read failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 5 crc is mismatched
+ * @note      none
+ */
+uint8_t w25qxx_verify_range(w25qxx_handle_t *handle, uint32_t addr, uint32_t len, uint32_t crc);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,85 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_endian.h
+ * @brief     driver w25qxx endian header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DRIVER_W25QXX_ENDIAN_H_
+#define _DRIVER_W25QXX_ENDIAN_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @addtogroup w25qxx_driver
+ * @{
+ */
+
+/**
+ * @brief     put a 32 bits little endian value
+ * @param[in] *buf points to a data buffer
+ * @param[in] v is the value
+ * @note      internal helper of the on-flash modules
+ */
+static inline void _w25qxx_put32(uint8_t *buf, uint32_t v)
+{
+    buf[0] = (uint8_t)(v >> 0);                                                        /* set byte 0 */
+    buf[1] = (uint8_t)(v >> 8);                                                        /* set byte 1 */
+    buf[2] = (uint8_t)(v >> 16);                                                       /* set byte 2 */
+    buf[3] = (uint8_t)(v >> 24);                                                       /* set byte 3 */
+}
+
+/**
+ * @brief     get a 32 bits little endian value
+ * @param[in] *buf points to a data buffer
+ * @return    value
+ * @note      internal helper of the on-flash modules
+ */
+static inline uint32_t _w25qxx_get32(const uint8_t *buf)
+{
+    return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | 
+           ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);                         /* get value */
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
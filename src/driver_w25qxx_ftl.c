@@ -0,0 +1,774 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_ftl.c
+ * @brief     driver w25qxx ftl source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_ftl.h"
+#include "driver_w25qxx_endian.h"
+
+/**
+ * @brief sector header definition
+ * @note  page 0 of every sector holds magic, erase count, ~erase count, open sequence
+ *        and one tag per data page, tag is lpn | (~lpn << 16)
+ */
+#define W25QXX_FTL_MAGIC             0x314C5446U        /**< "FTL1" */
+#define W25QXX_FTL_HEADER_ERASE      4                  /**< erase count offset */
+#define W25QXX_FTL_HEADER_SEQ        12                 /**< open sequence offset */
+#define W25QXX_FTL_HEADER_TAG        16                 /**< first tag offset */
+#define W25QXX_FTL_HEADER_SIZE       (W25QXX_FTL_HEADER_TAG + W25QXX_FTL_SECTOR_PAGES * 4)        /**< header size */
+#define W25QXX_FTL_NONE              0xFFFFU            /**< unmapped page */
+
+/**
+ * @brief static wear leveling period definition
+ */
+#ifndef W25QXX_FTL_STATIC_PERIOD
+    #define W25QXX_FTL_STATIC_PERIOD 32                 /**< min erases between two static moves */
+#endif
+
+/**
+ * @brief     get the physical address of a page
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @param[in] s is the physical sector index
+ * @param[in] page is the page index in the sector
+ * @return    physical address
+ * @note      none
+ */
+static uint32_t _w25qxx_ftl_addr(w25qxx_ftl_t *ftl, uint32_t s, uint32_t page)
+{
+    return (ftl->first + s) * 4096 + page * 256;                                       /* get address */
+}
+
+/**
+ * @brief     program one word of a sector header
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @param[in] s is the physical sector index
+ * @param[in] offset is the word offset
+ * @param[in] value is the word value
+ * @return    status code
+ *            - 0 success
+ *            - 1 program failed
+ * @note      the bytes before the word are programmed as 0xFF and keep their content
+ */
+static uint8_t _w25qxx_ftl_header_program(w25qxx_ftl_t *ftl, uint32_t s, uint32_t offset, uint32_t value)
+{
+    uint8_t header[W25QXX_FTL_HEADER_SIZE];
+    
+    memset(header, 0xFF, offset);                                                      /* keep the other bytes */
+    _w25qxx_put32(&header[offset], value);                                             /* set value */
+    
+    return w25qxx_page_program(ftl->handle, _w25qxx_ftl_addr(ftl, s, 0), 
+                               header, (uint16_t)(offset + 4));                        /* program header */
+}
+
+/**
+ * @brief     erase a sector and write its header
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @param[in] s is the physical sector index
+ * @return    status code
+ *            - 0 success
+ *            - 1 erase failed
+ * @note      none
+ */
+static uint8_t _w25qxx_ftl_erase(w25qxx_ftl_t *ftl, uint32_t s)
+{
+    uint8_t header[12];
+    
+    if (ftl->open == s)                                                                /* check open */
+    {
+        ftl->open = ftl->num;                                                          /* close */
+    }
+    if (w25qxx_sector_erase_4k(ftl->handle, _w25qxx_ftl_addr(ftl, s, 0)) != 0)         /* erase sector */
+    {
+        ftl->handle->debug_print("w25qxx: ftl erase failed.\n");                       /* ftl erase failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    ftl->sector[s].erase_count++;                                                      /* erase count++ */
+    ftl->sector[s].seq = 0xFFFFFFFFU;                                                  /* no sequence */
+    ftl->sector[s].valid = 0;                                                          /* no valid page */
+    ftl->sector[s].state = W25QXX_FTL_SECTOR_DIRTY;                                    /* dirty until the header is written */
+    ftl->erase++;                                                                      /* erase++ */
+    _w25qxx_put32(&header[0], W25QXX_FTL_MAGIC);                                       /* set magic */
+    _w25qxx_put32(&header[4], ftl->sector[s].erase_count);                             /* set erase count */
+    _w25qxx_put32(&header[8], ~ftl->sector[s].erase_count);                            /* set check */
+    if (w25qxx_page_program(ftl->handle, _w25qxx_ftl_addr(ftl, s, 0), header, 12) != 0)          /* program header */
+    {
+        ftl->handle->debug_print("w25qxx: ftl program failed.\n");                     /* ftl program failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    ftl->sector[s].state = W25QXX_FTL_SECTOR_FREE;                                     /* free */
+    ftl->free_num++;                                                                   /* free++ */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     find a sector without valid data that is not free
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @return    sector index, num if none
+ * @note      none
+ */
+static uint32_t _w25qxx_ftl_find_erasable(w25qxx_ftl_t *ftl)
+{
+    uint32_t s;
+    
+    for (s = 0; s < ftl->num; s++)                                                     /* all sectors */
+    {
+        if ((ftl->sector[s].state == W25QXX_FTL_SECTOR_DIRTY) ||
+            ((ftl->sector[s].state == W25QXX_FTL_SECTOR_FULL) && (ftl->sector[s].valid == 0)))      /* check sector */
+        {
+            return s;                                                                  /* found */
+        }
+    }
+    
+    return ftl->num;                                                                   /* none */
+}
+
+/**
+ * @brief     open a new sector
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 alloc failed
+ *            - 5 no space
+ * @note      dynamic wear leveling takes the least worn free sector,
+ *            after a static move the most worn one takes the cold data
+ */
+static uint8_t _w25qxx_ftl_alloc(w25qxx_ftl_t *ftl)
+{
+    uint32_t s;
+    uint32_t best;
+    
+    best = ftl->num;                                                                   /* none */
+    for (s = 0; s < ftl->num; s++)                                                     /* all sectors */
+    {
+        if (ftl->sector[s].state != W25QXX_FTL_SECTOR_FREE)                            /* check free */
+        {
+            continue;                                                                  /* next */
+        }
+        if ((best == ftl->num) ||
+            ((ftl->alloc_hot == 0) && (ftl->sector[s].erase_count < ftl->sector[best].erase_count)) ||
+            ((ftl->alloc_hot != 0) && (ftl->sector[s].erase_count > ftl->sector[best].erase_count)))     /* check wear */
+        {
+            best = s;                                                                  /* set best */
+        }
+    }
+    if (best == ftl->num)                                                              /* no free sector */
+    {
+        best = _w25qxx_ftl_find_erasable(ftl);                                         /* find erasable */
+        if (best == ftl->num)                                                          /* check erasable */
+        {
+            return 5;                                                                  /* no space */
+        }
+        if (_w25qxx_ftl_erase(ftl, best) != 0)                                         /* erase */
+        {
+            return 1;                                                                  /* return error */
+        }
+    }
+    if (_w25qxx_ftl_header_program(ftl, best, W25QXX_FTL_HEADER_SEQ, ftl->seq + 1) != 0)         /* set sequence */
+    {
+        ftl->handle->debug_print("w25qxx: ftl program failed.\n");                     /* ftl program failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    ftl->seq++;                                                                        /* sequence++ */
+    ftl->sector[best].seq = ftl->seq;                                                  /* set sequence */
+    ftl->sector[best].state = W25QXX_FTL_SECTOR_OPEN;                                  /* open */
+    ftl->free_num--;                                                                   /* free-- */
+    ftl->open = best;                                                                  /* set open */
+    ftl->open_page = 1;                                                                /* first data page */
+    ftl->alloc_hot = 0;                                                                /* back to dynamic */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     move to the next page of the open sector
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @param[in] s is the open sector index
+ * @note      the sector is closed after its last data page
+ */
+static void _w25qxx_ftl_next_page(w25qxx_ftl_t *ftl, uint32_t s)
+{
+    ftl->open_page++;                                                                  /* next page */
+    if (ftl->open_page > W25QXX_FTL_SECTOR_PAGES)                                      /* check full */
+    {
+        ftl->sector[s].state = W25QXX_FTL_SECTOR_FULL;                                 /* full */
+        ftl->open = ftl->num;                                                          /* close */
+    }
+}
+
+/**
+ * @brief     retire a page whose program failed
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @param[in] s is the open sector index
+ * @note      the page may hold partial data, its tag is cleared to a dead value
+ *            and the page is never programmed again
+ */
+static void _w25qxx_ftl_retire_page(w25qxx_ftl_t *ftl, uint32_t s)
+{
+    (void)_w25qxx_ftl_header_program(ftl, s, W25QXX_FTL_HEADER_TAG + 
+                                     (ftl->open_page - 1) * 4, 0x00000000U);          /* dead tag */
+    _w25qxx_ftl_next_page(ftl, s);                                                     /* skip the page */
+}
+
+/**
+ * @brief     write a logical page out of place
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @param[in] lpn is the logical page number
+ * @param[in] *buf points to a page buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 program failed
+ *            - 5 no space
+ * @note      the data page is programmed before its tag, so a torn page is never mapped,
+ *            a failed page is retired so the next write takes a fresh one
+ */
+static uint8_t _w25qxx_ftl_program(w25qxx_ftl_t *ftl, uint32_t lpn, uint8_t *buf)
+{
+    uint8_t res;
+    uint32_t s;
+    uint32_t old;
+    
+    if (ftl->open == ftl->num)                                                         /* no open sector */
+    {
+        res = _w25qxx_ftl_alloc(ftl);                                                  /* alloc */
+        if (res != 0)
+        {
+            return res;                                                                /* return error */
+        }
+    }
+    s = ftl->open;                                                                     /* get open */
+    if (w25qxx_page_program(ftl->handle, _w25qxx_ftl_addr(ftl, s, ftl->open_page), buf, 256) != 0)   /* program data */
+    {
+        ftl->handle->debug_print("w25qxx: ftl program failed.\n");                     /* ftl program failed */
+        _w25qxx_ftl_retire_page(ftl, s);                                               /* retire the page */
+        
+        return 1;                                                                      /* return error */
+    }
+    if (_w25qxx_ftl_header_program(ftl, s, W25QXX_FTL_HEADER_TAG + (ftl->open_page - 1) * 4, 
+                                   (lpn & 0xFFFFU) | ((~lpn & 0xFFFFU) << 16)) != 0)   /* program tag */
+    {
+        ftl->handle->debug_print("w25qxx: ftl program failed.\n");                     /* ftl program failed */
+        _w25qxx_ftl_retire_page(ftl, s);                                               /* retire the page */
+        
+        return 1;                                                                      /* return error */
+    }
+    old = ftl->map[lpn];                                                               /* get old page */
+    if (old != W25QXX_FTL_NONE)                                                        /* check old */
+    {
+        ftl->sector[old / 16].valid--;                                                 /* invalidate */
+    }
+    ftl->map[lpn] = (uint16_t)(s * 16 + ftl->open_page);                               /* map */
+    ftl->sector[s].valid++;                                                            /* valid++ */
+    _w25qxx_ftl_next_page(ftl, s);                                                     /* next page */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     run one gc step
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @param[in] force is 1 when the host is out of free sectors
+ * @return    status code
+ *            - 0 one step done
+ *            - 1 gc failed
+ *            - 6 nothing to do
+ * @note      a step erases an empty sector, or moves the valid pages of a victim and erases it,
+ *            the victim is the full sector with the least valid pages or, for static wear leveling,
+ *            the coldest full sector once the erase count gap exceeds W25QXX_FTL_STATIC_DELTA
+ */
+static uint8_t _w25qxx_ftl_gc_step(w25qxx_ftl_t *ftl, uint8_t force)
+{
+    uint8_t header[W25QXX_FTL_HEADER_SIZE];
+    uint32_t s;
+    uint32_t victim;
+    uint32_t coldest;
+    uint32_t max_erase;
+    uint32_t tag;
+    uint32_t lpn;
+    uint32_t i;
+    
+    s = _w25qxx_ftl_find_erasable(ftl);                                                /* find erasable */
+    if (s != ftl->num)                                                                 /* check erasable */
+    {
+        return _w25qxx_ftl_erase(ftl, s);                                              /* erase */
+    }
+    
+    victim = ftl->num;                                                                 /* no victim */
+    coldest = ftl->num;                                                                /* no coldest */
+    max_erase = 0;                                                                     /* init 0 */
+    for (s = 0; s < ftl->num; s++)                                                     /* all sectors */
+    {
+        if (ftl->sector[s].erase_count > max_erase)                                    /* check max */
+        {
+            max_erase = ftl->sector[s].erase_count;                                    /* set max */
+        }
+        if (ftl->sector[s].state != W25QXX_FTL_SECTOR_FULL)                            /* only full sectors */
+        {
+            continue;                                                                  /* next */
+        }
+        if ((coldest == ftl->num) || (ftl->sector[s].erase_count < ftl->sector[coldest].erase_count))      /* check coldest */
+        {
+            coldest = s;                                                               /* set coldest */
+        }
+        if ((victim == ftl->num) || (ftl->sector[s].valid < ftl->sector[victim].valid) ||
+            ((ftl->sector[s].valid == ftl->sector[victim].valid) && 
+             (ftl->sector[s].erase_count < ftl->sector[victim].erase_count)))          /* check victim */
+        {
+            victim = s;                                                                /* set victim */
+        }
+    }
+    if ((force == 0) && (coldest != ftl->num) && (ftl->erase >= ftl->static_next) &&
+        (max_erase - ftl->sector[coldest].erase_count > W25QXX_FTL_STATIC_DELTA))      /* static wear leveling */
+    {
+        victim = coldest;                                                              /* move the cold data */
+        ftl->alloc_hot = 1;                                                            /* onto a worn sector */
+        ftl->static_next = ftl->erase + W25QXX_FTL_STATIC_PERIOD;                      /* rate limit */
+    }
+    else if ((victim == ftl->num) || (ftl->sector[victim].valid >= W25QXX_FTL_SECTOR_PAGES) ||
+             ((force == 0) && (ftl->free_num >= W25QXX_FTL_GC_FREE_TARGET)))           /* check greedy victim */
+    {
+        return 6;                                                                      /* nothing to do */
+    }
+    else
+    {
+        /* greedy victim */
+    }
+    
+    if (w25qxx_read(ftl->handle, _w25qxx_ftl_addr(ftl, victim, 0), header, W25QXX_FTL_HEADER_SIZE) != 0)       /* read tags */
+    {
+        ftl->handle->debug_print("w25qxx: ftl read failed.\n");                        /* ftl read failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    for (i = 0; (i < W25QXX_FTL_SECTOR_PAGES) && (ftl->sector[victim].valid != 0); i++)          /* all data pages */
+    {
+        tag = _w25qxx_get32(&header[W25QXX_FTL_HEADER_TAG + i * 4]);                   /* get tag */
+        lpn = tag & 0xFFFFU;                                                           /* get lpn */
+        if ((lpn >= ftl->pages) || (ftl->map[lpn] != victim * 16 + i + 1))             /* check live */
+        {
+            continue;                                                                  /* dead page */
+        }
+        if (w25qxx_read(ftl->handle, _w25qxx_ftl_addr(ftl, victim, i + 1), ftl->buf, 256) != 0)  /* read page */
+        {
+            ftl->handle->debug_print("w25qxx: ftl read failed.\n");                    /* ftl read failed */
+            
+            return 1;                                                                  /* return error */
+        }
+        if (_w25qxx_ftl_program(ftl, lpn, ftl->buf) != 0)                              /* move page */
+        {
+            return 1;                                                                  /* return error */
+        }
+        ftl->gc_page++;                                                                /* gc page++ */
+    }
+    
+    return _w25qxx_ftl_erase(ftl, victim);                                             /* erase victim */
+}
+
+/**
+ * @brief     mount the ftl
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @param[in] *map points to a table of W25QXX_FTL_LOGICAL_PAGES(num) entries
+ * @param[in] *sector points to a table of num entries
+ * @param[in] first is the first physical 4k sector
+ * @param[in] num is the physical sector number
+ * @return    status code
+ *            - 0 success
+ *            - 1 mount failed
+ *            - 2 handle or ftl is NULL
+ *            - 3 handle is not initialized
+ *            - 4 param is invalid
+ * @note      reads one compact header per sector, a blank or foreign region mounts as empty
+ */
+uint8_t w25qxx_ftl_mount(w25qxx_handle_t *handle, w25qxx_ftl_t *ftl, uint16_t *map, 
+                         w25qxx_ftl_sector_t *sector, uint32_t first, uint32_t num)
+{
+    uint8_t header[W25QXX_FTL_HEADER_SIZE];
+    uint32_t s;
+    uint32_t i;
+    uint32_t tag;
+    uint32_t lpn;
+    uint32_t cur;
+    uint32_t erase;
+    uint32_t max_erase;
+    
+    if ((handle == NULL) || (ftl == NULL))                                             /* check handle */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if (handle->inited != 1)                                                           /* check handle initialization */
+    {
+        return 3;                                                                      /* return error */
+    }
+    if ((map == NULL) || (sector == NULL) || (num <= W25QXX_FTL_SPARE_SECTORS) ||
+        (num > W25QXX_FTL_MAX_SECTORS))                                                /* check param */
+    {
+        handle->debug_print("w25qxx: ftl param is invalid.\n");                        /* ftl param is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    memset(ftl, 0, sizeof(w25qxx_ftl_t));                                              /* clear the structure */
+    ftl->handle = handle;                                                              /* set handle */
+    ftl->map = map;                                                                    /* set map */
+    ftl->sector = sector;                                                              /* set sector */
+    ftl->first = first;                                                                /* set first */
+    ftl->num = num;                                                                    /* set number */
+    ftl->pages = W25QXX_FTL_LOGICAL_PAGES(num);                                        /* set pages */
+    ftl->open = num;                                                                   /* no open sector */
+    ftl->static_next = W25QXX_FTL_STATIC_PERIOD;                                       /* first static check */
+    for (i = 0; i < ftl->pages; i++)                                                   /* all logical pages */
+    {
+        map[i] = W25QXX_FTL_NONE;                                                      /* unmapped */
+    }
+    
+    max_erase = 0;                                                                     /* init 0 */
+    for (s = 0; s < num; s++)                                                          /* all sectors */
+    {
+        if (w25qxx_read(handle, _w25qxx_ftl_addr(ftl, s, 0), header, W25QXX_FTL_HEADER_SIZE) != 0)       /* read header */
+        {
+            handle->debug_print("w25qxx: ftl read failed.\n");                         /* ftl read failed */
+            
+            return 1;                                                                  /* return error */
+        }
+        sector[s].valid = 0;                                                           /* no valid page */
+        sector[s].seq = _w25qxx_get32(&header[W25QXX_FTL_HEADER_SEQ]);                 /* get sequence */
+        erase = _w25qxx_get32(&header[W25QXX_FTL_HEADER_ERASE]);                       /* get erase count */
+        if ((_w25qxx_get32(&header[0]) != W25QXX_FTL_MAGIC) || 
+            (_w25qxx_get32(&header[W25QXX_FTL_HEADER_ERASE + 4]) != ~erase))           /* check header */
+        {
+            sector[s].erase_count = 0xFFFFFFFFU;                                       /* unknown */
+            sector[s].seq = 0xFFFFFFFFU;                                               /* no sequence */
+            sector[s].state = W25QXX_FTL_SECTOR_DIRTY;                                 /* must be erased */
+            
+            continue;                                                                  /* next */
+        }
+        sector[s].erase_count = erase;                                                 /* set erase count */
+        if (erase > max_erase)                                                         /* check max */
+        {
+            max_erase = erase;                                                         /* set max */
+        }
+        if (sector[s].seq == 0xFFFFFFFFU)                                              /* never opened */
+        {
+            sector[s].state = W25QXX_FTL_SECTOR_FREE;                                  /* free */
+            for (i = W25QXX_FTL_HEADER_TAG; i < W25QXX_FTL_HEADER_SIZE; i++)           /* check tags */
+            {
+                if (header[i] != 0xFF)                                                 /* check erased */
+                {
+                    sector[s].state = W25QXX_FTL_SECTOR_DIRTY;                         /* must be erased */
+                    
+                    break;                                                             /* break */
+                }
+            }
+            if (sector[s].state == W25QXX_FTL_SECTOR_FREE)                             /* check free */
+            {
+                ftl->free_num++;                                                       /* free++ */
+            }
+            
+            continue;                                                                  /* next */
+        }
+        sector[s].state = W25QXX_FTL_SECTOR_FULL;                                      /* closed, never appended again */
+        if (sector[s].seq > ftl->seq)                                                  /* check sequence */
+        {
+            ftl->seq = sector[s].seq;                                                  /* set sequence */
+        }
+        for (i = 0; i < W25QXX_FTL_SECTOR_PAGES; i++)                                  /* all tags */
+        {
+            tag = _w25qxx_get32(&header[W25QXX_FTL_HEADER_TAG + i * 4]);               /* get tag */
+            lpn = tag & 0xFFFFU;                                                       /* get lpn */
+            if (((tag >> 16) != (~lpn & 0xFFFFU)) || (lpn >= ftl->pages))              /* check tag */
+            {
+                continue;                                                              /* unwritten or torn */
+            }
+            cur = map[lpn];                                                            /* get current */
+            if ((cur == W25QXX_FTL_NONE) || (sector[cur / 16].seq <= sector[s].seq))   /* newer copy */
+            {
+                map[lpn] = (uint16_t)(s * 16 + i + 1);                                 /* map */
+            }
+        }
+    }
+    for (s = 0; s < num; s++)                                                          /* all sectors */
+    {
+        if (sector[s].erase_count == 0xFFFFFFFFU)                                      /* unknown erase count */
+        {
+            sector[s].erase_count = max_erase;                                         /* assume the worst */
+        }
+    }
+    for (i = 0; i < ftl->pages; i++)                                                   /* all logical pages */
+    {
+        if (map[i] != W25QXX_FTL_NONE)                                                 /* check mapped */
+        {
+            sector[map[i] / 16].valid++;                                               /* valid++ */
+        }
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     unmount the ftl
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 ftl is NULL
+ * @note      every write is already durable, nothing is flushed
+ */
+uint8_t w25qxx_ftl_unmount(w25qxx_ftl_t *ftl)
+{
+    if ((ftl == NULL) || (ftl->handle == NULL))                                        /* check ftl */
+    {
+        return 2;                                                                      /* return error */
+    }
+    
+    ftl->handle = NULL;                                                                /* clear handle */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief      read data
+ * @param[in]  *ftl points to a w25qxx ftl structure
+ * @param[in]  addr is the logical address
+ * @param[out] *data points to a data buffer
+ * @param[in]  len is the data length
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 ftl is NULL
+ *             - 4 addr is invalid
+ * @note       unwritten pages read as 0xFF
+ */
+uint8_t w25qxx_ftl_read(w25qxx_ftl_t *ftl, uint32_t addr, uint8_t *data, uint32_t len)
+{
+    uint32_t lpn;
+    uint32_t offset;
+    uint32_t n;
+    uint32_t p;
+    
+    if ((ftl == NULL) || (ftl->handle == NULL))                                        /* check ftl */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if ((len > ftl->pages * 256) || (addr > ftl->pages * 256 - len))                   /* check addr */
+    {
+        ftl->handle->debug_print("w25qxx: addr is invalid.\n");                        /* addr is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    while (len != 0)                                                                   /* read all */
+    {
+        lpn = addr / 256;                                                              /* get lpn */
+        offset = addr % 256;                                                           /* get offset */
+        n = 256 - offset;                                                              /* page remain */
+        if (n > len)                                                                   /* check length */
+        {
+            n = len;                                                                   /* set length */
+        }
+        p = ftl->map[lpn];                                                             /* get physical page */
+        if (p == W25QXX_FTL_NONE)                                                      /* unmapped */
+        {
+            memset(data, 0xFF, n);                                                     /* erased content */
+        }
+        else if (w25qxx_read(ftl->handle, _w25qxx_ftl_addr(ftl, p / 16, p % 16) + offset, data, n) != 0)    /* read page */
+        {
+            ftl->handle->debug_print("w25qxx: ftl read failed.\n");                    /* ftl read failed */
+            
+            return 1;                                                                  /* return error */
+        }
+        else
+        {
+            /* read done */
+        }
+        addr += n;                                                                     /* next address */
+        data += n;                                                                     /* next data */
+        len -= n;                                                                      /* remain */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     write data
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @param[in] addr is the logical address
+ * @param[in] *data points to a data buffer
+ * @param[in] len is the data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ *            - 2 ftl is NULL
+ *            - 4 addr is invalid
+ *            - 5 no space
+ * @note      every touched page is written out of place with one page program and a tag program,
+ *            partial pages are merged with the old content first
+ */
+uint8_t w25qxx_ftl_write(w25qxx_ftl_t *ftl, uint32_t addr, uint8_t *data, uint32_t len)
+{
+    uint8_t res;
+    uint8_t *buf;
+    uint32_t lpn;
+    uint32_t offset;
+    uint32_t n;
+    
+    if ((ftl == NULL) || (ftl->handle == NULL))                                        /* check ftl */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if ((len > ftl->pages * 256) || (addr > ftl->pages * 256 - len))                   /* check addr */
+    {
+        ftl->handle->debug_print("w25qxx: addr is invalid.\n");                        /* addr is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    while (len != 0)                                                                   /* write all */
+    {
+        lpn = addr / 256;                                                              /* get lpn */
+        offset = addr % 256;                                                           /* get offset */
+        n = 256 - offset;                                                              /* page remain */
+        if (n > len)                                                                   /* check length */
+        {
+            n = len;                                                                   /* set length */
+        }
+        while ((ftl->open == ftl->num) && (ftl->free_num < 2))                         /* keep one sector for gc */
+        {
+            res = _w25qxx_ftl_gc_step(ftl, 1);                                         /* foreground gc */
+            if (res != 0)
+            {
+                if (res == 6)                                                          /* check space */
+                {
+                    ftl->handle->debug_print("w25qxx: ftl is full.\n");                /* ftl is full */
+                    
+                    return 5;                                                          /* return error */
+                }
+                
+                return 1;                                                              /* return error */
+            }
+        }
+        if (n == 256)                                                                  /* full page */
+        {
+            buf = data;                                                                /* program directly */
+        }
+        else
+        {
+            res = w25qxx_ftl_read(ftl, lpn * 256, ftl->buf, 256);                      /* read old page */
+            if (res != 0)
+            {
+                return 1;                                                              /* return error */
+            }
+            memcpy(&ftl->buf[offset], data, n);                                        /* merge */
+            buf = ftl->buf;                                                            /* program the buffer */
+        }
+        res = _w25qxx_ftl_program(ftl, lpn, buf);                                      /* program page */
+        if (res != 0)
+        {
+            return res;                                                                /* return error */
+        }
+        ftl->host_page++;                                                              /* host page++ */
+        addr += n;                                                                     /* next address */
+        data += n;                                                                     /* next data */
+        len -= n;                                                                      /* remain */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     run one background gc step
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @return    status code
+ *            - 0 one step done
+ *            - 1 gc failed
+ *            - 2 ftl is NULL
+ *            - 6 nothing to do
+ * @note      call it from the idle loop until it returns 6, a step erases one sector
+ *            and may move up to W25QXX_FTL_SECTOR_PAGES pages
+ */
+uint8_t w25qxx_ftl_gc(w25qxx_ftl_t *ftl)
+{
+    if ((ftl == NULL) || (ftl->handle == NULL))                                        /* check ftl */
+    {
+        return 2;                                                                      /* return error */
+    }
+    
+    return _w25qxx_ftl_gc_step(ftl, 0);                                                /* background gc */
+}
+
+/**
+ * @brief      get the ftl info
+ * @param[in]  *ftl points to a w25qxx ftl structure
+ * @param[out] *info points to a w25qxx ftl info structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 ftl is NULL
+ * @note       none
+ */
+uint8_t w25qxx_ftl_get_info(w25qxx_ftl_t *ftl, w25qxx_ftl_info_t *info)
+{
+    uint32_t s;
+    
+    if ((ftl == NULL) || (ftl->handle == NULL) || (info == NULL))                      /* check ftl */
+    {
+        return 2;                                                                      /* return error */
+    }
+    
+    memset(info, 0, sizeof(w25qxx_ftl_info_t));                                        /* clear info */
+    info->capacity = ftl->pages * 256;                                                 /* set capacity */
+    info->free_sector = ftl->free_num;                                                 /* set free */
+    info->min_erase = 0xFFFFFFFFU;                                                     /* init min */
+    for (s = 0; s < ftl->num; s++)                                                     /* all sectors */
+    {
+        if (ftl->sector[s].erase_count < info->min_erase)                              /* check min */
+        {
+            info->min_erase = ftl->sector[s].erase_count;                              /* set min */
+        }
+        if (ftl->sector[s].erase_count > info->max_erase)                              /* check max */
+        {
+            info->max_erase = ftl->sector[s].erase_count;                              /* set max */
+        }
+    }
+    info->host_page = ftl->host_page;                                                  /* set host pages */
+    info->gc_page = ftl->gc_page;                                                      /* set gc pages */
+    info->erase = ftl->erase;                                                          /* set erases */
+    if (ftl->host_page != 0)                                                           /* check host pages */
+    {
+        info->write_amplification = (float)(ftl->host_page + ftl->gc_page) / (float)ftl->host_page;   /* set amplification */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
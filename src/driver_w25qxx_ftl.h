@@ -0,0 +1,235 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_ftl.h
+ * @brief     driver w25qxx ftl header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DRIVER_W25QXX_FTL_H_
+#define _DRIVER_W25QXX_FTL_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup w25qxx_ftl_driver w25qxx ftl driver function
+ * @brief    w25qxx ftl driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+/**
+ * @brief w25qxx ftl layout definition
+ */
+#define W25QXX_FTL_PAGE_SIZE           256        /**< logical page size */
+#define W25QXX_FTL_SECTOR_PAGES        15         /**< data pages of a sector, page 0 is the header */
+#define W25QXX_FTL_SPARE_SECTORS       3          /**< sectors kept out of the logical space for gc */
+#define W25QXX_FTL_MAX_SECTORS         4095       /**< max physical sectors, the map uses 16 bits */
+
+/**
+ * @brief w25qxx ftl gc definition
+ */
+#ifndef W25QXX_FTL_GC_FREE_TARGET
+    #define W25QXX_FTL_GC_FREE_TARGET  4          /**< background gc keeps this number of free sectors */
+#endif
+#ifndef W25QXX_FTL_STATIC_DELTA
+    #define W25QXX_FTL_STATIC_DELTA    128        /**< erase count gap that triggers static wear leveling */
+#endif
+
+/**
+ * @brief w25qxx ftl logical page number definition
+ * @note  the length of the map table passed to w25qxx_ftl_mount
+ */
+#define W25QXX_FTL_LOGICAL_PAGES(num)  (((num) - W25QXX_FTL_SPARE_SECTORS) * W25QXX_FTL_SECTOR_PAGES)
+
+/**
+ * @brief w25qxx ftl capacity definition
+ */
+#define W25QXX_FTL_CAPACITY(num)       (W25QXX_FTL_LOGICAL_PAGES(num) * W25QXX_FTL_PAGE_SIZE)
+
+/**
+ * @brief w25qxx ftl sector state enumeration definition
+ */
+typedef enum
+{
+    W25QXX_FTL_SECTOR_DIRTY = 0x00,        /**< must be erased before use */
+    W25QXX_FTL_SECTOR_FREE  = 0x01,        /**< erased with a header */
+    W25QXX_FTL_SECTOR_OPEN  = 0x02,        /**< being filled */
+    W25QXX_FTL_SECTOR_FULL  = 0x03,        /**< closed */
+} w25qxx_ftl_sector_state_t;
+
+/**
+ * @brief w25qxx ftl sector structure definition
+ */
+typedef struct w25qxx_ftl_sector_s
+{
+    uint32_t erase_count;        /**< erase count */
+    uint32_t seq;                /**< open sequence */
+    uint8_t valid;               /**< valid pages */
+    uint8_t state;               /**< sector state */
+} w25qxx_ftl_sector_t;
+
+/**
+ * @brief w25qxx ftl structure definition
+ */
+typedef struct w25qxx_ftl_s
+{
+    w25qxx_handle_t *handle;             /**< w25qxx handle */
+    uint16_t *map;                       /**< logical page to physical page table */
+    w25qxx_ftl_sector_t *sector;         /**< physical sector table */
+    uint32_t first;                      /**< first physical sector */
+    uint32_t num;                        /**< physical sector number */
+    uint32_t pages;                      /**< logical page number */
+    uint32_t seq;                        /**< last open sequence */
+    uint32_t free_num;                   /**< free sector number */
+    uint32_t open;                       /**< open sector, num if none */
+    uint8_t open_page;                   /**< next page of the open sector */
+    uint8_t alloc_hot;                   /**< next allocation takes the most worn sector */
+    uint32_t static_next;                /**< erase number of the next static wear leveling check */
+    uint32_t host_page;                  /**< pages written by the host */
+    uint32_t gc_page;                    /**< pages moved by gc */
+    uint32_t erase;                      /**< sectors erased */
+    uint8_t buf[256];                    /**< page buffer */
+} w25qxx_ftl_t;
+
+/**
+ * @brief w25qxx ftl info structure definition
+ */
+typedef struct w25qxx_ftl_info_s
+{
+    uint32_t capacity;             /**< logical capacity in bytes */
+    uint32_t free_sector;          /**< free sectors */
+    uint32_t min_erase;            /**< min sector erase count */
+    uint32_t max_erase;            /**< max sector erase count */
+    uint32_t host_page;            /**< pages written by the host */
+    uint32_t gc_page;              /**< pages moved by gc */
+    uint32_t erase;                /**< sectors erased */
+    float write_amplification;     /**< (host + gc) pages / host pages */
+} w25qxx_ftl_info_t;
+
+/**
+ * @brief     mount the ftl
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @param[in] *map points to a table of W25QXX_FTL_LOGICAL_PAGES(num) entries
+ * @param[in] *sector points to a table of num entries
+ * @param[in] first is the first physical 4k sector
+ * @param[in] num is the physical sector number
+ * @return    status code
+ *            - 0 success
+ *            - 1 mount failed
+ *            - 2 handle or ftl is NULL
+ *            - 3 handle is not initialized
+ *            - 4 param is invalid
+ * @note      reads one compact header per sector, a blank or foreign region mounts as empty
+ */
+uint8_t w25qxx_ftl_mount(w25qxx_handle_t *handle, w25qxx_ftl_t *ftl, uint16_t *map, 
+                         w25qxx_ftl_sector_t *sector, uint32_t first, uint32_t num);
+
+/**
+ * @brief     unmount the ftl
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 ftl is NULL
+ * @note      every write is already durable, nothing is flushed
+ */
+uint8_t w25qxx_ftl_unmount(w25qxx_ftl_t *ftl);
+
+/**
+ * @brief      read data
+ * @param[in]  *ftl points to a w25qxx ftl structure
+ * @param[in]  addr is the logical address
+ * @param[out] *data points to a data buffer
+ * @param[in]  len is the data length
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 ftl is NULL
+ *             - 4 addr is invalid
+ * @note       unwritten pages read as 0xFF
+ */
+uint8_t w25qxx_ftl_read(w25qxx_ftl_t *ftl, uint32_t addr, uint8_t *data, uint32_t len);
+
+/**
+ * @brief     write data
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @param[in] addr is the logical address
+ * @param[in] *data points to a data buffer
+ * @param[in] len is the data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ *            - 2 ftl is NULL
+ *            - 4 addr is invalid
+ *            - 5 no space
+ * @note      every touched page is written out of place with one page program and a tag program,
+ *            partial pages are merged with the old content first
+ */
+uint8_t w25qxx_ftl_write(w25qxx_ftl_t *ftl, uint32_t addr, uint8_t *data, uint32_t len);
+
+/**
+ * @brief     run one background gc step
+ * @param[in] *ftl points to a w25qxx ftl structure
+ * @return    status code
+ *            - 0 one step done
+ *            - 1 gc failed
+ *            - 2 ftl is NULL
+ *            - 6 nothing to do
+ * @note      call it from the idle loop until it returns 6, a step erases one sector
+ *            and may move up to W25QXX_FTL_SECTOR_PAGES pages
+ */
+uint8_t w25qxx_ftl_gc(w25qxx_ftl_t *ftl);
+
+/**
+ * @brief      get the ftl info
+ * @param[in]  *ftl points to a w25qxx ftl structure
+ * @param[out] *info points to a w25qxx ftl info structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 ftl is NULL
+ * @note       none
+ */
+uint8_t w25qxx_ftl_get_info(w25qxx_ftl_t *ftl, w25qxx_ftl_info_t *info);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,1062 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_kv.c
+ * @brief     driver w25qxx kv source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_kv.h"
+#include "driver_w25qxx_crc.h"
+#include "driver_w25qxx_endian.h"
+
+/**
+ * @brief kv layout definition
+ * @note  a sector starts with the magic and is followed by records,
+ *        a record is key_len, type, value_len[2], seq[4], crc[4], key, value
+ */
+#define W25QXX_KV_MAGIC             0x3153564BU        /**< "KVS1" */
+#define W25QXX_KV_SECTOR_HEADER     4                  /**< sector header size */
+#define W25QXX_KV_RECORD_HEADER     12                 /**< record header size */
+#define W25QXX_KV_TYPE_PUT          0x50               /**< put record */
+#define W25QXX_KV_TYPE_DELETE       0x44               /**< tombstone record */
+
+/**
+ * @brief kv index definition
+ */
+#define W25QXX_KV_EMPTY             0xFFFFFFFFU        /**< empty slot */
+#define W25QXX_KV_REMOVED           0xFFFFFFFEU        /**< removed slot */
+#define W25QXX_KV_DELETED           0x80000000U        /**< tombstone flag, only used while mounting */
+
+/**
+ * @brief kv sector state definition
+ */
+#define W25QXX_KV_SECTOR_FREE       0                  /**< erased */
+#define W25QXX_KV_SECTOR_DIRTY      1                  /**< foreign data, erase before use */
+#define W25QXX_KV_SECTOR_USED       2                  /**< has records */
+
+/**
+ * @brief     hash a key
+ * @param[in] *key points to a key buffer
+ * @param[in] len is the key length
+ * @return    fnv-1a hash
+ * @note      none
+ */
+static uint32_t _w25qxx_kv_hash(const uint8_t *key, uint32_t len)
+{
+    uint32_t hash;
+    uint32_t i;
+    
+    hash = 0x811C9DC5U;                                                                /* offset basis */
+    for (i = 0; i < len; i++)                                                          /* all bytes */
+    {
+        hash = (hash ^ key[i]) * 0x01000193U;                                          /* fnv prime */
+    }
+    
+    return hash;                                                                       /* return hash */
+}
+
+/**
+ * @brief     get the check value of a key
+ * @param[in] *key points to a key buffer
+ * @param[in] len is the key length
+ * @return    crc32 of the key
+ * @note      independent of the fnv-1a hash, the index matches a key on both
+ */
+static uint32_t _w25qxx_kv_check(const uint8_t *key, uint32_t len)
+{
+    return w25qxx_crc32(0, key, len);                                                  /* return crc */
+}
+
+/**
+ * @brief     get the crc of a record
+ * @param[in] *record points to a record whose header is filled
+ * @param[in] *key points to a key buffer
+ * @param[in] *value points to a value buffer
+ * @return    crc
+ * @note      covers the first 8 header bytes, the key and the value
+ */
+static uint32_t _w25qxx_kv_record_crc(const uint8_t *record, const uint8_t *key, const uint8_t *value)
+{
+    uint32_t crc;
+    uint16_t value_len;
+    
+    value_len = (uint16_t)(record[2] | (record[3] << 8));                              /* get value length */
+    crc = w25qxx_crc32(0, record, 8);                                                  /* header */
+    crc = w25qxx_crc32(crc, key, record[0]);                                           /* key */
+    crc = w25qxx_crc32(crc, value, value_len);                                         /* value */
+    
+    return crc;                                                                        /* return crc */
+}
+
+/**
+ * @brief      check a record in a buffer
+ * @param[in]  *buf points to a record
+ * @param[in]  avail is the available length
+ * @param[out] *size points to a record size buffer
+ * @return     status code
+ *             - 0 valid
+ *             - 1 invalid
+ * @note       none
+ */
+static uint8_t _w25qxx_kv_record_check(const uint8_t *buf, uint32_t avail, uint32_t *size)
+{
+    uint32_t key_len;
+    uint32_t value_len;
+    
+    if (avail < W25QXX_KV_RECORD_HEADER)                                               /* check header */
+    {
+        return 1;                                                                      /* return error */
+    }
+    key_len = buf[0];                                                                  /* get key length */
+    value_len = (uint32_t)buf[2] | ((uint32_t)buf[3] << 8);                            /* get value length */
+    if ((key_len == 0) || (key_len > W25QXX_KV_KEY_MAX) || (value_len > W25QXX_KV_VALUE_MAX) ||
+        ((buf[1] != W25QXX_KV_TYPE_PUT) && (buf[1] != W25QXX_KV_TYPE_DELETE)))        /* check fields */
+    {
+        return 1;                                                                      /* return error */
+    }
+    *size = W25QXX_KV_RECORD_HEADER + key_len + value_len;                             /* record size */
+    if (*size > avail)                                                                 /* check size */
+    {
+        return 1;                                                                      /* return error */
+    }
+    if (_w25qxx_kv_record_crc(buf, &buf[W25QXX_KV_RECORD_HEADER], 
+                              &buf[W25QXX_KV_RECORD_HEADER + key_len]) != _w25qxx_get32(&buf[8]))       /* check crc */
+    {
+        return 1;                                                                      /* return error */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief      find a key in the index
+ * @param[in]  *kv points to a w25qxx kv structure
+ * @param[in]  hash is the key hash
+ * @param[in]  check is the key check value
+ * @param[out] *slot points to a slot buffer, the insert slot or entry_num if not found
+ * @return     status code
+ *             - 0 found
+ *             - 5 not found
+ * @note       the index holds the hash, the crc, the size and the sequence of every key,
+ *             so a lookup never touches the flash
+ */
+static uint8_t _w25qxx_kv_lookup(w25qxx_kv_t *kv, uint32_t hash, uint32_t check, uint32_t *slot)
+{
+    uint32_t i;
+    uint32_t n;
+    uint32_t insert;
+    w25qxx_kv_entry_t *e;
+    
+    insert = kv->entry_num;                                                            /* no slot */
+    i = hash & (kv->entry_num - 1);                                                    /* home slot */
+    for (n = 0; n < kv->entry_num; n++)                                                /* linear probe */
+    {
+        e = &kv->entry[i];                                                             /* get entry */
+        if (e->addr == W25QXX_KV_EMPTY)                                                /* end of the chain */
+        {
+            if (insert == kv->entry_num)                                               /* check insert */
+            {
+                insert = i;                                                            /* set insert */
+            }
+            
+            break;                                                                     /* break */
+        }
+        else if (e->addr == W25QXX_KV_REMOVED)                                         /* removed slot */
+        {
+            if (insert == kv->entry_num)                                               /* check insert */
+            {
+                insert = i;                                                            /* reuse it */
+            }
+        }
+        else if ((e->hash == hash) && (e->check == check))                             /* check key */
+        {
+            *slot = i;                                                                 /* set slot */
+            
+            return 0;                                                                  /* found */
+        }
+        else
+        {
+            /* another key */
+        }
+        i = (i + 1) & (kv->entry_num - 1);                                             /* next slot */
+    }
+    *slot = insert;                                                                    /* set insert slot */
+    
+    return 5;                                                                          /* not found */
+}
+
+/**
+ * @brief     get the sector index of an address
+ * @param[in] *kv points to a w25qxx kv structure
+ * @param[in] addr is the flash address
+ * @return    sector index
+ * @note      none
+ */
+static uint32_t _w25qxx_kv_sector(w25qxx_kv_t *kv, uint32_t addr)
+{
+    return (addr & ~W25QXX_KV_DELETED) / 4096 - kv->first;                             /* get sector */
+}
+
+/**
+ * @brief     open a new append sector
+ * @param[in] *kv points to a w25qxx kv structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 open failed
+ *            - 5 no free sector
+ * @note      none
+ */
+static uint8_t _w25qxx_kv_open(w25qxx_kv_t *kv)
+{
+    uint32_t s;
+    uint32_t best;
+    uint8_t magic[4];
+    
+    best = kv->num;                                                                    /* none */
+    for (s = 0; s < kv->num; s++)                                                      /* all sectors */
+    {
+        if (kv->sector[s].state == W25QXX_KV_SECTOR_FREE)                              /* erased first */
+        {
+            best = s;                                                                  /* set best */
+            
+            break;                                                                     /* break */
+        }
+        if ((kv->sector[s].state == W25QXX_KV_SECTOR_DIRTY) && (best == kv->num))      /* then dirty */
+        {
+            best = s;                                                                  /* set best */
+        }
+    }
+    if (best == kv->num)                                                               /* check free */
+    {
+        return 5;                                                                      /* no free sector */
+    }
+    if (kv->sector[best].state == W25QXX_KV_SECTOR_DIRTY)                              /* check dirty */
+    {
+        if (w25qxx_sector_erase_4k(kv->handle, (kv->first + best) * 4096) != 0)        /* erase */
+        {
+            kv->handle->debug_print("w25qxx: kv erase failed.\n");                     /* kv erase failed */
+            
+            return 1;                                                                  /* return error */
+        }
+    }
+    _w25qxx_put32(magic, W25QXX_KV_MAGIC);                                             /* set magic */
+    if (w25qxx_page_program(kv->handle, (kv->first + best) * 4096, magic, 4) != 0)     /* program magic */
+    {
+        kv->handle->debug_print("w25qxx: kv program failed.\n");                       /* kv program failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    kv->sector[best].state = W25QXX_KV_SECTOR_USED;                                    /* used */
+    kv->sector[best].used = W25QXX_KV_SECTOR_HEADER;                                   /* after the magic */
+    kv->sector[best].dead = 0;                                                         /* no dead bytes */
+    kv->sector[best].first_seq = 0xFFFFFFFFU;                                          /* no record */
+    kv->free_num--;                                                                    /* free-- */
+    kv->active = best;                                                                 /* set active */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief      append a record
+ * @param[in]  *kv points to a w25qxx kv structure
+ * @param[in]  **seg points to the record segments
+ * @param[in]  *seg_len points to the segment lengths
+ * @param[in]  seg_num is the segment number
+ * @param[out] *addr points to a record address buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 append failed
+ *             - 5 no free sector
+ * @note       the first segment starts with the record header, bytes before the
+ *             record in its first page are programmed as 0xFF
+ */
+static uint8_t _w25qxx_kv_append(w25qxx_kv_t *kv, const uint8_t * const *seg, const uint32_t *seg_len,
+                                 uint8_t seg_num, uint32_t *addr)
+{
+    uint8_t res;
+    uint8_t i;
+    uint32_t size;
+    uint32_t pos;
+    uint32_t fill;
+    uint32_t base;
+    w25qxx_kv_sector_t *sector;
+    
+    for (size = 0, i = 0; i < seg_num; i++)                                            /* all segments */
+    {
+        size += seg_len[i];                                                            /* record size */
+    }
+    if ((kv->active != kv->num) && (4096U - kv->sector[kv->active].used < size))       /* check room */
+    {
+        sector = &kv->sector[kv->active];                                              /* get sector */
+        sector->dead = (uint16_t)(sector->dead + 4096 - sector->used);                 /* the tail is dead */
+        sector->used = 4096;                                                           /* close */
+        kv->active = kv->num;                                                          /* no active */
+    }
+    if (kv->active == kv->num)                                                         /* check active */
+    {
+        res = _w25qxx_kv_open(kv);                                                     /* open */
+        if (res != 0)
+        {
+            return res;                                                                /* return error */
+        }
+    }
+    sector = &kv->sector[kv->active];                                                  /* get sector */
+    *addr = (kv->first + kv->active) * 4096 + sector->used;                            /* record address */
+    base = *addr & ~0xFFU;                                                             /* page address */
+    fill = *addr & 0xFFU;                                                              /* page offset */
+    memset(kv->page, 0xFF, fill);                                                      /* keep the bytes before */
+    for (i = 0, pos = 0; i < seg_num; )                                                /* gather */
+    {
+        if (pos == seg_len[i])                                                         /* segment done */
+        {
+            i++;                                                                       /* next segment */
+            pos = 0;                                                                   /* reset */
+            
+            continue;                                                                  /* next */
+        }
+        kv->page[fill++] = seg[i][pos++];                                              /* copy */
+        if (fill == 256)                                                               /* page full */
+        {
+            if (w25qxx_page_program(kv->handle, base, kv->page, 256) != 0)             /* program page */
+            {
+                kv->handle->debug_print("w25qxx: kv program failed.\n");               /* kv program failed */
+                
+                return 1;                                                              /* return error */
+            }
+            base += 256;                                                               /* next page */
+            fill = 0;                                                                  /* reset */
+        }
+    }
+    if (fill != 0)                                                                     /* the last page */
+    {
+        if (w25qxx_page_program(kv->handle, base, kv->page, (uint16_t)fill) != 0)      /* program page */
+        {
+            kv->handle->debug_print("w25qxx: kv program failed.\n");                   /* kv program failed */
+            
+            return 1;                                                                  /* return error */
+        }
+    }
+    sector->used = (uint16_t)(sector->used + size);                                    /* used */
+    if (sector->first_seq == 0xFFFFFFFFU)                                              /* first record */
+    {
+        sector->first_seq = _w25qxx_get32(&seg[0][4]);                                 /* set first sequence */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     compact the sector with the most dead bytes
+ * @param[in] *kv points to a w25qxx kv structure
+ * @param[in] force is 1 when any dead byte is enough
+ * @return    status code
+ *            - 0 success
+ *            - 1 compaction failed
+ *            - 6 nothing to do
+ * @note      live records are copied with a new sequence, a tombstone is kept only while
+ *            an older sector may still hold a record of its key
+ */
+static uint8_t _w25qxx_kv_compact_step(w25qxx_kv_t *kv, uint8_t force)
+{
+    uint8_t res;
+    uint8_t *p;
+    uint32_t s;
+    uint32_t victim;
+    uint32_t min_seq;
+    uint32_t off;
+    uint32_t size;
+    uint32_t addr;
+    uint32_t hash;
+    uint32_t slot;
+    uint32_t i;
+    uint32_t n;
+    uint8_t keep;
+    const uint8_t *seg[1];
+    uint32_t seg_len[1];
+    
+    victim = kv->num;                                                                  /* no victim */
+    min_seq = 0xFFFFFFFFU;                                                             /* init max */
+    for (s = 0; s < kv->num; s++)                                                      /* all sectors */
+    {
+        if ((kv->sector[s].state != W25QXX_KV_SECTOR_USED) || (s == kv->active))       /* only closed sectors */
+        {
+            continue;                                                                  /* next */
+        }
+        if ((victim == kv->num) || (kv->sector[s].dead > kv->sector[victim].dead))     /* most dead */
+        {
+            victim = s;                                                                /* set victim */
+        }
+    }
+    if ((victim == kv->num) || (kv->sector[victim].dead == 0) ||
+        ((force == 0) && (kv->sector[victim].dead < W25QXX_KV_COMPACT_DEAD)))          /* check victim */
+    {
+        return 6;                                                                      /* nothing to do */
+    }
+    for (s = 0; s < kv->num; s++)                                                      /* all other sectors */
+    {
+        if ((s != victim) && (kv->sector[s].state == W25QXX_KV_SECTOR_USED) && 
+            (kv->sector[s].first_seq < min_seq))                                       /* check oldest */
+        {
+            min_seq = kv->sector[s].first_seq;                                         /* set oldest */
+        }
+    }
+    
+    if (w25qxx_read(kv->handle, (kv->first + victim) * 4096, kv->buf, kv->sector[victim].used) != 0)     /* read victim */
+    {
+        kv->handle->debug_print("w25qxx: kv read failed.\n");                          /* kv read failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    off = W25QXX_KV_SECTOR_HEADER;                                                     /* first record */
+    while (off < kv->sector[victim].used)                                              /* all records */
+    {
+        p = &kv->buf[off];                                                             /* get record */
+        if (_w25qxx_kv_record_check(p, kv->sector[victim].used - off, &size) != 0)     /* check record */
+        {
+            break;                                                                     /* torn or closed tail */
+        }
+        addr = (kv->first + victim) * 4096 + off;                                      /* record address */
+        hash = _w25qxx_kv_hash(&p[W25QXX_KV_RECORD_HEADER], p[0]);                     /* get hash */
+        keep = 0;                                                                      /* drop by default */
+        slot = kv->entry_num;                                                          /* no slot */
+        if (p[1] == W25QXX_KV_TYPE_PUT)                                                /* put record */
+        {
+            for (i = hash & (kv->entry_num - 1), n = 0; 
+                 (n < kv->entry_num) && (kv->entry[i].addr != W25QXX_KV_EMPTY); 
+                 i = (i + 1) & (kv->entry_num - 1), n++)                               /* probe by address */
+            {
+                if (kv->entry[i].addr == addr)                                         /* live */
+                {
+                    keep = 1;                                                          /* keep */
+                    slot = i;                                                          /* set slot */
+                    
+                    break;                                                             /* break */
+                }
+            }
+        }
+        else
+        {
+            res = _w25qxx_kv_lookup(kv, hash, _w25qxx_kv_check(&p[W25QXX_KV_RECORD_HEADER], p[0]), 
+                                    &slot);                                            /* check the key */
+            keep = ((res == 5) && (min_seq < _w25qxx_get32(&p[4]))) ? 1 : 0;           /* older records may remain */
+        }
+        if (keep != 0)                                                                 /* copy the record */
+        {
+            _w25qxx_put32(&p[4], ++kv->seq);                                           /* new sequence */
+            _w25qxx_put32(&p[8], _w25qxx_kv_record_crc(p, &p[W25QXX_KV_RECORD_HEADER], 
+                             &p[W25QXX_KV_RECORD_HEADER + p[0]]));                     /* new crc */
+            seg[0] = p;                                                                /* one segment */
+            seg_len[0] = size;                                                         /* record size */
+            res = _w25qxx_kv_append(kv, seg, seg_len, 1, &addr);                       /* append */
+            if (res != 0)
+            {
+                return 1;                                                              /* return error */
+            }
+            if (p[1] == W25QXX_KV_TYPE_PUT)                                            /* put record */
+            {
+                kv->entry[slot].addr = addr;                                           /* move the index */
+                kv->entry[slot].seq = kv->seq;                                         /* set sequence */
+            }
+            else
+            {
+                kv->sector[_w25qxx_kv_sector(kv, addr)].dead += (uint16_t)size;        /* tombstones are dead */
+            }
+        }
+        off += size;                                                                   /* next record */
+    }
+    if (w25qxx_sector_erase_4k(kv->handle, (kv->first + victim) * 4096) != 0)          /* erase victim */
+    {
+        kv->handle->debug_print("w25qxx: kv erase failed.\n");                         /* kv erase failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    kv->sector[victim].state = W25QXX_KV_SECTOR_FREE;                                  /* free */
+    kv->sector[victim].used = 0;                                                       /* clear used */
+    kv->sector[victim].dead = 0;                                                       /* clear dead */
+    kv->sector[victim].first_seq = 0xFFFFFFFFU;                                        /* no record */
+    kv->free_num++;                                                                    /* free++ */
+    kv->compaction++;                                                                  /* compaction++ */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     make room for a host record
+ * @param[in] *kv points to a w25qxx kv structure
+ * @param[in] size is the record size
+ * @return    status code
+ *            - 0 success
+ *            - 1 compaction failed
+ *            - 5 store is full
+ * @note      one free sector is always kept for compaction
+ */
+static uint8_t _w25qxx_kv_reserve(w25qxx_kv_t *kv, uint32_t size)
+{
+    uint8_t res;
+    uint32_t n;
+    
+    for (n = 0; n <= kv->num; n++)                                                     /* bounded */
+    {
+        if (((kv->active != kv->num) && (4096U - kv->sector[kv->active].used >= size)) ||
+            (kv->free_num >= 2))                                                       /* check room */
+        {
+            return 0;                                                                  /* success return 0 */
+        }
+        res = _w25qxx_kv_compact_step(kv, 1);                                          /* foreground compaction */
+        if (res == 6)                                                                  /* no dead data */
+        {
+            break;                                                                     /* break */
+        }
+        if (res != 0)
+        {
+            return 1;                                                                  /* return error */
+        }
+    }
+    kv->handle->debug_print("w25qxx: kv is full.\n");                                  /* kv is full */
+    
+    return 5;                                                                          /* return error */
+}
+
+/**
+ * @brief     mount the kv store
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *kv points to a w25qxx kv structure
+ * @param[in] *entry points to a hash index table
+ * @param[in] entry_num is the hash index length, a power of 2 larger than the key number
+ * @param[in] *sector points to a table of num entries
+ * @param[in] first is the first 4k sector
+ * @param[in] num is the sector number
+ * @return    status code
+ *            - 0 success
+ *            - 1 mount failed
+ *            - 2 handle or kv is NULL
+ *            - 3 handle is not initialized
+ *            - 4 param is invalid
+ *            - 6 index is full
+ * @note      every sector is read once with a 4k read and nothing else is read, a torn
+ *            record closes its sector
+ */
+uint8_t w25qxx_kv_mount(w25qxx_handle_t *handle, w25qxx_kv_t *kv, w25qxx_kv_entry_t *entry, uint32_t entry_num,
+                        w25qxx_kv_sector_t *sector, uint32_t first, uint32_t num)
+{
+    uint8_t res;
+    uint8_t *p;
+    uint32_t s;
+    uint32_t i;
+    uint32_t off;
+    uint32_t size;
+    uint32_t seq;
+    uint32_t hash;
+    uint32_t check;
+    uint32_t slot;
+    uint32_t addr;
+    
+    if ((handle == NULL) || (kv == NULL))                                              /* check handle */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if (handle->inited != 1)                                                           /* check handle initialization */
+    {
+        return 3;                                                                      /* return error */
+    }
+    if ((entry == NULL) || (entry_num < 2) || ((entry_num & (entry_num - 1)) != 0) ||
+        (sector == NULL) || (num < 2))                                                 /* check param */
+    {
+        handle->debug_print("w25qxx: kv param is invalid.\n");                         /* kv param is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    memset(kv, 0, sizeof(w25qxx_kv_t));                                                /* clear the structure */
+    kv->handle = handle;                                                               /* set handle */
+    kv->entry = entry;                                                                 /* set entry */
+    kv->entry_num = entry_num;                                                         /* set entry number */
+    kv->sector = sector;                                                               /* set sector */
+    kv->first = first;                                                                 /* set first */
+    kv->num = num;                                                                     /* set number */
+    kv->active = num;                                                                  /* no active */
+    for (i = 0; i < entry_num; i++)                                                    /* all entries */
+    {
+        memset(&entry[i], 0, sizeof(w25qxx_kv_entry_t));                               /* clear entry */
+        entry[i].addr = W25QXX_KV_EMPTY;                                               /* empty */
+    }
+    
+    for (s = 0; s < num; s++)                                                          /* one pass */
+    {
+        if (w25qxx_read(handle, (first + s) * 4096, kv->buf, 4096) != 0)               /* read sector */
+        {
+            handle->debug_print("w25qxx: kv read failed.\n");                          /* kv read failed */
+            
+            return 1;                                                                  /* return error */
+        }
+        sector[s].used = 0;                                                            /* init 0 */
+        sector[s].dead = 0;                                                            /* init 0 */
+        sector[s].first_seq = 0xFFFFFFFFU;                                             /* no record */
+        if (_w25qxx_get32(kv->buf) != W25QXX_KV_MAGIC)                                 /* not a kv sector */
+        {
+            sector[s].state = W25QXX_KV_SECTOR_FREE;                                   /* erased */
+            for (i = 0; i < 4096; i++)                                                 /* check erased */
+            {
+                if (kv->buf[i] != 0xFF)
+                {
+                    sector[s].state = W25QXX_KV_SECTOR_DIRTY;                          /* erase before use */
+                    
+                    break;                                                             /* break */
+                }
+            }
+            kv->free_num++;                                                            /* free++ */
+            
+            continue;                                                                  /* next */
+        }
+        sector[s].state = W25QXX_KV_SECTOR_USED;                                       /* used */
+        off = W25QXX_KV_SECTOR_HEADER;                                                 /* first record */
+        while (off < 4096)                                                             /* all records */
+        {
+            p = &kv->buf[off];                                                         /* get record */
+            if (p[0] == 0xFF)                                                          /* end of the log */
+            {
+                for (i = off; i < 4096; i++)                                           /* the tail must be erased */
+                {
+                    if (kv->buf[i] != 0xFF)
+                    {
+                        break;                                                         /* break */
+                    }
+                }
+                if (i != 4096)                                                         /* torn tail */
+                {
+                    sector[s].dead = (uint16_t)(sector[s].dead + 4096 - off);          /* dead */
+                    off = 4096;                                                        /* close */
+                }
+                
+                break;                                                                 /* break */
+            }
+            if (_w25qxx_kv_record_check(p, 4096 - off, &size) != 0)                    /* torn record */
+            {
+                sector[s].dead = (uint16_t)(sector[s].dead + 4096 - off);              /* dead */
+                off = 4096;                                                            /* close */
+                
+                break;                                                                 /* break */
+            }
+            seq = _w25qxx_get32(&p[4]);                                                /* get sequence */
+            if (seq > kv->seq)                                                         /* check sequence */
+            {
+                kv->seq = seq;                                                         /* set sequence */
+            }
+            if (seq < sector[s].first_seq)                                             /* check first */
+            {
+                sector[s].first_seq = seq;                                             /* set first */
+            }
+            addr = ((first + s) * 4096 + off) |
+                   ((p[1] == W25QXX_KV_TYPE_DELETE) ? W25QXX_KV_DELETED : 0);          /* record address */
+            hash = _w25qxx_kv_hash(&p[W25QXX_KV_RECORD_HEADER], p[0]);                 /* get hash */
+            check = _w25qxx_kv_check(&p[W25QXX_KV_RECORD_HEADER], p[0]);               /* get check */
+            res = _w25qxx_kv_lookup(kv, hash, check, &slot);                           /* find the key */
+            if (res == 0)                                                              /* found */
+            {
+                if (entry[slot].seq < seq)                                             /* newer */
+                {
+                    sector[_w25qxx_kv_sector(kv, entry[slot].addr)].dead += entry[slot].size;    /* old is dead */
+                    entry[slot].addr = addr;                                           /* replace */
+                    entry[slot].seq = seq;                                             /* set sequence */
+                    entry[slot].size = (uint16_t)size;                                 /* set size */
+                }
+                else
+                {
+                    sector[s].dead += (uint16_t)size;                                  /* this is dead */
+                }
+            }
+            else
+            {
+                if (slot == entry_num)                                                 /* check index */
+                {
+                    handle->debug_print("w25qxx: kv index is full.\n");                /* kv index is full */
+                    
+                    return 6;                                                          /* return error */
+                }
+                entry[slot].hash = hash;                                               /* set hash */
+                entry[slot].check = check;                                             /* set check */
+                entry[slot].addr = addr;                                               /* set address */
+                entry[slot].seq = seq;                                                 /* set sequence */
+                entry[slot].size = (uint16_t)size;                                     /* set size */
+            }
+            off += size;                                                               /* next record */
+        }
+        sector[s].used = (uint16_t)off;                                                /* set used */
+    }
+    
+    for (i = 0; i < entry_num; i++)                                                    /* all entries */
+    {
+        if ((entry[i].addr == W25QXX_KV_EMPTY) || (entry[i].addr == W25QXX_KV_REMOVED))           /* check entry */
+        {
+            continue;                                                                  /* next */
+        }
+        if ((entry[i].addr & W25QXX_KV_DELETED) != 0)                                  /* deleted key */
+        {
+            sector[_w25qxx_kv_sector(kv, entry[i].addr)].dead += entry[i].size;        /* tombstones are dead */
+            entry[i].addr = W25QXX_KV_REMOVED;                                         /* remove */
+        }
+        else
+        {
+            kv->count++;                                                               /* count++ */
+        }
+    }
+    for (s = 0; s < num; s++)                                                          /* pick the append sector */
+    {
+        if ((sector[s].state == W25QXX_KV_SECTOR_USED) && (sector[s].used < 4096) &&
+            ((kv->active == num) || (sector[s].first_seq > sector[kv->active].first_seq)))          /* the newest open sector */
+        {
+            kv->active = s;                                                            /* set active */
+        }
+    }
+    for (s = 0; s < num; s++)                                                          /* close the others */
+    {
+        if ((sector[s].state == W25QXX_KV_SECTOR_USED) && (s != kv->active) && (sector[s].used < 4096))
+        {
+            sector[s].dead = (uint16_t)(sector[s].dead + 4096 - sector[s].used);       /* the tail is dead */
+            sector[s].used = 4096;                                                     /* close */
+        }
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     unmount the kv store
+ * @param[in] *kv points to a w25qxx kv structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 kv is NULL
+ * @note      every put is already durable, nothing is flushed
+ */
+uint8_t w25qxx_kv_unmount(w25qxx_kv_t *kv)
+{
+    if ((kv == NULL) || (kv->handle == NULL))                                          /* check kv */
+    {
+        return 2;                                                                      /* return error */
+    }
+    
+    kv->handle = NULL;                                                                 /* clear handle */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief         get a value
+ * @param[in]     *kv points to a w25qxx kv structure
+ * @param[in]     *key points to a key string
+ * @param[out]    *value points to a value buffer
+ * @param[in,out] *len points to a length buffer, the buffer size in and the value length out
+ * @return        status code
+ *                - 0 success
+ *                - 1 get failed
+ *                - 2 kv is NULL
+ *                - 4 param is invalid
+ *                - 5 key is not found
+ * @note          one index probe and one record read, the key is checked on the read record
+ */
+uint8_t w25qxx_kv_get(w25qxx_kv_t *kv, const char *key, uint8_t *value, uint16_t *len)
+{
+    uint8_t res;
+    uint32_t key_len;
+    uint32_t slot;
+    uint32_t value_len;
+    
+    if ((kv == NULL) || (kv->handle == NULL))                                          /* check kv */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if ((key == NULL) || (value == NULL) || (len == NULL))                             /* check param */
+    {
+        return 4;                                                                      /* return error */
+    }
+    key_len = (uint32_t)strlen(key);                                                   /* get key length */
+    if ((key_len == 0) || (key_len > W25QXX_KV_KEY_MAX))                               /* check key */
+    {
+        kv->handle->debug_print("w25qxx: key is invalid.\n");                          /* key is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    res = _w25qxx_kv_lookup(kv, _w25qxx_kv_hash((const uint8_t *)key, key_len), 
+                            _w25qxx_kv_check((const uint8_t *)key, key_len), &slot);   /* find the key */
+    if (res != 0)
+    {
+        return res;                                                                    /* return error */
+    }
+    value_len = kv->entry[slot].size - W25QXX_KV_RECORD_HEADER - key_len;             /* get value length */
+    if (value_len > *len)                                                              /* check buffer */
+    {
+        kv->handle->debug_print("w25qxx: buffer is too small.\n");                     /* buffer is too small */
+        *len = (uint16_t)value_len;                                                    /* needed length */
+        
+        return 4;                                                                      /* return error */
+    }
+    if (w25qxx_read(kv->handle, kv->entry[slot].addr, kv->buf, kv->entry[slot].size) != 0)     /* read record */
+    {
+        kv->handle->debug_print("w25qxx: kv read failed.\n");                          /* kv read failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    if ((kv->buf[0] != key_len) || (memcmp(&kv->buf[W25QXX_KV_RECORD_HEADER], key, key_len) != 0))   /* check key */
+    {
+        kv->handle->debug_print("w25qxx: kv key check failed.\n");                     /* kv key check failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    memcpy(value, &kv->buf[W25QXX_KV_RECORD_HEADER + key_len], value_len);             /* copy value */
+    *len = (uint16_t)value_len;                                                        /* set length */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     put a value
+ * @param[in] *kv points to a w25qxx kv structure
+ * @param[in] *key points to a key string
+ * @param[in] *value points to a value buffer
+ * @param[in] len is the value length
+ * @return    status code
+ *            - 0 success
+ *            - 1 put failed
+ *            - 2 kv is NULL
+ *            - 4 param is invalid
+ *            - 5 store is full
+ *            - 6 index is full
+ * @note      the record is appended with one page program, or two if it crosses a page
+ */
+uint8_t w25qxx_kv_put(w25qxx_kv_t *kv, const char *key, const uint8_t *value, uint16_t len)
+{
+    uint8_t res;
+    uint8_t found;
+    uint8_t header[W25QXX_KV_RECORD_HEADER];
+    uint32_t key_len;
+    uint32_t hash;
+    uint32_t check;
+    uint32_t slot;
+    uint32_t addr;
+    const uint8_t *seg[3];
+    uint32_t seg_len[3];
+    
+    if ((kv == NULL) || (kv->handle == NULL))                                          /* check kv */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if ((key == NULL) || ((value == NULL) && (len != 0)))                              /* check param */
+    {
+        return 4;                                                                      /* return error */
+    }
+    key_len = (uint32_t)strlen(key);                                                   /* get key length */
+    if ((key_len == 0) || (key_len > W25QXX_KV_KEY_MAX) || (len > W25QXX_KV_VALUE_MAX))          /* check length */
+    {
+        kv->handle->debug_print("w25qxx: key or value is invalid.\n");                 /* key or value is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    res = _w25qxx_kv_reserve(kv, W25QXX_KV_RECORD_HEADER + key_len + len);             /* make room */
+    if (res != 0)
+    {
+        return res;                                                                    /* return error */
+    }
+    hash = _w25qxx_kv_hash((const uint8_t *)key, key_len);                             /* get hash */
+    check = _w25qxx_kv_check((const uint8_t *)key, key_len);                           /* get check */
+    res = _w25qxx_kv_lookup(kv, hash, check, &slot);                                   /* find the key */
+    if ((res == 5) && ((slot == kv->entry_num) || (kv->count + 1 >= kv->entry_num)))  /* check index */
+    {
+        kv->handle->debug_print("w25qxx: kv index is full.\n");                        /* kv index is full */
+        
+        return 6;                                                                      /* return error */
+    }
+    header[0] = (uint8_t)key_len;                                                      /* set key length */
+    header[1] = W25QXX_KV_TYPE_PUT;                                                    /* set type */
+    header[2] = (uint8_t)(len >> 0);                                                   /* set value length */
+    header[3] = (uint8_t)(len >> 8);                                                   /* set value length */
+    _w25qxx_put32(&header[4], kv->seq + 1);                                            /* set sequence */
+    _w25qxx_put32(&header[8], _w25qxx_kv_record_crc(header, (const uint8_t *)key, value));         /* set crc */
+    seg[0] = header;                                                                   /* header */
+    seg_len[0] = W25QXX_KV_RECORD_HEADER;                                              /* header length */
+    seg[1] = (const uint8_t *)key;                                                     /* key */
+    seg_len[1] = key_len;                                                              /* key length */
+    seg[2] = value;                                                                    /* value */
+    seg_len[2] = len;                                                                  /* value length */
+    found = (res == 0) ? 1 : 0;                                                        /* save the lookup */
+    res = _w25qxx_kv_append(kv, seg, seg_len, 3, &addr);                               /* append */
+    if (res != 0)
+    {
+        return 1;                                                                      /* return error */
+    }
+    kv->seq++;                                                                         /* sequence++ */
+    if (found != 0)                                                                    /* update */
+    {
+        kv->sector[_w25qxx_kv_sector(kv, kv->entry[slot].addr)].dead += kv->entry[slot].size;   /* old is dead */
+    }
+    else
+    {
+        kv->entry[slot].hash = hash;                                                   /* set hash */
+        kv->entry[slot].check = check;                                                 /* set check */
+        kv->count++;                                                                   /* count++ */
+    }
+    kv->entry[slot].addr = addr;                                                       /* set address */
+    kv->entry[slot].seq = kv->seq;                                                     /* set sequence */
+    kv->entry[slot].size = (uint16_t)(W25QXX_KV_RECORD_HEADER + key_len + len);        /* set size */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     delete a key
+ * @param[in] *kv points to a w25qxx kv structure
+ * @param[in] *key points to a key string
+ * @return    status code
+ *            - 0 success
+ *            - 1 delete failed
+ *            - 2 kv is NULL
+ *            - 4 param is invalid
+ *            - 5 key is not found
+ * @note      a tombstone record is appended
+ */
+uint8_t w25qxx_kv_delete(w25qxx_kv_t *kv, const char *key)
+{
+    uint8_t res;
+    uint8_t header[W25QXX_KV_RECORD_HEADER];
+    uint32_t key_len;
+    uint32_t slot;
+    uint32_t addr;
+    const uint8_t *seg[2];
+    uint32_t seg_len[2];
+    
+    if ((kv == NULL) || (kv->handle == NULL))                                          /* check kv */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if (key == NULL)                                                                   /* check param */
+    {
+        return 4;                                                                      /* return error */
+    }
+    key_len = (uint32_t)strlen(key);                                                   /* get key length */
+    if ((key_len == 0) || (key_len > W25QXX_KV_KEY_MAX))                               /* check key */
+    {
+        kv->handle->debug_print("w25qxx: key is invalid.\n");                          /* key is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    res = _w25qxx_kv_reserve(kv, W25QXX_KV_RECORD_HEADER + key_len);                  /* make room */
+    if (res != 0)
+    {
+        return res;                                                                    /* return error */
+    }
+    res = _w25qxx_kv_lookup(kv, _w25qxx_kv_hash((const uint8_t *)key, key_len), 
+                            _w25qxx_kv_check((const uint8_t *)key, key_len), &slot);   /* find the key */
+    if (res != 0)
+    {
+        return res;                                                                    /* return error */
+    }
+    header[0] = (uint8_t)key_len;                                                      /* set key length */
+    header[1] = W25QXX_KV_TYPE_DELETE;                                                 /* set type */
+    header[2] = 0;                                                                     /* no value */
+    header[3] = 0;                                                                     /* no value */
+    _w25qxx_put32(&header[4], kv->seq + 1);                                            /* set sequence */
+    _w25qxx_put32(&header[8], _w25qxx_kv_record_crc(header, (const uint8_t *)key, NULL));          /* set crc */
+    seg[0] = header;                                                                   /* header */
+    seg_len[0] = W25QXX_KV_RECORD_HEADER;                                              /* header length */
+    seg[1] = (const uint8_t *)key;                                                     /* key */
+    seg_len[1] = key_len;                                                              /* key length */
+    res = _w25qxx_kv_append(kv, seg, seg_len, 2, &addr);                               /* append */
+    if (res != 0)
+    {
+        return 1;                                                                      /* return error */
+    }
+    kv->seq++;                                                                         /* sequence++ */
+    kv->sector[_w25qxx_kv_sector(kv, kv->entry[slot].addr)].dead += kv->entry[slot].size;       /* old is dead */
+    kv->sector[_w25qxx_kv_sector(kv, addr)].dead += (uint16_t)(W25QXX_KV_RECORD_HEADER + key_len);   /* tombstones are dead */
+    kv->entry[slot].addr = W25QXX_KV_REMOVED;                                          /* remove */
+    kv->count--;                                                                       /* count-- */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     run one background compaction
+ * @param[in] *kv points to a w25qxx kv structure
+ * @return    status code
+ *            - 0 one sector compacted
+ *            - 1 compaction failed
+ *            - 2 kv is NULL
+ *            - 6 nothing to do
+ * @note      the sector with the most dead bytes is compacted if it has at least
+ *            W25QXX_KV_COMPACT_DEAD dead bytes
+ */
+uint8_t w25qxx_kv_compact(w25qxx_kv_t *kv)
+{
+    if ((kv == NULL) || (kv->handle == NULL))                                          /* check kv */
+    {
+        return 2;                                                                      /* return error */
+    }
+    
+    return _w25qxx_kv_compact_step(kv, 0);                                             /* background compaction */
+}
+
+/**
+ * @brief      get the kv info
+ * @param[in]  *kv points to a w25qxx kv structure
+ * @param[out] *info points to a w25qxx kv info structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 kv is NULL
+ * @note       none
+ */
+uint8_t w25qxx_kv_get_info(w25qxx_kv_t *kv, w25qxx_kv_info_t *info)
+{
+    uint32_t s;
+    
+    if ((kv == NULL) || (kv->handle == NULL) || (info == NULL))                        /* check kv */
+    {
+        return 2;                                                                      /* return error */
+    }
+    
+    memset(info, 0, sizeof(w25qxx_kv_info_t));                                         /* clear info */
+    info->count = kv->count;                                                           /* set count */
+    info->free_sector = kv->free_num;                                                  /* set free */
+    for (s = 0; s < kv->num; s++)                                                      /* all sectors */
+    {
+        if (kv->sector[s].state != W25QXX_KV_SECTOR_USED)                              /* check used */
+        {
+            continue;                                                                  /* next */
+        }
+        info->dead += kv->sector[s].dead;                                              /* dead */
+        info->live += kv->sector[s].used - W25QXX_KV_SECTOR_HEADER - kv->sector[s].dead;           /* live */
+    }
+    info->compaction = kv->compaction;                                                 /* set compaction */
+    
+    return 0;                                                                          /* success return 0 */
+}
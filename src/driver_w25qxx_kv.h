@@ -0,0 +1,232 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_kv.h
+ * @brief     driver w25qxx kv header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DRIVER_W25QXX_KV_H_
+#define _DRIVER_W25QXX_KV_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup w25qxx_kv_driver w25qxx kv driver function
+ * @brief    w25qxx kv driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+/**
+ * @brief w25qxx kv limit definition
+ */
+#ifndef W25QXX_KV_KEY_MAX
+    #define W25QXX_KV_KEY_MAX         32            /**< max key length */
+#endif
+#ifndef W25QXX_KV_VALUE_MAX
+    #define W25QXX_KV_VALUE_MAX       1024          /**< max value length */
+#endif
+#ifndef W25QXX_KV_COMPACT_DEAD
+    #define W25QXX_KV_COMPACT_DEAD    1024          /**< dead bytes that make a sector worth a background compaction */
+#endif
+
+/**
+ * @brief w25qxx kv index entry structure definition
+ */
+typedef struct w25qxx_kv_entry_s
+{
+    uint32_t hash;        /**< key hash */
+    uint32_t check;       /**< key crc, tells keys with the same hash apart */
+    uint32_t addr;        /**< record address */
+    uint32_t seq;         /**< record sequence */
+    uint16_t size;        /**< record size */
+} w25qxx_kv_entry_t;
+
+/**
+ * @brief w25qxx kv sector structure definition
+ */
+typedef struct w25qxx_kv_sector_s
+{
+    uint32_t first_seq;        /**< sequence of the first record */
+    uint16_t used;             /**< append offset */
+    uint16_t dead;             /**< dead bytes */
+    uint8_t state;             /**< sector state */
+} w25qxx_kv_sector_t;
+
+/**
+ * @brief w25qxx kv structure definition
+ */
+typedef struct w25qxx_kv_s
+{
+    w25qxx_handle_t *handle;            /**< w25qxx handle */
+    w25qxx_kv_entry_t *entry;           /**< hash index */
+    uint32_t entry_num;                 /**< hash index length, power of 2 */
+    w25qxx_kv_sector_t *sector;         /**< sector table */
+    uint32_t first;                     /**< first 4k sector */
+    uint32_t num;                       /**< sector number */
+    uint32_t seq;                       /**< last record sequence */
+    uint32_t active;                    /**< append sector, num if none */
+    uint32_t free_num;                  /**< free sector number */
+    uint32_t count;                     /**< key number */
+    uint32_t compaction;                /**< compaction times */
+    uint8_t page[256];                  /**< page buffer */
+    uint8_t buf[4096];                  /**< sector buffer */
+} w25qxx_kv_t;
+
+/**
+ * @brief w25qxx kv info structure definition
+ */
+typedef struct w25qxx_kv_info_s
+{
+    uint32_t count;              /**< key number */
+    uint32_t free_sector;        /**< free sectors */
+    uint32_t live;               /**< live bytes */
+    uint32_t dead;               /**< dead bytes */
+    uint32_t compaction;         /**< compaction times */
+} w25qxx_kv_info_t;
+
+/**
+ * @brief     mount the kv store
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *kv points to a w25qxx kv structure
+ * @param[in] *entry points to a hash index table
+ * @param[in] entry_num is the hash index length, a power of 2 larger than the key number
+ * @param[in] *sector points to a table of num entries
+ * @param[in] first is the first 4k sector
+ * @param[in] num is the sector number
+ * @return    status code
+ *            - 0 success
+ *            - 1 mount failed
+ *            - 2 handle or kv is NULL
+ *            - 3 handle is not initialized
+ *            - 4 param is invalid
+ *            - 6 index is full
+ * @note      every sector is read once with a 4k read and nothing else is read, a torn
+ *            record closes its sector
+ */
+uint8_t w25qxx_kv_mount(w25qxx_handle_t *handle, w25qxx_kv_t *kv, w25qxx_kv_entry_t *entry, uint32_t entry_num,
+                        w25qxx_kv_sector_t *sector, uint32_t first, uint32_t num);
+
+/**
+ * @brief     unmount the kv store
+ * @param[in] *kv points to a w25qxx kv structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 kv is NULL
+ * @note      every put is already durable, nothing is flushed
+ */
+uint8_t w25qxx_kv_unmount(w25qxx_kv_t *kv);
+
+/**
+ * @brief         get a value
+ * @param[in]     *kv points to a w25qxx kv structure
+ * @param[in]     *key points to a key string
+ * @param[out]    *value points to a value buffer
+ * @param[in,out] *len points to a length buffer, the buffer size in and the value length out
+ * @return        status code
+ *                - 0 success
+ *                - 1 get failed
+ *                - 2 kv is NULL
+ *                - 4 param is invalid
+ *                - 5 key is not found
+ * @note          one index probe and one value read
+ */
+uint8_t w25qxx_kv_get(w25qxx_kv_t *kv, const char *key, uint8_t *value, uint16_t *len);
+
+/**
+ * @brief     put a value
+ * @param[in] *kv points to a w25qxx kv structure
+ * @param[in] *key points to a key string
+ * @param[in] *value points to a value buffer
+ * @param[in] len is the value length
+ * @return    status code
+ *            - 0 success
+ *            - 1 put failed
+ *            - 2 kv is NULL
+ *            - 4 param is invalid
+ *            - 5 store is full
+ *            - 6 index is full
+ * @note      the record is appended with one page program, or two if it crosses a page
+ */
+uint8_t w25qxx_kv_put(w25qxx_kv_t *kv, const char *key, const uint8_t *value, uint16_t len);
+
+/**
+ * @brief     delete a key
+ * @param[in] *kv points to a w25qxx kv structure
+ * @param[in] *key points to a key string
+ * @return    status code
+ *            - 0 success
+ *            - 1 delete failed
+ *            - 2 kv is NULL
+ *            - 4 param is invalid
+ *            - 5 key is not found
+ * @note      a tombstone record is appended
+ */
+uint8_t w25qxx_kv_delete(w25qxx_kv_t *kv, const char *key);
+
+/**
+ * @brief     run one background compaction
+ * @param[in] *kv points to a w25qxx kv structure
+ * @return    status code
+ *            - 0 one sector compacted
+ *            - 1 compaction failed
+ *            - 2 kv is NULL
+ *            - 6 nothing to do
+ * @note      the sector with the most dead bytes is compacted if it has at least
+ *            W25QXX_KV_COMPACT_DEAD dead bytes
+ */
+uint8_t w25qxx_kv_compact(w25qxx_kv_t *kv);
+
+/**
+ * @brief      get the kv info
+ * @param[in]  *kv points to a w25qxx kv structure
+ * @param[out] *info points to a w25qxx kv info structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 kv is NULL
+ * @note       none
+ */
+uint8_t w25qxx_kv_get_info(w25qxx_kv_t *kv, w25qxx_kv_info_t *info);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
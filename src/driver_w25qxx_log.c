@@ -0,0 +1,596 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_log.c
+ * @brief     driver w25qxx log source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_log.h"
+
+/**
+ * @brief log page status definition
+ */
+#define W25QXX_LOG_PAGE_VALID        0        /**< valid page */
+#define W25QXX_LOG_PAGE_ERROR        1        /**< read failed */
+#define W25QXX_LOG_PAGE_ERASED       5        /**< erased page */
+#define W25QXX_LOG_PAGE_INVALID      6        /**< torn or foreign page */
+
+/**
+ * @brief     crc16 update
+ * @param[in] crc is the current crc
+ * @param[in] *buf points to a data buffer
+ * @param[in] len is the data length
+ * @return    updated crc
+ * @note      ccitt 0x1021, start with 0xFFFF
+ */
+static uint16_t _w25qxx_log_crc16(uint16_t crc, const uint8_t *buf, uint32_t len)
+{
+    uint32_t i;
+    uint8_t j;
+    
+    for (i = 0; i < len; i++)                                                          /* all bytes */
+    {
+        crc ^= (uint16_t)(buf[i] << 8);                                                /* xor the byte */
+        for (j = 0; j < 8; j++)                                                        /* 8 bits */
+        {
+            crc = (crc & 0x8000U) ? (uint16_t)((crc << 1) ^ 0x1021U) : (uint16_t)(crc << 1);   /* shift */
+        }
+    }
+    
+    return crc;                                                                        /* return crc */
+}
+
+/**
+ * @brief     get the address of a page
+ * @param[in] *log points to a w25qxx log structure
+ * @param[in] s is the sector index
+ * @param[in] page is the page index
+ * @return    flash address
+ * @note      none
+ */
+static uint32_t _w25qxx_log_addr(w25qxx_log_t *log, uint32_t s, uint32_t page)
+{
+    return (log->first + s) * 4096 + page * 256;                                       /* get address */
+}
+
+/**
+ * @brief      read and check a page
+ * @param[in]  *log points to a w25qxx log structure
+ * @param[in]  s is the sector index
+ * @param[in]  page is the page index
+ * @param[out] *buf points to a page buffer
+ * @param[out] *seq points to a sequence buffer
+ * @return     page status
+ * @note       none
+ */
+static uint8_t _w25qxx_log_page_read(w25qxx_log_t *log, uint32_t s, uint32_t page, uint8_t *buf, uint32_t *seq)
+{
+    uint16_t len;
+    uint16_t crc;
+    
+    if (w25qxx_read(log->handle, _w25qxx_log_addr(log, s, page), buf, 256) != 0)      /* read page */
+    {
+        log->handle->debug_print("w25qxx: log read failed.\n");                        /* log read failed */
+        
+        return W25QXX_LOG_PAGE_ERROR;                                                  /* return error */
+    }
+    *seq = (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | 
+           ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);                         /* get sequence */
+    len = (uint16_t)(buf[4] | (buf[5] << 8));                                          /* get length */
+    crc = (uint16_t)(buf[6] | (buf[7] << 8));                                          /* get crc */
+    if ((*seq == 0xFFFFFFFFU) && (len == 0xFFFF) && (crc == 0xFFFF))                   /* check erased */
+    {
+        return W25QXX_LOG_PAGE_ERASED;                                                 /* erased */
+    }
+    if ((len > W25QXX_LOG_PAYLOAD) || 
+        (_w25qxx_log_crc16(_w25qxx_log_crc16(0xFFFF, buf, 6), &buf[W25QXX_LOG_PAGE_HEADER], len) != crc))   /* check crc */
+    {
+        return W25QXX_LOG_PAGE_INVALID;                                                /* invalid */
+    }
+    
+    return W25QXX_LOG_PAGE_VALID;                                                      /* valid */
+}
+
+/**
+ * @brief     erase a sector of the ring
+ * @param[in] *log points to a w25qxx log structure
+ * @param[in] s is the sector index
+ * @return    status code
+ *            - 0 success
+ *            - 1 erase failed
+ * @note      the tail moves on when its sector is erased
+ */
+static uint8_t _w25qxx_log_erase(w25qxx_log_t *log, uint32_t s)
+{
+    if (w25qxx_sector_erase_4k(log->handle, _w25qxx_log_addr(log, s, 0)) != 0)        /* erase sector */
+    {
+        log->handle->debug_print("w25qxx: log erase failed.\n");                       /* log erase failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    log->erase++;                                                                      /* erase++ */
+    if ((log->empty == 0) && (log->tail_sector == s))                                  /* oldest data is lost */
+    {
+        log->tail_sector = (s + 1) % log->num;                                         /* move the tail */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     mount the log
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *log points to a w25qxx log structure
+ * @param[in] first is the first 4k sector
+ * @param[in] num is the sector number
+ * @return    status code
+ *            - 0 success
+ *            - 1 mount failed
+ *            - 2 handle or log is NULL
+ *            - 3 handle is not initialized
+ *            - 4 param is invalid
+ * @note      head and tail are found by binary search on the page sequences,
+ *            a blank or foreign region mounts as an empty log
+ */
+uint8_t w25qxx_log_mount(w25qxx_handle_t *handle, w25qxx_log_t *log, uint32_t first, uint32_t num)
+{
+    uint8_t res;
+    uint32_t i;
+    uint32_t origin;
+    uint32_t origin_seq;
+    uint32_t seq;
+    uint32_t lo;
+    uint32_t hi;
+    uint32_t mid;
+    uint32_t head_seq;
+    
+    if ((handle == NULL) || (log == NULL))                                             /* check handle */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if (handle->inited != 1)                                                           /* check handle initialization */
+    {
+        return 3;                                                                      /* return error */
+    }
+    if (num < 2)                                                                       /* check param */
+    {
+        handle->debug_print("w25qxx: log param is invalid.\n");                        /* log param is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    memset(log, 0, sizeof(w25qxx_log_t));                                              /* clear the structure */
+    log->handle = handle;                                                              /* set handle */
+    log->first = first;                                                                /* set first */
+    log->num = num;                                                                    /* set number */
+    
+    /* the erased gap before the tail is at most two sectors long */
+    origin = num;                                                                      /* no origin */
+    origin_seq = 0;                                                                    /* init 0 */
+    for (i = 0; (i < 3) && (i < num); i++)                                             /* find the first written sector */
+    {
+        res = _w25qxx_log_page_read(log, i, 0, log->page, &seq);                       /* read the first page */
+        if (res == W25QXX_LOG_PAGE_ERROR)
+        {
+            return 1;                                                                  /* return error */
+        }
+        if (res == W25QXX_LOG_PAGE_VALID)                                              /* check valid */
+        {
+            origin = i;                                                                /* set origin */
+            origin_seq = seq;                                                          /* set origin sequence */
+            
+            break;                                                                     /* break */
+        }
+    }
+    if (origin == num)                                                                 /* empty log */
+    {
+        log->empty = 1;                                                                /* empty */
+        
+        return 0;                                                                      /* success return 0 */
+    }
+    
+    /* sectors from the origin are increasing up to the head, then erased or older */
+    lo = origin;                                                                       /* the origin is newer or equal */
+    hi = num - 1;                                                                      /* last sector */
+    while (lo < hi)                                                                    /* binary search */
+    {
+        mid = (lo + hi + 1) / 2;                                                       /* upper middle */
+        res = _w25qxx_log_page_read(log, mid, 0, log->page, &seq);                     /* read the first page */
+        if (res == W25QXX_LOG_PAGE_ERROR)
+        {
+            return 1;                                                                  /* return error */
+        }
+        if ((res == W25QXX_LOG_PAGE_VALID) && (seq >= origin_seq))                     /* same run */
+        {
+            lo = mid;                                                                  /* go right */
+        }
+        else
+        {
+            hi = mid - 1;                                                              /* go left */
+        }
+    }
+    log->head_sector = lo;                                                             /* the newest sector */
+    res = _w25qxx_log_page_read(log, lo, 0, log->page, &head_seq);                     /* get its sequence */
+    if (res != W25QXX_LOG_PAGE_VALID)
+    {
+        return 1;                                                                      /* return error */
+    }
+    
+    /* pages are written in order, find the first erased one */
+    lo = 1;                                                                            /* page 0 is written */
+    hi = 16;                                                                           /* 16 means full */
+    while (lo < hi)                                                                    /* binary search */
+    {
+        mid = (lo + hi) / 2;                                                           /* lower middle */
+        if (w25qxx_read(handle, _w25qxx_log_addr(log, log->head_sector, mid), 
+                        log->page, W25QXX_LOG_PAGE_HEADER) != 0)                       /* read header */
+        {
+            handle->debug_print("w25qxx: log read failed.\n");                         /* log read failed */
+            
+            return 1;                                                                  /* return error */
+        }
+        for (i = 0; (i < W25QXX_LOG_PAGE_HEADER) && (log->page[i] == 0xFF); i++)       /* check erased */
+        {
+            
+        }
+        if (i == W25QXX_LOG_PAGE_HEADER)                                               /* erased */
+        {
+            hi = mid;                                                                  /* go left */
+        }
+        else
+        {
+            lo = mid + 1;                                                              /* go right */
+        }
+    }
+    log->seq = head_seq + lo;                                                          /* next sequence */
+    
+    /* the tail is the first written sector after the gap */
+    log->tail_sector = origin;                                                         /* default */
+    if (origin == 0)                                                                   /* the ring wrapped */
+    {
+        for (i = 1; i <= 3; i++)                                                       /* skip the gap */
+        {
+            mid = (log->head_sector + i) % num;                                        /* next sector */
+            if (mid == log->head_sector)                                               /* back to the head */
+            {
+                break;                                                                 /* break */
+            }
+            res = _w25qxx_log_page_read(log, mid, 0, log->page, &seq);                 /* read the first page */
+            if (res == W25QXX_LOG_PAGE_ERROR)
+            {
+                return 1;                                                              /* return error */
+            }
+            if (res == W25QXX_LOG_PAGE_VALID)                                          /* check valid */
+            {
+                log->tail_sector = mid;                                                /* set tail */
+                
+                break;                                                                 /* break */
+            }
+        }
+    }
+    if (lo == 16)                                                                      /* the head sector is full */
+    {
+        log->head_sector = (log->head_sector + 1) % num;                               /* next sector */
+        log->head_page = 0;                                                            /* erased before use */
+    }
+    else
+    {
+        log->head_page = (uint8_t)lo;                                                  /* set head page */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     flush and unmount the log
+ * @param[in] *log points to a w25qxx log structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 log is NULL
+ * @note      none
+ */
+uint8_t w25qxx_log_unmount(w25qxx_log_t *log)
+{
+    uint8_t res;
+    
+    if ((log == NULL) || (log->handle == NULL))                                        /* check log */
+    {
+        return 2;                                                                      /* return error */
+    }
+    
+    res = w25qxx_log_flush(log);                                                       /* flush */
+    if (res != 0)
+    {
+        return res;                                                                    /* return error */
+    }
+    log->handle = NULL;                                                                /* clear handle */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     append a record
+ * @param[in] *log points to a w25qxx log structure
+ * @param[in] *data points to a data buffer
+ * @param[in] len is the data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 append failed
+ *            - 2 log is NULL
+ *            - 4 len is invalid
+ * @note      records are packed in ram and programmed a whole page at a time,
+ *            the oldest sector is erased when the head needs it
+ */
+uint8_t w25qxx_log_append(w25qxx_log_t *log, const uint8_t *data, uint16_t len)
+{
+    uint8_t res;
+    
+    if ((log == NULL) || (log->handle == NULL))                                        /* check log */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if ((len > W25QXX_LOG_RECORD_MAX) || ((data == NULL) && (len != 0)))               /* check len */
+    {
+        log->handle->debug_print("w25qxx: len is invalid.\n");                         /* len is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    if (log->fill + 2 + len > W25QXX_LOG_PAYLOAD)                                      /* check room */
+    {
+        res = w25qxx_log_flush(log);                                                   /* program the page */
+        if (res != 0)
+        {
+            return res;                                                                /* return error */
+        }
+    }
+    log->page[W25QXX_LOG_PAGE_HEADER + log->fill + 0] = (uint8_t)(len >> 0);           /* set length */
+    log->page[W25QXX_LOG_PAGE_HEADER + log->fill + 1] = (uint8_t)(len >> 8);           /* set length */
+    memcpy(&log->page[W25QXX_LOG_PAGE_HEADER + log->fill + 2], data, len);             /* copy data */
+    log->fill = (uint16_t)(log->fill + 2 + len);                                       /* fill */
+    if (log->fill + 2 >= W25QXX_LOG_PAYLOAD)                                           /* no room for another record */
+    {
+        return w25qxx_log_flush(log);                                                  /* program the page */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     program the buffered records
+ * @param[in] *log points to a w25qxx log structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 log is NULL
+ * @note      a partial page is programmed and the next record starts a new page
+ */
+uint8_t w25qxx_log_flush(w25qxx_log_t *log)
+{
+    uint16_t crc;
+    
+    if ((log == NULL) || (log->handle == NULL))                                        /* check log */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if (log->fill == 0)                                                                /* nothing buffered */
+    {
+        return 0;                                                                      /* success return 0 */
+    }
+    
+    if (log->head_page == 0)                                                           /* first page of a sector */
+    {
+        if (log->ahead_erased == 0)                                                    /* not prepared */
+        {
+            if (_w25qxx_log_erase(log, log->head_sector) != 0)                         /* erase the head sector */
+            {
+                return 1;                                                              /* return error */
+            }
+        }
+        log->ahead_erased = 0;                                                         /* the sector after it is not */
+    }
+    log->page[0] = (uint8_t)(log->seq >> 0);                                           /* set sequence */
+    log->page[1] = (uint8_t)(log->seq >> 8);                                           /* set sequence */
+    log->page[2] = (uint8_t)(log->seq >> 16);                                          /* set sequence */
+    log->page[3] = (uint8_t)(log->seq >> 24);                                          /* set sequence */
+    log->page[4] = (uint8_t)(log->fill >> 0);                                          /* set length */
+    log->page[5] = (uint8_t)(log->fill >> 8);                                          /* set length */
+    crc = _w25qxx_log_crc16(_w25qxx_log_crc16(0xFFFF, log->page, 6), 
+                            &log->page[W25QXX_LOG_PAGE_HEADER], log->fill);            /* get crc */
+    log->page[6] = (uint8_t)(crc >> 0);                                                /* set crc */
+    log->page[7] = (uint8_t)(crc >> 8);                                                /* set crc */
+    if (w25qxx_page_program(log->handle, _w25qxx_log_addr(log, log->head_sector, log->head_page), 
+                            log->page, (uint16_t)(W25QXX_LOG_PAGE_HEADER + log->fill)) != 0)       /* program page */
+    {
+        log->handle->debug_print("w25qxx: log program failed.\n");                     /* log program failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    if (log->empty != 0)                                                               /* first page */
+    {
+        log->empty = 0;                                                                /* not empty */
+        log->tail_sector = log->head_sector;                                           /* set tail */
+    }
+    log->program++;                                                                    /* program++ */
+    log->seq++;                                                                        /* sequence++ */
+    log->fill = 0;                                                                     /* clear buffer */
+    log->head_page++;                                                                  /* next page */
+    if (log->head_page == 16)                                                          /* sector full */
+    {
+        log->head_sector = (log->head_sector + 1) % log->num;                          /* next sector */
+        log->head_page = 0;                                                            /* first page */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     erase the sector ahead of the head
+ * @param[in] *log points to a w25qxx log structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 erase failed
+ *            - 2 log is NULL
+ *            - 6 nothing to do
+ * @note      call it from the idle loop so appends never wait for an erase
+ */
+uint8_t w25qxx_log_prepare(w25qxx_log_t *log)
+{
+    uint32_t s;
+    
+    if ((log == NULL) || (log->handle == NULL))                                        /* check log */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if (log->ahead_erased != 0)                                                        /* already erased */
+    {
+        return 6;                                                                      /* nothing to do */
+    }
+    
+    s = (log->head_page == 0) ? log->head_sector : ((log->head_sector + 1) % log->num);          /* the next sector to open */
+    if (_w25qxx_log_erase(log, s) != 0)                                                /* erase */
+    {
+        return 1;                                                                      /* return error */
+    }
+    log->ahead_erased = 1;                                                             /* erased */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief      move a cursor to the oldest record
+ * @param[in]  *log points to a w25qxx log structure
+ * @param[out] *cursor points to a w25qxx log cursor structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 log or cursor is NULL
+ * @note       none
+ */
+uint8_t w25qxx_log_rewind(w25qxx_log_t *log, w25qxx_log_cursor_t *cursor)
+{
+    if ((log == NULL) || (log->handle == NULL) || (cursor == NULL))                    /* check log */
+    {
+        return 2;                                                                      /* return error */
+    }
+    
+    cursor->sector = (log->empty != 0) ? log->head_sector : log->tail_sector;          /* oldest sector */
+    cursor->page = (log->empty != 0) ? log->head_page : 0;                             /* first page */
+    cursor->off = 0;                                                                   /* no buffered record */
+    cursor->len = 0;                                                                   /* no buffered record */
+    cursor->started = 0;                                                               /* a full ring starts at the head */
+    cursor->seq = 0xFFFFFFFFU;                                                         /* take the first sequence */
+    cursor->lost = 0;                                                                  /* nothing lost */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief         read the next record
+ * @param[in]     *log points to a w25qxx log structure
+ * @param[in]     *cursor points to a w25qxx log cursor structure
+ * @param[out]    *data points to a data buffer
+ * @param[in,out] *len points to a length buffer, the buffer size in and the record length out
+ * @return        status code
+ *                - 0 success
+ *                - 1 read failed
+ *                - 2 log or cursor is NULL
+ *                - 4 buffer is too small
+ *                - 6 no more record
+ * @note          buffered records are visible after w25qxx_log_flush
+ */
+uint8_t w25qxx_log_read(w25qxx_log_t *log, w25qxx_log_cursor_t *cursor, uint8_t *data, uint16_t *len)
+{
+    uint8_t res;
+    uint16_t record;
+    uint32_t seq;
+    
+    if ((log == NULL) || (log->handle == NULL) || (cursor == NULL) || (len == NULL))   /* check log */
+    {
+        return 2;                                                                      /* return error */
+    }
+    
+    while (1)
+    {
+        if (cursor->off + 2 <= cursor->len)                                            /* buffered record */
+        {
+            record = (uint16_t)(cursor->buf[W25QXX_LOG_PAGE_HEADER + cursor->off] | 
+                                (cursor->buf[W25QXX_LOG_PAGE_HEADER + cursor->off + 1] << 8));      /* get length */
+            if (record > cursor->len - cursor->off - 2)                                /* check length */
+            {
+                cursor->off = cursor->len;                                             /* drop the page */
+                
+                continue;                                                              /* next */
+            }
+            if (record > *len)                                                         /* check buffer */
+            {
+                *len = record;                                                         /* needed length */
+                
+                return 4;                                                              /* return error */
+            }
+            memcpy(data, &cursor->buf[W25QXX_LOG_PAGE_HEADER + cursor->off + 2], record);   /* copy record */
+            cursor->off = (uint16_t)(cursor->off + 2 + record);                        /* next record */
+            *len = record;                                                             /* set length */
+            
+            return 0;                                                                  /* success return 0 */
+        }
+        if ((log->empty != 0) || ((cursor->started != 0) && 
+            (cursor->sector == log->head_sector) && (cursor->page == log->head_page))) /* reach the head */
+        {
+            return 6;                                                                  /* no more record */
+        }
+        res = _w25qxx_log_page_read(log, cursor->sector, cursor->page, cursor->buf, &seq);      /* read page */
+        if (res == W25QXX_LOG_PAGE_ERROR)
+        {
+            return 1;                                                                  /* return error */
+        }
+        cursor->started = 1;                                                           /* started */
+        cursor->page++;                                                                /* next page */
+        if (cursor->page == 16)                                                        /* next sector */
+        {
+            cursor->sector = (cursor->sector + 1) % log->num;                          /* next sector */
+            cursor->page = 0;                                                          /* first page */
+        }
+        cursor->off = 0;                                                               /* first record */
+        cursor->len = 0;                                                               /* no record */
+        if (res != W25QXX_LOG_PAGE_VALID)                                              /* torn or erased page */
+        {
+            continue;                                                                  /* skip */
+        }
+        if ((cursor->seq != 0xFFFFFFFFU) && (seq > cursor->seq))                       /* overwritten pages */
+        {
+            cursor->lost += seq - cursor->seq;                                         /* lost */
+        }
+        cursor->seq = seq + 1;                                                         /* next sequence */
+        cursor->len = (uint16_t)(cursor->buf[4] | (cursor->buf[5] << 8));              /* set length */
+    }
+}
@@ -0,0 +1,197 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_log.h
+ * @brief     driver w25qxx log header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DRIVER_W25QXX_LOG_H_
+#define _DRIVER_W25QXX_LOG_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup w25qxx_log_driver w25qxx log driver function
+ * @brief    w25qxx log driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+/**
+ * @brief w25qxx log page definition
+ * @note  a page is seq[4], len[2], crc[2] and the payload, a record is len[2] and the data
+ */
+#define W25QXX_LOG_PAGE_HEADER       8                                          /**< page header size */
+#define W25QXX_LOG_PAYLOAD           (256 - W25QXX_LOG_PAGE_HEADER)             /**< page payload size */
+#define W25QXX_LOG_RECORD_MAX        (W25QXX_LOG_PAYLOAD - 2)                   /**< max record length */
+
+/**
+ * @brief w25qxx log structure definition
+ */
+typedef struct w25qxx_log_s
+{
+    w25qxx_handle_t *handle;        /**< w25qxx handle */
+    uint32_t first;                 /**< first 4k sector */
+    uint32_t num;                   /**< sector number */
+    uint32_t head_sector;           /**< sector of the next page */
+    uint8_t head_page;              /**< next page in the head sector */
+    uint8_t ahead_erased;           /**< the sector after the head sector is erased */
+    uint8_t empty;                  /**< no page is written */
+    uint32_t tail_sector;           /**< sector of the oldest page */
+    uint32_t seq;                   /**< sequence of the next page */
+    uint16_t fill;                  /**< buffered payload bytes */
+    uint32_t program;               /**< programmed pages */
+    uint32_t erase;                 /**< erased sectors */
+    uint8_t page[256];              /**< page buffer */
+} w25qxx_log_t;
+
+/**
+ * @brief w25qxx log cursor structure definition
+ */
+typedef struct w25qxx_log_cursor_s
+{
+    uint32_t sector;          /**< sector of the next page */
+    uint8_t page;             /**< next page */
+    uint8_t started;          /**< a page was read since the rewind */
+    uint16_t off;             /**< offset in the buffered payload */
+    uint16_t len;             /**< buffered payload length */
+    uint32_t seq;             /**< sequence of the next page */
+    uint32_t lost;            /**< pages overwritten before they were read */
+    uint8_t buf[256];         /**< page buffer */
+} w25qxx_log_cursor_t;
+
+/**
+ * @brief     mount the log
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *log points to a w25qxx log structure
+ * @param[in] first is the first 4k sector
+ * @param[in] num is the sector number
+ * @return    status code
+ *            - 0 success
+ *            - 1 mount failed
+ *            - 2 handle or log is NULL
+ *            - 3 handle is not initialized
+ *            - 4 param is invalid
+ * @note      head and tail are found by binary search on the page sequences,
+ *            a blank or foreign region mounts as an empty log
+ */
+uint8_t w25qxx_log_mount(w25qxx_handle_t *handle, w25qxx_log_t *log, uint32_t first, uint32_t num);
+
+/**
+ * @brief     flush and unmount the log
+ * @param[in] *log points to a w25qxx log structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 log is NULL
+ * @note      none
+ */
+uint8_t w25qxx_log_unmount(w25qxx_log_t *log);
+
+/**
+ * @brief     append a record
+ * @param[in] *log points to a w25qxx log structure
+ * @param[in] *data points to a data buffer
+ * @param[in] len is the data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 append failed
+ *            - 2 log is NULL
+ *            - 4 len is invalid
+ * @note      records are packed in ram and programmed a whole page at a time,
+ *            the oldest sector is erased when the head needs it
+ */
+uint8_t w25qxx_log_append(w25qxx_log_t *log, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief     program the buffered records
+ * @param[in] *log points to a w25qxx log structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 log is NULL
+ * @note      a partial page is programmed and the next record starts a new page
+ */
+uint8_t w25qxx_log_flush(w25qxx_log_t *log);
+
+/**
+ * @brief     erase the sector ahead of the head
+ * @param[in] *log points to a w25qxx log structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 erase failed
+ *            - 2 log is NULL
+ *            - 6 nothing to do
+ * @note      call it from the idle loop so appends never wait for an erase
+ */
+uint8_t w25qxx_log_prepare(w25qxx_log_t *log);
+
+/**
+ * @brief      move a cursor to the oldest record
+ * @param[in]  *log points to a w25qxx log structure
+ * @param[out] *cursor points to a w25qxx log cursor structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 log or cursor is NULL
+ * @note       none
+ */
+uint8_t w25qxx_log_rewind(w25qxx_log_t *log, w25qxx_log_cursor_t *cursor);
+
+/**
+ * @brief         read the next record
+ * @param[in]     *log points to a w25qxx log structure
+ * @param[in]     *cursor points to a w25qxx log cursor structure
+ * @param[out]    *data points to a data buffer
+ * @param[in,out] *len points to a length buffer, the buffer size in and the record length out
+ * @return        status code
+ *                - 0 success
+ *                - 1 read failed
+ *                - 2 log or cursor is NULL
+ *                - 4 buffer is too small
+ *                - 6 no more record
+ * @note          buffered records are visible after w25qxx_log_flush
+ */
+uint8_t w25qxx_log_read(w25qxx_log_t *log, w25qxx_log_cursor_t *cursor, uint8_t *data, uint16_t *len);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,380 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_ring.c
+ * @brief     driver w25qxx ring source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_ring.h"
+
+/**
+ * @brief ring index access definition
+ * @note  acquire loads and release stores order the entries against the indexes,
+ *        compilers without the gnu builtins use the c11 atomics on the same storage
+ */
+#if defined(__GNUC__) || defined(__clang__)
+    #define W25QXX_RING_LOAD(x)            __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+    #define W25QXX_RING_STORE(x, v)        __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+    #include <stdatomic.h>
+    _Static_assert(sizeof(_Atomic uint32_t) == sizeof(uint32_t), "ring index is not a plain uint32_t");
+    #define W25QXX_RING_LOAD(x)            atomic_load_explicit((volatile _Atomic uint32_t *)&(x), memory_order_acquire)
+    #define W25QXX_RING_STORE(x, v)        atomic_store_explicit((volatile _Atomic uint32_t *)&(x), (v), memory_order_release)
+#else
+    #error "driver w25qxx ring needs the gnu atomic builtins or c11 atomics"
+#endif
+
+/**
+ * @brief     post one completion
+ * @param[in] *ring points to a w25qxx ring structure
+ * @param[in] user_data is the submission tag
+ * @param[in] op is the operation
+ * @param[in] res is the status code
+ * @note      the caller checked the free space
+ */
+static void _w25qxx_ring_complete(w25qxx_ring_t *ring, uint32_t user_data, uint8_t op, uint8_t res)
+{
+    w25qxx_ring_cqe_t *cqe;
+    uint32_t tail;
+    
+    tail = ring->cq_tail;                                                                      /* only the worker writes it */
+    cqe = &ring->cq[tail & ring->cq_mask];                                                     /* get the entry */
+    cqe->user_data = user_data;                                                                /* set the tag */
+    cqe->op = op;                                                                              /* set the operation */
+    cqe->res = res;                                                                            /* set the result */
+    W25QXX_RING_STORE(ring->cq_tail, tail + 1);                                                /* publish */
+}
+
+/**
+ * @brief     find an in flight handle
+ * @param[in] *ring points to a w25qxx ring structure
+ * @param[in] *handle points to a w25qxx handle structure, NULL matches any
+ * @return    1 if the handle is in flight, otherwise 0
+ * @note      none
+ */
+static uint8_t _w25qxx_ring_busy(w25qxx_ring_t *ring, w25qxx_handle_t *handle)
+{
+    uint8_t i;
+    
+    for (i = 0; i < ring->inflight_num; i++)                                                   /* all started operations */
+    {
+        if ((handle == NULL) || (ring->inflight[i].handle == handle))                          /* check the handle */
+        {
+            return 1;                                                                          /* return busy */
+        }
+    }
+    
+    return 0;                                                                                  /* return idle */
+}
+
+/**
+ * @brief     run one submission
+ * @param[in] *ring points to a w25qxx ring structure
+ * @param[in] *sqe points to a submission entry
+ * @return    1 if a completion was posted, 0 if the operation was started
+ * @note      none
+ */
+static uint8_t _w25qxx_ring_run(w25qxx_ring_t *ring, w25qxx_ring_sqe_t *sqe)
+{
+    uint8_t res;
+    
+    switch (sqe->op)
+    {
+        case W25QXX_RING_OP_READ :
+        {
+            res = w25qxx_read(sqe->handle, sqe->addr, sqe->buf, sqe->len);                     /* read */
+            
+            break;
+        }
+        case W25QXX_RING_OP_WRITE :
+        {
+            res = w25qxx_write(sqe->handle, sqe->addr, sqe->buf, sqe->len);                    /* read modify write */
+            
+            break;
+        }
+        case W25QXX_RING_OP_PROGRAM :
+        {
+            if (sqe->len > 256)                                                                /* check the length */
+            {
+                res = 4;                                                                       /* crosses a page */
+                
+                break;
+            }
+            res = w25qxx_page_program_start(sqe->handle, sqe->addr, sqe->buf, (uint16_t)sqe->len);  /* start the program */
+            
+            break;
+        }
+        case W25QXX_RING_OP_ERASE :
+        {
+            res = w25qxx_erase_start(sqe->handle, sqe->addr, sqe->len);                        /* start the erase */
+            
+            break;
+        }
+        case W25QXX_RING_OP_FLUSH :
+        {
+            res = 0;                                                                           /* earlier operations are done */
+            
+            break;
+        }
+        default :
+        {
+            res = 4;                                                                           /* invalid operation */
+            
+            break;
+        }
+    }
+    if ((res == 0) && ((sqe->op == W25QXX_RING_OP_PROGRAM) || (sqe->op == W25QXX_RING_OP_ERASE)))  /* started */
+    {
+        ring->inflight[ring->inflight_num].handle = sqe->handle;                               /* set the handle */
+        ring->inflight[ring->inflight_num].user_data = sqe->user_data;                         /* set the tag */
+        ring->inflight[ring->inflight_num].addr = sqe->addr;                                   /* set the address */
+        ring->inflight[ring->inflight_num].len = sqe->len;                                     /* set the length */
+        ring->inflight[ring->inflight_num].op = sqe->op;                                       /* set the operation */
+        ring->inflight_num++;                                                                  /* one more in flight */
+        
+        return 0;                                                                              /* completes later */
+    }
+    _w25qxx_ring_complete(ring, sqe->user_data, sqe->op, res);                                 /* post the completion */
+    
+    return 1;                                                                                  /* completed */
+}
+
+/**
+ * @brief     init the rings
+ * @param[in] *ring points to a w25qxx ring structure
+ * @param[in] *sq points to the submission entries
+ * @param[in] sq_entries is the submission entry number, a power of two
+ * @param[in] *cq points to the completion entries
+ * @param[in] cq_entries is the completion entry number, a power of two
+ * @return    status code
+ *            - 0 success
+ *            - 2 ring, sq or cq is NULL
+ *            - 4 an entry number is not a power of two
+ * @note      none
+ */
+uint8_t w25qxx_ring_init(w25qxx_ring_t *ring, w25qxx_ring_sqe_t *sq, uint32_t sq_entries,
+                         w25qxx_ring_cqe_t *cq, uint32_t cq_entries)
+{
+    if ((ring == NULL) || (sq == NULL) || (cq == NULL))                                        /* check the pointers */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if ((sq_entries == 0) || ((sq_entries & (sq_entries - 1)) != 0) ||
+        (cq_entries == 0) || ((cq_entries & (cq_entries - 1)) != 0))                           /* check the entry numbers */
+    {
+        return 4;                                                                              /* return error */
+    }
+    
+    memset(ring, 0, sizeof(w25qxx_ring_t));                                                    /* clear the ring */
+    ring->sq = sq;                                                                             /* set the submission entries */
+    ring->cq = cq;                                                                             /* set the completion entries */
+    ring->sq_mask = sq_entries - 1;                                                            /* set the mask */
+    ring->cq_mask = cq_entries - 1;                                                            /* set the mask */
+    ring->inited = 1;                                                                          /* set inited */
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief     submit one operation
+ * @param[in] *ring points to a w25qxx ring structure
+ * @param[in] *sqe points to a submission entry, it is copied
+ * @return    status code
+ *            - 0 success
+ *            - 2 ring or sqe is NULL
+ *            - 3 ring is not initialized
+ *            - 5 submission ring is full
+ * @note      none
+ */
+uint8_t w25qxx_ring_submit(w25qxx_ring_t *ring, const w25qxx_ring_sqe_t *sqe)
+{
+    uint32_t tail;
+    
+    if ((ring == NULL) || (sqe == NULL))                                                       /* check ring and sqe */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (ring->inited != 1)                                                                     /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    
+    tail = ring->sq_tail;                                                                      /* only the caller writes it */
+    if ((tail - W25QXX_RING_LOAD(ring->sq_head)) > ring->sq_mask)                              /* check the free space */
+    {
+        return 5;                                                                              /* return full */
+    }
+    memcpy(&ring->sq[tail & ring->sq_mask], sqe, sizeof(w25qxx_ring_sqe_t));                   /* copy the entry */
+    W25QXX_RING_STORE(ring->sq_tail, tail + 1);                                                /* publish */
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief      reap one completion
+ * @param[in]  *ring points to a w25qxx ring structure
+ * @param[out] *cqe points to a completion entry buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 ring or cqe is NULL
+ *             - 3 ring is not initialized
+ *             - 5 completion ring is empty
+ * @note       none
+ */
+uint8_t w25qxx_ring_reap(w25qxx_ring_t *ring, w25qxx_ring_cqe_t *cqe)
+{
+    uint32_t head;
+    
+    if ((ring == NULL) || (cqe == NULL))                                                       /* check ring and cqe */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (ring->inited != 1)                                                                     /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    
+    head = ring->cq_head;                                                                      /* only the caller writes it */
+    if (W25QXX_RING_LOAD(ring->cq_tail) == head)                                               /* check the completions */
+    {
+        return 5;                                                                              /* return empty */
+    }
+    memcpy(cqe, &ring->cq[head & ring->cq_mask], sizeof(w25qxx_ring_cqe_t));                   /* copy the entry */
+    W25QXX_RING_STORE(ring->cq_head, head + 1);                                                /* release the entry */
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief      run the worker once
+ * @param[in]  *ring points to a w25qxx ring structure
+ * @param[out] *done points to a completion number buffer, it may be NULL
+ * @return     status code
+ *             - 0 success
+ *             - 2 ring is NULL
+ *             - 3 ring is not initialized
+ * @note       none
+ */
+uint8_t w25qxx_ring_process(w25qxx_ring_t *ring, uint32_t *done)
+{
+    uint8_t i;
+    uint8_t res;
+    uint32_t num;
+    uint32_t head;
+    w25qxx_bool_t busy;
+    w25qxx_ring_sqe_t *sqe;
+    
+    if (ring == NULL)                                                                          /* check ring */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (ring->inited != 1)                                                                     /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    
+    num = 0;                                                                                   /* init 0 */
+    i = 0;                                                                                     /* init 0 */
+    while (i < ring->inflight_num)                                                             /* poll the started operations */
+    {
+        res = w25qxx_get_busy(ring->inflight[i].handle, &busy);                                /* get the busy status */
+        if ((res == 0) && (busy == W25QXX_BOOL_TRUE))                                          /* still working */
+        {
+            i++;                                                                               /* next one */
+            
+            continue;                                                                          /* continue */
+        }
+        if ((res == 0) && (ring->inflight[i].op == W25QXX_RING_OP_ERASE))                      /* erased */
+        {
+            res = w25qxx_erase_finish(ring->inflight[i].handle, ring->inflight[i].addr, 
+                                      ring->inflight[i].len);                                  /* finish the erase */
+        }
+        _w25qxx_ring_complete(ring, ring->inflight[i].user_data, ring->inflight[i].op, res);   /* space is reserved */
+        num++;                                                                                 /* one more completion */
+        ring->inflight_num--;                                                                  /* one less in flight */
+        ring->inflight[i] = ring->inflight[ring->inflight_num];                                /* fill the hole */
+    }
+    
+    head = ring->sq_head;                                                                      /* only the worker writes it */
+    while (head != W25QXX_RING_LOAD(ring->sq_tail))                                            /* all submissions */
+    {
+        if (((ring->cq_tail - W25QXX_RING_LOAD(ring->cq_head)) + ring->inflight_num) > ring->cq_mask)  /* keep the in flight space */
+        {
+            break;                                                                             /* completion ring is full */
+        }
+        sqe = &ring->sq[head & ring->sq_mask];                                                 /* get the entry */
+        if (_w25qxx_ring_busy(ring, sqe->handle) != 0)                                             /* a flush of NULL waits for all */
+        {
+            break;                                                                             /* keep the handle order */
+        }
+        if (((sqe->op == W25QXX_RING_OP_PROGRAM) || (sqe->op == W25QXX_RING_OP_ERASE)) &&
+            (ring->inflight_num >= W25QXX_RING_INFLIGHT_MAX))                                  /* check the in flight table */
+        {
+            break;                                                                             /* table is full */
+        }
+        num += _w25qxx_ring_run(ring, sqe);                                                    /* run the submission */
+        head++;                                                                                /* next submission */
+        W25QXX_RING_STORE(ring->sq_head, head);                                                /* release the entry */
+    }
+    if (done != NULL)                                                                          /* check done */
+    {
+        *done = num;                                                                           /* set the completions */
+    }
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief      get the in flight operation number
+ * @param[in]  *ring points to a w25qxx ring structure
+ * @param[out] *num points to a number buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 ring is NULL
+ *             - 3 ring is not initialized
+ * @note       none
+ */
+uint8_t w25qxx_ring_get_inflight(w25qxx_ring_t *ring, uint32_t *num)
+{
+    if (ring == NULL)                                                                          /* check ring */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (ring->inited != 1)                                                                     /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    
+    *num = ring->inflight_num;                                                                 /* get the number */
+    
+    return 0;                                                                                  /* success return 0 */
+}
@@ -0,0 +1,206 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_ring.h
+ * @brief     driver w25qxx ring header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DRIVER_W25QXX_RING_H_
+#define _DRIVER_W25QXX_RING_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup w25qxx_ring_driver w25qxx ring driver function
+ * @brief    w25qxx ring driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+/**
+ * @brief w25qxx ring max in flight operations definition
+ * @note  one started erase or page program per handle
+ */
+#ifndef W25QXX_RING_INFLIGHT_MAX
+    #define W25QXX_RING_INFLIGHT_MAX 4
+#endif
+
+/**
+ * @brief w25qxx ring operation enumeration definition
+ */
+typedef enum
+{
+    W25QXX_RING_OP_READ    = 0x00,        /**< w25qxx_read, addr, buf and len */
+    W25QXX_RING_OP_WRITE   = 0x01,        /**< w25qxx_write with the read modify write, addr, buf and len */
+    W25QXX_RING_OP_PROGRAM = 0x02,        /**< page program of an erased area inside one page, addr, buf and len */
+    W25QXX_RING_OP_ERASE   = 0x03,        /**< erase of 4096, 32768 or 65536 bytes, addr and len */
+    W25QXX_RING_OP_FLUSH   = 0x04,        /**< completes after the earlier operations of handle, or of all handles if NULL */
+} w25qxx_ring_op_t;
+
+/**
+ * @brief w25qxx ring submission entry structure definition
+ */
+typedef struct w25qxx_ring_sqe_s
+{
+    w25qxx_handle_t *handle;        /**< target handle */
+    uint8_t *buf;                   /**< data buffer, it must live until the completion */
+    uint32_t addr;                  /**< flash address */
+    uint32_t len;                   /**< data or erase length */
+    uint32_t user_data;             /**< tag copied into the completion */
+    uint8_t op;                     /**< w25qxx_ring_op_t */
+} w25qxx_ring_sqe_t;
+
+/**
+ * @brief w25qxx ring completion entry structure definition
+ */
+typedef struct w25qxx_ring_cqe_s
+{
+    uint32_t user_data;        /**< tag of the submission */
+    uint8_t op;                /**< w25qxx_ring_op_t */
+    uint8_t res;               /**< status code of the operation, 4 for an invalid submission */
+} w25qxx_ring_cqe_t;
+
+/**
+ * @brief w25qxx ring in flight structure definition
+ */
+typedef struct w25qxx_ring_inflight_s
+{
+    w25qxx_handle_t *handle;        /**< busy handle */
+    uint32_t user_data;             /**< tag of the started operation */
+    uint32_t addr;                  /**< erase address */
+    uint32_t len;                   /**< erase size */
+    uint8_t op;                     /**< started operation */
+} w25qxx_ring_inflight_t;
+
+/**
+ * @brief w25qxx ring structure definition
+ * @note  the submission ring has one producer, the caller, and one consumer, the worker,
+ *        the completion ring has one producer, the worker, and one consumer, the caller,
+ *        so the indexes are published with release stores and no lock is needed
+ */
+typedef struct w25qxx_ring_s
+{
+    w25qxx_ring_sqe_t *sq;                                                 /**< submission entries */
+    w25qxx_ring_cqe_t *cq;                                                 /**< completion entries */
+    uint32_t sq_mask;                                                      /**< submission entries - 1 */
+    uint32_t cq_mask;                                                      /**< completion entries - 1 */
+    volatile uint32_t sq_head;                                             /**< next submission of the worker */
+    volatile uint32_t sq_tail;                                             /**< next free submission of the caller */
+    volatile uint32_t cq_head;                                             /**< next completion of the caller */
+    volatile uint32_t cq_tail;                                             /**< next free completion of the worker */
+    w25qxx_ring_inflight_t inflight[W25QXX_RING_INFLIGHT_MAX];             /**< started operations, worker only */
+    uint8_t inflight_num;                                                  /**< started operation number, worker only */
+    uint8_t inited;                                                        /**< inited flag */
+} w25qxx_ring_t;
+
+/**
+ * @brief     init the rings
+ * @param[in] *ring points to a w25qxx ring structure
+ * @param[in] *sq points to the submission entries
+ * @param[in] sq_entries is the submission entry number, a power of two
+ * @param[in] *cq points to the completion entries
+ * @param[in] cq_entries is the completion entry number, a power of two
+ * @return    status code
+ *            - 0 success
+ *            - 2 ring, sq or cq is NULL
+ *            - 4 an entry number is not a power of two
+ * @note      none
+ */
+uint8_t w25qxx_ring_init(w25qxx_ring_t *ring, w25qxx_ring_sqe_t *sq, uint32_t sq_entries,
+                         w25qxx_ring_cqe_t *cq, uint32_t cq_entries);
+
+/**
+ * @brief     submit one operation
+ * @param[in] *ring points to a w25qxx ring structure
+ * @param[in] *sqe points to a submission entry, it is copied
+ * @return    status code
+ *            - 0 success
+ *            - 2 ring or sqe is NULL
+ *            - 3 ring is not initialized
+ *            - 5 submission ring is full
+ * @note      caller side, the operations of one handle complete in the submission order
+ */
+uint8_t w25qxx_ring_submit(w25qxx_ring_t *ring, const w25qxx_ring_sqe_t *sqe);
+
+/**
+ * @brief      reap one completion
+ * @param[in]  *ring points to a w25qxx ring structure
+ * @param[out] *cqe points to a completion entry buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 ring or cqe is NULL
+ *             - 3 ring is not initialized
+ *             - 5 completion ring is empty
+ * @note       caller side
+ */
+uint8_t w25qxx_ring_reap(w25qxx_ring_t *ring, w25qxx_ring_cqe_t *cqe);
+
+/**
+ * @brief      run the worker once
+ * @param[in]  *ring points to a w25qxx ring structure
+ * @param[out] *done points to a completion number buffer, it may be NULL
+ * @return     status code
+ *             - 0 success
+ *             - 2 ring is NULL
+ *             - 3 ring is not initialized
+ * @note       worker side, it never waits for the chip: erases and page programs are only started
+ *             and polled with w25qxx_get_busy later, so the next submissions, such as the erases of
+ *             other chips, run meanwhile, the head submission stays queued while its handle is busy,
+ *             the in flight table is full or the completion ring could overflow
+ */
+uint8_t w25qxx_ring_process(w25qxx_ring_t *ring, uint32_t *done);
+
+/**
+ * @brief      get the in flight operation number
+ * @param[in]  *ring points to a w25qxx ring structure
+ * @param[out] *num points to a number buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 ring is NULL
+ *             - 3 ring is not initialized
+ * @note       worker side
+ */
+uint8_t w25qxx_ring_get_inflight(w25qxx_ring_t *ring, uint32_t *num);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,557 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_sched.c
+ * @brief     driver w25qxx sched source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_sched.h"
+
+/**
+ * @brief     compare two requests
+ * @param[in] *sched points to a w25qxx sched structure
+ * @param[in] *a points to a request
+ * @param[in] *b points to a request
+ * @return    1 if a goes after b, otherwise 0
+ * @note      the order is the bank counted from the last used bank, writes before reads,
+ *            then the sector of a write or the address of a read, equal writes keep the queue order
+ */
+static uint8_t _w25qxx_sched_after(w25qxx_sched_t *sched, w25qxx_sched_req_t *a, w25qxx_sched_req_t *b)
+{
+    uint8_t bank_a;
+    uint8_t bank_b;
+    
+    bank_a = (uint8_t)((a->addr >> 24) - sched->bank);                                         /* rotate the bank */
+    bank_b = (uint8_t)((b->addr >> 24) - sched->bank);                                         /* rotate the bank */
+    if (bank_a != bank_b)                                                                      /* different banks */
+    {
+        return (bank_a > bank_b) ? 1 : 0;                                                      /* bank order */
+    }
+    if (a->write != b->write)                                                                  /* a write and a read */
+    {
+        return (a->write == 0) ? 1 : 0;                                                        /* writes first */
+    }
+    if (a->write != 0)                                                                         /* two writes */
+    {
+        return ((a->addr / 4096) > (b->addr / 4096)) ? 1 : 0;                                  /* sector order */
+    }
+    
+    return (a->addr > b->addr) ? 1 : 0;                                                        /* address order */
+}
+
+/**
+ * @brief     sort the requests
+ * @param[in] *sched points to a w25qxx sched structure
+ * @note      a stable insertion sort, the batch is short
+ */
+static void _w25qxx_sched_sort(w25qxx_sched_t *sched)
+{
+    uint32_t i;
+    uint32_t j;
+    w25qxx_sched_req_t r;
+    
+    for (i = 1; i < sched->req_num; i++)                                                       /* all requests */
+    {
+        r = sched->req[i];                                                                     /* take the request */
+        j = i;                                                                                 /* start position */
+        while ((j > 0) && (_w25qxx_sched_after(sched, &sched->req[j - 1], &r) != 0))           /* find the position */
+        {
+            sched->req[j] = sched->req[j - 1];                                                 /* move up */
+            j--;                                                                               /* previous one */
+        }
+        sched->req[j] = r;                                                                     /* insert */
+    }
+}
+
+/**
+ * @brief     check the queued reads
+ * @param[in] *sched points to a w25qxx sched structure
+ * @param[in] addr is the first address
+ * @param[in] len is the length
+ * @return    1 if a queued read overlaps the range, otherwise 0
+ * @note      none
+ */
+static uint8_t _w25qxx_sched_read_overlap(w25qxx_sched_t *sched, uint32_t addr, uint32_t len)
+{
+    uint32_t i;
+    
+    for (i = 0; i < sched->req_num; i++)                                                       /* all requests */
+    {
+        if ((sched->req[i].write == 0) && (sched->req[i].addr < addr + len) &&
+            (addr < sched->req[i].addr + sched->req[i].len))                                   /* overlapping read */
+        {
+            return 1;                                                                          /* return overlap */
+        }
+    }
+    
+    return 0;                                                                                  /* return none */
+}
+
+/**
+ * @brief     send the writes of one sector
+ * @param[in] *sched points to a w25qxx sched structure
+ * @param[in] first is the first request of the sector
+ * @param[in] last is the request after the sector
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ * @note      the gaps between the writes are read first, so the sector gets one w25qxx_write
+ */
+static uint8_t _w25qxx_sched_write_sector(w25qxx_sched_t *sched, uint32_t first, uint32_t last)
+{
+    uint8_t changed;
+    uint32_t i;
+    uint32_t lo;
+    uint32_t hi;
+    uint32_t reach;
+    uint32_t sector;
+    w25qxx_sched_req_t *r;
+    
+    sector = sched->req[first].addr & ~(uint32_t)4095;                                         /* sector address */
+    lo = sched->req[first].addr;                                                               /* init the span */
+    hi = lo + sched->req[first].len;                                                           /* init the span */
+    for (i = first + 1; i < last; i++)                                                         /* all writes */
+    {
+        r = &sched->req[i];                                                                    /* get the request */
+        lo = (r->addr < lo) ? r->addr : lo;                                                    /* extend down */
+        hi = (r->addr + r->len > hi) ? r->addr + r->len : hi;                                  /* extend up */
+    }
+    reach = lo;                                                                                /* covered up to */
+    do
+    {
+        changed = 0;                                                                           /* init 0 */
+        for (i = first; i < last; i++)                                                         /* all writes */
+        {
+            r = &sched->req[i];                                                                /* get the request */
+            if ((r->addr <= reach) && (r->addr + r->len > reach))                              /* continues the cover */
+            {
+                reach = r->addr + r->len;                                                      /* extend */
+                changed = 1;                                                                   /* again */
+            }
+        }
+    } while (changed != 0);
+    if (reach < hi)                                                                            /* gaps in the span */
+    {
+        if (w25qxx_read(sched->handle, lo, &sched->buf[lo - sector], hi - lo) != 0)            /* read the span */
+        {
+            return 1;                                                                          /* return error */
+        }
+    }
+    for (i = first; i < last; i++)                                                             /* apply in queue order */
+    {
+        r = &sched->req[i];                                                                    /* get the request */
+        memcpy(&sched->buf[r->addr - sector], &sched->pool[r->offset], r->len);                /* copy the data */
+    }
+    if (w25qxx_write(sched->handle, lo, &sched->buf[lo - sector], hi - lo) != 0)               /* one read modify write */
+    {
+        return 1;                                                                              /* return error */
+    }
+    sched->stats.sector_writes++;                                                              /* one more sector */
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief     send a run of reads
+ * @param[in] *sched points to a w25qxx sched structure
+ * @param[in] first is the first read
+ * @param[in] last is the read after the run
+ * @param[in] lo is the first address of the run
+ * @param[in] hi is the end address of the run
+ * @return    status code
+ *            - 0 success
+ *            - 1 read failed
+ * @note      a single read goes straight to its buffer, a longer run is read into the bounce buffer
+ */
+static uint8_t _w25qxx_sched_read_run(w25qxx_sched_t *sched, uint32_t first, uint32_t last, uint32_t lo, uint32_t hi)
+{
+    uint32_t i;
+    w25qxx_sched_req_t *r;
+    
+    sched->stats.read_transactions++;                                                          /* one more transaction */
+    if (last == first + 1)                                                                     /* single read */
+    {
+        r = &sched->req[first];                                                                /* get the request */
+        
+        return (w25qxx_read(sched->handle, r->addr, r->buf, r->len) != 0) ? 1 : 0;            /* read */
+    }
+    if (w25qxx_read(sched->handle, lo, sched->buf, hi - lo) != 0)                              /* read the run */
+    {
+        return 1;                                                                              /* return error */
+    }
+    for (i = first; i < last; i++)                                                             /* all reads */
+    {
+        r = &sched->req[i];                                                                    /* get the request */
+        memcpy(r->buf, &sched->buf[r->addr - lo], r->len);                                     /* copy the data */
+    }
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief     init the scheduler
+ * @param[in] *sched points to a w25qxx sched structure
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *req points to a request array
+ * @param[in] req_max is the request array length
+ * @param[in] *pool points to a write data pool
+ * @param[in] pool_size is the write data pool size
+ * @param[in] *buf points to a 4096 bytes buffer
+ * @param[in] window_ms is the batch window, 0 sends the batch on every poll
+ * @return    status code
+ *            - 0 success
+ *            - 2 a pointer is NULL
+ *            - 3 handle is not initialized
+ *            - 4 req_max or pool_size is 0
+ * @note      none
+ */
+uint8_t w25qxx_sched_init(w25qxx_sched_t *sched, w25qxx_handle_t *handle, w25qxx_sched_req_t *req, uint32_t req_max,
+                          uint8_t *pool, uint32_t pool_size, uint8_t *buf, uint32_t window_ms)
+{
+    if ((sched == NULL) || (handle == NULL) || (req == NULL) || 
+        (pool == NULL) || (buf == NULL))                                                       /* check the pointers */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (handle->inited != 1)                                                                   /* check handle initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    if ((req_max == 0) || (pool_size == 0))                                                    /* check the sizes */
+    {
+        handle->debug_print("w25qxx: sched size is invalid.\n");                               /* sched size is invalid */
+        
+        return 4;                                                                              /* return error */
+    }
+    
+    memset(sched, 0, sizeof(w25qxx_sched_t));                                                  /* clear the scheduler */
+    sched->handle = handle;                                                                    /* set the handle */
+    sched->req = req;                                                                          /* set the requests */
+    sched->req_max = req_max;                                                                  /* set the request number */
+    sched->pool = pool;                                                                        /* set the pool */
+    sched->pool_size = pool_size;                                                              /* set the pool size */
+    sched->buf = buf;                                                                          /* set the buffer */
+    sched->window_ms = window_ms;                                                              /* set the window */
+    sched->inited = 1;                                                                         /* set inited */
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief     queue a write
+ * @param[in] *sched points to a w25qxx sched structure
+ * @param[in] addr is the write address
+ * @param[in] *data points to a data buffer, it is copied
+ * @param[in] len is the data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 sched is NULL
+ *            - 3 sched is not initialized
+ * @note      none
+ */
+uint8_t w25qxx_sched_write(w25qxx_sched_t *sched, uint32_t addr, uint8_t *data, uint32_t len)
+{
+    uint32_t n;
+    uint32_t sectors;
+    w25qxx_sched_req_t *r;
+    
+    if (sched == NULL)                                                                         /* check sched */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (sched->inited != 1)                                                                    /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    if (len == 0)                                                                              /* nothing to write */
+    {
+        return 0;                                                                              /* success return 0 */
+    }
+    
+    sectors = (addr + len - 1) / 4096 - addr / 4096 + 1;                                       /* touched sectors */
+    if ((_w25qxx_sched_read_overlap(sched, addr, len) != 0) ||
+        (sched->req_num + sectors > sched->req_max) ||
+        (sched->pool_used + len > sched->pool_size))                                           /* keep the order or make room */
+    {
+        if (w25qxx_sched_flush(sched) != 0)                                                    /* flush */
+        {
+            return 1;                                                                          /* return error */
+        }
+    }
+    sched->stats.writes++;                                                                     /* one more write */
+    if ((sectors > sched->req_max) || (len > sched->pool_size))                                /* larger than the batch */
+    {
+        sched->stats.sector_writes += sectors;                                                 /* count the sectors */
+        
+        return (w25qxx_write(sched->handle, addr, data, len) != 0) ? 1 : 0;                    /* write at once */
+    }
+    memcpy(&sched->pool[sched->pool_used], data, len);                                         /* copy the data */
+    while (len != 0)                                                                           /* split per sector */
+    {
+        n = 4096 - (addr % 4096);                                                              /* sector remain */
+        n = (len < n) ? len : n;                                                               /* chunk length */
+        r = &sched->req[sched->req_num++];                                                     /* new request */
+        r->addr = addr;                                                                        /* set the address */
+        r->len = n;                                                                            /* set the length */
+        r->offset = sched->pool_used;                                                          /* set the data */
+        r->buf = NULL;                                                                         /* no destination */
+        r->write = 1;                                                                          /* write */
+        sched->pool_used += n;                                                                 /* use the pool */
+        addr += n;                                                                             /* next address */
+        len -= n;                                                                              /* remain */
+    }
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief      queue a read
+ * @param[in]  *sched points to a w25qxx sched structure
+ * @param[in]  addr is the read address
+ * @param[out] *data points to a data buffer, it is filled by the flush
+ * @param[in]  len is the data length
+ * @return     status code
+ *             - 0 success
+ *             - 1 flush failed
+ *             - 2 sched is NULL
+ *             - 3 sched is not initialized
+ * @note       none
+ */
+uint8_t w25qxx_sched_read(w25qxx_sched_t *sched, uint32_t addr, uint8_t *data, uint32_t len)
+{
+    uint32_t n;
+    uint32_t banks;
+    w25qxx_sched_req_t *r;
+    
+    if (sched == NULL)                                                                         /* check sched */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (sched->inited != 1)                                                                    /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    if (len == 0)                                                                              /* nothing to read */
+    {
+        return 0;                                                                              /* success return 0 */
+    }
+    
+    banks = ((addr + len - 1) >> 24) - (addr >> 24) + 1;                                       /* touched banks */
+    if (sched->req_num + banks > sched->req_max)                                               /* make room */
+    {
+        if (w25qxx_sched_flush(sched) != 0)                                                    /* flush */
+        {
+            return 1;                                                                          /* return error */
+        }
+    }
+    sched->stats.reads++;                                                                      /* one more read */
+    if (banks > sched->req_max)                                                                /* larger than the batch */
+    {
+        sched->stats.read_transactions++;                                                      /* one more transaction */
+        
+        return (w25qxx_read(sched->handle, addr, data, len) != 0) ? 1 : 0;                     /* read at once */
+    }
+    while (len != 0)                                                                           /* split per bank */
+    {
+        n = 0x1000000 - (addr & 0xFFFFFF);                                                     /* bank remain */
+        n = (len < n) ? len : n;                                                               /* chunk length */
+        r = &sched->req[sched->req_num++];                                                     /* new request */
+        r->addr = addr;                                                                        /* set the address */
+        r->len = n;                                                                            /* set the length */
+        r->offset = 0;                                                                         /* no data */
+        r->buf = data;                                                                         /* set the destination */
+        r->write = 0;                                                                          /* read */
+        addr += n;                                                                             /* next address */
+        data += n;                                                                             /* next destination */
+        len -= n;                                                                              /* remain */
+    }
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief     age the batch
+ * @param[in] *sched points to a w25qxx sched structure
+ * @param[in] elapsed_ms is the time since the last poll
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 sched is NULL
+ *            - 3 sched is not initialized
+ * @note      none
+ */
+uint8_t w25qxx_sched_poll(w25qxx_sched_t *sched, uint32_t elapsed_ms)
+{
+    if (sched == NULL)                                                                         /* check sched */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (sched->inited != 1)                                                                    /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    if (sched->req_num == 0)                                                                   /* nothing queued */
+    {
+        return 0;                                                                              /* success return 0 */
+    }
+    
+    sched->age_ms += elapsed_ms;                                                               /* age the batch */
+    if (sched->age_ms < sched->window_ms)                                                      /* still in the window */
+    {
+        return 0;                                                                              /* success return 0 */
+    }
+    
+    return w25qxx_sched_flush(sched);                                                          /* flush */
+}
+
+/**
+ * @brief     send the batch
+ * @param[in] *sched points to a w25qxx sched structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 sched is NULL
+ *            - 3 sched is not initialized
+ * @note      a failed batch is dropped
+ */
+uint8_t w25qxx_sched_flush(w25qxx_sched_t *sched)
+{
+    uint8_t res;
+    uint8_t bank;
+    uint32_t i;
+    uint32_t j;
+    uint32_t lo;
+    uint32_t hi;
+    w25qxx_sched_req_t *r;
+    
+    if (sched == NULL)                                                                         /* check sched */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (sched->inited != 1)                                                                    /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    if (sched->req_num == 0)                                                                   /* nothing queued */
+    {
+        return 0;                                                                              /* success return 0 */
+    }
+    
+    _w25qxx_sched_sort(sched);                                                                 /* order the batch */
+    res = 0;                                                                                   /* init 0 */
+    i = 0;                                                                                     /* init 0 */
+    while ((i < sched->req_num) && (res == 0))                                                 /* all requests */
+    {
+        r = &sched->req[i];                                                                    /* get the request */
+        bank = (uint8_t)(r->addr >> 24);                                                       /* get the bank */
+        if (bank != sched->bank)                                                               /* bank changes */
+        {
+            sched->stats.bank_switches++;                                                      /* count the switch */
+            sched->bank = bank;                                                                /* set the bank */
+        }
+        lo = r->addr;                                                                          /* run start */
+        hi = r->addr + r->len;                                                                 /* run end */
+        for (j = i + 1; j < sched->req_num; j++)                                               /* find the run */
+        {
+            if ((sched->req[j].write != r->write) || ((sched->req[j].addr >> 24) != bank))     /* another kind or bank */
+            {
+                break;                                                                         /* end of the run */
+            }
+            if (r->write != 0)                                                                 /* writes */
+            {
+                if ((sched->req[j].addr / 4096) != (r->addr / 4096))                           /* another sector */
+                {
+                    break;                                                                     /* end of the run */
+                }
+            }
+            else                                                                               /* reads */
+            {
+                if ((sched->req[j].addr > hi) ||
+                    (((sched->req[j].addr + sched->req[j].len > hi) ? 
+                      sched->req[j].addr + sched->req[j].len : hi) - lo > 4096))               /* a gap or too long */
+                {
+                    break;                                                                     /* end of the run */
+                }
+                hi = (sched->req[j].addr + sched->req[j].len > hi) ? 
+                      sched->req[j].addr + sched->req[j].len : hi;                             /* extend the run */
+            }
+        }
+        if (r->write != 0)                                                                     /* write run */
+        {
+            res = _w25qxx_sched_write_sector(sched, i, j);                                     /* one sector */
+        }
+        else
+        {
+            res = _w25qxx_sched_read_run(sched, i, j, lo, hi);                                 /* one transaction */
+        }
+        i = j;                                                                                 /* next run */
+    }
+    sched->req_num = 0;                                                                        /* drop the batch */
+    sched->pool_used = 0;                                                                      /* free the pool */
+    sched->age_ms = 0;                                                                         /* reset the age */
+    sched->stats.flushes++;                                                                    /* one more batch */
+    if (res != 0)                                                                              /* check result */
+    {
+        sched->handle->debug_print("w25qxx: sched flush failed.\n");                           /* sched flush failed */
+        
+        return 1;                                                                              /* return error */
+    }
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief      get the statistics
+ * @param[in]  *sched points to a w25qxx sched structure
+ * @param[out] *stats points to a statistics buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 sched is NULL
+ *             - 3 sched is not initialized
+ * @note       none
+ */
+uint8_t w25qxx_sched_get_stats(w25qxx_sched_t *sched, w25qxx_sched_stats_t *stats)
+{
+    if (sched == NULL)                                                                         /* check sched */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (sched->inited != 1)                                                                    /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    
+    memcpy(stats, &sched->stats, sizeof(w25qxx_sched_stats_t));                                /* copy the statistics */
+    
+    return 0;                                                                                  /* success return 0 */
+}
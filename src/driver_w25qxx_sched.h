@@ -0,0 +1,200 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_sched.h
+ * @brief     driver w25qxx sched header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DRIVER_W25QXX_SCHED_H_
+#define _DRIVER_W25QXX_SCHED_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup w25qxx_sched_driver w25qxx sched driver function
+ * @brief    w25qxx sched driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+/**
+ * @brief w25qxx sched request structure definition
+ * @note  a queued write never crosses a sector, its data lives in the pool,
+ *        a queued read never crosses a 16MB bank
+ */
+typedef struct w25qxx_sched_req_s
+{
+    uint32_t addr;          /**< flash address */
+    uint32_t len;           /**< length */
+    uint32_t offset;        /**< pool offset of a write */
+    uint8_t *buf;           /**< destination of a read */
+    uint8_t write;          /**< 1 for a write, 0 for a read */
+} w25qxx_sched_req_t;
+
+/**
+ * @brief w25qxx sched statistics structure definition
+ * @note  the merge ratio is writes / sector_writes
+ */
+typedef struct w25qxx_sched_stats_s
+{
+    uint32_t writes;                   /**< queued writes */
+    uint32_t sector_writes;            /**< read modify writes sent to the chip */
+    uint32_t reads;                    /**< queued reads */
+    uint32_t read_transactions;        /**< reads sent to the chip */
+    uint32_t bank_switches;            /**< 16MB bank changes between sent operations */
+    uint32_t flushes;                  /**< flushed batches */
+} w25qxx_sched_stats_t;
+
+/**
+ * @brief w25qxx sched structure definition
+ */
+typedef struct w25qxx_sched_s
+{
+    w25qxx_handle_t *handle;               /**< w25qxx handle */
+    w25qxx_sched_req_t *req;               /**< request array */
+    uint32_t req_max;                      /**< request array length */
+    uint32_t req_num;                      /**< queued requests */
+    uint8_t *pool;                         /**< write data pool */
+    uint32_t pool_size;                    /**< write data pool size */
+    uint32_t pool_used;                    /**< used write data pool */
+    uint8_t *buf;                          /**< 4096 bytes sector image and read bounce buffer */
+    uint32_t window_ms;                    /**< batch window */
+    uint32_t age_ms;                       /**< age of the queued batch */
+    uint8_t bank;                          /**< last used bank */
+    uint8_t inited;                        /**< inited flag */
+    w25qxx_sched_stats_t stats;            /**< statistics */
+} w25qxx_sched_t;
+
+/**
+ * @brief     init the scheduler
+ * @param[in] *sched points to a w25qxx sched structure
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *req points to a request array
+ * @param[in] req_max is the request array length
+ * @param[in] *pool points to a write data pool
+ * @param[in] pool_size is the write data pool size
+ * @param[in] *buf points to a 4096 bytes buffer
+ * @param[in] window_ms is the batch window, 0 sends the batch on every poll
+ * @return    status code
+ *            - 0 success
+ *            - 2 a pointer is NULL
+ *            - 3 handle is not initialized
+ *            - 4 req_max or pool_size is 0
+ * @note      none
+ */
+uint8_t w25qxx_sched_init(w25qxx_sched_t *sched, w25qxx_handle_t *handle, w25qxx_sched_req_t *req, uint32_t req_max,
+                          uint8_t *pool, uint32_t pool_size, uint8_t *buf, uint32_t window_ms);
+
+/**
+ * @brief     queue a write
+ * @param[in] *sched points to a w25qxx sched structure
+ * @param[in] addr is the write address
+ * @param[in] *data points to a data buffer, it is copied
+ * @param[in] len is the data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 sched is NULL
+ *            - 3 sched is not initialized
+ * @note      the batch is flushed first when it is full or a queued read overlaps the range,
+ *            a write larger than the pool is sent at once
+ */
+uint8_t w25qxx_sched_write(w25qxx_sched_t *sched, uint32_t addr, uint8_t *data, uint32_t len);
+
+/**
+ * @brief      queue a read
+ * @param[in]  *sched points to a w25qxx sched structure
+ * @param[in]  addr is the read address
+ * @param[out] *data points to a data buffer, it is filled by the flush
+ * @param[in]  len is the data length
+ * @return     status code
+ *             - 0 success
+ *             - 1 flush failed
+ *             - 2 sched is NULL
+ *             - 3 sched is not initialized
+ * @note       the read sees every write queued before the flush, a read crossing a 16MB bank
+ *             is split at the boundary and each part is sorted into its own bank,
+ *             adjacent and overlapping reads are sent as one transaction
+ */
+uint8_t w25qxx_sched_read(w25qxx_sched_t *sched, uint32_t addr, uint8_t *data, uint32_t len);
+
+/**
+ * @brief     age the batch
+ * @param[in] *sched points to a w25qxx sched structure
+ * @param[in] elapsed_ms is the time since the last poll
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 sched is NULL
+ *            - 3 sched is not initialized
+ * @note      the batch is flushed once it is window_ms old
+ */
+uint8_t w25qxx_sched_poll(w25qxx_sched_t *sched, uint32_t elapsed_ms);
+
+/**
+ * @brief     send the batch
+ * @param[in] *sched points to a w25qxx sched structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 sched is NULL
+ *            - 3 sched is not initialized
+ * @note      writes are merged into one read modify write per sector and sent sector by sector
+ *            grouped per 16MB bank starting with the last used bank, the reads of a bank follow its writes
+ */
+uint8_t w25qxx_sched_flush(w25qxx_sched_t *sched);
+
+/**
+ * @brief      get the statistics
+ * @param[in]  *sched points to a w25qxx sched structure
+ * @param[out] *stats points to a statistics buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 sched is NULL
+ *             - 3 sched is not initialized
+ * @note       none
+ */
+uint8_t w25qxx_sched_get_stats(w25qxx_sched_t *sched, w25qxx_sched_stats_t *stats);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
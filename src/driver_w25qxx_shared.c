@@ -0,0 +1,530 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_shared.c
+ * @brief     driver w25qxx shared source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_shared.h"
+
+/**
+ * @brief     check the lower classes
+ * @param[in] *shared points to a w25qxx shared structure
+ * @param[in] cls is the request class
+ * @return    1 if a lower class has waiting requests, otherwise 0
+ * @note      call it with the mutex held
+ */
+static uint8_t _w25qxx_shared_lower_waiting(w25qxx_shared_t *shared, uint32_t cls)
+{
+    uint32_t i;
+    
+    for (i = 0; i < cls; i++)                                                                  /* all lower classes */
+    {
+        if (shared->next_ticket[i] != shared->serving[i])                                      /* requests waiting */
+        {
+            return 1;                                                                          /* return waiting */
+        }
+    }
+    
+    return 0;                                                                                  /* return none */
+}
+
+/**
+ * @brief     check the turn of a class
+ * @param[in] *shared points to a w25qxx shared structure
+ * @param[in] cls is the request class
+ * @return    1 if the class may take the chip, otherwise 0
+ * @note      call it with the mutex held
+ */
+static uint8_t _w25qxx_shared_turn(w25qxx_shared_t *shared, uint32_t cls)
+{
+    uint32_t i;
+    
+    for (i = 0; i < W25QXX_SHARED_CLASS_MAX; i++)                                              /* all classes */
+    {
+        if ((shared->next_ticket[i] != shared->serving[i]) && 
+            (shared->bypass[i] >= W25QXX_SHARED_MAX_BYPASS))                                   /* starved class */
+        {
+            return (i == cls) ? 1 : 0;                                                         /* the lowest starved class goes */
+        }
+    }
+    
+    return (_w25qxx_shared_lower_waiting(shared, cls) == 0) ? 1 : 0;                           /* lower classes first */
+}
+
+/**
+ * @brief     init the shared front end
+ * @param[in] *shared points to a w25qxx shared structure with linked hooks
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 shared or handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 a hook is NULL
+ * @note      none
+ */
+uint8_t w25qxx_shared_init(w25qxx_shared_t *shared, w25qxx_handle_t *handle)
+{
+    uint32_t i;
+    
+    if ((shared == NULL) || (handle == NULL))                                                  /* check shared and handle */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (handle->inited != 1)                                                                   /* check handle initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    if ((shared->mutex_lock == NULL) || (shared->mutex_unlock == NULL) || 
+        (shared->cond_wait == NULL) || (shared->cond_broadcast == NULL))                       /* check the hooks */
+    {
+        handle->debug_print("w25qxx: shared hook is null.\n");                                 /* shared hook is null */
+        
+        return 4;                                                                              /* return error */
+    }
+    
+    shared->handle = handle;                                                                   /* set handle */
+    for (i = 0; i < W25QXX_SHARED_CLASS_MAX; i++)                                              /* all classes */
+    {
+        shared->next_ticket[i] = 0;                                                            /* init 0 */
+        shared->serving[i] = 0;                                                                /* init 0 */
+        shared->bypass[i] = 0;                                                                 /* init 0 */
+        memset(&shared->stats[i], 0, sizeof(w25qxx_shared_stats_t));                           /* clear the statistics */
+    }
+    shared->active = 0;                                                                        /* nobody owns the chip */
+    shared->discard_pending = 1;                                                               /* scan the declared discards */
+    shared->discard_stop = 0;                                                                  /* keep the worker */
+    shared->inited = 1;                                                                        /* set inited */
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief     acquire the chip
+ * @param[in] *shared points to a w25qxx shared structure
+ * @param[in] cls is the request class
+ * @return    status code
+ *            - 0 success
+ *            - 2 shared is NULL
+ *            - 3 shared is not initialized
+ *            - 4 cls is invalid
+ * @note      none
+ */
+uint8_t w25qxx_shared_lock(w25qxx_shared_t *shared, w25qxx_shared_class_t cls)
+{
+    uint32_t i;
+    uint32_t ticket;
+    uint64_t start;
+    uint64_t wait;
+    w25qxx_shared_stats_t *stats;
+    
+    if (shared == NULL)                                                                        /* check shared */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (shared->inited != 1)                                                                   /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    if ((uint32_t)cls >= W25QXX_SHARED_CLASS_MAX)                                              /* check the class */
+    {
+        return 4;                                                                              /* return error */
+    }
+    
+    start = (shared->timestamp_us != NULL) ? shared->timestamp_us() : 0;                       /* get the enqueue time */
+    stats = &shared->stats[cls];                                                               /* get the statistics */
+    shared->mutex_lock();                                                                      /* lock */
+    ticket = shared->next_ticket[cls]++;                                                       /* take a ticket */
+    stats->depth++;                                                                            /* one more waiting */
+    if (stats->depth > stats->max_depth)                                                       /* check the max */
+    {
+        stats->max_depth = stats->depth;                                                       /* set the max */
+    }
+    while ((shared->active != 0) || (shared->serving[cls] != ticket) ||
+           (_w25qxx_shared_turn(shared, cls) == 0))                                            /* wait for the turn */
+    {
+        shared->cond_wait();                                                                   /* sleep */
+    }
+    shared->active = 1;                                                                        /* own the chip */
+    shared->serving[cls]++;                                                                    /* next ticket of the class */
+    if (shared->bypass[cls] > stats->max_bypass)                                               /* check the max */
+    {
+        stats->max_bypass = shared->bypass[cls];                                               /* set the max */
+    }
+    shared->bypass[cls] = 0;                                                                   /* the class was served */
+    for (i = cls + 1; i < W25QXX_SHARED_CLASS_MAX; i++)                                        /* all higher classes */
+    {
+        if (shared->next_ticket[i] != shared->serving[i])                                      /* requests waiting */
+        {
+            shared->bypass[i]++;                                                               /* overtaken once more */
+        }
+    }
+    stats->depth--;                                                                            /* one less waiting */
+    stats->requests++;                                                                         /* one more served */
+    if (shared->timestamp_us != NULL)                                                          /* measure the wait */
+    {
+        wait = shared->timestamp_us() - start;                                                 /* get the wait */
+        stats->wait_us += wait;                                                                /* total wait */
+        if (wait > stats->max_wait_us)                                                         /* check the max */
+        {
+            stats->max_wait_us = (uint32_t)wait;                                               /* set the max */
+        }
+    }
+    shared->mutex_unlock();                                                                    /* unlock */
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief     release the chip
+ * @param[in] *shared points to a w25qxx shared structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 shared is NULL
+ *            - 3 shared is not initialized
+ * @note      none
+ */
+uint8_t w25qxx_shared_unlock(w25qxx_shared_t *shared)
+{
+    if (shared == NULL)                                                                        /* check shared */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (shared->inited != 1)                                                                   /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    
+    shared->mutex_lock();                                                                      /* lock */
+    shared->active = 0;                                                                        /* release the chip */
+    shared->cond_broadcast();                                                                  /* wake the waiters */
+    shared->mutex_unlock();                                                                    /* unlock */
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief      read data in the read class
+ * @param[in]  *shared points to a w25qxx shared structure
+ * @param[in]  addr is the read address
+ * @param[out] *data points to a data buffer
+ * @param[in]  len is the data length
+ * @return     status code of w25qxx_shared_lock or w25qxx_read
+ * @note       none
+ */
+uint8_t w25qxx_shared_read(w25qxx_shared_t *shared, uint32_t addr, uint8_t *data, uint32_t len)
+{
+    uint8_t res;
+    
+    res = w25qxx_shared_lock(shared, W25QXX_SHARED_CLASS_READ);                                /* acquire */
+    if (res != 0)                                                                              /* check result */
+    {
+        return res;                                                                            /* return error */
+    }
+    res = w25qxx_read(shared->handle, addr, data, len);                                        /* read */
+    (void)w25qxx_shared_unlock(shared);                                                        /* release */
+    
+    return res;                                                                                /* return result */
+}
+
+/**
+ * @brief     write data in the write class
+ * @param[in] *shared points to a w25qxx shared structure
+ * @param[in] addr is the write address
+ * @param[in] *data points to a data buffer
+ * @param[in] len is the data length
+ * @return    status code of w25qxx_shared_lock or w25qxx_write
+ * @note      none
+ */
+uint8_t w25qxx_shared_write(w25qxx_shared_t *shared, uint32_t addr, uint8_t *data, uint32_t len)
+{
+    uint8_t res;
+    
+    res = w25qxx_shared_lock(shared, W25QXX_SHARED_CLASS_WRITE);                               /* acquire */
+    if (res != 0)                                                                              /* check result */
+    {
+        return res;                                                                            /* return error */
+    }
+    res = w25qxx_write(shared->handle, addr, data, len);                                       /* write */
+    (void)w25qxx_shared_unlock(shared);                                                        /* release */
+    
+    return res;                                                                                /* return result */
+}
+
+/**
+ * @brief     erase in the erase class
+ * @param[in] *shared points to a w25qxx shared structure
+ * @param[in] addr is the erase address
+ * @param[in] len is the erase size, 4096, 32768 or 65536
+ * @return    status code
+ *            - 0 success
+ *            - 1 erase failed
+ *            - 2 shared is NULL
+ *            - 3 shared is not initialized
+ *            - 4 len is invalid
+ * @note      none
+ */
+uint8_t w25qxx_shared_erase(w25qxx_shared_t *shared, uint32_t addr, uint32_t len)
+{
+    uint8_t res;
+    
+    if ((len != 4096) && (len != 32768) && (len != 65536))                                     /* check the size */
+    {
+        return 4;                                                                              /* return error */
+    }
+    res = w25qxx_shared_lock(shared, W25QXX_SHARED_CLASS_ERASE);                               /* acquire */
+    if (res != 0)                                                                              /* check result */
+    {
+        return res;                                                                            /* return error */
+    }
+    if (len == 4096)                                                                           /* 4k sector */
+    {
+        res = w25qxx_sector_erase_4k(shared->handle, addr);                                    /* sector erase 4k */
+    }
+    else if (len == 32768)                                                                     /* 32k block */
+    {
+        res = w25qxx_block_erase_32k(shared->handle, addr);                                    /* block erase 32k */
+    }
+    else
+    {
+        res = w25qxx_block_erase_64k(shared->handle, addr);                                    /* block erase 64k */
+    }
+    (void)w25qxx_shared_unlock(shared);                                                        /* release */
+    
+    return (res != 0) ? 1 : 0;                                                                 /* return result */
+}
+
+/**
+ * @brief     discard a range in the write class
+ * @param[in] *shared points to a w25qxx shared structure
+ * @param[in] addr is the first address
+ * @param[in] len is the range length
+ * @return    status code of w25qxx_shared_lock or w25qxx_discard
+ * @note      none
+ */
+uint8_t w25qxx_shared_discard(w25qxx_shared_t *shared, uint32_t addr, uint32_t len)
+{
+    uint8_t res;
+    
+    res = w25qxx_shared_lock(shared, W25QXX_SHARED_CLASS_WRITE);                               /* acquire */
+    if (res != 0)                                                                              /* check result */
+    {
+        return res;                                                                            /* return error */
+    }
+    res = w25qxx_discard(shared->handle, addr, len);                                           /* queue the sectors */
+    shared->mutex_lock();                                                                      /* lock */
+    shared->active = 0;                                                                        /* release the chip */
+    if (res == 0)                                                                              /* check result */
+    {
+        shared->discard_pending = 1;                                                           /* wake the worker */
+    }
+    shared->cond_broadcast();                                                                  /* wake the waiters */
+    shared->mutex_unlock();                                                                    /* unlock */
+    
+    return res;                                                                                /* return result */
+}
+
+/**
+ * @brief      run one background erase step in the erase class
+ * @param[in]  *shared points to a w25qxx shared structure
+ * @param[out] *erased points to an erased length buffer
+ * @return     status code of w25qxx_shared_lock or w25qxx_discard_step
+ * @note       none
+ */
+uint8_t w25qxx_shared_discard_step(w25qxx_shared_t *shared, uint32_t *erased)
+{
+    uint8_t res;
+    
+    res = w25qxx_shared_lock(shared, W25QXX_SHARED_CLASS_ERASE);                               /* acquire */
+    if (res != 0)                                                                              /* check result */
+    {
+        return res;                                                                            /* return error */
+    }
+    res = w25qxx_discard_step(shared->handle, erased);                                         /* erase one run */
+    (void)w25qxx_shared_unlock(shared);                                                        /* release */
+    
+    return res;                                                                                /* return result */
+}
+
+/**
+ * @brief     run the discard worker
+ * @param[in] *shared points to a w25qxx shared structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 shared is NULL
+ *            - 3 shared is not initialized
+ *            - others status code of w25qxx_shared_discard_step
+ * @note      none
+ */
+uint8_t w25qxx_shared_discard_worker(w25qxx_shared_t *shared)
+{
+    uint8_t res;
+    uint8_t stop;
+    uint32_t erased;
+    
+    if (shared == NULL)                                                                        /* check shared */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (shared->inited != 1)                                                                   /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    
+    stop = 0;                                                                                  /* init 0 */
+    while (stop == 0)                                                                          /* until stopped */
+    {
+        shared->mutex_lock();                                                                  /* lock */
+        while ((shared->discard_stop == 0) && (shared->discard_pending == 0))                  /* wait for discards */
+        {
+            shared->cond_wait();                                                               /* sleep */
+        }
+        stop = shared->discard_stop;                                                           /* get the stop */
+        shared->discard_pending = 0;                                                           /* take the discards */
+        shared->mutex_unlock();                                                                /* unlock */
+        erased = 1;                                                                            /* run a step */
+        while ((stop == 0) && (erased != 0))                                                   /* until the backlog is erased */
+        {
+            res = w25qxx_shared_discard_step(shared, &erased);                                 /* erase one run */
+            if (res != 0)                                                                      /* check result */
+            {
+                return res;                                                                    /* return error */
+            }
+            shared->mutex_lock();                                                              /* lock */
+            stop = shared->discard_stop;                                                       /* get the stop */
+            shared->mutex_unlock();                                                            /* unlock */
+        }
+    }
+    shared->mutex_lock();                                                                      /* lock */
+    shared->discard_stop = 0;                                                                  /* take the stop */
+    shared->mutex_unlock();                                                                    /* unlock */
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief     ask the discard worker to return
+ * @param[in] *shared points to a w25qxx shared structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 shared is NULL
+ *            - 3 shared is not initialized
+ * @note      none
+ */
+uint8_t w25qxx_shared_discard_stop(w25qxx_shared_t *shared)
+{
+    if (shared == NULL)                                                                        /* check shared */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (shared->inited != 1)                                                                   /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    
+    shared->mutex_lock();                                                                      /* lock */
+    shared->discard_stop = 1;                                                                  /* ask the worker */
+    shared->cond_broadcast();                                                                  /* wake the worker */
+    shared->mutex_unlock();                                                                    /* unlock */
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief      get the statistics of a class
+ * @param[in]  *shared points to a w25qxx shared structure
+ * @param[in]  cls is the request class
+ * @param[out] *stats points to a statistics buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 shared is NULL
+ *             - 3 shared is not initialized
+ *             - 4 cls is invalid
+ * @note       none
+ */
+uint8_t w25qxx_shared_get_stats(w25qxx_shared_t *shared, w25qxx_shared_class_t cls, w25qxx_shared_stats_t *stats)
+{
+    if (shared == NULL)                                                                        /* check shared */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (shared->inited != 1)                                                                   /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    if ((uint32_t)cls >= W25QXX_SHARED_CLASS_MAX)                                              /* check the class */
+    {
+        return 4;                                                                              /* return error */
+    }
+    
+    shared->mutex_lock();                                                                      /* lock */
+    memcpy(stats, &shared->stats[cls], sizeof(w25qxx_shared_stats_t));                         /* copy the statistics */
+    shared->mutex_unlock();                                                                    /* unlock */
+    
+    return 0;                                                                                  /* success return 0 */
+}
+
+/**
+ * @brief     clear the statistics
+ * @param[in] *shared points to a w25qxx shared structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 shared is NULL
+ *            - 3 shared is not initialized
+ * @note      none
+ */
+uint8_t w25qxx_shared_clear_stats(w25qxx_shared_t *shared)
+{
+    uint32_t i;
+    uint32_t depth;
+    
+    if (shared == NULL)                                                                        /* check shared */
+    {
+        return 2;                                                                              /* return error */
+    }
+    if (shared->inited != 1)                                                                   /* check initialization */
+    {
+        return 3;                                                                              /* return error */
+    }
+    
+    shared->mutex_lock();                                                                      /* lock */
+    for (i = 0; i < W25QXX_SHARED_CLASS_MAX; i++)                                              /* all classes */
+    {
+        depth = shared->stats[i].depth;                                                        /* keep the depth */
+        memset(&shared->stats[i], 0, sizeof(w25qxx_shared_stats_t));                           /* clear the statistics */
+        shared->stats[i].depth = depth;                                                        /* restore the depth */
+        shared->stats[i].max_depth = depth;                                                    /* restart the max */
+    }
+    shared->mutex_unlock();                                                                    /* unlock */
+    
+    return 0;                                                                                  /* success return 0 */
+}
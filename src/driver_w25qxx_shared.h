@@ -0,0 +1,313 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_shared.h
+ * @brief     driver w25qxx shared header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DRIVER_W25QXX_SHARED_H_
+#define _DRIVER_W25QXX_SHARED_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup w25qxx_shared_driver w25qxx shared driver function
+ * @brief    w25qxx shared driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+/**
+ * @brief w25qxx shared max bypass definition
+ * @note  a waiting class is served first once this many requests of lower classes
+ *        were served ahead of it
+ */
+#ifndef W25QXX_SHARED_MAX_BYPASS
+    #define W25QXX_SHARED_MAX_BYPASS    16        /**< 16 requests */
+#endif
+
+/**
+ * @brief w25qxx shared class enumeration definition
+ * @note  a lower class is served first until W25QXX_SHARED_MAX_BYPASS of its requests
+ *        overtook a waiting higher class
+ */
+typedef enum
+{
+    W25QXX_SHARED_CLASS_READ  = 0x00,        /**< latency sensitive reads */
+    W25QXX_SHARED_CLASS_WRITE = 0x01,        /**< writes */
+    W25QXX_SHARED_CLASS_ERASE = 0x02,        /**< background erases */
+    W25QXX_SHARED_CLASS_MAX   = 0x03,        /**< class number */
+} w25qxx_shared_class_t;
+
+/**
+ * @brief w25qxx shared statistics structure definition
+ */
+typedef struct w25qxx_shared_stats_s
+{
+    uint32_t depth;              /**< requests waiting now */
+    uint32_t max_depth;          /**< most requests waiting at once */
+    uint32_t requests;           /**< served requests */
+    uint64_t wait_us;            /**< total queue wait */
+    uint32_t max_wait_us;        /**< longest queue wait */
+    uint32_t max_bypass;         /**< most lower requests served ahead of one request */
+} w25qxx_shared_stats_t;
+
+/**
+ * @brief w25qxx shared structure definition
+ * @note  the hooks are one mutex and one condition variable, pthread on linux or the rtos primitives on a mcu,
+ *        cond_wait must release the mutex while it sleeps and hold it again when it returns
+ */
+typedef struct w25qxx_shared_s
+{
+    w25qxx_handle_t *handle;                                           /**< w25qxx handle */
+    void (*mutex_lock)(void);                                          /**< point to a mutex_lock function address */
+    void (*mutex_unlock)(void);                                        /**< point to a mutex_unlock function address */
+    void (*cond_wait)(void);                                           /**< point to a cond_wait function address */
+    void (*cond_broadcast)(void);                                      /**< point to a cond_broadcast function address */
+    uint64_t (*timestamp_us)(void);                                    /**< point to a timestamp_us function address, may be NULL */
+    uint32_t next_ticket[W25QXX_SHARED_CLASS_MAX];                     /**< next ticket of every class */
+    uint32_t serving[W25QXX_SHARED_CLASS_MAX];                         /**< ticket served next in every class */
+    uint32_t bypass[W25QXX_SHARED_CLASS_MAX];                          /**< lower requests served ahead of every class */
+    uint8_t active;                                                    /**< a request owns the chip */
+    uint8_t discard_pending;                                           /**< discards wait for the worker */
+    uint8_t discard_stop;                                              /**< the worker is asked to return */
+    uint8_t inited;                                                    /**< inited flag */
+    w25qxx_shared_stats_t stats[W25QXX_SHARED_CLASS_MAX];              /**< statistics of every class */
+} w25qxx_shared_t;
+
+/**
+ * @brief     initialize w25qxx_shared_t structure
+ * @param[in] SHARED is w25qxx_shared_t
+ * @note      none
+ */
+#define DRIVER_W25QXX_SHARED_LINK_INIT(SHARED)                        memset(SHARED, 0, sizeof(w25qxx_shared_t))
+
+/**
+ * @brief     link mutex_lock function
+ * @param[in] SHARED points to a w25qxx shared structure
+ * @param[in] FUC points to a mutex_lock function address
+ * @note      none
+ */
+#define DRIVER_W25QXX_SHARED_LINK_MUTEX_LOCK(SHARED, FUC)             (SHARED)->mutex_lock = FUC
+
+/**
+ * @brief     link mutex_unlock function
+ * @param[in] SHARED points to a w25qxx shared structure
+ * @param[in] FUC points to a mutex_unlock function address
+ * @note      none
+ */
+#define DRIVER_W25QXX_SHARED_LINK_MUTEX_UNLOCK(SHARED, FUC)           (SHARED)->mutex_unlock = FUC
+
+/**
+ * @brief     link cond_wait function
+ * @param[in] SHARED points to a w25qxx shared structure
+ * @param[in] FUC points to a cond_wait function address
+ * @note      none
+ */
+#define DRIVER_W25QXX_SHARED_LINK_COND_WAIT(SHARED, FUC)              (SHARED)->cond_wait = FUC
+
+/**
+ * @brief     link cond_broadcast function
+ * @param[in] SHARED points to a w25qxx shared structure
+ * @param[in] FUC points to a cond_broadcast function address
+ * @note      none
+ */
+#define DRIVER_W25QXX_SHARED_LINK_COND_BROADCAST(SHARED, FUC)         (SHARED)->cond_broadcast = FUC
+
+/**
+ * @brief     link timestamp_us function
+ * @param[in] SHARED points to a w25qxx shared structure
+ * @param[in] FUC points to a timestamp_us function address
+ * @note      none
+ */
+#define DRIVER_W25QXX_SHARED_LINK_TIMESTAMP_US(SHARED, FUC)           (SHARED)->timestamp_us = FUC
+
+/**
+ * @brief     init the shared front end
+ * @param[in] *shared points to a w25qxx shared structure with linked hooks
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 shared or handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 a hook is NULL
+ * @note      the handle must only be used through the front end afterwards
+ */
+uint8_t w25qxx_shared_init(w25qxx_shared_t *shared, w25qxx_handle_t *handle);
+
+/**
+ * @brief     acquire the chip
+ * @param[in] *shared points to a w25qxx shared structure
+ * @param[in] cls is the request class
+ * @return    status code
+ *            - 0 success
+ *            - 2 shared is NULL
+ *            - 3 shared is not initialized
+ *            - 4 cls is invalid
+ * @note      blocks until no request owns the chip, no lower class waits and the earlier
+ *            requests of the same class are served, then the caller may use shared->handle
+ *            until w25qxx_shared_unlock, a class that W25QXX_SHARED_MAX_BYPASS lower requests
+ *            overtook is served before the lower classes, the lowest such class first
+ */
+uint8_t w25qxx_shared_lock(w25qxx_shared_t *shared, w25qxx_shared_class_t cls);
+
+/**
+ * @brief     release the chip
+ * @param[in] *shared points to a w25qxx shared structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 shared is NULL
+ *            - 3 shared is not initialized
+ * @note      none
+ */
+uint8_t w25qxx_shared_unlock(w25qxx_shared_t *shared);
+
+/**
+ * @brief      read data in the read class
+ * @param[in]  *shared points to a w25qxx shared structure
+ * @param[in]  addr is the read address
+ * @param[out] *data points to a data buffer
+ * @param[in]  len is the data length
+ * @return     status code of w25qxx_shared_lock or w25qxx_read
+ * @note       none
+ */
+uint8_t w25qxx_shared_read(w25qxx_shared_t *shared, uint32_t addr, uint8_t *data, uint32_t len);
+
+/**
+ * @brief     write data in the write class
+ * @param[in] *shared points to a w25qxx shared structure
+ * @param[in] addr is the write address
+ * @param[in] *data points to a data buffer
+ * @param[in] len is the data length
+ * @return    status code of w25qxx_shared_lock or w25qxx_write
+ * @note      none
+ */
+uint8_t w25qxx_shared_write(w25qxx_shared_t *shared, uint32_t addr, uint8_t *data, uint32_t len);
+
+/**
+ * @brief     erase in the erase class
+ * @param[in] *shared points to a w25qxx shared structure
+ * @param[in] addr is the erase address
+ * @param[in] len is the erase size, 4096, 32768 or 65536
+ * @return    status code
+ *            - 0 success
+ *            - 1 erase failed
+ *            - 2 shared is NULL
+ *            - 3 shared is not initialized
+ *            - 4 len is invalid
+ * @note      none
+ */
+uint8_t w25qxx_shared_erase(w25qxx_shared_t *shared, uint32_t addr, uint32_t len);
+
+/**
+ * @brief     discard a range in the write class
+ * @param[in] *shared points to a w25qxx shared structure
+ * @param[in] addr is the first address
+ * @param[in] len is the range length
+ * @return    status code of w25qxx_shared_lock or w25qxx_discard
+ * @note      wakes the discard worker
+ */
+uint8_t w25qxx_shared_discard(w25qxx_shared_t *shared, uint32_t addr, uint32_t len);
+
+/**
+ * @brief      run one background erase step in the erase class
+ * @param[in]  *shared points to a w25qxx shared structure
+ * @param[out] *erased points to an erased length buffer
+ * @return     status code of w25qxx_shared_lock or w25qxx_discard_step
+ * @note       none
+ */
+uint8_t w25qxx_shared_discard_step(w25qxx_shared_t *shared, uint32_t *erased);
+
+/**
+ * @brief     run the discard worker
+ * @param[in] *shared points to a w25qxx shared structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 shared is NULL
+ *            - 3 shared is not initialized
+ *            - others status code of w25qxx_shared_discard_step
+ * @note      the body of a low priority thread or rtos task, it sleeps on the condition until
+ *            w25qxx_shared_discard queues sectors, then runs w25qxx_shared_discard_step until the
+ *            backlog is erased, every step is one erase class request so the reads and writes keep
+ *            the chip first, returns after w25qxx_shared_discard_stop or when a step fails
+ */
+uint8_t w25qxx_shared_discard_worker(w25qxx_shared_t *shared);
+
+/**
+ * @brief     ask the discard worker to return
+ * @param[in] *shared points to a w25qxx shared structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 shared is NULL
+ *            - 3 shared is not initialized
+ * @note      the worker returns after its current step
+ */
+uint8_t w25qxx_shared_discard_stop(w25qxx_shared_t *shared);
+
+/**
+ * @brief      get the statistics of a class
+ * @param[in]  *shared points to a w25qxx shared structure
+ * @param[in]  cls is the request class
+ * @param[out] *stats points to a statistics buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 shared is NULL
+ *             - 3 shared is not initialized
+ *             - 4 cls is invalid
+ * @note       the wait times need the timestamp_us hook
+ */
+uint8_t w25qxx_shared_get_stats(w25qxx_shared_t *shared, w25qxx_shared_class_t cls, w25qxx_shared_stats_t *stats);
+
+/**
+ * @brief     clear the statistics
+ * @param[in] *shared points to a w25qxx shared structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 shared is NULL
+ *            - 3 shared is not initialized
+ * @note      the current depths are kept
+ */
+uint8_t w25qxx_shared_clear_stats(w25qxx_shared_t *shared);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
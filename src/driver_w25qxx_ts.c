@@ -0,0 +1,942 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_ts.c
+ * @brief     driver w25qxx ts source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_ts.h"
+#include "driver_w25qxx_crc.h"
+#include "driver_w25qxx_endian.h"
+
+/**
+ * @brief ts summary layout definition
+ * @note  magic[4] max_ts[4] count[4] crc32[4] and 15 page aggregates of first_ts[4] min[4] max[4] sum[4]
+ */
+#define W25QXX_TS_MAGIC            0x31535354U        /**< "TSS1" */
+#define W25QXX_TS_SUMMARY_AGG      16                 /**< page aggregates offset */
+
+/**
+ * @brief ts summary status definition
+ */
+#define W25QXX_TS_SUMMARY_VALID    0        /**< closed sector */
+#define W25QXX_TS_SUMMARY_ERROR    1        /**< read failed */
+#define W25QXX_TS_SUMMARY_OPEN     5        /**< marked sector without summary */
+#define W25QXX_TS_SUMMARY_TORN     6        /**< torn summary */
+#define W25QXX_TS_SUMMARY_FOREIGN  7        /**< unmarked sector */
+
+/**
+ * @brief     put a float
+ * @param[in] *buf points to a data buffer
+ * @param[in] v is the value
+ * @note      stored as its 32 bits ieee 754 pattern
+ */
+static void _w25qxx_ts_put_float(uint8_t *buf, float v)
+{
+    uint32_t u;
+    
+    memcpy(&u, &v, 4);                                                                 /* get bits */
+    _w25qxx_put32(buf, u);                                                             /* put bits */
+}
+
+/**
+ * @brief     get a float
+ * @param[in] *buf points to a data buffer
+ * @return    value
+ * @note      none
+ */
+static float _w25qxx_ts_get_float(const uint8_t *buf)
+{
+    uint32_t u;
+    float v;
+    
+    u = _w25qxx_get32(buf);                                                            /* get bits */
+    memcpy(&v, &u, 4);                                                                 /* set value */
+    
+    return v;                                                                          /* return value */
+}
+
+/**
+ * @brief     get the summary crc
+ * @param[in] *buf points to a summary page
+ * @return    crc
+ * @note      covers max_ts, count and the page aggregates
+ */
+static uint32_t _w25qxx_ts_summary_crc(const uint8_t *buf)
+{
+    uint32_t crc;
+    
+    crc = w25qxx_crc32(0, &buf[4], 8);                                                 /* max_ts and count */
+    crc = w25qxx_crc32(crc, &buf[W25QXX_TS_SUMMARY_AGG], 256 - W25QXX_TS_SUMMARY_AGG); /* page aggregates */
+    
+    return crc;                                                                        /* return crc */
+}
+
+/**
+ * @brief     get the address of a page
+ * @param[in] *ts points to a w25qxx ts structure
+ * @param[in] s is the sector index
+ * @param[in] page is the page index
+ * @return    flash address
+ * @note      none
+ */
+static uint32_t _w25qxx_ts_addr(w25qxx_ts_t *ts, uint32_t s, uint32_t page)
+{
+    return (ts->first + s) * 4096 + page * 256;                                        /* get address */
+}
+
+/**
+ * @brief     get the sample number of a sector page
+ * @param[in] count is the sector sample number
+ * @param[in] j is the page index from 0
+ * @return    sample number
+ * @note      pages are filled in order, only the last one may be partial
+ */
+static uint32_t _w25qxx_ts_page_count(uint32_t count, uint32_t j)
+{
+    if (count <= j * W25QXX_TS_PAGE_SAMPLES)                                           /* no sample */
+    {
+        return 0;                                                                      /* return 0 */
+    }
+    count -= j * W25QXX_TS_PAGE_SAMPLES;                                               /* skip the previous pages */
+    
+    return (count > W25QXX_TS_PAGE_SAMPLES) ? W25QXX_TS_PAGE_SAMPLES : count;          /* return number */
+}
+
+/**
+ * @brief     fold a sample into a page aggregate
+ * @param[in] *agg points to a page aggregate
+ * @param[in] first is the first sample of the page
+ * @param[in] timestamp is the sample timestamp
+ * @param[in] value is the sample value
+ * @note      none
+ */
+static void _w25qxx_ts_fold(w25qxx_ts_page_t *agg, uint8_t first, uint32_t timestamp, float value)
+{
+    if (first != 0)                                                                    /* first sample */
+    {
+        agg->first_ts = timestamp;                                                     /* set first timestamp */
+        agg->min = value;                                                              /* set min */
+        agg->max = value;                                                              /* set max */
+        agg->sum = value;                                                              /* set sum */
+        
+        return;                                                                        /* return */
+    }
+    agg->min = (value < agg->min) ? value : agg->min;                                  /* update min */
+    agg->max = (value > agg->max) ? value : agg->max;                                  /* update max */
+    agg->sum += value;                                                                 /* update sum */
+}
+
+/**
+ * @brief     fill a sector index entry from its page aggregates
+ * @param[in] *ts points to a w25qxx ts structure
+ * @param[in] s is the sector index
+ * @param[in] *agg points to the page aggregates
+ * @param[in] count is the sample number
+ * @param[in] max_ts is the last timestamp
+ * @note      none
+ */
+static void _w25qxx_ts_index(w25qxx_ts_t *ts, uint32_t s, const w25qxx_ts_page_t *agg, 
+                             uint32_t count, uint32_t max_ts)
+{
+    w25qxx_ts_sector_t *e;
+    uint32_t j;
+    
+    e = &ts->sector[s];                                                                /* get entry */
+    e->count = count;                                                                  /* set count */
+    e->max_ts = max_ts;                                                                /* set last timestamp */
+    if (count == 0)                                                                    /* empty */
+    {
+        return;                                                                        /* return */
+    }
+    e->min_ts = agg[0].first_ts;                                                       /* set first timestamp */
+    e->min = agg[0].min;                                                               /* set min */
+    e->max = agg[0].max;                                                               /* set max */
+    e->sum = agg[0].sum;                                                               /* set sum */
+    for (j = 1; (j < W25QXX_TS_SECTOR_PAGES) && (_w25qxx_ts_page_count(count, j) != 0); j++)  /* other pages */
+    {
+        e->min = (agg[j].min < e->min) ? agg[j].min : e->min;                          /* update min */
+        e->max = (agg[j].max > e->max) ? agg[j].max : e->max;                          /* update max */
+        e->sum += agg[j].sum;                                                          /* update sum */
+    }
+}
+
+/**
+ * @brief      read the summary of a sector
+ * @param[in]  *ts points to a w25qxx ts structure
+ * @param[in]  s is the sector index
+ * @param[out] *agg points to a page aggregate table
+ * @param[out] *count points to a sample number buffer
+ * @param[out] *max_ts points to a last timestamp buffer
+ * @return     summary status
+ * @note       none
+ */
+static uint8_t _w25qxx_ts_summary_read(w25qxx_ts_t *ts, uint32_t s, w25qxx_ts_page_t *agg, 
+                                       uint32_t *count, uint32_t *max_ts)
+{
+    uint8_t *p;
+    uint32_t i;
+    uint32_t j;
+    
+    if (w25qxx_read(ts->handle, _w25qxx_ts_addr(ts, s, 0), ts->page, 256) != 0)       /* read summary */
+    {
+        ts->handle->debug_print("w25qxx: ts read failed.\n");                          /* ts read failed */
+        
+        return W25QXX_TS_SUMMARY_ERROR;                                                /* return error */
+    }
+    if (_w25qxx_get32(ts->page) != W25QXX_TS_MAGIC)                                    /* check mark */
+    {
+        return W25QXX_TS_SUMMARY_FOREIGN;                                              /* foreign */
+    }
+    if (_w25qxx_get32(&ts->page[12]) != _w25qxx_ts_summary_crc(ts->page))              /* check crc */
+    {
+        for (i = 4; i < 256; i++)                                                      /* check the rest */
+        {
+            if (ts->page[i] != 0xFF)                                                   /* not erased */
+            {
+                return W25QXX_TS_SUMMARY_TORN;                                         /* torn */
+            }
+        }
+        
+        return W25QXX_TS_SUMMARY_OPEN;                                                 /* open */
+    }
+    *max_ts = _w25qxx_get32(&ts->page[4]);                                             /* get last timestamp */
+    *count = _w25qxx_get32(&ts->page[8]);                                              /* get count */
+    if (*count > W25QXX_TS_SECTOR_SAMPLES)                                             /* check count */
+    {
+        return W25QXX_TS_SUMMARY_TORN;                                                 /* torn */
+    }
+    for (j = 0; j < W25QXX_TS_SECTOR_PAGES; j++)                                       /* page aggregates */
+    {
+        p = &ts->page[W25QXX_TS_SUMMARY_AGG + j * 16];                                 /* get entry */
+        agg[j].first_ts = _w25qxx_get32(&p[0]);                                        /* get first timestamp */
+        agg[j].min = _w25qxx_ts_get_float(&p[4]);                                      /* get min */
+        agg[j].max = _w25qxx_ts_get_float(&p[8]);                                      /* get max */
+        agg[j].sum = _w25qxx_ts_get_float(&p[12]);                                     /* get sum */
+    }
+    
+    return W25QXX_TS_SUMMARY_VALID;                                                    /* valid */
+}
+
+/**
+ * @brief      scan the sample pages of a sector
+ * @param[in]  *ts points to a w25qxx ts structure
+ * @param[in]  s is the sector index
+ * @param[out] *agg points to a page aggregate table
+ * @param[out] *count points to a sample number buffer
+ * @param[out] *max_ts points to a last timestamp buffer
+ * @param[out] *torn points to a torn flag buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ * @note       the scan stops at the first erased or decreasing timestamp, ts->page keeps
+ *             the last page read, torn is set when the rest of that page is not erased
+ */
+static uint8_t _w25qxx_ts_scan(w25qxx_ts_t *ts, uint32_t s, w25qxx_ts_page_t *agg, 
+                               uint32_t *count, uint32_t *max_ts, uint8_t *torn)
+{
+    uint32_t j;
+    uint32_t i;
+    uint32_t k;
+    uint32_t t;
+    uint32_t prev;
+    
+    *count = 0;                                                                        /* init 0 */
+    *max_ts = 0;                                                                       /* init 0 */
+    *torn = 0;                                                                         /* init 0 */
+    prev = 0;                                                                          /* init 0 */
+    for (j = 0; j < W25QXX_TS_SECTOR_PAGES; j++)                                       /* all sample pages */
+    {
+        if (w25qxx_read(ts->handle, _w25qxx_ts_addr(ts, s, j + 1), ts->page, 256) != 0)       /* read page */
+        {
+            ts->handle->debug_print("w25qxx: ts read failed.\n");                      /* ts read failed */
+            
+            return 1;                                                                  /* return error */
+        }
+        for (i = 0; i < W25QXX_TS_PAGE_SAMPLES; i++)                                   /* all samples */
+        {
+            t = _w25qxx_get32(&ts->page[i * 8]);                                       /* get timestamp */
+            if ((t == 0xFFFFFFFFU) || (t < prev))                                      /* end of the samples */
+            {
+                for (k = i * 8; k < 256; k++)                                          /* check the rest */
+                {
+                    if (ts->page[k] != 0xFF)                                           /* not erased */
+                    {
+                        *torn = 1;                                                     /* torn */
+                        
+                        break;                                                         /* break */
+                    }
+                }
+                
+                return 0;                                                              /* success return 0 */
+            }
+            _w25qxx_ts_fold(&agg[j], (uint8_t)(i == 0), t, _w25qxx_ts_get_float(&ts->page[i * 8 + 4]));       /* fold */
+            prev = t;                                                                  /* save timestamp */
+            *max_ts = t;                                                               /* set last timestamp */
+            (*count)++;                                                                /* count++ */
+        }
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     open the next sector
+ * @param[in] *ts points to a w25qxx ts structure
+ * @param[in] s is the sector index
+ * @note      the sector is erased by the first flush, the oldest data is dropped from the index now
+ */
+static void _w25qxx_ts_enter(w25qxx_ts_t *ts, uint32_t s)
+{
+    uint32_t k;
+    
+    memset(&ts->sector[s], 0, sizeof(w25qxx_ts_sector_t));                             /* drop the sector */
+    memset(ts->agg, 0, sizeof(ts->agg));                                               /* clear aggregates */
+    ts->head = s;                                                                      /* set head */
+    ts->head_page = 1;                                                                 /* first sample page */
+    ts->fill = 0;                                                                      /* clear buffer */
+    ts->programmed = 0;                                                                /* clear buffer */
+    ts->erased = 0;                                                                    /* not erased */
+    ts->tail = s;                                                                      /* empty store */
+    for (k = 1; k < ts->num; k++)                                                      /* find the oldest sector */
+    {
+        if (ts->sector[(s + k) % ts->num].count != 0)                                  /* found */
+        {
+            ts->tail = (s + k) % ts->num;                                              /* set tail */
+            
+            break;                                                                     /* break */
+        }
+    }
+}
+
+/**
+ * @brief     write the summary of the open sector
+ * @param[in] *ts points to a w25qxx ts structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 program failed
+ * @note      the magic was programmed when the sector opened and is kept as 0xFF here
+ */
+static uint8_t _w25qxx_ts_close(w25qxx_ts_t *ts)
+{
+    uint8_t *p;
+    uint32_t j;
+    w25qxx_ts_sector_t *e;
+    
+    e = &ts->sector[ts->head];                                                         /* get entry */
+    memset(ts->page, 0xFF, 256);                                                       /* unused pages stay erased */
+    _w25qxx_put32(&ts->page[4], e->max_ts);                                            /* set last timestamp */
+    _w25qxx_put32(&ts->page[8], e->count);                                             /* set count */
+    for (j = 0; j < W25QXX_TS_SECTOR_PAGES; j++)                                       /* page aggregates */
+    {
+        if (_w25qxx_ts_page_count(e->count, j) == 0)                                   /* no sample */
+        {
+            break;                                                                     /* break */
+        }
+        p = &ts->page[W25QXX_TS_SUMMARY_AGG + j * 16];                                 /* get entry */
+        _w25qxx_put32(&p[0], ts->agg[j].first_ts);                                     /* set first timestamp */
+        _w25qxx_ts_put_float(&p[4], ts->agg[j].min);                                   /* set min */
+        _w25qxx_ts_put_float(&p[8], ts->agg[j].max);                                   /* set max */
+        _w25qxx_ts_put_float(&p[12], ts->agg[j].sum);                                  /* set sum */
+    }
+    _w25qxx_put32(&ts->page[12], _w25qxx_ts_summary_crc(ts->page));                    /* set crc */
+    if (w25qxx_page_program(ts->handle, _w25qxx_ts_addr(ts, ts->head, 0), ts->page, 256) != 0)     /* program summary */
+    {
+        ts->handle->debug_print("w25qxx: ts program failed.\n");                       /* ts program failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    e->closed = 1;                                                                     /* closed */
+    _w25qxx_ts_enter(ts, (ts->head + 1) % ts->num);                                    /* open the next sector */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief      get the page aggregates of a sector
+ * @param[in]  *ts points to a w25qxx ts structure
+ * @param[in]  s is the sector index
+ * @param[out] **agg points to a page aggregate table pointer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ * @note       the open sector is served from ram, a sector with a torn summary is scanned
+ */
+static uint8_t _w25qxx_ts_view(w25qxx_ts_t *ts, uint32_t s, w25qxx_ts_page_t **agg)
+{
+    uint8_t res;
+    uint8_t torn;
+    uint32_t count;
+    uint32_t max_ts;
+    
+    if (s == ts->head)                                                                 /* open sector */
+    {
+        *agg = ts->agg;                                                                /* ram aggregates */
+        
+        return 0;                                                                      /* success return 0 */
+    }
+    *agg = ts->view;                                                                   /* view aggregates */
+    res = _w25qxx_ts_summary_read(ts, s, ts->view, &count, &max_ts);                   /* read summary */
+    if (res == W25QXX_TS_SUMMARY_VALID)                                                /* closed */
+    {
+        return 0;                                                                      /* success return 0 */
+    }
+    if (res == W25QXX_TS_SUMMARY_ERROR)                                                /* read failed */
+    {
+        return 1;                                                                      /* return error */
+    }
+    
+    return _w25qxx_ts_scan(ts, s, ts->view, &count, &max_ts, &torn);                  /* scan the sector */
+}
+
+/**
+ * @brief     get the first logical sector whose samples reach a timestamp
+ * @param[in] *ts points to a w25qxx ts structure
+ * @param[in] t1 is the timestamp
+ * @param[in] n is the logical sector number
+ * @return    logical index, n if none
+ * @note      binary search on the ram index, sectors are in time order from the tail
+ */
+static uint32_t _w25qxx_ts_lower(w25qxx_ts_t *ts, uint32_t t1, uint32_t n)
+{
+    uint32_t lo;
+    uint32_t hi;
+    uint32_t mid;
+    w25qxx_ts_sector_t *e;
+    
+    lo = 0;                                                                            /* init 0 */
+    hi = n;                                                                            /* init n */
+    while (lo < hi)                                                                    /* binary search */
+    {
+        mid = lo + (hi - lo) / 2;                                                      /* get middle */
+        e = &ts->sector[(ts->tail + mid) % ts->num];                                   /* get entry */
+        if ((e->count != 0) && (e->max_ts < t1))                                       /* before the range */
+        {
+            lo = mid + 1;                                                              /* right half */
+        }
+        else
+        {
+            hi = mid;                                                                  /* left half */
+        }
+    }
+    
+    return lo;                                                                         /* return index */
+}
+
+/**
+ * @brief     get the first page of a sector that may hold a timestamp
+ * @param[in] *agg points to the page aggregates
+ * @param[in] pages is the page number
+ * @param[in] t1 is the timestamp
+ * @return    page index
+ * @note      binary search for the last page starting before t1
+ */
+static uint32_t _w25qxx_ts_page_lower(const w25qxx_ts_page_t *agg, uint32_t pages, uint32_t t1)
+{
+    uint32_t lo;
+    uint32_t hi;
+    uint32_t mid;
+    
+    lo = 0;                                                                            /* init 0 */
+    hi = pages;                                                                        /* init pages */
+    while (hi - lo > 1)                                                                /* binary search */
+    {
+        mid = lo + (hi - lo) / 2;                                                      /* get middle */
+        if (agg[mid].first_ts < t1)                                                    /* starts before */
+        {
+            lo = mid;                                                                  /* right half */
+        }
+        else
+        {
+            hi = mid;                                                                  /* left half */
+        }
+    }
+    
+    return lo;                                                                         /* return page */
+}
+
+/**
+ * @brief     mount the time series store
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *ts points to a w25qxx ts structure
+ * @param[in] *sector points to a table of num entries
+ * @param[in] first is the first 4k sector
+ * @param[in] num is the sector number
+ * @return    status code
+ *            - 0 success
+ *            - 1 mount failed
+ *            - 2 handle or ts is NULL
+ *            - 3 handle is not initialized
+ *            - 4 param is invalid
+ * @note      a closed sector costs one summary read, only the open sector is scanned,
+ *            an unmarked sector mounts as empty
+ */
+uint8_t w25qxx_ts_mount(w25qxx_handle_t *handle, w25qxx_ts_t *ts, w25qxx_ts_sector_t *sector, 
+                        uint32_t first, uint32_t num)
+{
+    uint8_t res;
+    uint8_t torn;
+    uint32_t s;
+    uint32_t best;
+    uint32_t next;
+    uint32_t count;
+    uint32_t max_ts;
+    
+    if ((handle == NULL) || (ts == NULL))                                              /* check handle */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if (handle->inited != 1)                                                           /* check handle initialization */
+    {
+        return 3;                                                                      /* return error */
+    }
+    if ((sector == NULL) || (num < 2))                                                 /* check param */
+    {
+        handle->debug_print("w25qxx: ts param is invalid.\n");                         /* ts param is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    memset(ts, 0, sizeof(w25qxx_ts_t));                                                /* clear the structure */
+    memset(sector, 0, sizeof(w25qxx_ts_sector_t) * num);                               /* clear the index */
+    ts->handle = handle;                                                               /* set handle */
+    ts->sector = sector;                                                               /* set index */
+    ts->first = first;                                                                 /* set first */
+    ts->num = num;                                                                     /* set number */
+    
+    for (s = 0; s < num; s++)                                                          /* build the index */
+    {
+        memset(ts->agg, 0, sizeof(ts->agg));                                           /* clear aggregates */
+        count = 0;                                                                     /* init 0 */
+        max_ts = 0;                                                                    /* init 0 */
+        res = _w25qxx_ts_summary_read(ts, s, ts->agg, &count, &max_ts);                /* read summary */
+        if (res == W25QXX_TS_SUMMARY_ERROR)                                            /* read failed */
+        {
+            return 1;                                                                  /* return error */
+        }
+        if ((res == W25QXX_TS_SUMMARY_OPEN) || (res == W25QXX_TS_SUMMARY_TORN))        /* no summary */
+        {
+            if (_w25qxx_ts_scan(ts, s, ts->agg, &count, &max_ts, &torn) != 0)          /* scan the sector */
+            {
+                return 1;                                                              /* return error */
+            }
+        }
+        _w25qxx_ts_index(ts, s, ts->agg, count, max_ts);                               /* fill the entry */
+        sector[s].closed = (uint8_t)(res != W25QXX_TS_SUMMARY_OPEN);                   /* only a marked sector is open */
+    }
+    
+    /* the newest sector has the largest timestamp and no newer neighbour after it */
+    best = num;                                                                        /* none */
+    for (s = 0; s < num; s++)                                                          /* all sectors */
+    {
+        if ((sector[s].count != 0) && ((best == num) || (sector[s].max_ts > sector[best].max_ts)))     /* newer */
+        {
+            best = s;                                                                  /* save sector */
+        }
+    }
+    if (best == num)                                                                   /* empty store */
+    {
+        _w25qxx_ts_enter(ts, 0);                                                       /* open the first sector */
+        
+        return 0;                                                                      /* success return 0 */
+    }
+    for (s = 0; s < num; s++)                                                          /* resolve equal timestamps */
+    {
+        next = (best + 1) % num;                                                       /* get next */
+        if ((sector[next].count == 0) || (sector[next].max_ts != sector[best].max_ts) || 
+            (sector[next].min_ts < sector[best].min_ts))                               /* best is the newest */
+        {
+            break;                                                                     /* break */
+        }
+        best = next;                                                                   /* move on */
+    }
+    ts->last_ts = sector[best].max_ts;                                                 /* set last timestamp */
+    if (sector[best].closed != 0)                                                      /* the newest sector is closed */
+    {
+        _w25qxx_ts_enter(ts, (best + 1) % num);                                        /* open the next sector */
+        
+        return 0;                                                                      /* success return 0 */
+    }
+    
+    /* reopen the newest sector and reload its partial page */
+    _w25qxx_ts_enter(ts, best);                                                        /* set head */
+    if (_w25qxx_ts_scan(ts, best, ts->agg, &count, &max_ts, &torn) != 0)               /* scan the sector */
+    {
+        return 1;                                                                      /* return error */
+    }
+    _w25qxx_ts_index(ts, best, ts->agg, count, max_ts);                                /* fill the entry */
+    ts->erased = 1;                                                                    /* marked */
+    ts->head_page = (uint8_t)(1 + count / W25QXX_TS_PAGE_SAMPLES);                     /* set page */
+    ts->fill = (uint8_t)(count % W25QXX_TS_PAGE_SAMPLES);                              /* set fill */
+    ts->programmed = ts->fill;                                                         /* already programmed */
+    memcpy(ts->buf, ts->page, 256);                                                    /* reload the partial page */
+    if ((torn != 0) || (ts->head_page > W25QXX_TS_SECTOR_PAGES))                       /* torn or full */
+    {
+        ts->fill = 0;                                                                  /* drop the partial page */
+        ts->programmed = 0;                                                            /* drop the partial page */
+        
+        return _w25qxx_ts_close(ts);                                                   /* close it */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     flush and unmount the time series store
+ * @param[in] *ts points to a w25qxx ts structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 ts is NULL
+ * @note      none
+ */
+uint8_t w25qxx_ts_unmount(w25qxx_ts_t *ts)
+{
+    uint8_t res;
+    
+    if ((ts == NULL) || (ts->handle == NULL))                                          /* check ts */
+    {
+        return 2;                                                                      /* return error */
+    }
+    
+    res = w25qxx_ts_flush(ts);                                                         /* flush */
+    if (res != 0)
+    {
+        return res;                                                                    /* return error */
+    }
+    ts->handle = NULL;                                                                 /* unmounted */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     append a sample
+ * @param[in] *ts points to a w25qxx ts structure
+ * @param[in] timestamp is the sample timestamp
+ * @param[in] value is the sample value
+ * @return    status code
+ *            - 0 success
+ *            - 1 append failed
+ *            - 2 ts is NULL
+ *            - 4 timestamp is invalid
+ * @note      timestamps must not decrease, a full page is programmed at once,
+ *            a full sector gets its summary and the oldest sector is erased
+ */
+uint8_t w25qxx_ts_append(w25qxx_ts_t *ts, uint32_t timestamp, float value)
+{
+    w25qxx_ts_sector_t *e;
+    
+    if ((ts == NULL) || (ts->handle == NULL))                                          /* check ts */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if ((timestamp == 0xFFFFFFFFU) || (timestamp < ts->last_ts))                       /* check timestamp */
+    {
+        ts->handle->debug_print("w25qxx: timestamp is invalid.\n");                    /* timestamp is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    _w25qxx_put32(&ts->buf[ts->fill * 8], timestamp);                                  /* set timestamp */
+    _w25qxx_ts_put_float(&ts->buf[ts->fill * 8 + 4], value);                           /* set value */
+    _w25qxx_ts_fold(&ts->agg[ts->head_page - 1], (uint8_t)(ts->fill == 0), timestamp, value);      /* page aggregate */
+    e = &ts->sector[ts->head];                                                         /* get entry */
+    if (e->count == 0)                                                                 /* first sample of the sector */
+    {
+        e->min_ts = timestamp;                                                         /* set first timestamp */
+        e->min = value;                                                                /* set min */
+        e->max = value;                                                                /* set max */
+        e->sum = 0.0f;                                                                 /* init 0 */
+    }
+    e->min = (value < e->min) ? value : e->min;                                        /* update min */
+    e->max = (value > e->max) ? value : e->max;                                        /* update max */
+    e->sum += value;                                                                   /* update sum */
+    e->max_ts = timestamp;                                                             /* set last timestamp */
+    e->count++;                                                                        /* count++ */
+    ts->last_ts = timestamp;                                                           /* save timestamp */
+    ts->fill++;                                                                        /* fill++ */
+    if (ts->fill == W25QXX_TS_PAGE_SAMPLES)                                            /* page full */
+    {
+        return w25qxx_ts_flush(ts);                                                    /* program the page */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     program the buffered samples
+ * @param[in] *ts points to a w25qxx ts structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 ts is NULL
+ * @note      only the new samples are programmed, the page keeps filling afterwards
+ */
+uint8_t w25qxx_ts_flush(w25qxx_ts_t *ts)
+{
+    if ((ts == NULL) || (ts->handle == NULL))                                          /* check ts */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if (ts->fill == ts->programmed)                                                    /* nothing buffered */
+    {
+        return 0;                                                                      /* success return 0 */
+    }
+    
+    if (ts->erased == 0)                                                               /* first samples of the sector */
+    {
+        if (w25qxx_sector_erase_4k(ts->handle, _w25qxx_ts_addr(ts, ts->head, 0)) != 0) /* erase sector */
+        {
+            ts->handle->debug_print("w25qxx: ts erase failed.\n");                     /* ts erase failed */
+            
+            return 1;                                                                  /* return error */
+        }
+        _w25qxx_put32(ts->page, W25QXX_TS_MAGIC);                                      /* set magic */
+        if (w25qxx_page_program(ts->handle, _w25qxx_ts_addr(ts, ts->head, 0), ts->page, 4) != 0)  /* mark sector */
+        {
+            ts->handle->debug_print("w25qxx: ts program failed.\n");                   /* ts program failed */
+            
+            return 1;                                                                  /* return error */
+        }
+        ts->erased = 1;                                                                /* marked */
+    }
+    memset(ts->page, 0xFF, ts->programmed * 8);                                        /* keep the programmed samples */
+    memcpy(&ts->page[ts->programmed * 8], &ts->buf[ts->programmed * 8], 
+           (ts->fill - ts->programmed) * 8);                                           /* copy the new samples */
+    if (w25qxx_page_program(ts->handle, _w25qxx_ts_addr(ts, ts->head, ts->head_page), 
+                            ts->page, (uint16_t)(ts->fill * 8)) != 0)                  /* program page */
+    {
+        ts->handle->debug_print("w25qxx: ts program failed.\n");                       /* ts program failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    ts->programmed = ts->fill;                                                         /* programmed */
+    if (ts->fill == W25QXX_TS_PAGE_SAMPLES)                                            /* page full */
+    {
+        ts->head_page++;                                                               /* next page */
+        ts->fill = 0;                                                                  /* clear buffer */
+        ts->programmed = 0;                                                            /* clear buffer */
+        if (ts->head_page > W25QXX_TS_SECTOR_PAGES)                                    /* sector full */
+        {
+            return _w25qxx_ts_close(ts);                                               /* write the summary */
+        }
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief      query the samples in a time range
+ * @param[in]  *ts points to a w25qxx ts structure
+ * @param[in]  t1 is the first timestamp
+ * @param[in]  t2 is the last timestamp
+ * @param[out] *samples points to a sample buffer
+ * @param[in]  max is the buffer length
+ * @param[out] *num points to a sample number buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 query failed
+ *             - 2 ts is NULL
+ *             - 4 param is invalid
+ * @note       sectors and pages are found by binary search, only the matching pages are read,
+ *             the result stops at max samples, unflushed samples are returned from the page
+ *             buffer like w25qxx_ts_downsample counts them
+ */
+uint8_t w25qxx_ts_query(w25qxx_ts_t *ts, uint32_t t1, uint32_t t2, w25qxx_ts_sample_t *samples, 
+                        uint32_t max, uint32_t *num)
+{
+    uint32_t n;
+    uint32_t k;
+    uint32_t s;
+    uint32_t j;
+    uint32_t i;
+    uint32_t cnt;
+    uint32_t pages;
+    uint32_t t;
+    uint8_t *src;
+    w25qxx_ts_page_t *agg;
+    
+    if ((ts == NULL) || (ts->handle == NULL))                                          /* check ts */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if ((samples == NULL) || (num == NULL) || (t1 > t2))                               /* check param */
+    {
+        ts->handle->debug_print("w25qxx: ts param is invalid.\n");                     /* ts param is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    *num = 0;                                                                          /* init 0 */
+    n = (ts->head + ts->num - ts->tail) % ts->num + 1;                                 /* logical sectors */
+    for (k = _w25qxx_ts_lower(ts, t1, n); k < n; k++)                                  /* matching sectors */
+    {
+        s = (ts->tail + k) % ts->num;                                                  /* get sector */
+        if (ts->sector[s].count == 0)                                                  /* empty */
+        {
+            continue;                                                                  /* skip */
+        }
+        if (ts->sector[s].min_ts > t2)                                                 /* after the range */
+        {
+            break;                                                                     /* break */
+        }
+        if (_w25qxx_ts_view(ts, s, &agg) != 0)                                         /* get page aggregates */
+        {
+            return 1;                                                                  /* return error */
+        }
+        pages = (ts->sector[s].count + W25QXX_TS_PAGE_SAMPLES - 1) / W25QXX_TS_PAGE_SAMPLES;       /* page number */
+        for (j = _w25qxx_ts_page_lower(agg, pages, t1); j < pages; j++)                /* matching pages */
+        {
+            if (agg[j].first_ts > t2)                                                  /* after the range */
+            {
+                return 0;                                                              /* success return 0 */
+            }
+            cnt = _w25qxx_ts_page_count(ts->sector[s].count, j);                       /* get sample number */
+            if ((s == ts->head) && (j == (uint32_t)(ts->head_page - 1)))               /* partial page */
+            {
+                cnt = ts->fill;                                                        /* programmed and buffered samples */
+                src = ts->buf;                                                         /* the page buffer */
+            }
+            else
+            {
+                if (w25qxx_read(ts->handle, _w25qxx_ts_addr(ts, s, j + 1), ts->page, cnt * 8) != 0)   /* read samples */
+                {
+                    ts->handle->debug_print("w25qxx: ts read failed.\n");              /* ts read failed */
+                    
+                    return 1;                                                          /* return error */
+                }
+                src = ts->page;                                                        /* the read samples */
+            }
+            for (i = 0; i < cnt; i++)                                                  /* all samples */
+            {
+                t = _w25qxx_get32(&src[i * 8]);                                        /* get timestamp */
+                if (t > t2)                                                            /* after the range */
+                {
+                    return 0;                                                          /* success return 0 */
+                }
+                if (t < t1)                                                            /* before the range */
+                {
+                    continue;                                                          /* skip */
+                }
+                if (*num == max)                                                       /* buffer full */
+                {
+                    return 0;                                                          /* success return 0 */
+                }
+                samples[*num].timestamp = t;                                           /* set timestamp */
+                samples[*num].value = _w25qxx_ts_get_float(&src[i * 8 + 4]);           /* set value */
+                (*num)++;                                                              /* num++ */
+            }
+        }
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief      get the page aggregates of a time range
+ * @param[in]  *ts points to a w25qxx ts structure
+ * @param[in]  t1 is the first timestamp
+ * @param[in]  t2 is the last timestamp
+ * @param[out] *bucket points to a bucket buffer
+ * @param[in]  max is the buffer length
+ * @param[out] *num points to a bucket number buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 get failed
+ *             - 2 ts is NULL
+ *             - 4 param is invalid
+ * @note       one bucket per page overlapping the range, a closed sector costs one
+ *             summary read and no sample is read, unflushed samples are counted like
+ *             w25qxx_ts_query returns them
+ */
+uint8_t w25qxx_ts_downsample(w25qxx_ts_t *ts, uint32_t t1, uint32_t t2, w25qxx_ts_bucket_t *bucket, 
+                             uint32_t max, uint32_t *num)
+{
+    uint32_t n;
+    uint32_t k;
+    uint32_t s;
+    uint32_t j;
+    uint32_t cnt;
+    uint32_t pages;
+    w25qxx_ts_page_t *agg;
+    
+    if ((ts == NULL) || (ts->handle == NULL))                                          /* check ts */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if ((bucket == NULL) || (num == NULL) || (t1 > t2))                                /* check param */
+    {
+        ts->handle->debug_print("w25qxx: ts param is invalid.\n");                     /* ts param is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    *num = 0;                                                                          /* init 0 */
+    n = (ts->head + ts->num - ts->tail) % ts->num + 1;                                 /* logical sectors */
+    for (k = _w25qxx_ts_lower(ts, t1, n); k < n; k++)                                  /* matching sectors */
+    {
+        s = (ts->tail + k) % ts->num;                                                  /* get sector */
+        if (ts->sector[s].count == 0)                                                  /* empty */
+        {
+            continue;                                                                  /* skip */
+        }
+        if (ts->sector[s].min_ts > t2)                                                 /* after the range */
+        {
+            break;                                                                     /* break */
+        }
+        if (_w25qxx_ts_view(ts, s, &agg) != 0)                                         /* get page aggregates */
+        {
+            return 1;                                                                  /* return error */
+        }
+        pages = (ts->sector[s].count + W25QXX_TS_PAGE_SAMPLES - 1) / W25QXX_TS_PAGE_SAMPLES;       /* page number */
+        for (j = _w25qxx_ts_page_lower(agg, pages, t1); j < pages; j++)                /* matching pages */
+        {
+            if (agg[j].first_ts > t2)                                                  /* after the range */
+            {
+                return 0;                                                              /* success return 0 */
+            }
+            if (*num == max)                                                           /* buffer full */
+            {
+                return 0;                                                              /* success return 0 */
+            }
+            cnt = _w25qxx_ts_page_count(ts->sector[s].count, j);                       /* get sample number */
+            bucket[*num].first_ts = agg[j].first_ts;                                   /* set first timestamp */
+            bucket[*num].count = cnt;                                                  /* set count */
+            bucket[*num].min = agg[j].min;                                             /* set min */
+            bucket[*num].max = agg[j].max;                                             /* set max */
+            bucket[*num].mean = agg[j].sum / (float)cnt;                               /* set mean */
+            (*num)++;                                                                  /* num++ */
+        }
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
@@ -0,0 +1,234 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_ts.h
+ * @brief     driver w25qxx ts header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DRIVER_W25QXX_TS_H_
+#define _DRIVER_W25QXX_TS_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup w25qxx_ts_driver w25qxx ts driver function
+ * @brief    w25qxx ts driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+/**
+ * @brief w25qxx ts layout definition
+ * @note  page 0 of a sector is marked when the sector opens and gets the summary when it closes,
+ *        pages 1 - 15 hold the samples
+ */
+#define W25QXX_TS_PAGE_SAMPLES      32                                              /**< samples of a page */
+#define W25QXX_TS_SECTOR_PAGES      15                                              /**< sample pages of a sector */
+#define W25QXX_TS_SECTOR_SAMPLES    (W25QXX_TS_PAGE_SAMPLES * W25QXX_TS_SECTOR_PAGES)        /**< samples of a sector */
+
+/**
+ * @brief w25qxx ts sample structure definition
+ */
+typedef struct w25qxx_ts_sample_s
+{
+    uint32_t timestamp;        /**< timestamp, 0xFFFFFFFF is reserved */
+    float value;               /**< value */
+} w25qxx_ts_sample_t;
+
+/**
+ * @brief w25qxx ts page aggregate structure definition
+ */
+typedef struct w25qxx_ts_page_s
+{
+    uint32_t first_ts;        /**< first timestamp */
+    float min;                /**< min value */
+    float max;                /**< max value */
+    float sum;                /**< sum of the values */
+} w25qxx_ts_page_t;
+
+/**
+ * @brief w25qxx ts bucket structure definition
+ */
+typedef struct w25qxx_ts_bucket_s
+{
+    uint32_t first_ts;        /**< first timestamp */
+    uint32_t count;           /**< sample number */
+    float min;                /**< min value */
+    float max;                /**< max value */
+    float mean;               /**< mean value */
+} w25qxx_ts_bucket_t;
+
+/**
+ * @brief w25qxx ts sector index structure definition
+ */
+typedef struct w25qxx_ts_sector_s
+{
+    uint32_t min_ts;          /**< first timestamp */
+    uint32_t max_ts;          /**< last timestamp */
+    uint32_t count;           /**< sample number, 0 if empty */
+    float min;                /**< min value */
+    float max;                /**< max value */
+    float sum;                /**< sum of the values */
+    uint8_t closed;           /**< the summary is written */
+} w25qxx_ts_sector_t;
+
+/**
+ * @brief w25qxx ts structure definition
+ */
+typedef struct w25qxx_ts_s
+{
+    w25qxx_handle_t *handle;                             /**< w25qxx handle */
+    w25qxx_ts_sector_t *sector;                          /**< sector index */
+    uint32_t first;                                      /**< first 4k sector */
+    uint32_t num;                                        /**< sector number */
+    uint32_t head;                                       /**< open sector */
+    uint32_t tail;                                       /**< oldest sector */
+    uint8_t head_page;                                   /**< current page of the open sector, 1 - 15 */
+    uint8_t fill;                                        /**< samples in the page buffer */
+    uint8_t programmed;                                  /**< samples of the page buffer already programmed */
+    uint8_t erased;                                      /**< the open sector is erased and marked */
+    uint32_t last_ts;                                    /**< last timestamp */
+    w25qxx_ts_page_t agg[W25QXX_TS_SECTOR_PAGES];        /**< page aggregates of the open sector */
+    w25qxx_ts_page_t view[W25QXX_TS_SECTOR_PAGES];       /**< page aggregates of a queried sector */
+    uint8_t buf[256];                                    /**< page buffer */
+    uint8_t page[256];                                   /**< scratch buffer */
+} w25qxx_ts_t;
+
+/**
+ * @brief     mount the time series store
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *ts points to a w25qxx ts structure
+ * @param[in] *sector points to a table of num entries
+ * @param[in] first is the first 4k sector
+ * @param[in] num is the sector number
+ * @return    status code
+ *            - 0 success
+ *            - 1 mount failed
+ *            - 2 handle or ts is NULL
+ *            - 3 handle is not initialized
+ *            - 4 param is invalid
+ * @note      a closed sector costs one summary read, only the open sector is scanned,
+ *            an unmarked sector mounts as empty
+ */
+uint8_t w25qxx_ts_mount(w25qxx_handle_t *handle, w25qxx_ts_t *ts, w25qxx_ts_sector_t *sector, 
+                        uint32_t first, uint32_t num);
+
+/**
+ * @brief     flush and unmount the time series store
+ * @param[in] *ts points to a w25qxx ts structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 ts is NULL
+ * @note      none
+ */
+uint8_t w25qxx_ts_unmount(w25qxx_ts_t *ts);
+
+/**
+ * @brief     append a sample
+ * @param[in] *ts points to a w25qxx ts structure
+ * @param[in] timestamp is the sample timestamp
+ * @param[in] value is the sample value
+ * @return    status code
+ *            - 0 success
+ *            - 1 append failed
+ *            - 2 ts is NULL
+ *            - 4 timestamp is invalid
+ * @note      timestamps must not decrease, a full page is programmed at once,
+ *            a full sector gets its summary and the oldest sector is erased
+ */
+uint8_t w25qxx_ts_append(w25qxx_ts_t *ts, uint32_t timestamp, float value);
+
+/**
+ * @brief     program the buffered samples
+ * @param[in] *ts points to a w25qxx ts structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 ts is NULL
+ * @note      only the new samples are programmed, the page keeps filling afterwards
+ */
+uint8_t w25qxx_ts_flush(w25qxx_ts_t *ts);
+
+/**
+ * @brief      query the samples in a time range
+ * @param[in]  *ts points to a w25qxx ts structure
+ * @param[in]  t1 is the first timestamp
+ * @param[in]  t2 is the last timestamp
+ * @param[out] *samples points to a sample buffer
+ * @param[in]  max is the buffer length
+ * @param[out] *num points to a sample number buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 query failed
+ *             - 2 ts is NULL
+ *             - 4 param is invalid
+ * @note       sectors and pages are found by binary search, only the matching pages are read,
+ *             the result stops at max samples, unflushed samples are returned from the page
+ *             buffer like w25qxx_ts_downsample counts them
+ */
+uint8_t w25qxx_ts_query(w25qxx_ts_t *ts, uint32_t t1, uint32_t t2, w25qxx_ts_sample_t *samples, 
+                        uint32_t max, uint32_t *num);
+
+/**
+ * @brief      get the page aggregates of a time range
+ * @param[in]  *ts points to a w25qxx ts structure
+ * @param[in]  t1 is the first timestamp
+ * @param[in]  t2 is the last timestamp
+ * @param[out] *bucket points to a bucket buffer
+ * @param[in]  max is the buffer length
+ * @param[out] *num points to a bucket number buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 get failed
+ *             - 2 ts is NULL
+ *             - 4 param is invalid
+ * @note       one bucket per page overlapping the range, a closed sector costs one
+ *             summary read and no sample is read, unflushed samples are counted like
+ *             w25qxx_ts_query returns them
+ */
+uint8_t w25qxx_ts_downsample(w25qxx_ts_t *ts, uint32_t t1, uint32_t t2, w25qxx_ts_bucket_t *bucket, 
+                             uint32_t max, uint32_t *num);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
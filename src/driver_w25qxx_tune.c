@@ -0,0 +1,156 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_tune.c
+ * @brief     driver w25qxx tune source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_tune.h"
+
+/**
+ * @brief     tune check one dummy setting
+ * @param[in] *handle points to a w25qxx handle structure
+ * @param[in] addr is the pattern address
+ * @param[in] *ref points to the reference pattern
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      none
+ */
+static uint8_t _w25qxx_tune_check(w25qxx_handle_t *handle, uint32_t addr, const uint8_t *ref)
+{
+    uint8_t buf[256];
+    uint32_t i;
+    
+    for (i = 0; i < W25QXX_TUNE_LOOPS; i++)
+    {
+        if ((w25qxx_read(handle, addr, buf, 256) != 0) || (memcmp(buf, ref, 256) != 0))                  /* read */
+        {
+            return 1;                                                                                     /* return error */
+        }
+        if ((w25qxx_fast_read(handle, addr, buf, 256) != 0) || (memcmp(buf, ref, 256) != 0))             /* fast read */
+        {
+            return 1;                                                                                     /* return error */
+        }
+        if ((w25qxx_fast_read_quad_io(handle, addr, buf, 256) != 0) || (memcmp(buf, ref, 256) != 0))     /* fast read quad io */
+        {
+            return 1;                                                                                     /* return error */
+        }
+    }
+    
+    return 0;                                                                                             /* success return 0 */
+}
+
+/**
+ * @brief      tune the qspi read dummy for the current clock
+ * @param[in]  *handle points to an inited w25qxx handle structure
+ * @param[in]  addr is the address of a 256 byte pattern page
+ * @param[out] *dummy points to a qspi read dummy buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 spi interface can't use this function
+ *             - 5 pattern page holds one repeated byte
+ *             - 6 no dummy setting passed
+ * @note       none
+ */
+uint8_t w25qxx_tune_read_dummy(w25qxx_handle_t *handle, uint32_t addr, w25qxx_qspi_read_dummy_t *dummy)
+{
+    uint8_t res;
+    uint8_t ref[256];
+    uint32_t i;
+    w25qxx_qspi_read_wrap_length_t length;
+    w25qxx_interface_t interface;
+    
+    if (handle == NULL)                                                                    /* check handle */
+    {
+        return 2;                                                                          /* return error */
+    }
+    if (handle->inited != 1)                                                               /* check handle initialization */
+    {
+        return 3;                                                                          /* return error */
+    }
+    res = w25qxx_get_interface(handle, &interface);                                        /* get interface */
+    if ((res != 0) || (interface != W25QXX_INTERFACE_QSPI))                                /* check interface */
+    {
+        handle->debug_print("w25qxx: spi interface can't use this function.\n");           /* spi interface can't use this function */
+        
+        return 4;                                                                          /* return error */
+    }
+    length = (w25qxx_qspi_read_wrap_length_t)(handle->param & 0x03);                      /* keep the wrap length */
+    
+    /* reference with the safe setting */
+    res = w25qxx_set_read_parameters(handle, W25QXX_QSPI_READ_DUMMY_8_80MHZ, length);     /* set 8 dummy */
+    if (res != 0)                                                                          /* check result */
+    {
+        return 1;                                                                          /* return error */
+    }
+    res = w25qxx_read(handle, addr, ref, 256);                                             /* read reference */
+    if (res != 0)                                                                          /* check result */
+    {
+        return 1;                                                                          /* return error */
+    }
+    for (i = 1; (i < 256) && (ref[i] == ref[0]); i++)                                      /* check pattern */
+    {
+        
+    }
+    if (i == 256)                                                                          /* a shifted read looks the same */
+    {
+        handle->debug_print("w25qxx: pattern page holds one repeated byte.\n");            /* pattern is invalid */
+        
+        return 5;                                                                          /* return error */
+    }
+    
+    /* fewest dummy clocks first */
+    for (i = W25QXX_QSPI_READ_DUMMY_2_33MHZ; i <= W25QXX_QSPI_READ_DUMMY_8_80MHZ; i++)
+    {
+        res = w25qxx_set_read_parameters(handle, (w25qxx_qspi_read_dummy_t)i, length);   /* set dummy */
+        if (res != 0)                                                                      /* check result */
+        {
+            return 1;                                                                      /* return error */
+        }
+        if (_w25qxx_tune_check(handle, addr, ref) == 0)                                    /* check setting */
+        {
+            *dummy = (w25qxx_qspi_read_dummy_t)i;                                          /* set dummy */
+            (void)w25qxx_set_init_read_dummy(handle, *dummy);                              /* used by the next init */
+            
+            return 0;                                                                      /* success return 0 */
+        }
+    }
+    
+    /* leave the safe setting */
+    (void)w25qxx_set_read_parameters(handle, W25QXX_QSPI_READ_DUMMY_8_80MHZ, length);     /* set 8 dummy */
+    
+    return 6;                                                                              /* return error */
+}
@@ -0,0 +1,94 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_tune.h
+ * @brief     driver w25qxx tune header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DRIVER_W25QXX_TUNE_H_
+#define _DRIVER_W25QXX_TUNE_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup w25qxx_tune_driver w25qxx tune driver function
+ * @brief    w25qxx tune driver modules
+ * @ingroup  w25qxx_driver
+ * @{
+ */
+
+/**
+ * @brief w25qxx tune loops definition
+ * @note  every dummy setting reads the pattern this many times on every fast read path
+ */
+#ifndef W25QXX_TUNE_LOOPS
+    #define W25QXX_TUNE_LOOPS    8        /**< 8 times */
+#endif
+
+/**
+ * @brief      tune the qspi read dummy for the current clock
+ * @param[in]  *handle points to an inited w25qxx handle structure
+ * @param[in]  addr is the address of a 256 byte pattern page
+ * @param[out] *dummy points to a qspi read dummy buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 spi interface can't use this function
+ *             - 5 pattern page holds one repeated byte
+ *             - 6 no dummy setting passed
+ * @note       the pattern is read as reference with 8 dummy clocks, then the settings are tried
+ *             from 2 to 8 dummy clocks, each one reads the pattern W25QXX_TUNE_LOOPS times with
+ *             w25qxx_read, w25qxx_fast_read and w25qxx_fast_read_quad_io, the first setting
+ *             matching every time is kept and stored with w25qxx_set_init_read_dummy;
+ *             the driver does not persist it, the handle keeps it only until DRIVER_W25QXX_LINK_INIT
+ *             clears the handle or the board resets, so the caller must save *dummy in its own
+ *             non volatile storage and pass it to w25qxx_set_init_read_dummy before every w25qxx_init,
+ *             otherwise w25qxx_init falls back to W25QXX_QSPI_READ_DUMMY_8_80MHZ, the tuning is only
+ *             valid for the clock it ran at and must be run again when the clock changes
+ */
+uint8_t w25qxx_tune_read_dummy(w25qxx_handle_t *handle, uint32_t addr, w25qxx_qspi_read_dummy_t *dummy);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,525 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_wear.c
+ * @brief     driver w25qxx wear source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_wear.h"
+#include "driver_w25qxx_crc.h"
+#include "driver_w25qxx_endian.h"
+
+#if (W25QXX_ENABLE_WEAR == 1)
+
+/**
+ * @brief wear slot definition
+ */
+#define W25QXX_WEAR_MAGIC             0x52414557U        /**< "WEAR" */
+#define W25QXX_WEAR_HEADER_SIZE       256                /**< header page */
+#define W25QXX_WEAR_HEADER_CRC        20                 /**< bytes covered by the header crc */
+
+/**
+ * @brief     get the chip sector number
+ * @param[in] *handle points to a w25qxx handle structure
+ * @return    4k sector number
+ * @note      the low byte of the type is the density id, 0x13 is 1MB
+ */
+static uint32_t _w25qxx_wear_sectors(w25qxx_handle_t *handle)
+{
+    return 1UL << ((handle->type & 0xFF) - 11);                                       /* 2 ^ (id + 1) / 4096 */
+}
+
+/**
+ * @brief     check a slot header
+ * @param[in] *wear points to a w25qxx wear structure
+ * @param[in] slot is the slot index
+ * @param[out] *seq points to a sequence buffer
+ * @param[out] *crc points to a counts crc buffer
+ * @return    status code
+ *            - 0 valid
+ *            - 1 invalid
+ * @note      none
+ */
+static uint8_t _w25qxx_wear_header(w25qxx_wear_t *wear, uint8_t slot, uint32_t *seq, uint32_t *crc)
+{
+    uint32_t check;
+    
+    if (w25qxx_read(wear->handle, wear->region + slot * wear->slot_size, wear->buf, 
+                    W25QXX_WEAR_HEADER_SIZE) != 0)                                     /* read header */
+    {
+        return 1;                                                                      /* return error */
+    }
+    check = w25qxx_crc32(0, wear->buf, W25QXX_WEAR_HEADER_CRC);                        /* header crc */
+    if ((_w25qxx_get32(&wear->buf[0]) != W25QXX_WEAR_MAGIC) ||
+        (_w25qxx_get32(&wear->buf[8]) != wear->handle->wear_first) ||
+        (_w25qxx_get32(&wear->buf[12]) != wear->handle->wear_num) ||
+        (_w25qxx_get32(&wear->buf[20]) != check))                                      /* check header */
+    {
+        return 1;                                                                      /* return error */
+    }
+    *seq = _w25qxx_get32(&wear->buf[4]);                                               /* get sequence */
+    *crc = _w25qxx_get32(&wear->buf[16]);                                              /* get counts crc */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     load the counts of a slot
+ * @param[in] *wear points to a w25qxx wear structure
+ * @param[in] *count points to a count table
+ * @param[in] slot is the slot index
+ * @param[in] crc is the expected counts crc
+ * @return    status code
+ *            - 0 success
+ *            - 1 load failed
+ * @note      none
+ */
+static uint8_t _w25qxx_wear_load(w25qxx_wear_t *wear, uint32_t *count, uint8_t slot, uint32_t crc)
+{
+    uint32_t addr;
+    uint32_t i;
+    uint32_t j;
+    uint32_t n;
+    uint32_t check;
+    
+    addr = wear->region + slot * wear->slot_size + W25QXX_WEAR_HEADER_SIZE;            /* counts address */
+    check = 0;                                                                         /* init crc */
+    for (i = 0; i < wear->handle->wear_num; i += 64)                                   /* 64 counts per page */
+    {
+        n = wear->handle->wear_num - i;                                                /* remain */
+        if (n > 64)                                                                    /* check remain */
+        {
+            n = 64;                                                                    /* one page */
+        }
+        if (w25qxx_read(wear->handle, addr, wear->buf, n * 4) != 0)                    /* read counts */
+        {
+            return 1;                                                                  /* return error */
+        }
+        check = w25qxx_crc32(check, wear->buf, n * 4);                                 /* update crc */
+        for (j = 0; j < n; j++)                                                        /* all counts */
+        {
+            count[i + j] = _w25qxx_get32(&wear->buf[j * 4]);                           /* get count */
+        }
+        addr += 256;                                                                   /* next page */
+    }
+    
+    return (check == crc) ? 0 : 1;                                                     /* check crc */
+}
+
+/**
+ * @brief     get the reserved region size
+ * @param[in] num is the tracked sector number
+ * @return    region size in bytes
+ * @note      the region holds two slots of 4k aligned copies
+ */
+uint32_t w25qxx_wear_region_size(uint32_t num)
+{
+    return 2 * ((W25QXX_WEAR_HEADER_SIZE + num * 4 + 4095) / 4096) * 4096;             /* two slots */
+}
+
+/**
+ * @brief     init the wear tracking and load the saved table
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *wear points to a w25qxx wear structure
+ * @param[in] *count points to a table of num counters
+ * @param[in] first is the first tracked 4k sector
+ * @param[in] num is the tracked sector number
+ * @param[in] region is the 4k aligned reserved region address
+ * @return    status code
+ *            - 0 success
+ *            - 1 load failed
+ *            - 2 handle or wear is NULL
+ *            - 3 handle is not initialized
+ *            - 4 param is invalid
+ * @note      the table is cleared when no valid copy is found, the tracked sectors and the
+ *            region must be inside the chip, the region must not be written by anything else
+ */
+uint8_t w25qxx_wear_init(w25qxx_handle_t *handle, w25qxx_wear_t *wear, uint32_t *count,
+                         uint32_t first, uint32_t num, uint32_t region)
+{
+    uint32_t seq[2];
+    uint32_t crc[2];
+    uint8_t valid[2];
+    uint8_t order[2];
+    uint8_t i;
+    uint32_t j;
+    
+    if ((handle == NULL) || (wear == NULL))                                            /* check handle */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if (handle->inited != 1)                                                           /* check handle initialization */
+    {
+        return 3;                                                                      /* return error */
+    }
+    if ((count == NULL) || (num == 0) || ((region % 4096) != 0) ||
+        (first >= _w25qxx_wear_sectors(handle)) || (num > _w25qxx_wear_sectors(handle) - first) ||
+        (region / 4096 >= _w25qxx_wear_sectors(handle)) ||
+        (w25qxx_wear_region_size(num) / 4096 > _w25qxx_wear_sectors(handle) - region / 4096))      /* check param */
+    {
+        handle->debug_print("w25qxx: wear param is invalid.\n");                       /* wear param is invalid */
+        
+        return 4;                                                                      /* return error */
+    }
+    
+    memset(wear, 0, sizeof(w25qxx_wear_t));                                            /* clear the structure */
+    wear->handle = handle;                                                             /* set handle */
+    wear->region = region;                                                             /* set region */
+    wear->slot_size = w25qxx_wear_region_size(num) / 2;                                /* set slot size */
+    handle->wear_count = NULL;                                                         /* detach while loading */
+    handle->wear_first = first;                                                        /* set first */
+    handle->wear_num = num;                                                            /* set number */
+    handle->wear_dirty = 0;                                                            /* clear dirty */
+    
+    for (i = 0; i < 2; i++)                                                            /* check both slots */
+    {
+        valid[i] = (_w25qxx_wear_header(wear, i, &seq[i], &crc[i]) == 0) ? 1 : 0;      /* check header */
+    }
+    order[0] = ((valid[1] != 0) && ((valid[0] == 0) || ((int32_t)(seq[1] - seq[0]) > 0))) ? 1 : 0;        /* newest first */
+    order[1] = order[0] ^ 1;                                                           /* then the other */
+    wear->slot = 1;                                                                    /* the first save uses slot 0 */
+    memset(count, 0, sizeof(uint32_t) * num);                                          /* clear the table */
+    for (i = 0; i < 2; i++)
+    {
+        if (valid[order[i]] == 0)                                                      /* check valid */
+        {
+            continue;                                                                  /* next */
+        }
+        if (_w25qxx_wear_load(wear, count, order[i], crc[order[i]]) == 0)              /* load the copy */
+        {
+            wear->slot = order[i];                                                     /* set slot */
+            wear->seq = seq[order[i]];                                                 /* set sequence */
+            
+            break;                                                                     /* break */
+        }
+        handle->debug_print("w25qxx: wear slot %d is corrupted.\n", order[i]);         /* slot is corrupted */
+        memset(count, 0, sizeof(uint32_t) * num);                                      /* clear the table */
+    }
+    for (j = 0; j < num; j++)                                                          /* all sectors */
+    {
+        wear->total_at_load += count[j];                                               /* sum */
+    }
+    handle->wear_count = count;                                                        /* attach the table */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     stop the wear tracking
+ * @param[in] *wear points to a w25qxx wear structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 wear is NULL
+ * @note      the table is not saved
+ */
+uint8_t w25qxx_wear_deinit(w25qxx_wear_t *wear)
+{
+    if ((wear == NULL) || (wear->handle == NULL))                                      /* check wear */
+    {
+        return 2;                                                                      /* return error */
+    }
+    
+    wear->handle->wear_count = NULL;                                                   /* detach the table */
+    wear->handle = NULL;                                                               /* clear handle */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     save the table
+ * @param[in] *wear points to a w25qxx wear structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 save failed
+ *            - 2 wear is NULL
+ * @note      the older slot is erased and programmed, its header page is programmed last,
+ *            so a power loss leaves the previous copy valid
+ */
+uint8_t w25qxx_wear_save(w25qxx_wear_t *wear)
+{
+    w25qxx_handle_t *handle;
+    uint32_t base;
+    uint32_t addr;
+    uint32_t crc;
+    uint32_t i;
+    uint32_t j;
+    uint32_t n;
+    uint8_t slot;
+    
+    if ((wear == NULL) || (wear->handle == NULL))                                      /* check wear */
+    {
+        return 2;                                                                      /* return error */
+    }
+    
+    handle = wear->handle;                                                             /* get handle */
+    slot = wear->slot ^ 1;                                                             /* use the older slot */
+    base = wear->region + slot * wear->slot_size;                                      /* slot address */
+    for (addr = base; addr < base + wear->slot_size; addr += 4096)                     /* erase the slot */
+    {
+        if (w25qxx_sector_erase_4k(handle, addr) != 0)                                 /* erase 4k */
+        {
+            handle->debug_print("w25qxx: wear erase failed.\n");                       /* wear erase failed */
+            
+            return 1;                                                                  /* return error */
+        }
+    }
+    crc = 0;                                                                           /* init crc */
+    addr = base + W25QXX_WEAR_HEADER_SIZE;                                             /* counts address */
+    for (i = 0; i < handle->wear_num; i += 64)                                         /* 64 counts per page */
+    {
+        n = handle->wear_num - i;                                                      /* remain */
+        if (n > 64)                                                                    /* check remain */
+        {
+            n = 64;                                                                    /* one page */
+        }
+        for (j = 0; j < n; j++)                                                        /* all counts */
+        {
+            _w25qxx_put32(&wear->buf[j * 4], handle->wear_count[i + j]);               /* put count */
+        }
+        crc = w25qxx_crc32(crc, wear->buf, n * 4);                                     /* update crc */
+        if (w25qxx_page_program(handle, addr, wear->buf, (uint16_t)(n * 4)) != 0)      /* program counts */
+        {
+            handle->debug_print("w25qxx: wear program failed.\n");                     /* wear program failed */
+            
+            return 1;                                                                  /* return error */
+        }
+        addr += 256;                                                                   /* next page */
+    }
+    _w25qxx_put32(&wear->buf[0], W25QXX_WEAR_MAGIC);                                   /* set magic */
+    _w25qxx_put32(&wear->buf[4], wear->seq + 1);                                       /* set sequence */
+    _w25qxx_put32(&wear->buf[8], handle->wear_first);                                  /* set first */
+    _w25qxx_put32(&wear->buf[12], handle->wear_num);                                   /* set number */
+    _w25qxx_put32(&wear->buf[16], crc);                                                /* set counts crc */
+    _w25qxx_put32(&wear->buf[20], w25qxx_crc32(0, wear->buf, W25QXX_WEAR_HEADER_CRC)); /* set header crc */
+    if (w25qxx_page_program(handle, base, wear->buf, 24) != 0)                         /* commit the copy */
+    {
+        handle->debug_print("w25qxx: wear program failed.\n");                         /* wear program failed */
+        
+        return 1;                                                                      /* return error */
+    }
+    wear->slot = slot;                                                                 /* set slot */
+    wear->seq++;                                                                       /* sequence++ */
+    handle->wear_dirty = 0;                                                            /* clear dirty */
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief     save the table if enough erases happened
+ * @param[in] *wear points to a w25qxx wear structure
+ * @param[in] interval is the erase number between two saves
+ * @return    status code
+ *            - 0 success
+ *            - 1 save failed
+ *            - 2 wear is NULL
+ * @note      call it periodically from the application
+ */
+uint8_t w25qxx_wear_sync(w25qxx_wear_t *wear, uint32_t interval)
+{
+    if ((wear == NULL) || (wear->handle == NULL))                                      /* check wear */
+    {
+        return 2;                                                                      /* return error */
+    }
+    
+    if (wear->handle->wear_dirty < interval)                                           /* check dirty */
+    {
+        return 0;                                                                      /* success return 0 */
+    }
+    
+    return w25qxx_wear_save(wear);                                                     /* save */
+}
+
+/**
+ * @brief      get the wear histogram
+ * @param[in]  *wear points to a w25qxx wear structure
+ * @param[out] *bins points to a bins buffer
+ * @param[in]  bin_num is the bins number
+ * @param[in]  bin_width is the erase count width of one bin
+ * @return     status code
+ *             - 0 success
+ *             - 2 wear is NULL
+ *             - 4 param is invalid
+ * @note       bin i counts the sectors erased [i * bin_width, (i + 1) * bin_width) times,
+ *             the last bin also counts all the hotter sectors
+ */
+uint8_t w25qxx_wear_histogram(w25qxx_wear_t *wear, uint32_t *bins, uint16_t bin_num, uint32_t bin_width)
+{
+    uint32_t i;
+    uint32_t bin;
+    
+    if ((wear == NULL) || (wear->handle == NULL))                                      /* check wear */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if ((bins == NULL) || (bin_num == 0) || (bin_width == 0))                          /* check param */
+    {
+        return 4;                                                                      /* return error */
+    }
+    
+    memset(bins, 0, sizeof(uint32_t) * bin_num);                                       /* clear bins */
+    for (i = 0; i < wear->handle->wear_num; i++)                                       /* all sectors */
+    {
+        bin = wear->handle->wear_count[i] / bin_width;                                 /* get bin */
+        if (bin >= bin_num)                                                            /* check bin */
+        {
+            bin = bin_num - 1;                                                         /* last bin */
+        }
+        bins[bin]++;                                                                   /* bin++ */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief      get the hottest sectors
+ * @param[in]  *wear points to a w25qxx wear structure
+ * @param[out] *sector points to a sector buffer
+ * @param[out] *count points to a count buffer
+ * @param[in]  num is the buffer length
+ * @return     status code
+ *             - 0 success
+ *             - 2 wear is NULL
+ *             - 4 param is invalid
+ * @note       the result is sorted from the hottest, sector is the absolute 4k sector number
+ */
+uint8_t w25qxx_wear_hottest(w25qxx_wear_t *wear, uint32_t *sector, uint32_t *count, uint8_t num)
+{
+    uint32_t i;
+    uint32_t c;
+    uint8_t filled;
+    uint8_t j;
+    
+    if ((wear == NULL) || (wear->handle == NULL))                                      /* check wear */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if ((sector == NULL) || (count == NULL) || (num == 0))                             /* check param */
+    {
+        return 4;                                                                      /* return error */
+    }
+    
+    filled = 0;                                                                        /* init 0 */
+    for (i = 0; i < wear->handle->wear_num; i++)                                       /* all sectors */
+    {
+        c = wear->handle->wear_count[i];                                               /* get count */
+        if ((filled == num) && (c <= count[num - 1]))                                  /* not hotter */
+        {
+            continue;                                                                  /* next */
+        }
+        j = (filled < num) ? filled++ : (uint8_t)(num - 1);                            /* insert position */
+        while ((j > 0) && (count[j - 1] < c))                                          /* keep sorted */
+        {
+            count[j] = count[j - 1];                                                   /* move count */
+            sector[j] = sector[j - 1];                                                 /* move sector */
+            j--;                                                                       /* j-- */
+        }
+        count[j] = c;                                                                  /* set count */
+        sector[j] = wear->handle->wear_first + i;                                      /* set sector */
+    }
+    for (j = filled; j < num; j++)                                                     /* clear the rest */
+    {
+        count[j] = 0;                                                                  /* clear count */
+        sector[j] = 0xFFFFFFFFU;                                                       /* no sector */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+/**
+ * @brief      get the wear report
+ * @param[in]  *wear points to a w25qxx wear structure
+ * @param[in]  endurance is the rated cycles of one sector
+ * @param[in]  elapsed_s is the time since w25qxx_wear_init in seconds
+ * @param[out] *report points to a w25qxx wear report structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 wear is NULL
+ *             - 4 param is invalid
+ * @note       the projection assumes the erase rate since init and that the hottest
+ *             sector keeps its share of all erases
+ */
+uint8_t w25qxx_wear_report(w25qxx_wear_t *wear, uint32_t endurance, uint32_t elapsed_s, w25qxx_wear_report_t *report)
+{
+    uint32_t i;
+    uint32_t c;
+    uint64_t delta;
+    
+    if ((wear == NULL) || (wear->handle == NULL))                                      /* check wear */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if ((report == NULL) || (endurance == 0))                                          /* check param */
+    {
+        return 4;                                                                      /* return error */
+    }
+    
+    memset(report, 0, sizeof(w25qxx_wear_report_t));                                   /* clear report */
+    report->min = 0xFFFFFFFFU;                                                         /* init min */
+    for (i = 0; i < wear->handle->wear_num; i++)                                       /* all sectors */
+    {
+        c = wear->handle->wear_count[i];                                               /* get count */
+        report->total += c;                                                            /* sum */
+        if (c < report->min)                                                           /* check min */
+        {
+            report->min = c;                                                           /* set min */
+        }
+        if (c > report->max)                                                           /* check max */
+        {
+            report->max = c;                                                           /* set max */
+            report->hottest = wear->handle->wear_first + i;                            /* set hottest */
+        }
+    }
+    if (report->max == 0)                                                              /* no erase */
+    {
+        report->hottest = wear->handle->wear_first;                                    /* first sector */
+    }
+    report->mean = (uint32_t)(report->total / wear->handle->wear_num);                 /* mean */
+    report->remaining = (report->max < endurance) ? (endurance - report->max) : 0;     /* remaining cycles */
+    report->remaining_percent = (float)report->remaining * 100.0f / (float)endurance;  /* remaining percent */
+    delta = report->total - wear->total_at_load;                                       /* erases since init */
+    if ((elapsed_s == 0) || (delta == 0))                                              /* unknown rate */
+    {
+        report->projected_days = -1.0f;                                                /* unknown */
+    }
+    else
+    {
+        double rate;
+        
+        rate = (double)delta / (double)elapsed_s * 86400.0 *
+               (double)report->max / (double)report->total;                            /* hottest erases per day */
+        report->projected_days = (float)((double)report->remaining / rate);            /* projected days */
+    }
+    
+    return 0;                                                                          /* success return 0 */
+}
+
+#endif
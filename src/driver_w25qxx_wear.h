@@ -0,0 +1,202 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_wear.h
+ * @brief     driver w25qxx wear header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DRIVER_W25QXX_WEAR_H_
+#define _DRIVER_W25QXX_WEAR_H_
+
+#include "driver_w25qxx.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup w25qxx_wear_driver w25qxx wear driver function
+ * @brief    w25qxx wear driver modules
+ * @ingroup  w25qxx_driver
+ * @note     W25QXX_ENABLE_WEAR must be 1
+ * @{
+ */
+
+/**
+ * @brief w25qxx wear default endurance definition
+ */
+#define W25QXX_WEAR_ENDURANCE 100000        /**< typical program erase cycles of a w25qxx sector */
+
+/**
+ * @brief w25qxx wear structure definition
+ */
+typedef struct w25qxx_wear_s
+{
+    w25qxx_handle_t *handle;        /**< w25qxx handle */
+    uint32_t region;                /**< reserved region address, two slots */
+    uint32_t slot_size;             /**< slot size in bytes */
+    uint32_t seq;                   /**< sequence of the latest saved copy */
+    uint8_t slot;                   /**< slot of the latest saved copy */
+    uint64_t total_at_load;         /**< total erases when the table was loaded */
+    uint8_t buf[256];               /**< page buffer */
+} w25qxx_wear_t;
+
+/**
+ * @brief w25qxx wear report structure definition
+ */
+typedef struct w25qxx_wear_report_s
+{
+    uint64_t total;                 /**< total erases of the tracked sectors */
+    uint32_t min;                   /**< min erase count */
+    uint32_t max;                   /**< max erase count */
+    uint32_t mean;                  /**< mean erase count */
+    uint32_t hottest;               /**< hottest sector */
+    uint32_t remaining;             /**< remaining cycles of the hottest sector */
+    float remaining_percent;        /**< remaining endurance of the hottest sector in percent */
+    float projected_days;           /**< projected days until the hottest sector wears out, -1 if unknown */
+} w25qxx_wear_report_t;
+
+/**
+ * @brief     get the reserved region size
+ * @param[in] num is the tracked sector number
+ * @return    region size in bytes
+ * @note      the region holds two slots of 4k aligned copies
+ */
+uint32_t w25qxx_wear_region_size(uint32_t num);
+
+/**
+ * @brief     init the wear tracking and load the saved table
+ * @param[in] *handle points to an inited w25qxx handle structure
+ * @param[in] *wear points to a w25qxx wear structure
+ * @param[in] *count points to a table of num counters
+ * @param[in] first is the first tracked 4k sector
+ * @param[in] num is the tracked sector number
+ * @param[in] region is the 4k aligned reserved region address
+ * @return    status code
+ *            - 0 success
+ *            - 1 load failed
+ *            - 2 handle or wear is NULL
+ *            - 3 handle is not initialized
+ *            - 4 param is invalid
+ * @note      the table is cleared when no valid copy is found, the tracked sectors and the
+ *            region must be inside the chip, the region must not be written by anything else
+ */
+uint8_t w25qxx_wear_init(w25qxx_handle_t *handle, w25qxx_wear_t *wear, uint32_t *count,
+                         uint32_t first, uint32_t num, uint32_t region);
+
+/**
+ * @brief     stop the wear tracking
+ * @param[in] *wear points to a w25qxx wear structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 wear is NULL
+ * @note      the table is not saved
+ */
+uint8_t w25qxx_wear_deinit(w25qxx_wear_t *wear);
+
+/**
+ * @brief     save the table
+ * @param[in] *wear points to a w25qxx wear structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 save failed
+ *            - 2 wear is NULL
+ * @note      the older slot is erased and programmed, its header page is programmed last,
+ *            so a power loss leaves the previous copy valid
+ */
+uint8_t w25qxx_wear_save(w25qxx_wear_t *wear);
+
+/**
+ * @brief     save the table if enough erases happened
+ * @param[in] *wear points to a w25qxx wear structure
+ * @param[in] interval is the erase number between two saves
+ * @return    status code
+ *            - 0 success
+ *            - 1 save failed
+ *            - 2 wear is NULL
+ * @note      call it periodically from the application
+ */
+uint8_t w25qxx_wear_sync(w25qxx_wear_t *wear, uint32_t interval);
+
+/**
+ * @brief      get the wear histogram
+ * @param[in]  *wear points to a w25qxx wear structure
+ * @param[out] *bins points to a bins buffer
+ * @param[in]  bin_num is the bins number
+ * @param[in]  bin_width is the erase count width of one bin
+ * @return     status code
+ *             - 0 success
+ *             - 2 wear is NULL
+ *             - 4 param is invalid
+ * @note       bin i counts the sectors erased [i * bin_width, (i + 1) * bin_width) times,
+ *             the last bin also counts all the hotter sectors
+ */
+uint8_t w25qxx_wear_histogram(w25qxx_wear_t *wear, uint32_t *bins, uint16_t bin_num, uint32_t bin_width);
+
+/**
+ * @brief      get the hottest sectors
+ * @param[in]  *wear points to a w25qxx wear structure
+ * @param[out] *sector points to a sector buffer
+ * @param[out] *count points to a count buffer
+ * @param[in]  num is the buffer length
+ * @return     status code
+ *             - 0 success
+ *             - 2 wear is NULL
+ *             - 4 param is invalid
+ * @note       the result is sorted from the hottest, sector is the absolute 4k sector number
+ */
+uint8_t w25qxx_wear_hottest(w25qxx_wear_t *wear, uint32_t *sector, uint32_t *count, uint8_t num);
+
+/**
+ * @brief      get the wear report
+ * @param[in]  *wear points to a w25qxx wear structure
+ * @param[in]  endurance is the rated cycles of one sector
+ * @param[in]  elapsed_s is the time since w25qxx_wear_init in seconds
+ * @param[out] *report points to a w25qxx wear report structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 wear is NULL
+ *             - 4 param is invalid
+ * @note       the projection assumes the erase rate since init and that the hottest
+ *             sector keeps its share of all erases
+ */
+uint8_t w25qxx_wear_report(w25qxx_wear_t *wear, uint32_t endurance, uint32_t elapsed_s, w25qxx_wear_report_t *report);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,221 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_async_test.c
+ * @brief     driver w25qxx async test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_async_test.h"
+#include <stdlib.h>
+#include <string.h>
+
+static w25qxx_handle_t gs_handle;                                                                 /**< w25qxx handle */
+static uint8_t gs_buffer_input[256];                                                              /**< input buffer */
+static uint8_t gs_buffer_output[256];                                                             /**< output buffer */
+static const uint32_t gsc_size[] = {0x100000, 0x200000, 0x400000, 0x800000, 0x1000000, 0x2000000};  /**< flash size */
+
+/**
+ * @brief  async test wait until the chip is idle
+ * @return status code
+ *         - 0 success
+ *         - 1 get busy failed
+ * @note   none
+ */
+static uint8_t a_w25qxx_async_test_wait(void)
+{
+    uint8_t res;
+    w25qxx_bool_t busy;
+    
+    do
+    {
+        w25qxx_interface_delay_us(100);
+        res = w25qxx_get_busy(&gs_handle, &busy);
+    } while ((res == 0) && (busy == W25QXX_BOOL_TRUE));
+    
+    return res;
+}
+
+/**
+ * @brief     async test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+uint8_t w25qxx_async_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    uint8_t res;
+    uint32_t addr;
+    uint32_t len;
+    uint32_t j;
+    w25qxx_bool_t busy;
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    
+    /* set chip type */
+    res = w25qxx_set_type(&gs_handle, type);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set type failed.\n");
+       
+        return 1;
+    }
+    
+    /* set chip interface */
+    res = w25qxx_set_interface(&gs_handle, interface);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set interface failed.\n");
+       
+        return 1;
+    }
+    
+    /* set dual quad spi */
+    res = w25qxx_set_dual_quad_spi(&gs_handle, dual_quad_spi_enable);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set dual quad spi failed.\n");
+       
+        return 1;
+    }
+    
+    /* chip init */
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    
+    /* start async test */
+    w25qxx_interface_debug_print("w25qxx: start async test.\n");
+    
+    /* every erase size, in the last 64k block so the extended address is exercised on the >128Mb chips */
+    for (len = 4096; len <= 65536; len = (len == 4096) ? 32768 : len * 2)
+    {
+        addr = gsc_size[type - W25Q80] - len;
+        w25qxx_interface_debug_print("w25qxx: w25qxx_erase_start %d bytes at 0x%08X.\n", len, addr);
+        for (j = 0; j < 256; j++)
+        {
+            gs_buffer_input[j] = (uint8_t)j;
+        }
+        res = w25qxx_page_program(&gs_handle, addr + len - 256, gs_buffer_input, 256);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: page program failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+           
+            return 1;
+        }
+        res = w25qxx_erase_start(&gs_handle, addr, len);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: erase start failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+           
+            return 1;
+        }
+        res = w25qxx_get_busy(&gs_handle, &busy);
+        if ((res != 0) || (busy != W25QXX_BOOL_TRUE))
+        {
+            w25qxx_interface_debug_print("w25qxx: erase start returned after the erase.\n");
+            (void)w25qxx_deinit(&gs_handle);
+           
+            return 1;
+        }
+        if ((a_w25qxx_async_test_wait() != 0) || (w25qxx_erase_finish(&gs_handle, addr, len) != 0) ||
+            (w25qxx_blank_check(&gs_handle, addr, len) != 0))
+        {
+            w25qxx_interface_debug_print("w25qxx: erase start check failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+           
+            return 1;
+        }
+    }
+    if (w25qxx_erase_start(&gs_handle, 0, 8192) != 4)
+    {
+        w25qxx_interface_debug_print("w25qxx: erase start accepted an invalid length.\n");
+        (void)w25qxx_deinit(&gs_handle);
+       
+        return 1;
+    }
+    
+    /* a program inside a page */
+    w25qxx_interface_debug_print("w25qxx: w25qxx_page_program_start test.\n");
+    addr = gsc_size[type - W25Q80] - 4096;
+    for (j = 0; j < 100; j++)
+    {
+        gs_buffer_input[j] = rand() % 256;
+    }
+    res = w25qxx_page_program_start(&gs_handle, addr + 100, gs_buffer_input, 100);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: page program start failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+       
+        return 1;
+    }
+    if ((a_w25qxx_async_test_wait() != 0) || (w25qxx_read(&gs_handle, addr + 100, gs_buffer_output, 100) != 0) || 
+        (memcmp(gs_buffer_input, gs_buffer_output, 100) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: page program start check failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+       
+        return 1;
+    }
+    
+    /* a program crossing a page is rejected */
+    if (w25qxx_page_program_start(&gs_handle, addr + 200, gs_buffer_input, 100) != 4)
+    {
+        w25qxx_interface_debug_print("w25qxx: page program start crossed a page.\n");
+        (void)w25qxx_deinit(&gs_handle);
+       
+        return 1;
+    }
+    
+    /* finish async test */
+    w25qxx_interface_debug_print("w25qxx: finish async test.\n");
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+}
@@ -0,0 +1,345 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_atomic_test.c
+ * @brief     driver w25qxx atomic test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_atomic_test.h"
+
+static w25qxx_handle_t gs_handle;              /**< w25qxx handle */
+static w25qxx_atomic_t gs_atomic;              /**< w25qxx atomic */
+static uint8_t gs_image[4096];                 /**< image buffer */
+static uint8_t gs_check[4096];                 /**< check buffer */
+static uint32_t gs_budget = 0xFFFFFFFFU;       /**< program and erase commands before the power cut */
+
+/**
+ * @brief      atomic test bus write read with a simulated power cut
+ * @param[in]  instruction is the sent instruction
+ * @param[in]  instruction_line is the instruction phy lines
+ * @param[in]  address is the register address
+ * @param[in]  address_line is the address phy lines
+ * @param[in]  address_len is the address length
+ * @param[in]  alternate is the register address
+ * @param[in]  alternate_line is the alternate phy lines
+ * @param[in]  alternate_len is the alternate length
+ * @param[in]  dummy is the dummy cycle
+ * @param[in]  *in_buf points to a input buffer
+ * @param[in]  in_len is the input length
+ * @param[out] *out_buf points to a output buffer
+ * @param[in]  out_len is the output length
+ * @param[in]  data_line is the data phy lines
+ * @return     status code
+ *             - 0 success
+ *             - 1 write read failed
+ * @note       once the budget is used up every program or erase command fails
+ */
+static uint8_t a_w25qxx_atomic_test_write_read(uint8_t instruction, uint8_t instruction_line,
+                                               uint32_t address, uint8_t address_line, uint8_t address_len,
+                                               uint32_t alternate, uint8_t alternate_line, uint8_t alternate_len,
+                                               uint8_t dummy, uint8_t *in_buf, uint32_t in_len,
+                                               uint8_t *out_buf, uint32_t out_len, uint8_t data_line)
+{
+    uint8_t cmd;
+    
+    cmd = ((instruction_line == 0) && (in_len != 0)) ? in_buf[0] : instruction;
+    if ((cmd == 0x02) || (cmd == 0x32) || (cmd == 0x12) || (cmd == 0x34) || 
+        (cmd == 0x20) || (cmd == 0x21) || (cmd == 0x52) || (cmd == 0xD8) || (cmd == 0xDC))
+    {
+        if (gs_budget == 0)
+        {
+            return 1;
+        }
+        if (gs_budget != 0xFFFFFFFFU)
+        {
+            gs_budget--;
+        }
+    }
+    
+    return w25qxx_interface_spi_qspi_write_read(instruction, instruction_line, address, address_line, address_len,
+                                                alternate, alternate_line, alternate_len, dummy,
+                                                in_buf, in_len, out_buf, out_len, data_line);
+}
+
+/**
+ * @brief      atomic test make a sector image
+ * @param[in]  target is the target index
+ * @param[in]  gen is the image generation
+ * @param[out] *buf points to an image buffer
+ * @note       none
+ */
+static void a_w25qxx_atomic_test_image(uint32_t target, uint32_t gen, uint8_t *buf)
+{
+    uint32_t i;
+    
+    for (i = 0; i < 4096; i++)
+    {
+        buf[i] = (uint8_t)(gen * 31 + target * 7 + i + (i >> 8));
+    }
+}
+
+/**
+ * @brief         atomic test check that all targets hold the same generation
+ * @param[in,out] *gen points to the old generation, returns the found one
+ * @return        status code
+ *                - 0 success
+ *                - 1 check failed
+ * @note          the targets hold either the old or the next generation
+ */
+static uint8_t a_w25qxx_atomic_test_check(uint32_t *gen)
+{
+    uint32_t t;
+    uint32_t g;
+    uint32_t found;
+    
+    found = 0xFFFFFFFFU;
+    for (t = 0; t < W25QXX_ATOMIC_TEST_TARGETS; t++)
+    {
+        if (w25qxx_read(&gs_handle, (W25QXX_ATOMIC_TEST_TARGET + t) * 4096, gs_check, 4096) != 0)
+        {
+            w25qxx_interface_debug_print("w25qxx: read failed.\n");
+            
+            return 1;
+        }
+        for (g = *gen; g < *gen + 2; g++)
+        {
+            a_w25qxx_atomic_test_image(t, g, gs_image);
+            if (memcmp(gs_image, gs_check, 4096) == 0)
+            {
+                break;
+            }
+        }
+        if ((g == *gen + 2) || ((found != 0xFFFFFFFFU) && (found != g)))
+        {
+            w25qxx_interface_debug_print("w25qxx: atomic target %d is mixed.\n", t);
+            
+            return 1;
+        }
+        found = g;
+    }
+    *gen = found;
+    
+    return 0;
+}
+
+/**
+ * @brief     atomic test stage and commit a generation
+ * @param[in] gen is the image generation
+ * @return    status code
+ *            - 0 success
+ *            - 1 update failed
+ * @note      none
+ */
+static uint8_t a_w25qxx_atomic_test_update(uint32_t gen)
+{
+    uint32_t t;
+    
+    if (w25qxx_atomic_begin(&gs_atomic) != 0)
+    {
+        return 1;
+    }
+    for (t = 0; t < W25QXX_ATOMIC_TEST_TARGETS; t++)
+    {
+        a_w25qxx_atomic_test_image(t, gen, gs_image);
+        if (w25qxx_atomic_stage(&gs_atomic, (W25QXX_ATOMIC_TEST_TARGET + t) * 4096, gs_image) != 0)
+        {
+            return 1;
+        }
+    }
+    
+    return w25qxx_atomic_commit(&gs_atomic);
+}
+
+/**
+ * @brief     atomic test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+uint8_t w25qxx_atomic_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    uint8_t res;
+    uint32_t i;
+    uint32_t gen;
+    uint32_t old;
+    uint32_t forward;
+    uint32_t back;
+    
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, a_w25qxx_atomic_test_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    
+    /* set chip type */
+    res = w25qxx_set_type(&gs_handle, type);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set type failed.\n");
+       
+        return 1;
+    }
+    
+    /* set chip interface */
+    res = w25qxx_set_interface(&gs_handle, interface);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set interface failed.\n");
+       
+        return 1;
+    }
+    
+    /* set dual quad spi */
+    res = w25qxx_set_dual_quad_spi(&gs_handle, dual_quad_spi_enable);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set dual quad spi failed.\n");
+       
+        return 1;
+    }
+    
+    /* chip init */
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    
+    /* start atomic test */
+    w25qxx_interface_debug_print("w25qxx: start atomic test.\n");
+    
+    /* the test region is reused, start from an erased one */
+    for (i = 0; i < W25QXX_ATOMIC_TEST_SECTORS; i++)
+    {
+        res = w25qxx_sector_erase_4k(&gs_handle, i * 4096);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: sector erase 4k failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    
+    /* first generation */
+    w25qxx_interface_debug_print("w25qxx: commit %d sectors together.\n", W25QXX_ATOMIC_TEST_TARGETS);
+    res = w25qxx_atomic_mount(&gs_handle, &gs_atomic, 0, W25QXX_ATOMIC_TEST_SECTORS);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: atomic mount failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    gen = 0;
+    if ((a_w25qxx_atomic_test_update(gen) != 0) || (a_w25qxx_atomic_test_check(&gen) != 0) || (gen != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: atomic commit failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* cut the power at every point of an update */
+    w25qxx_interface_debug_print("w25qxx: cut the power during updates, the failures below are expected.\n");
+    forward = 0;
+    back = 0;
+    for (i = 0; i < W25QXX_ATOMIC_TEST_CUTS; i += 3)
+    {
+        gs_budget = i;
+        (void)a_w25qxx_atomic_test_update(gen + 1);
+        gs_budget = 0xFFFFFFFFU;
+        
+        /* power cycle */
+        (void)w25qxx_deinit(&gs_handle);
+        res = w25qxx_init(&gs_handle);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: init failed.\n");
+            
+            return 1;
+        }
+        res = w25qxx_atomic_mount(&gs_handle, &gs_atomic, 0, W25QXX_ATOMIC_TEST_SECTORS);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: atomic mount failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        old = gen;
+        if (a_w25qxx_atomic_test_check(&gen) != 0)
+        {
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        forward += gs_atomic.roll_forward;
+        back += (gen == old) ? 1 : 0;
+    }
+    w25qxx_interface_debug_print("w25qxx: %d updates kept, %d rolled forward, %d rolled back.\n", 
+                                 gen, forward, back);
+    if ((forward == 0) || (back == 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: atomic recovery is not covered.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* a normal update after the recoveries */
+    old = gen;
+    if ((a_w25qxx_atomic_test_update(gen + 1) != 0) || (a_w25qxx_atomic_test_check(&gen) != 0) || (gen != old + 1))
+    {
+        w25qxx_interface_debug_print("w25qxx: atomic commit failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    w25qxx_interface_debug_print("w25qxx: %d commits, journal page %d.\n", gs_atomic.commit, gs_atomic.journal_page);
+    
+    /* finish atomic test */
+    w25qxx_interface_debug_print("w25qxx: finish atomic test.\n");
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+}
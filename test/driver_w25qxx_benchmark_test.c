@@ -0,0 +1,577 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_benchmark_test.c
+ * @brief     driver w25qxx benchmark test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_benchmark_test.h"
+#include <stdlib.h>
+
+/**
+ * @brief read function pointer definition
+ */
+typedef uint8_t (*w25qxx_benchmark_read_t)(w25qxx_handle_t *handle, uint32_t addr, uint8_t *data, uint32_t len);
+
+/**
+ * @brief read command structure definition
+ */
+typedef struct w25qxx_benchmark_read_cmd_s
+{
+    uint8_t cmd;                            /**< command */
+    w25qxx_benchmark_read_t read;           /**< read function */
+    uint8_t spi;                            /**< valid on the standard spi */
+    uint8_t dual_quad;                      /**< valid on the spi with dual quad enable */
+    uint8_t qspi;                           /**< valid on the qspi */
+} w25qxx_benchmark_read_cmd_t;
+
+static w25qxx_handle_t gs_handle;                                                 /**< w25qxx handle */
+static uint8_t gs_buffer_input[4096];                                             /**< input buffer */
+static uint8_t gs_buffer_output[4096];                                            /**< output buffer */
+static uint32_t gs_latency[W25QXX_BENCHMARK_TEST_READ_TIMES];                     /**< latency of each operation */
+static uint32_t gs_transactions;                                                  /**< bus transactions */
+static uint64_t gs_bus_bytes;                                                     /**< bytes on the bus */
+static uint32_t gs_programs;                                                      /**< page program commands */
+static uint32_t gs_erases;                                                        /**< erase commands */
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+static uint16_t gs_erase_map[16];                                                 /**< erase map of the write region */
+#endif
+static const uint32_t gsc_size[] = {0x100000, 0x200000, 0x400000, 0x800000, 0x1000000, 0x2000000};        /**< flash size */
+static const uint32_t gsc_read_size[] = {16, 64, 256, 1024, 4096};               /**< read size */
+static const uint32_t gsc_read_align[] = {0, 1, 128};                             /**< read alignment */
+static const uint32_t gsc_write_size[] = {16, 256, 4096};                         /**< write size */
+static const w25qxx_benchmark_read_cmd_t gsc_read_cmd[] =                         /**< read command */
+{
+    {0x03, w25qxx_only_spi_read,           1, 1, 0},
+    {0x0B, w25qxx_fast_read,               1, 1, 1},
+    {0x3B, w25qxx_fast_read_dual_output,   0, 1, 0},
+    {0x6B, w25qxx_fast_read_quad_output,   0, 1, 0},
+    {0xBB, w25qxx_fast_read_dual_io,       0, 1, 0},
+    {0xEB, w25qxx_fast_read_quad_io,       0, 1, 1},
+    {0xE7, w25qxx_word_read_quad_io,       0, 1, 0},
+    {0xE3, w25qxx_octal_word_read_quad_io, 0, 1, 0},
+};
+
+/**
+ * @brief      counting bus write read
+ * @param[in]  instruction is the sent instruction
+ * @param[in]  instruction_line is the instruction phy lines
+ * @param[in]  address is the register address
+ * @param[in]  address_line is the address phy lines
+ * @param[in]  address_len is the address length
+ * @param[in]  alternate is the register address
+ * @param[in]  alternate_line is the alternate phy lines
+ * @param[in]  alternate_len is the alternate length
+ * @param[in]  dummy is the dummy cycle
+ * @param[in]  *in_buf points to a input buffer
+ * @param[in]  in_len is the input length
+ * @param[out] *out_buf points to a output buffer
+ * @param[in]  out_len is the output length
+ * @param[in]  data_line is the data phy lines
+ * @return     status code
+ *             - 0 success
+ *             - 1 write read failed
+ * @note       counts the transactions and forwards them to the interface
+ */
+static uint8_t a_w25qxx_benchmark_spi_qspi_write_read(uint8_t instruction, uint8_t instruction_line,
+                                                      uint32_t address, uint8_t address_line, uint8_t address_len,
+                                                      uint32_t alternate, uint8_t alternate_line, uint8_t alternate_len,
+                                                      uint8_t dummy, uint8_t *in_buf, uint32_t in_len,
+                                                      uint8_t *out_buf, uint32_t out_len, uint8_t data_line)
+{
+    uint8_t cmd;
+    
+    if (instruction_line == 0)                                                                   /* raw spi frame */
+    {
+        cmd = ((in_buf != NULL) && (in_len != 0)) ? in_buf[0] : 0x00;                            /* command is the first byte */
+        gs_bus_bytes += in_len + out_len;                                                        /* add the frame bytes */
+    }
+    else
+    {
+        cmd = instruction;                                                                       /* set the command */
+        gs_bus_bytes += 1 + address_len + alternate_len + (dummy + 7) / 8 + in_len + out_len;    /* add the frame bytes */
+    }
+    gs_transactions++;                                                                           /* add one transaction */
+    if ((cmd == 0x02) || (cmd == 0x32))                                                          /* page program */
+    {
+        gs_programs++;                                                                           /* add one program */
+    }
+    else if ((cmd == 0x20) || (cmd == 0x52) || (cmd == 0xD8) || (cmd == 0xC7) || (cmd == 0x60)) /* erase */
+    {
+        gs_erases++;                                                                             /* add one erase */
+    }
+    
+    return w25qxx_interface_spi_qspi_write_read(instruction, instruction_line,
+                                                address, address_line, address_len,
+                                                alternate, alternate_line, alternate_len,
+                                                dummy, in_buf, in_len,
+                                                out_buf, out_len, data_line);
+}
+
+/**
+ * @brief  clear the counters
+ * @note   none
+ */
+static void a_w25qxx_benchmark_clear(void)
+{
+    gs_transactions = 0;
+    gs_bus_bytes = 0;
+    gs_programs = 0;
+    gs_erases = 0;
+}
+
+/**
+ * @brief     latency compare function
+ * @param[in] *a points to the first latency
+ * @param[in] *b points to the second latency
+ * @return    compare result
+ * @note      none
+ */
+static int a_w25qxx_benchmark_compare(const void *a, const void *b)
+{
+    uint32_t l = *(const uint32_t *)a;
+    uint32_t r = *(const uint32_t *)b;
+    
+    return (l > r) - (l < r);
+}
+
+/**
+ * @brief     print one result line
+ * @param[in] *test points to the test name
+ * @param[in] cmd is the command or 0 if not used
+ * @param[in] size is the size of one operation
+ * @param[in] align is the address offset
+ * @param[in] ops is the operation number
+ * @param[in] total_us is the total time
+ * @note      none
+ */
+static void a_w25qxx_benchmark_report(const char *test, uint8_t cmd, uint32_t size, uint32_t align,
+                                      uint32_t ops, uint64_t total_us)
+{
+    double bytes;
+    double mbps;
+    
+    qsort(gs_latency, ops, sizeof(uint32_t), a_w25qxx_benchmark_compare);
+    bytes = (double)size * ops;
+    mbps = (total_us != 0) ? (bytes / (double)total_us) : 0.0;                                  /* 1 byte/us is 1 MB/s */
+    w25qxx_interface_debug_print("{\"test\":\"%s\",\"cmd\":\"0x%02X\",\"size\":%d,\"align\":%d,\"ops\":%d,"
+                                 "\"mbps\":%0.4f,\"p50_us\":%d,\"p99_us\":%d,\"trans_per_op\":%0.2f,"
+                                 "\"bus_per_byte\":%0.3f,\"programs\":%d,\"erases\":%d}\n",
+                                 test, cmd, size, align, ops, mbps,
+                                 gs_latency[(ops - 1) * 50 / 100], gs_latency[(ops - 1) * 99 / 100],
+                                 (double)gs_transactions / ops, (double)gs_bus_bytes / bytes,
+                                 gs_programs, gs_erases);
+}
+
+/**
+ * @brief     fill the pattern
+ * @param[in] addr is the flash address
+ * @param[in] *buf points to a data buffer
+ * @param[in] len is the data length
+ * @note      none
+ */
+static void a_w25qxx_benchmark_pattern(uint32_t addr, uint8_t *buf, uint32_t len)
+{
+    uint32_t i;
+    
+    for (i = 0; i < len; i++)
+    {
+        buf[i] = (uint8_t)((addr + i) * 7 + ((addr + i) >> 8));
+    }
+}
+
+/**
+ * @brief     benchmark test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      the test destroys the flash content, every result is printed as one json line
+ *            with the keys test, cmd, size, align, ops, mbps, p50_us, p99_us, trans_per_op,
+ *            bus_per_byte, programs and erases
+ */
+uint8_t w25qxx_benchmark_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    uint8_t res;
+    uint32_t i, j, k, n;
+    uint32_t base;
+    uint32_t addr;
+    uint64_t start;
+    uint64_t t;
+    uint64_t total;
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, a_w25qxx_benchmark_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    DRIVER_W25QXX_LINK_TIMESTAMP_US(&gs_handle, w25qxx_benchmark_test_interface_timestamp_us);
+    
+    /* set chip type */
+    res = w25qxx_set_type(&gs_handle, type);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set type failed.\n");
+       
+        return 1;
+    }
+    
+    /* set chip interface */
+    res = w25qxx_set_interface(&gs_handle, interface);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set interface failed.\n");
+       
+        return 1;
+    }
+    
+    /* set dual quad spi */
+    res = w25qxx_set_dual_quad_spi(&gs_handle, dual_quad_spi_enable);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set dual quad spi failed.\n");
+       
+        return 1;
+    }
+    
+    /* chip init */
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    
+    /* start benchmark test */
+    w25qxx_interface_debug_print("w25qxx: start benchmark test.\n");
+    srand(0x57AB);
+    
+    /* use the upper half, so the extended address register is exercised on the >128Mb chips */
+    base = gsc_size[type - W25Q80] / 2;
+    
+    /* prepare the read region */
+    for (i = 0; i < 65536; i += 4096)
+    {
+        a_w25qxx_benchmark_pattern(base + i, gs_buffer_input, 4096);
+        res = w25qxx_write(&gs_handle, base + i, gs_buffer_input, 4096);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: write failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    
+    /* read sweep */
+    for (i = 0; i < sizeof(gsc_read_cmd) / sizeof(gsc_read_cmd[0]); i++)
+    {
+        if (((interface == W25QXX_INTERFACE_QSPI) && (gsc_read_cmd[i].qspi == 0)) ||
+            ((interface == W25QXX_INTERFACE_SPI) && (dual_quad_spi_enable == W25QXX_BOOL_FALSE) && (gsc_read_cmd[i].spi == 0)) ||
+            ((interface == W25QXX_INTERFACE_SPI) && (dual_quad_spi_enable == W25QXX_BOOL_TRUE) && (gsc_read_cmd[i].dual_quad == 0)))
+        {
+            continue;
+        }
+        for (j = 0; j < sizeof(gsc_read_size) / sizeof(gsc_read_size[0]); j++)
+        {
+            for (k = 0; k < sizeof(gsc_read_align) / sizeof(gsc_read_align[0]); k++)
+            {
+                a_w25qxx_benchmark_clear();
+                total = 0;
+                for (n = 0; n < W25QXX_BENCHMARK_TEST_READ_TIMES; n++)
+                {
+                    addr = base + (n % 8) * 4096 + gsc_read_align[k];
+                    start = w25qxx_benchmark_test_interface_timestamp_us();
+                    res = gsc_read_cmd[i].read(&gs_handle, addr, gs_buffer_output, gsc_read_size[j]);
+                    t = w25qxx_benchmark_test_interface_timestamp_us() - start;
+                    if (res)
+                    {
+                        w25qxx_interface_debug_print("w25qxx: read 0x%02X failed.\n", gsc_read_cmd[i].cmd);
+                        (void)w25qxx_deinit(&gs_handle);
+                        
+                        return 1;
+                    }
+                    gs_latency[n] = (uint32_t)t;
+                    total += t;
+                }
+                a_w25qxx_benchmark_pattern(addr, gs_buffer_input, gsc_read_size[j]);
+                if (memcmp(gs_buffer_input, gs_buffer_output, gsc_read_size[j]) != 0)
+                {
+                    w25qxx_interface_debug_print("w25qxx: read 0x%02X check failed.\n", gsc_read_cmd[i].cmd);
+                    (void)w25qxx_deinit(&gs_handle);
+                    
+                    return 1;
+                }
+                a_w25qxx_benchmark_report("read", gsc_read_cmd[i].cmd, gsc_read_size[j], gsc_read_align[k],
+                                          W25QXX_BENCHMARK_TEST_READ_TIMES, total);
+            }
+        }
+    }
+    
+    /* write sweep, the region is the next 64k block */
+    base += 65536;
+    for (i = 0; i < 4; i++)
+    {
+        const char *name[4] = {"seq_write", "rand_write", "update", "page_program"};
+        
+        for (j = 0; j < sizeof(gsc_write_size) / sizeof(gsc_write_size[0]); j++)
+        {
+            res = w25qxx_block_erase_64k(&gs_handle, base);
+            if (res)
+            {
+                w25qxx_interface_debug_print("w25qxx: block erase 64k failed.\n");
+                (void)w25qxx_deinit(&gs_handle);
+                
+                return 1;
+            }
+            a_w25qxx_benchmark_clear();
+            total = 0;
+            for (n = 0; n < W25QXX_BENCHMARK_TEST_WRITE_TIMES; n++)
+            {
+                if (i == 0)                                                                      /* sequential */
+                {
+                    addr = base + n * gsc_write_size[j];
+                }
+                else if (i == 1)                                                                 /* random */
+                {
+                    addr = base + (rand() % (65536 / gsc_write_size[j])) * gsc_write_size[j];
+                }
+                else if (i == 2)                                                                 /* small in-place update */
+                {
+                    addr = base + 4096 + 64;
+                }
+                else                                                                             /* raw page program */
+                {
+                    addr = base + n * ((gsc_write_size[j] + 255) / 256) * 256;                  /* page aligned */
+                }
+                for (k = 0; k < gsc_write_size[j]; k++)
+                {
+                    gs_buffer_input[k] = (uint8_t)(rand() % 256);
+                }
+                start = w25qxx_benchmark_test_interface_timestamp_us();
+                if (i == 3)
+                {
+                    for (k = 0; (k < gsc_write_size[j]) && (res == 0); k += 256)
+                    {
+                        uint16_t len = (gsc_write_size[j] - k) > 256 ? 256 : (uint16_t)(gsc_write_size[j] - k);
+                        
+                        res = w25qxx_page_program(&gs_handle, addr + k, gs_buffer_input + k, len);
+                    }
+                }
+                else
+                {
+                    res = w25qxx_write(&gs_handle, addr, gs_buffer_input, gsc_write_size[j]);
+                }
+                t = w25qxx_benchmark_test_interface_timestamp_us() - start;
+                if (res)
+                {
+                    w25qxx_interface_debug_print("w25qxx: %s failed.\n", name[i]);
+                    (void)w25qxx_deinit(&gs_handle);
+                    
+                    return 1;
+                }
+                gs_latency[n] = (uint32_t)t;
+                total += t;
+            }
+            a_w25qxx_benchmark_report(name[i], 0x00, gsc_write_size[j], 0,
+                                      W25QXX_BENCHMARK_TEST_WRITE_TIMES, total);
+            res = w25qxx_read(&gs_handle, addr, gs_buffer_output, gsc_write_size[j]);
+            if (res)
+            {
+                w25qxx_interface_debug_print("w25qxx: read failed.\n");
+                (void)w25qxx_deinit(&gs_handle);
+                
+                return 1;
+            }
+            if (memcmp(gs_buffer_input, gs_buffer_output, gsc_write_size[j]) != 0)
+            {
+                w25qxx_interface_debug_print("w25qxx: %s check failed.\n", name[i]);
+                (void)w25qxx_deinit(&gs_handle);
+                
+                return 1;
+            }
+        }
+    }
+    
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    /* sequential write into a region the erase map knows as erased */
+    res = w25qxx_erase_map_init(&gs_handle, gs_erase_map, base / 4096, 16, W25QXX_BOOL_FALSE);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: erase map init failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    res = w25qxx_block_erase_64k(&gs_handle, base);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: block erase 64k failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    a_w25qxx_benchmark_clear();
+    total = 0;
+    for (n = 0; n < W25QXX_BENCHMARK_TEST_WRITE_TIMES; n++)
+    {
+        a_w25qxx_benchmark_pattern(base + n * 256, gs_buffer_input + n * 256, 256);
+        start = w25qxx_benchmark_test_interface_timestamp_us();
+        res = w25qxx_write(&gs_handle, base + n * 256, gs_buffer_input + n * 256, 256);
+        t = w25qxx_benchmark_test_interface_timestamp_us() - start;
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: mapped_seq_write failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        gs_latency[n] = (uint32_t)t;
+        total += t;
+    }
+    a_w25qxx_benchmark_report("mapped_seq_write", 0x00, 256, 0, W25QXX_BENCHMARK_TEST_WRITE_TIMES, total);
+    if ((double)gs_bus_bytes > 2.0 * 256 * W25QXX_BENCHMARK_TEST_WRITE_TIMES)                      /* a 4k read back per write is 16x */
+    {
+        w25qxx_interface_debug_print("w25qxx: mapped_seq_write still reads back.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    res = w25qxx_read(&gs_handle, base, gs_buffer_output, 256 * W25QXX_BENCHMARK_TEST_WRITE_TIMES);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: read failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (memcmp(gs_buffer_input, gs_buffer_output, 256 * W25QXX_BENCHMARK_TEST_WRITE_TIMES) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: mapped_seq_write check failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* discard the region and let the background step erase it */
+    {
+        uint32_t erased;
+        uint32_t pool;
+        uint32_t backlog;
+        
+        res = w25qxx_discard(&gs_handle, base, 65536);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: discard failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        a_w25qxx_benchmark_clear();
+        do
+        {
+            res = w25qxx_discard_step(&gs_handle, &erased);
+        } while ((res == 0) && (erased != 0));
+        if ((res != 0) || (w25qxx_discard_get_pool(&gs_handle, &pool, &backlog) != 0))
+        {
+            w25qxx_interface_debug_print("w25qxx: discard step failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        w25qxx_interface_debug_print("{\"test\":\"discard\",\"pool\":%d,\"backlog\":%d,\"erases\":%d}\n",
+                                     pool, backlog, gs_erases);
+        if ((pool != 65536) || (backlog != 0) || (gs_erases != 1))
+        {
+            w25qxx_interface_debug_print("w25qxx: discard did not erase one 64k block.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    (void)w25qxx_erase_map_init(&gs_handle, NULL, 0, 0, W25QXX_BOOL_FALSE);
+#endif
+    
+#if (W25QXX_ENABLE_STATS == 1)
+    /* print the driver statistics */
+    {
+        w25qxx_stats_t stats;
+        
+        res = w25qxx_get_stats(&gs_handle, &stats);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: get stats failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        w25qxx_interface_debug_print("{\"test\":\"stats\",\"read_bytes\":%llu,\"program_bytes\":%llu,\"page_program\":%u,"
+                                     "\"erase_4k\":%u,\"erase_32k\":%u,\"erase_64k\":%u,\"chip_erase\":%u}\n",
+                                     (unsigned long long)stats.read_bytes, (unsigned long long)stats.program_bytes,
+                                     stats.page_program, stats.erase_4k, stats.erase_32k, stats.erase_64k, stats.chip_erase);
+        w25qxx_interface_debug_print("{\"test\":\"stats\",\"write_enable\":%u,\"extended_address\":%u,\"status_poll\":%u,"
+                                     "\"busy_wait_us\":%llu,\"write_read_back_bytes\":%llu,\"write_erase\":%u}\n",
+                                     stats.write_enable, stats.extended_address, stats.status_poll,
+                                     (unsigned long long)stats.busy_wait_us, (unsigned long long)stats.write_read_back_bytes,
+                                     stats.write_erase);
+        for (i = 0; i < W25QXX_STATS_OPERATION_MAX; i++)
+        {
+            char line[240];
+            uint32_t pos;
+            
+            pos = (uint32_t)snprintf(line, sizeof(line), "{\"test\":\"latency\",\"op\":%d,\"log2_us\":[", (int)i);
+            for (j = 0; j < W25QXX_STATS_LATENCY_BINS; j++)
+            {
+                pos += (uint32_t)snprintf(line + pos, sizeof(line) - pos, "%u%s", stats.latency[i][j],
+                                          (j == W25QXX_STATS_LATENCY_BINS - 1) ? "]}" : ",");
+                if (pos >= sizeof(line))
+                {
+                    break;
+                }
+            }
+            w25qxx_interface_debug_print("%s\n", line);
+        }
+    }
+#endif
+    
+    /* finish benchmark test */
+    w25qxx_interface_debug_print("w25qxx: finish benchmark test.\n");
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+}
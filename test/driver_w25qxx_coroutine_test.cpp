@@ -0,0 +1,370 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_coroutine_test.cpp
+ * @brief     driver w25qxx coroutine test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_coroutine_test.h"
+#include "driver_w25qxx_coroutine.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @brief dual quad spi bus policy definition
+ */
+struct dual_quad_spi_bus : w25qxx::interface_bus
+{
+    static constexpr bool dual_quad_spi = true;                                                     /**< dual quad spi */
+};
+
+/**
+ * @brief qspi bus policy definition
+ */
+struct qspi_bus : w25qxx::interface_bus
+{
+    static constexpr w25qxx_interface_t interface = W25QXX_INTERFACE_QSPI;                         /**< chip interface */
+};
+
+std::array<uint8_t, 4096> gs_a;              /**< first sector data */
+std::array<uint8_t, 4096> gs_b;              /**< second sector data */
+std::array<uint8_t, 300> gs_c;               /**< overwrite data */
+std::array<uint8_t, 4096> gs_output;         /**< output buffer */
+
+/**
+ * @brief     coroutine test print
+ * @param[in] *fmt points to a format string
+ * @param[in] args are the format arguments
+ * @note      the c interface takes a mutable format string
+ */
+template <typename... Args>
+void a_w25qxx_coroutine_test_print(const char *fmt, Args... args)
+{
+    (void)w25qxx_interface_debug_print(const_cast<char *>(fmt), args...);
+}
+
+/**
+ * @brief     coroutine test drive the poller
+ * @param[in] &loop is the poller
+ * @note      every round also advances the clock of the chip by 1 ms, the simulated chip
+ *            only runs on bus transfers and delays
+ */
+void a_w25qxx_coroutine_test_drive(w25qxx::poller &loop)
+{
+    while (!loop.empty())
+    {
+        std::this_thread::sleep_until(loop.next_deadline());
+        w25qxx_interface_delay_us(1000);
+        loop.poll();
+    }
+}
+
+/**
+ * @brief     coroutine test check a finished task
+ * @param[in] &t is the task
+ * @param[in] *name points to a task name
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      none
+ */
+uint8_t a_w25qxx_coroutine_test_done(const w25qxx::task &t, const char *name)
+{
+    if (!t.done() || (t.status() != 0))
+    {
+        a_w25qxx_coroutine_test_print("w25qxx: %s task failed.\n", name);
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     coroutine test copy a sector
+ * @param[in] &flash is the async flash
+ * @param[in] from is the source sector address
+ * @param[in] to is the destination sector address
+ * @return    task with the first failing status code
+ * @note      the buffer lives in the coroutine frame
+ */
+template <w25qxx_type_t Type, typename Bus>
+w25qxx::task a_w25qxx_coroutine_test_copy(w25qxx::async_flash<Type, Bus> &flash, uint32_t from, uint32_t to)
+{
+    std::vector<uint8_t> buf(4096);
+    uint8_t res;
+    
+    res = co_await flash.read(from, buf);
+    if (res != 0)
+    {
+        co_return res;
+    }
+    
+    co_return co_await flash.write(to, buf);
+}
+
+/**
+ * @brief  coroutine test run one chip type and bus
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   none
+ */
+template <w25qxx_type_t Type, typename Bus>
+uint8_t a_w25qxx_coroutine_test_run(void)
+{
+    w25qxx::flash<Type, Bus> chip;
+    w25qxx::poller loop;
+    std::size_t i;
+    
+    if (chip.init() != 0)
+    {
+        a_w25qxx_coroutine_test_print("w25qxx: init failed.\n");
+        
+        return 1;
+    }
+    if constexpr (w25qxx::flash<Type, Bus>::traits::extended_address)
+    {
+        if (chip.set_address_mode(W25QXX_ADDRESS_MODE_4_BYTE) != 0)
+        {
+            a_w25qxx_coroutine_test_print("w25qxx: set address mode failed.\n");
+            
+            return 1;
+        }
+    }
+    for (i = 0; i < gs_a.size(); i++)
+    {
+        gs_a[i] = static_cast<uint8_t>(std::rand() % 256);
+        gs_b[i] = static_cast<uint8_t>(std::rand() % 256);
+    }
+    for (i = 0; i < gs_c.size(); i++)
+    {
+        gs_c[i] = static_cast<uint8_t>(std::rand() % 256);
+    }
+    
+    w25qxx::async_flash<Type, Bus> flash(chip, loop);
+    
+    /* two writes and a read contend for the chip */
+    a_w25qxx_coroutine_test_print("w25qxx: queue two writes and a read.\n");
+    {
+        w25qxx::task t1 = flash.write(4096, gs_a);
+        w25qxx::task t2 = flash.write(8192, gs_b);
+        w25qxx::task t3 = flash.read(4096, gs_output);
+        
+        t1.start();
+        t2.start();
+        t3.start();
+        if (!flash.busy() || t2.done() || t3.done())
+        {
+            a_w25qxx_coroutine_test_print("w25qxx: operations did not queue.\n");
+            
+            return 1;
+        }
+        a_w25qxx_coroutine_test_drive(loop);
+        if ((a_w25qxx_coroutine_test_done(t1, "first write") != 0) ||
+            (a_w25qxx_coroutine_test_done(t2, "second write") != 0) ||
+            (a_w25qxx_coroutine_test_done(t3, "read") != 0))
+        {
+            return 1;
+        }
+        if (flash.busy() || (gs_output != gs_a))
+        {
+            a_w25qxx_coroutine_test_print("w25qxx: queued read check failed.\n");
+            
+            return 1;
+        }
+        if ((chip.read(8192, gs_output) != 0) || (gs_output != gs_b))
+        {
+            a_w25qxx_coroutine_test_print("w25qxx: second write check failed.\n");
+            
+            return 1;
+        }
+    }
+    
+    /* a composed copy and an overwrite that needs an erase */
+    a_w25qxx_coroutine_test_print("w25qxx: queue a copy and an overwrite.\n");
+    {
+        w25qxx::task t4 = a_w25qxx_coroutine_test_copy(flash, 8192, 12288);
+        w25qxx::task t5 = flash.write(4096 + 100, gs_c);
+        
+        t4.start();
+        t5.start();
+        a_w25qxx_coroutine_test_drive(loop);
+        if ((a_w25qxx_coroutine_test_done(t4, "copy") != 0) ||
+            (a_w25qxx_coroutine_test_done(t5, "overwrite") != 0))
+        {
+            return 1;
+        }
+        if ((chip.read(12288, gs_output) != 0) || (gs_output != gs_b))
+        {
+            a_w25qxx_coroutine_test_print("w25qxx: copy check failed.\n");
+            
+            return 1;
+        }
+        std::memcpy(&gs_a[100], gs_c.data(), gs_c.size());
+        if ((chip.read(4096, gs_output) != 0) || (gs_output != gs_a))
+        {
+            a_w25qxx_coroutine_test_print("w25qxx: overwrite check failed.\n");
+            
+            return 1;
+        }
+    }
+    
+    return chip.deinit();
+}
+
+/**
+ * @brief     coroutine test select the bus of one chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+template <w25qxx_type_t Type>
+uint8_t a_w25qxx_coroutine_test_bus(w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    /* only the buses compiled into the driver are instantiated */
+#if ((W25QXX_CONFIG_INTERFACE & W25QXX_CONFIG_INTERFACE_QSPI) != 0)
+    if (interface == W25QXX_INTERFACE_QSPI)
+    {
+        return a_w25qxx_coroutine_test_run<Type, qspi_bus>();
+    }
+#endif
+#if ((W25QXX_CONFIG_INTERFACE & W25QXX_CONFIG_INTERFACE_SPI) != 0)
+#if (W25QXX_CONFIG_DUAL_QUAD_SPI != 0)
+    if ((interface == W25QXX_INTERFACE_SPI) && (dual_quad_spi_enable == W25QXX_BOOL_TRUE))
+    {
+        return a_w25qxx_coroutine_test_run<Type, dual_quad_spi_bus>();
+    }
+#endif
+    if ((interface == W25QXX_INTERFACE_SPI) && (dual_quad_spi_enable == W25QXX_BOOL_FALSE))
+    {
+        return a_w25qxx_coroutine_test_run<Type, w25qxx::interface_bus>();
+    }
+#endif
+    a_w25qxx_coroutine_test_print("w25qxx: bus is not compiled in.\n");
+    
+    return 1;
+}
+
+}
+
+/**
+ * @brief     coroutine test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+uint8_t w25qxx_coroutine_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    uint8_t res;
+    
+    /* start coroutine test */
+    a_w25qxx_coroutine_test_print("w25qxx: start coroutine test.\n");
+    switch (type)
+    {
+        case W25Q80 :
+        {
+            res = a_w25qxx_coroutine_test_bus<W25Q80>(interface, dual_quad_spi_enable);
+            
+            break;
+        }
+#if (W25QXX_CONFIG_MAX_TYPE >= 0xEF14)
+        case W25Q16 :
+        {
+            res = a_w25qxx_coroutine_test_bus<W25Q16>(interface, dual_quad_spi_enable);
+            
+            break;
+        }
+#endif
+#if (W25QXX_CONFIG_MAX_TYPE >= 0xEF15)
+        case W25Q32 :
+        {
+            res = a_w25qxx_coroutine_test_bus<W25Q32>(interface, dual_quad_spi_enable);
+            
+            break;
+        }
+#endif
+#if (W25QXX_CONFIG_MAX_TYPE >= 0xEF16)
+        case W25Q64 :
+        {
+            res = a_w25qxx_coroutine_test_bus<W25Q64>(interface, dual_quad_spi_enable);
+            
+            break;
+        }
+#endif
+#if (W25QXX_CONFIG_MAX_TYPE >= 0xEF17)
+        case W25Q128 :
+        {
+            res = a_w25qxx_coroutine_test_bus<W25Q128>(interface, dual_quad_spi_enable);
+            
+            break;
+        }
+#endif
+#if (W25QXX_CONFIG_MAX_TYPE >= 0xEF18)
+        case W25Q256 :
+        {
+            res = a_w25qxx_coroutine_test_bus<W25Q256>(interface, dual_quad_spi_enable);
+            
+            break;
+        }
+#endif
+        default :
+        {
+            res = 1;
+            
+            break;
+        }
+    }
+    if (res != 0)
+    {
+        return 1;
+    }
+    
+    /* finish coroutine test */
+    a_w25qxx_coroutine_test_print("w25qxx: finish coroutine test.\n");
+    
+    return 0;
+}
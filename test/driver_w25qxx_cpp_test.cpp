@@ -0,0 +1,313 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_cpp_test.cpp
+ * @brief     driver w25qxx c++ test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_cpp_test.h"
+#include "driver_w25qxx.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if !defined(__cpp_lib_span)
+    #error "the c++ test needs c++20 std::span"
+#endif
+
+namespace
+{
+
+/**
+ * @brief dual quad spi bus policy definition
+ */
+struct dual_quad_spi_bus : w25qxx::interface_bus
+{
+    static constexpr bool dual_quad_spi = true;                                                     /**< dual quad spi */
+};
+
+/**
+ * @brief qspi bus policy definition
+ */
+struct qspi_bus : w25qxx::interface_bus
+{
+    static constexpr w25qxx_interface_t interface = W25QXX_INTERFACE_QSPI;                         /**< chip interface */
+};
+
+std::array<uint8_t, 600> gs_input;         /**< input buffer */
+std::array<uint8_t, 600> gs_output;        /**< output buffer */
+
+/**
+ * @brief     c++ test print
+ * @param[in] *fmt points to a format string
+ * @param[in] args are the format arguments
+ * @note      the c interface takes a mutable format string
+ */
+template <typename... Args>
+void a_w25qxx_cpp_test_print(const char *fmt, Args... args)
+{
+    (void)w25qxx_interface_debug_print(const_cast<char *>(fmt), args...);
+}
+
+/**
+ * @brief     c++ test check the output buffer
+ * @param[in] len is the checked length
+ * @param[in] *name points to a check name
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      none
+ */
+uint8_t a_w25qxx_cpp_test_check(uint32_t len, const char *name)
+{
+    if (std::memcmp(gs_input.data(), gs_output.data(), len) != 0)
+    {
+        a_w25qxx_cpp_test_print("w25qxx: %s check failed.\n", name);
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  c++ test run one chip type and bus
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   every call form below must compile, the fixed extent ones go through the checked templates
+ */
+template <w25qxx_type_t Type, typename Bus>
+uint8_t a_w25qxx_cpp_test_run(void)
+{
+    w25qxx::flash<Type, Bus> flash;
+    std::vector<uint8_t> vector(256);
+    uint8_t raw[256];
+    uint32_t i;
+    
+    if (flash.init() != 0)
+    {
+        a_w25qxx_cpp_test_print("w25qxx: init failed.\n");
+        
+        return 1;
+    }
+    if constexpr (w25qxx::flash<Type, Bus>::traits::extended_address)
+    {
+        if (flash.set_address_mode(W25QXX_ADDRESS_MODE_4_BYTE) != 0)
+        {
+            a_w25qxx_cpp_test_print("w25qxx: set address mode failed.\n");
+            
+            return 1;
+        }
+    }
+    for (i = 0; i < gs_input.size(); i++)
+    {
+        gs_input[i] = static_cast<uint8_t>(std::rand() % 256);
+    }
+    
+    /* std::array converts to the dynamic spans */
+    a_w25qxx_cpp_test_print("w25qxx: std::array write and read.\n");
+    if ((flash.write(0, gs_input) != 0) || (flash.read(0, gs_output) != 0) ||
+        (a_w25qxx_cpp_test_check(600, "std::array") != 0))
+    {
+        return 1;
+    }
+    
+    /* a mutable span writes through the const span overload */
+    a_w25qxx_cpp_test_print("w25qxx: std::span write and read.\n");
+    gs_output.fill(0);
+    if ((flash.write(4096, std::span<uint8_t>(gs_input)) != 0) ||
+        (flash.read(4096, std::span<uint8_t>(gs_output).first(300)) != 0) ||
+        (flash.read(4096 + 300, std::span<uint8_t>(gs_output).subspan(300)) != 0) ||
+        (a_w25qxx_cpp_test_check(600, "std::span") != 0))
+    {
+        return 1;
+    }
+    
+    /* fixed extents pick the checked templates */
+    a_w25qxx_cpp_test_print("w25qxx: fixed extent page program and read.\n");
+    gs_output.fill(0);
+    if ((flash.erase_sector(8192) != 0) ||
+        (flash.page_program(8192, std::span<uint8_t, 256>(gs_input.data(), 256)) != 0) ||
+        (flash.page_program(8192 + 256, std::span<const uint8_t, 256>(gs_input.data() + 256, 256)) != 0) ||
+        (flash.read(8192, std::span<uint8_t, 512>(gs_output.data(), 512)) != 0) ||
+        (a_w25qxx_cpp_test_check(512, "fixed extent") != 0))
+    {
+        return 1;
+    }
+    
+    /* c arrays and vectors convert too */
+    a_w25qxx_cpp_test_print("w25qxx: c array and std::vector read.\n");
+    if ((flash.read(0, raw) != 0) || (std::memcmp(raw, gs_input.data(), 256) != 0))
+    {
+        a_w25qxx_cpp_test_print("w25qxx: c array check failed.\n");
+        
+        return 1;
+    }
+    if ((flash.read(256, vector) != 0) || (std::memcmp(vector.data(), gs_input.data() + 256, 256) != 0))
+    {
+        a_w25qxx_cpp_test_print("w25qxx: std::vector check failed.\n");
+        
+        return 1;
+    }
+    if ((flash.write(0, vector) != 0) || (flash.read(0, gs_output.data(), 256) != 0) ||
+        (std::memcmp(vector.data(), gs_output.data(), 256) != 0))
+    {
+        a_w25qxx_cpp_test_print("w25qxx: std::vector write check failed.\n");
+        
+        return 1;
+    }
+    
+    return flash.deinit();
+}
+
+/**
+ * @brief     c++ test select the bus of one chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+template <w25qxx_type_t Type>
+uint8_t a_w25qxx_cpp_test_bus(w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    /* only the buses compiled into the driver are instantiated */
+#if ((W25QXX_CONFIG_INTERFACE & W25QXX_CONFIG_INTERFACE_QSPI) != 0)
+    if (interface == W25QXX_INTERFACE_QSPI)
+    {
+        return a_w25qxx_cpp_test_run<Type, qspi_bus>();
+    }
+#endif
+#if ((W25QXX_CONFIG_INTERFACE & W25QXX_CONFIG_INTERFACE_SPI) != 0)
+#if (W25QXX_CONFIG_DUAL_QUAD_SPI != 0)
+    if ((interface == W25QXX_INTERFACE_SPI) && (dual_quad_spi_enable == W25QXX_BOOL_TRUE))
+    {
+        return a_w25qxx_cpp_test_run<Type, dual_quad_spi_bus>();
+    }
+#endif
+    if ((interface == W25QXX_INTERFACE_SPI) && (dual_quad_spi_enable == W25QXX_BOOL_FALSE))
+    {
+        return a_w25qxx_cpp_test_run<Type, w25qxx::interface_bus>();
+    }
+#endif
+    a_w25qxx_cpp_test_print("w25qxx: bus is not compiled in.\n");
+    
+    return 1;
+}
+
+}
+
+/**
+ * @brief     c++ test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+uint8_t w25qxx_cpp_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    uint8_t res;
+    
+    /* start c++ test */
+    a_w25qxx_cpp_test_print("w25qxx: start c++ test.\n");
+    switch (type)
+    {
+        case W25Q80 :
+        {
+            res = a_w25qxx_cpp_test_bus<W25Q80>(interface, dual_quad_spi_enable);
+            
+            break;
+        }
+#if (W25QXX_CONFIG_MAX_TYPE >= 0xEF14)
+        case W25Q16 :
+        {
+            res = a_w25qxx_cpp_test_bus<W25Q16>(interface, dual_quad_spi_enable);
+            
+            break;
+        }
+#endif
+#if (W25QXX_CONFIG_MAX_TYPE >= 0xEF15)
+        case W25Q32 :
+        {
+            res = a_w25qxx_cpp_test_bus<W25Q32>(interface, dual_quad_spi_enable);
+            
+            break;
+        }
+#endif
+#if (W25QXX_CONFIG_MAX_TYPE >= 0xEF16)
+        case W25Q64 :
+        {
+            res = a_w25qxx_cpp_test_bus<W25Q64>(interface, dual_quad_spi_enable);
+            
+            break;
+        }
+#endif
+#if (W25QXX_CONFIG_MAX_TYPE >= 0xEF17)
+        case W25Q128 :
+        {
+            res = a_w25qxx_cpp_test_bus<W25Q128>(interface, dual_quad_spi_enable);
+            
+            break;
+        }
+#endif
+#if (W25QXX_CONFIG_MAX_TYPE >= 0xEF18)
+        case W25Q256 :
+        {
+            res = a_w25qxx_cpp_test_bus<W25Q256>(interface, dual_quad_spi_enable);
+            
+            break;
+        }
+#endif
+        default :
+        {
+            res = 1;
+            
+            break;
+        }
+    }
+    if (res != 0)
+    {
+        return 1;
+    }
+    
+    /* finish c++ test */
+    a_w25qxx_cpp_test_print("w25qxx: finish c++ test.\n");
+    
+    return 0;
+}
@@ -0,0 +1,220 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_crc_test.c
+ * @brief     driver w25qxx crc test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_crc_test.h"
+#include <stdlib.h>
+
+static w25qxx_handle_t gs_handle;                      /**< w25qxx handle */
+static uint8_t gs_data[W25QXX_CRC_TEST_SIZE];          /**< test data */
+
+/**
+ * @brief     crc test bitwise reference
+ * @param[in] *buf points to a data buffer
+ * @param[in] len is the data length
+ * @return    crc32
+ * @note      none
+ */
+static uint32_t a_w25qxx_crc_test_reference(const uint8_t *buf, uint32_t len)
+{
+    uint32_t crc;
+    uint32_t i;
+    uint8_t j;
+    
+    crc = 0xFFFFFFFFU;
+    for (i = 0; i < len; i++)
+    {
+        crc ^= buf[i];
+        for (j = 0; j < 8; j++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1)));
+        }
+    }
+    
+    return ~crc;
+}
+
+/**
+ * @brief     crc test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+uint8_t w25qxx_crc_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    uint8_t res;
+    uint32_t i;
+    uint32_t crc;
+    uint32_t addr;
+    uint32_t len;
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    
+    /* set chip type */
+    res = w25qxx_set_type(&gs_handle, type);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set type failed.\n");
+       
+        return 1;
+    }
+    
+    /* set chip interface */
+    res = w25qxx_set_interface(&gs_handle, interface);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set interface failed.\n");
+       
+        return 1;
+    }
+    
+    /* set dual quad spi */
+    res = w25qxx_set_dual_quad_spi(&gs_handle, dual_quad_spi_enable);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set dual quad spi failed.\n");
+       
+        return 1;
+    }
+    
+    /* chip init */
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    
+    /* start crc test */
+    w25qxx_interface_debug_print("w25qxx: start crc test.\n");
+    
+    /* check value */
+    crc = w25qxx_crc32(0, (const uint8_t *)"123456789", 9);
+    if (crc != 0xCBF43926U)
+    {
+        w25qxx_interface_debug_print("w25qxx: crc32 check value is 0x%08X.\n", crc);
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    w25qxx_interface_debug_print("w25qxx: crc32 check value is right.\n");
+    
+    /* program random data */
+    for (i = 0; i < W25QXX_CRC_TEST_SIZE; i++)
+    {
+        gs_data[i] = (uint8_t)(rand() % 256);
+    }
+    for (i = 0; i < W25QXX_CRC_TEST_SIZE; i += 4096)
+    {
+        res = w25qxx_sector_erase_4k(&gs_handle, i);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: sector erase 4k failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    for (i = 0; i < W25QXX_CRC_TEST_SIZE; i += 256)
+    {
+        res = w25qxx_page_program(&gs_handle, i, &gs_data[i], 256);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: page program failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    
+    /* ranges of any alignment and length */
+    w25qxx_interface_debug_print("w25qxx: check crc32 ranges.\n");
+    for (i = 0; i < 64; i++)
+    {
+        addr = (uint32_t)(rand() % W25QXX_CRC_TEST_SIZE);
+        len = (uint32_t)(rand() % (W25QXX_CRC_TEST_SIZE - addr + 1));
+        res = w25qxx_crc32_range(&gs_handle, addr, len, &crc);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: crc32 range failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        if (crc != a_w25qxx_crc_test_reference(&gs_data[addr], len))
+        {
+            w25qxx_interface_debug_print("w25qxx: crc32 of 0x%06X - %d is wrong.\n", addr, len);
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    
+    /* verify */
+    w25qxx_interface_debug_print("w25qxx: verify the whole range.\n");
+    crc = a_w25qxx_crc_test_reference(gs_data, W25QXX_CRC_TEST_SIZE);
+    if (w25qxx_verify_range(&gs_handle, 0, W25QXX_CRC_TEST_SIZE, crc) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: verify range failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (w25qxx_verify_range(&gs_handle, 0, W25QXX_CRC_TEST_SIZE, crc ^ 1) != 5)
+    {
+        w25qxx_interface_debug_print("w25qxx: verify range misses a mismatch.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* finish crc test */
+    w25qxx_interface_debug_print("w25qxx: finish crc test.\n");
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+}
@@ -0,0 +1,694 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_erase_map_test.c
+ * @brief     driver w25qxx erase map test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_erase_map_test.h"
+#include "driver_w25qxx_ring.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+
+static w25qxx_handle_t gs_handle;                                  /**< w25qxx handle */
+static uint16_t gs_map[W25QXX_ERASE_MAP_TEST_SECTORS];             /**< erase map */
+static uint8_t gs_buffer[4096];                                    /**< data buffer */
+static uint8_t gs_check[4096];                                     /**< check buffer */
+static volatile uint32_t gs_erase = 0;                             /**< erase commands */
+static volatile uint32_t gs_rx = 0;                                /**< bytes read from the chip */
+static volatile uint8_t gs_fail_status = 0;                        /**< fail the status register reads */
+static w25qxx_ring_t gs_ring;                                      /**< w25qxx ring */
+static w25qxx_ring_sqe_t gs_sq[2];                                 /**< submission entries */
+static w25qxx_ring_cqe_t gs_cq[2];                                 /**< completion entries */
+
+/**
+ * @brief      erase map test interface spi qspi bus write read with counting
+ * @param[in]  instruction is the sent instruction
+ * @param[in]  instruction_line is the instruction phy lines
+ * @param[in]  address is the register address
+ * @param[in]  address_line is the address phy lines
+ * @param[in]  address_len is the address length
+ * @param[in]  alternate is the register address
+ * @param[in]  alternate_line is the alternate phy lines
+ * @param[in]  alternate_len is the alternate length
+ * @param[in]  dummy is the dummy cycle
+ * @param[in]  *in_buf points to a input buffer
+ * @param[in]  in_len is the input length
+ * @param[out] *out_buf points to a output buffer
+ * @param[in]  out_len is the output length
+ * @param[in]  data_line is the data phy lines
+ * @return     status code
+ *             - 0 success
+ *             - 1 write read failed
+ * @note       counts the erase commands in gs_erase and the read bytes in gs_rx,
+ *             fails the status register 1 reads while gs_fail_status is set
+ */
+static uint8_t a_w25qxx_erase_map_test_write_read(uint8_t instruction, uint8_t instruction_line,
+                                                  uint32_t address, uint8_t address_line, uint8_t address_len,
+                                                  uint32_t alternate, uint8_t alternate_line, uint8_t alternate_len,
+                                                  uint8_t dummy, uint8_t *in_buf, uint32_t in_len,
+                                                  uint8_t *out_buf, uint32_t out_len, uint8_t data_line)
+{
+    uint8_t cmd;
+    
+    cmd = (instruction_line != 0) ? instruction : ((in_len != 0) ? in_buf[0] : 0x00);
+    if ((cmd == 0x20) || (cmd == 0x52) || (cmd == 0xD8))
+    {
+        gs_erase++;
+    }
+    if ((cmd == 0x05) && (gs_fail_status != 0))
+    {
+        return 1;
+    }
+    gs_rx += out_len;
+    
+    return w25qxx_interface_spi_qspi_write_read(instruction, instruction_line, address, address_line, address_len,
+                                                alternate, alternate_line, alternate_len, dummy, in_buf, in_len,
+                                                out_buf, out_len, data_line);
+}
+
+/**
+ * @brief     erase map test write and read back
+ * @param[in] addr is the write address
+ * @param[in] *data points to a data buffer
+ * @param[in] len is the data length
+ * @param[in] read_back is a bool value, the write must read the sector back
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      the write must never erase, the mapped sectors are erased
+ */
+static uint8_t a_w25qxx_erase_map_test_write(uint32_t addr, uint8_t *data, uint32_t len, w25qxx_bool_t read_back)
+{
+    gs_erase = 0;
+    gs_rx = 0;
+    if (w25qxx_write(&gs_handle, addr, data, len) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: write failed.\n");
+        
+        return 1;
+    }
+    if (gs_erase != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: write erased an erased sector.\n");
+        
+        return 1;
+    }
+    if ((read_back == W25QXX_BOOL_TRUE) != (gs_rx >= 4096))
+    {
+        w25qxx_interface_debug_print("w25qxx: write read back %d bytes.\n", gs_rx);
+        
+        return 1;
+    }
+    if (w25qxx_read(&gs_handle, addr, gs_check, len) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: read failed.\n");
+        
+        return 1;
+    }
+    if (memcmp(gs_check, data, len) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: write read check failed.\n");
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     erase map test check an entry
+ * @param[in] i is the map index
+ * @param[in] mark is the expected erased offset
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      none
+ */
+static uint8_t a_w25qxx_erase_map_test_check(uint32_t i, uint16_t mark)
+{
+    if (gs_map[i] != mark)
+    {
+        w25qxx_interface_debug_print("w25qxx: sector %d mark %d is not %d.\n",
+                                     W25QXX_ERASE_MAP_TEST_FIRST + i, gs_map[i], mark);
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     erase map test check the pool
+ * @param[in] pool is the expected known erased bytes
+ * @param[in] backlog is the expected discarded bytes
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      none
+ */
+static uint8_t a_w25qxx_erase_map_test_pool(uint32_t pool, uint32_t backlog)
+{
+    uint32_t p;
+    uint32_t b;
+    
+    if (w25qxx_discard_get_pool(&gs_handle, &p, &b) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: discard get pool failed.\n");
+        
+        return 1;
+    }
+    if ((p != pool) || (b != backlog))
+    {
+        w25qxx_interface_debug_print("w25qxx: pool %d backlog %d is not %d %d.\n", p, b, pool, backlog);
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     erase map test run one discard step
+ * @param[in] len is the expected erased length
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      none
+ */
+static uint8_t a_w25qxx_erase_map_test_step(uint32_t len)
+{
+    uint32_t erased;
+    
+    if (w25qxx_discard_step(&gs_handle, &erased) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: discard step failed.\n");
+        
+        return 1;
+    }
+    if (erased != len)
+    {
+        w25qxx_interface_debug_print("w25qxx: discard step erased %d not %d.\n", erased, len);
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief      erase map test erase a sector through the ring
+ * @param[in]  addr is the sector address
+ * @param[out] *res points to a status buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 ring failed
+ * @note       res gets the status of the completion
+ */
+static uint8_t a_w25qxx_erase_map_test_ring_erase(uint32_t addr, uint8_t *res)
+{
+    w25qxx_ring_sqe_t sqe;
+    w25qxx_ring_cqe_t cqe;
+    uint32_t i;
+    
+    if (w25qxx_ring_init(&gs_ring, gs_sq, 2, gs_cq, 2) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: ring init failed.\n");
+        
+        return 1;
+    }
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.handle = &gs_handle;
+    sqe.addr = addr;
+    sqe.len = 4096;
+    sqe.op = W25QXX_RING_OP_ERASE;
+    if (w25qxx_ring_submit(&gs_ring, &sqe) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: ring submit failed.\n");
+        
+        return 1;
+    }
+    for (i = 0; i < 1000; i++)
+    {
+        if (w25qxx_ring_process(&gs_ring, NULL) != 0)
+        {
+            w25qxx_interface_debug_print("w25qxx: ring process failed.\n");
+            
+            return 1;
+        }
+        if (w25qxx_ring_reap(&gs_ring, &cqe) == 0)
+        {
+            *res = cqe.res;
+            
+            return 0;
+        }
+        w25qxx_interface_delay_us(1000);
+    }
+    w25qxx_interface_debug_print("w25qxx: ring erase timeout.\n");
+    
+    return 1;
+}
+
+#endif
+
+/**
+ * @brief     erase map test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      W25QXX_ENABLE_ERASE_MAP must be 1
+ */
+uint8_t w25qxx_erase_map_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    uint8_t res;
+    uint8_t status;
+    uint32_t i;
+    uint32_t base;
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, a_w25qxx_erase_map_test_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    
+    /* set chip type */
+    res = w25qxx_set_type(&gs_handle, type);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set type failed.\n");
+       
+        return 1;
+    }
+    
+    /* set chip interface */
+    res = w25qxx_set_interface(&gs_handle, interface);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set interface failed.\n");
+       
+        return 1;
+    }
+    
+    /* set dual quad spi */
+    res = w25qxx_set_dual_quad_spi(&gs_handle, dual_quad_spi_enable);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set dual quad spi failed.\n");
+       
+        return 1;
+    }
+    
+    /* chip init */
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    
+    /* start erase map test */
+    w25qxx_interface_debug_print("w25qxx: start erase map test.\n");
+    base = W25QXX_ERASE_MAP_TEST_FIRST * 4096;
+    for (i = 0; i < 4096; i++)
+    {
+        gs_buffer[i] = rand() % 256;
+    }
+    
+    /* erase the mapped sectors before the map is linked */
+    for (i = 0; i < W25QXX_ERASE_MAP_TEST_SECTORS; i++)
+    {
+        res = w25qxx_sector_erase_4k(&gs_handle, base + i * 4096);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: sector erase 4k failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    
+    /* write the first half of sector 0 and the last byte of sector 1 */
+    for (i = 0; i < 2048; i += 256)
+    {
+        res = w25qxx_page_program(&gs_handle, base + i, &gs_buffer[i], 256);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: page program failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    memset(gs_check, 0xFF, 256);
+    gs_check[255] = 0x00;
+    res = w25qxx_page_program(&gs_handle, base + 4096 + 3840, gs_check, 256);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: page program failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* a new map knows nothing */
+    w25qxx_interface_debug_print("w25qxx: scan the chip.\n");
+    res = w25qxx_erase_map_init(&gs_handle, gs_map, W25QXX_ERASE_MAP_TEST_FIRST, 
+                                W25QXX_ERASE_MAP_TEST_SECTORS, W25QXX_BOOL_FALSE);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: erase map init failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    for (i = 0; i < W25QXX_ERASE_MAP_TEST_SECTORS; i++)
+    {
+        if (a_w25qxx_erase_map_test_check(i, 4096) != 0)
+        {
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    
+    /* the scan finds the erased tails */
+    res = w25qxx_erase_map_scan(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: erase map scan failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if ((a_w25qxx_erase_map_test_check(0, 2048) != 0) || (a_w25qxx_erase_map_test_check(1, 4096) != 0))
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    for (i = 2; i < W25QXX_ERASE_MAP_TEST_SECTORS; i++)
+    {
+        if (a_w25qxx_erase_map_test_check(i, 0) != 0)
+        {
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    
+    /* a write into the erased tail programs without a read back */
+    w25qxx_interface_debug_print("w25qxx: write the erased tail.\n");
+    if ((a_w25qxx_erase_map_test_write(base + 2048, &gs_buffer[2048], 256, W25QXX_BOOL_FALSE) != 0) ||
+        (a_w25qxx_erase_map_test_check(0, 2304) != 0))
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if ((w25qxx_read(&gs_handle, base, gs_check, 2304) != 0) || (memcmp(gs_check, gs_buffer, 2304) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: head check failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* erase sector 1 behind the back of the map */
+    w25qxx_interface_debug_print("w25qxx: declare an erased sector.\n");
+    res = w25qxx_erase_map_init(&gs_handle, NULL, 0, 0, W25QXX_BOOL_FALSE);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: erase map init failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    res = w25qxx_sector_erase_4k(&gs_handle, base + 4096);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: sector erase 4k failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    res = w25qxx_erase_map_init(&gs_handle, gs_map, W25QXX_ERASE_MAP_TEST_FIRST, 
+                                W25QXX_ERASE_MAP_TEST_SECTORS, W25QXX_BOOL_TRUE);
+    if ((res != 0) || (a_w25qxx_erase_map_test_check(1, 4096) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: erase map keep failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* the declared sector is programmed without a read back */
+    res = w25qxx_erase_map_declare(&gs_handle, base + 4096, 4096, W25QXX_BOOL_TRUE);
+    if ((res != 0) || (a_w25qxx_erase_map_test_check(1, 0) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: erase map declare failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if ((a_w25qxx_erase_map_test_write(base + 4096, gs_buffer, 256, W25QXX_BOOL_FALSE) != 0) ||
+        (a_w25qxx_erase_map_test_check(1, 256) != 0))
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* a dirty declared sector is read back again */
+    w25qxx_interface_debug_print("w25qxx: declare a dirty sector.\n");
+    res = w25qxx_erase_map_declare(&gs_handle, base + 2 * 4096 + 100, 1, W25QXX_BOOL_FALSE);
+    if ((res != 0) || (a_w25qxx_erase_map_test_check(2, 4096) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: erase map declare failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if ((a_w25qxx_erase_map_test_write(base + 2 * 4096, gs_buffer, 256, W25QXX_BOOL_TRUE) != 0) ||
+        (a_w25qxx_erase_map_test_check(2, 256) != 0))
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* use the second 64k block */
+    w25qxx_interface_debug_print("w25qxx: discard and step.\n");
+    for (i = 16; i < W25QXX_ERASE_MAP_TEST_SECTORS; i++)
+    {
+        if (a_w25qxx_erase_map_test_write(base + i * 4096, gs_buffer, 256, W25QXX_BOOL_FALSE) != 0)
+        {
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    if (a_w25qxx_erase_map_test_pool((4096 - 2304) + 2 * (4096 - 256) + 13 * 4096 + 16 * (4096 - 256), 0) != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* a partial sector is never discarded */
+    if ((w25qxx_discard(&gs_handle, base + 100, 4095) != 0) || 
+        (w25qxx_discard(&gs_handle, base + 100, W25QXX_ERASE_MAP_TEST_SECTORS * 4096 - 100) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: discard failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (a_w25qxx_erase_map_test_pool((4096 - 2304) + 13 * 4096, 18 * 4096) != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* two single sectors, then one 64k block, then nothing */
+    gs_erase = 0;
+    if ((a_w25qxx_erase_map_test_step(4096) != 0) ||
+        (a_w25qxx_erase_map_test_pool((4096 - 2304) + 14 * 4096, 17 * 4096) != 0) ||
+        (a_w25qxx_erase_map_test_step(4096) != 0) ||
+        (a_w25qxx_erase_map_test_pool((4096 - 2304) + 15 * 4096, 16 * 4096) != 0) ||
+        (a_w25qxx_erase_map_test_step(65536) != 0) ||
+        (a_w25qxx_erase_map_test_pool((4096 - 2304) + 31 * 4096, 0) != 0) ||
+        (a_w25qxx_erase_map_test_step(0) != 0))
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (gs_erase != 3)
+    {
+        w25qxx_interface_debug_print("w25qxx: discard sent %d erases.\n", gs_erase);
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (w25qxx_blank_check(&gs_handle, base + 4096, (W25QXX_ERASE_MAP_TEST_SECTORS - 1) * 4096) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: discarded sectors are not erased.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if ((w25qxx_read(&gs_handle, base, gs_check, 2304) != 0) || (memcmp(gs_check, gs_buffer, 2304) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: head check failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* the idle hook keeps to the largest erase it is given */
+    w25qxx_interface_debug_print("w25qxx: discard from the idle hook.\n");
+    for (i = 16; i < W25QXX_ERASE_MAP_TEST_SECTORS; i++)
+    {
+        if (a_w25qxx_erase_map_test_write(base + i * 4096, gs_buffer, 256, W25QXX_BOOL_FALSE) != 0)
+        {
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    if ((w25qxx_discard(&gs_handle, base + 16 * 4096, 16 * 4096) != 0) ||
+        (w25qxx_discard_idle(&gs_handle, 8192) != 4))
+    {
+        w25qxx_interface_debug_print("w25qxx: discard failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    gs_erase = 0;
+    for (i = 0; i < 17; i++)
+    {
+        if (w25qxx_discard_idle(&gs_handle, 4096) != 0)
+        {
+            w25qxx_interface_debug_print("w25qxx: discard idle failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    if ((gs_erase != 16) || (a_w25qxx_erase_map_test_pool((4096 - 2304) + 31 * 4096, 0) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: discard idle sent %d erases.\n", gs_erase);
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (w25qxx_blank_check(&gs_handle, base + 16 * 4096, 16 * 4096) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: discarded sectors are not erased.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* an erase that fails while it runs leaves the map alone */
+    w25qxx_interface_debug_print("w25qxx: fail an erase in flight.\n");
+    if ((a_w25qxx_erase_map_test_write(base + 3 * 4096, gs_buffer, 256, W25QXX_BOOL_FALSE) != 0) ||
+        (a_w25qxx_erase_map_test_check(3, 256) != 0))
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    gs_fail_status = 1;
+    res = a_w25qxx_erase_map_test_ring_erase(base + 3 * 4096, &status);
+    gs_fail_status = 0;
+    if ((res != 0) || (status == 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: ring erase did not fail.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    w25qxx_interface_delay_ms(400);
+    if (a_w25qxx_erase_map_test_check(3, 256) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: failed erase changed the map.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    res = a_w25qxx_erase_map_test_ring_erase(base + 3 * 4096, &status);
+    if ((res != 0) || (status != 0) || (a_w25qxx_erase_map_test_check(3, 0) != 0) ||
+        (w25qxx_blank_check(&gs_handle, base + 3 * 4096, 4096) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: ring erase failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* the out parameters are checked */
+    if ((w25qxx_discard_step(&gs_handle, NULL) != 2) || (w25qxx_discard_get_pool(&gs_handle, NULL, &i) != 2) ||
+        (w25qxx_discard_get_pool(&gs_handle, &i, NULL) != 2))
+    {
+        w25qxx_interface_debug_print("w25qxx: discard null check failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    (void)w25qxx_erase_map_init(&gs_handle, NULL, 0, 0, W25QXX_BOOL_FALSE);
+    
+    /* finish erase map test */
+    w25qxx_interface_debug_print("w25qxx: finish erase map test.\n");
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+#else
+    (void)type;
+    (void)interface;
+    (void)dual_quad_spi_enable;
+    w25qxx_interface_debug_print("w25qxx: erase map is disabled.\n");
+    
+    return 1;
+#endif
+}
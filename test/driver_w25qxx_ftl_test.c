@@ -0,0 +1,409 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_ftl_test.c
+ * @brief     driver w25qxx ftl test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_ftl_test.h"
+#include <stdlib.h>
+
+static w25qxx_handle_t gs_handle;                                                         /**< w25qxx handle */
+static w25qxx_ftl_t gs_ftl;                                                               /**< w25qxx ftl */
+static uint16_t gs_map[W25QXX_FTL_LOGICAL_PAGES(W25QXX_FTL_TEST_SECTORS)];                /**< ftl map */
+static w25qxx_ftl_sector_t gs_sector[W25QXX_FTL_TEST_SECTORS];                            /**< ftl sectors */
+static uint8_t gs_mirror[W25QXX_FTL_CAPACITY(W25QXX_FTL_TEST_SECTORS)];                   /**< expected content */
+static uint8_t gs_buffer[W25QXX_FTL_CAPACITY(W25QXX_FTL_TEST_SECTORS)];                   /**< read buffer */
+static int32_t gs_fail_program = -1;                                                      /**< programs before the injected failure, -1 is off */
+
+/**
+ * @brief      ftl test interface spi qspi bus write read with fault injection
+ * @param[in]  instruction is the sent instruction
+ * @param[in]  instruction_line is the instruction phy lines
+ * @param[in]  address is the register address
+ * @param[in]  address_line is the address phy lines
+ * @param[in]  address_len is the address length
+ * @param[in]  alternate is the register address
+ * @param[in]  alternate_line is the alternate phy lines
+ * @param[in]  alternate_len is the alternate length
+ * @param[in]  dummy is the dummy cycle
+ * @param[in]  *in_buf points to a input buffer
+ * @param[in]  in_len is the input length
+ * @param[out] *out_buf points to a output buffer
+ * @param[in]  out_len is the output length
+ * @param[in]  data_line is the data phy lines
+ * @return     status code
+ *             - 0 success
+ *             - 1 write read failed
+ * @note       the page program after gs_fail_program others fails without reaching the chip
+ */
+static uint8_t a_w25qxx_ftl_test_write_read(uint8_t instruction, uint8_t instruction_line,
+                                            uint32_t address, uint8_t address_line, uint8_t address_len,
+                                            uint32_t alternate, uint8_t alternate_line, uint8_t alternate_len,
+                                            uint8_t dummy, uint8_t *in_buf, uint32_t in_len,
+                                            uint8_t *out_buf, uint32_t out_len, uint8_t data_line)
+{
+    uint8_t cmd;
+    
+    cmd = (instruction_line != 0) ? instruction : ((in_len != 0) ? in_buf[0] : 0x00);
+    if ((gs_fail_program >= 0) && ((cmd == 0x02) || (cmd == 0x32)))
+    {
+        if (gs_fail_program == 0)
+        {
+            gs_fail_program = -1;
+            
+            return 1;
+        }
+        gs_fail_program--;
+    }
+    
+    return w25qxx_interface_spi_qspi_write_read(instruction, instruction_line, address, address_line, address_len,
+                                                alternate, alternate_line, alternate_len, dummy, in_buf, in_len,
+                                                out_buf, out_len, data_line);
+}
+
+/**
+ * @brief  ftl test check the whole logical space
+ * @return status code
+ *         - 0 success
+ *         - 1 check failed
+ * @note   none
+ */
+static uint8_t a_w25qxx_ftl_test_check(void)
+{
+    uint8_t res;
+    
+    res = w25qxx_ftl_read(&gs_ftl, 0, gs_buffer, sizeof(gs_buffer));
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: ftl read failed.\n");
+        
+        return 1;
+    }
+    if (memcmp(gs_buffer, gs_mirror, sizeof(gs_buffer)) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: ftl check failed.\n");
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  ftl test print the ftl info
+ * @return status code
+ *         - 0 success
+ *         - 1 print failed
+ * @note   none
+ */
+static uint8_t a_w25qxx_ftl_test_info(void)
+{
+    w25qxx_ftl_info_t info;
+    
+    if (w25qxx_ftl_get_info(&gs_ftl, &info) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: ftl get info failed.\n");
+        
+        return 1;
+    }
+    w25qxx_interface_debug_print("w25qxx: capacity %d, free sectors %d, erase count %d - %d, erases %d, write amplification %0.2f.\n",
+                                 info.capacity, info.free_sector, info.min_erase, info.max_erase,
+                                 info.erase, info.write_amplification);
+    
+    return 0;
+}
+
+/**
+ * @brief     ftl test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+uint8_t w25qxx_ftl_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    uint8_t res;
+    uint32_t i;
+    uint32_t addr;
+    uint32_t len;
+    uint32_t s;
+    uint32_t page;
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, a_w25qxx_ftl_test_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    
+    /* set chip type */
+    res = w25qxx_set_type(&gs_handle, type);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set type failed.\n");
+       
+        return 1;
+    }
+    
+    /* set chip interface */
+    res = w25qxx_set_interface(&gs_handle, interface);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set interface failed.\n");
+       
+        return 1;
+    }
+    
+    /* set dual quad spi */
+    res = w25qxx_set_dual_quad_spi(&gs_handle, dual_quad_spi_enable);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set dual quad spi failed.\n");
+       
+        return 1;
+    }
+    
+    /* chip init */
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    
+    /* start ftl test */
+    w25qxx_interface_debug_print("w25qxx: start ftl test.\n");
+    
+    /* the test region is reused, start from an erased one */
+    for (i = 0; i < W25QXX_FTL_TEST_SECTORS; i++)
+    {
+        res = w25qxx_sector_erase_4k(&gs_handle, i * 4096);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: sector erase 4k failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    
+    /* mount a blank region */
+    w25qxx_interface_debug_print("w25qxx: mount a blank region.\n");
+    res = w25qxx_ftl_mount(&gs_handle, &gs_ftl, gs_map, gs_sector, 0, W25QXX_FTL_TEST_SECTORS);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: ftl mount failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    memset(gs_mirror, 0xFF, sizeof(gs_mirror));
+    if (a_w25qxx_ftl_test_check() != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* fill the whole logical space */
+    w25qxx_interface_debug_print("w25qxx: fill the logical space.\n");
+    srand(0x5A5A);
+    for (i = 0; i < sizeof(gs_mirror); i++)
+    {
+        gs_mirror[i] = (uint8_t)(rand() % 256);
+    }
+    res = w25qxx_ftl_write(&gs_ftl, 0, gs_mirror, sizeof(gs_mirror));
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: ftl write failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (a_w25qxx_ftl_test_check() != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* small updates on a hot spot */
+    w25qxx_interface_debug_print("w25qxx: run %d small updates.\n", W25QXX_FTL_TEST_UPDATES);
+    for (i = 0; i < W25QXX_FTL_TEST_UPDATES; i++)
+    {
+        uint32_t j;
+        
+        len = (uint32_t)(rand() % 64) + 1;
+        if ((i % 8) == 0)
+        {
+            addr = (uint32_t)(rand() % (sizeof(gs_mirror) - len));
+        }
+        else
+        {
+            addr = (uint32_t)(rand() % (4096 - len));
+        }
+        for (j = 0; j < len; j++)
+        {
+            gs_buffer[j] = (uint8_t)(rand() % 256);
+        }
+        memcpy(&gs_mirror[addr], gs_buffer, len);
+        res = w25qxx_ftl_write(&gs_ftl, addr, gs_buffer, len);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: ftl write failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        if ((i % 16) == 0)
+        {
+            /* background gc */
+            while ((res = w25qxx_ftl_gc(&gs_ftl)) == 0)
+            {
+                
+            }
+            if (res != 6)
+            {
+                w25qxx_interface_debug_print("w25qxx: ftl gc failed.\n");
+                (void)w25qxx_deinit(&gs_handle);
+                
+                return 1;
+            }
+        }
+    }
+    if (a_w25qxx_ftl_test_check() != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (a_w25qxx_ftl_test_info() != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* a failed tag program retires the page */
+    w25qxx_interface_debug_print("w25qxx: inject a tag program failure.\n");
+    do
+    {
+        for (i = 0; i < 256; i++)
+        {
+            gs_mirror[i] = (uint8_t)(rand() % 256);
+        }
+        res = w25qxx_ftl_write(&gs_ftl, 0, gs_mirror, 256);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: ftl write failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    } while ((gs_ftl.open == gs_ftl.num) || (gs_ftl.open_page >= W25QXX_FTL_SECTOR_PAGES - 1));
+    s = gs_ftl.open;
+    page = gs_ftl.open_page;
+    for (i = 0; i < 256; i++)
+    {
+        gs_buffer[i] = (uint8_t)(rand() % 256);
+    }
+    gs_fail_program = 1;
+    res = w25qxx_ftl_write(&gs_ftl, 256, gs_buffer, 256);
+    if ((res != 1) || (gs_fail_program != -1) || (gs_ftl.open != s) || (gs_ftl.open_page != page + 1))
+    {
+        w25qxx_interface_debug_print("w25qxx: ftl failed page is not retired.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (a_w25qxx_ftl_test_check() != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    memcpy(&gs_mirror[256], gs_buffer, 256);
+    res = w25qxx_ftl_write(&gs_ftl, 256, gs_buffer, 256);
+    if ((res != 0) || (gs_map[1] != s * 16 + page + 1))
+    {
+        w25qxx_interface_debug_print("w25qxx: ftl write after the failure is not on a fresh page.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (a_w25qxx_ftl_test_check() != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* remount */
+    w25qxx_interface_debug_print("w25qxx: remount and check.\n");
+    (void)w25qxx_ftl_unmount(&gs_ftl);
+    memset(gs_map, 0, sizeof(gs_map));
+    memset(gs_sector, 0, sizeof(gs_sector));
+    res = w25qxx_ftl_mount(&gs_handle, &gs_ftl, gs_map, gs_sector, 0, W25QXX_FTL_TEST_SECTORS);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: ftl mount failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (a_w25qxx_ftl_test_check() != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (a_w25qxx_ftl_test_info() != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    (void)w25qxx_ftl_unmount(&gs_ftl);
+    
+    /* finish ftl test */
+    w25qxx_interface_debug_print("w25qxx: finish ftl test.\n");
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+}
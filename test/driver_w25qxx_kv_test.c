@@ -0,0 +1,296 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_kv_test.c
+ * @brief     driver w25qxx kv test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_kv_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static w25qxx_handle_t gs_handle;                                                  /**< w25qxx handle */
+static w25qxx_kv_t gs_kv;                                                          /**< w25qxx kv */
+static w25qxx_kv_entry_t gs_entry[W25QXX_KV_TEST_ENTRIES];                         /**< kv index */
+static w25qxx_kv_sector_t gs_sector[W25QXX_KV_TEST_SECTORS];                       /**< kv sectors */
+static uint8_t gs_value[W25QXX_KV_TEST_KEYS][W25QXX_KV_TEST_VALUE];                /**< expected values */
+static uint16_t gs_len[W25QXX_KV_TEST_KEYS];                                       /**< expected lengths */
+static uint8_t gs_present[W25QXX_KV_TEST_KEYS];                                    /**< key is present */
+
+/**
+ * @brief  kv test check all keys
+ * @return status code
+ *         - 0 success
+ *         - 1 check failed
+ * @note   none
+ */
+static uint8_t a_w25qxx_kv_test_check(void)
+{
+    uint8_t res;
+    uint32_t i;
+    uint32_t count;
+    char key[16];
+    uint8_t value[W25QXX_KV_TEST_VALUE];
+    uint16_t len;
+    w25qxx_kv_info_t info;
+    
+    count = 0;
+    for (i = 0; i < W25QXX_KV_TEST_KEYS; i++)
+    {
+        (void)snprintf(key, sizeof(key), "key%03d", (int)i);
+        len = sizeof(value);
+        res = w25qxx_kv_get(&gs_kv, key, value, &len);
+        if (gs_present[i] != 0)
+        {
+            if ((res != 0) || (len != gs_len[i]) || (memcmp(value, gs_value[i], len) != 0))
+            {
+                w25qxx_interface_debug_print("w25qxx: kv check %s failed.\n", key);
+                
+                return 1;
+            }
+            count++;
+        }
+        else if (res != 5)
+        {
+            w25qxx_interface_debug_print("w25qxx: kv check deleted %s failed.\n", key);
+            
+            return 1;
+        }
+        else
+        {
+            /* deleted */
+        }
+    }
+    if (w25qxx_kv_get_info(&gs_kv, &info) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: kv get info failed.\n");
+        
+        return 1;
+    }
+    if (info.count != count)
+    {
+        w25qxx_interface_debug_print("w25qxx: kv count %d is not %d.\n", info.count, count);
+        
+        return 1;
+    }
+    w25qxx_interface_debug_print("w25qxx: keys %d, free sectors %d, live %d, dead %d, compaction %d.\n",
+                                 info.count, info.free_sector, info.live, info.dead, info.compaction);
+    
+    return 0;
+}
+
+/**
+ * @brief     kv test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+uint8_t w25qxx_kv_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    uint8_t res;
+    uint32_t i;
+    uint32_t j;
+    uint32_t k;
+    char key[16];
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    
+    /* set chip type */
+    res = w25qxx_set_type(&gs_handle, type);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set type failed.\n");
+       
+        return 1;
+    }
+    
+    /* set chip interface */
+    res = w25qxx_set_interface(&gs_handle, interface);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set interface failed.\n");
+       
+        return 1;
+    }
+    
+    /* set dual quad spi */
+    res = w25qxx_set_dual_quad_spi(&gs_handle, dual_quad_spi_enable);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set dual quad spi failed.\n");
+       
+        return 1;
+    }
+    
+    /* chip init */
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    
+    /* start kv test */
+    w25qxx_interface_debug_print("w25qxx: start kv test.\n");
+    
+    /* the test region is reused, start from an erased one */
+    for (i = 0; i < W25QXX_KV_TEST_SECTORS; i++)
+    {
+        res = w25qxx_sector_erase_4k(&gs_handle, i * 4096);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: sector erase 4k failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    
+    /* mount a blank region */
+    w25qxx_interface_debug_print("w25qxx: mount a blank region.\n");
+    res = w25qxx_kv_mount(&gs_handle, &gs_kv, gs_entry, W25QXX_KV_TEST_ENTRIES, gs_sector, 0, W25QXX_KV_TEST_SECTORS);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: kv mount failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    memset(gs_present, 0, sizeof(gs_present));
+    
+    /* random put, delete and background compaction */
+    w25qxx_interface_debug_print("w25qxx: run %d random operations.\n", W25QXX_KV_TEST_TIMES);
+    srand(0x3C3C);
+    for (i = 0; i < W25QXX_KV_TEST_TIMES; i++)
+    {
+        k = (uint32_t)(rand() % W25QXX_KV_TEST_KEYS);
+        (void)snprintf(key, sizeof(key), "key%03d", (int)k);
+        if (((rand() % 10) == 0) && (gs_present[k] != 0))
+        {
+            res = w25qxx_kv_delete(&gs_kv, key);
+            gs_present[k] = 0;
+        }
+        else
+        {
+            gs_len[k] = (uint16_t)(rand() % W25QXX_KV_TEST_VALUE + 1);
+            for (j = 0; j < gs_len[k]; j++)
+            {
+                gs_value[k][j] = (uint8_t)(rand() % 256);
+            }
+            res = w25qxx_kv_put(&gs_kv, key, gs_value[k], gs_len[k]);
+            gs_present[k] = 1;
+        }
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: kv put or delete failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        if ((i % 64) == 0)
+        {
+            /* background compaction */
+            while ((res = w25qxx_kv_compact(&gs_kv)) == 0)
+            {
+                
+            }
+            if (res != 6)
+            {
+                w25qxx_interface_debug_print("w25qxx: kv compact failed.\n");
+                (void)w25qxx_deinit(&gs_handle);
+                
+                return 1;
+            }
+        }
+    }
+    if (a_w25qxx_kv_test_check() != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* remount */
+    w25qxx_interface_debug_print("w25qxx: remount and check.\n");
+    (void)w25qxx_kv_unmount(&gs_kv);
+#if (W25QXX_ENABLE_STATS == 1)
+    (void)w25qxx_clear_stats(&gs_handle);
+#endif
+    res = w25qxx_kv_mount(&gs_handle, &gs_kv, gs_entry, W25QXX_KV_TEST_ENTRIES, gs_sector, 0, W25QXX_KV_TEST_SECTORS);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: kv mount failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+#if (W25QXX_ENABLE_STATS == 1)
+    {
+        w25qxx_stats_t stats;
+        
+        /* the mount is one sequential pass */
+        (void)w25qxx_get_stats(&gs_handle, &stats);
+        if (stats.read_bytes != W25QXX_KV_TEST_SECTORS * 4096)
+        {
+            w25qxx_interface_debug_print("w25qxx: kv mount read %d bytes.\n", (uint32_t)stats.read_bytes);
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+#endif
+    if (a_w25qxx_kv_test_check() != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    (void)w25qxx_kv_unmount(&gs_kv);
+    
+    /* finish kv test */
+    w25qxx_interface_debug_print("w25qxx: finish kv test.\n");
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+}
@@ -0,0 +1,292 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_log_test.c
+ * @brief     driver w25qxx log test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_log_test.h"
+
+static w25qxx_handle_t gs_handle;                  /**< w25qxx handle */
+static w25qxx_log_t gs_log;                        /**< w25qxx log */
+static w25qxx_log_cursor_t gs_cursor;              /**< w25qxx log cursor */
+
+/**
+ * @brief      log test make a record
+ * @param[in]  index is the record index
+ * @param[out] *buf points to a record buffer
+ * @return     record length
+ * @note       none
+ */
+static uint16_t a_w25qxx_log_test_record(uint32_t index, uint8_t *buf)
+{
+    uint16_t len;
+    uint16_t j;
+    
+    len = (uint16_t)(4 + (index * 7) % 40);
+    buf[0] = (uint8_t)(index >> 0);
+    buf[1] = (uint8_t)(index >> 8);
+    buf[2] = (uint8_t)(index >> 16);
+    buf[3] = (uint8_t)(index >> 24);
+    for (j = 4; j < len; j++)
+    {
+        buf[j] = (uint8_t)(index + j);
+    }
+    
+    return len;
+}
+
+/**
+ * @brief     log test read back the whole ring
+ * @param[in] last is the expected last record index
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      the ring holds a contiguous run of the newest records
+ */
+static uint8_t a_w25qxx_log_test_check(uint32_t last)
+{
+    uint8_t res;
+    uint8_t buf[W25QXX_LOG_RECORD_MAX];
+    uint8_t expect[W25QXX_LOG_RECORD_MAX];
+    uint16_t len;
+    uint32_t index;
+    uint32_t next;
+    uint32_t count;
+    
+    if (w25qxx_log_rewind(&gs_log, &gs_cursor) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: log rewind failed.\n");
+        
+        return 1;
+    }
+    count = 0;
+    next = 0;
+    while (1)
+    {
+        len = sizeof(buf);
+        res = w25qxx_log_read(&gs_log, &gs_cursor, buf, &len);
+        if (res == 6)
+        {
+            break;
+        }
+        if (res != 0)
+        {
+            w25qxx_interface_debug_print("w25qxx: log read failed.\n");
+            
+            return 1;
+        }
+        index = (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+        if (((count != 0) && (index != next)) || (len != a_w25qxx_log_test_record(index, expect)) ||
+            (memcmp(buf, expect, len) != 0))
+        {
+            w25qxx_interface_debug_print("w25qxx: log record %d is wrong.\n", index);
+            
+            return 1;
+        }
+        next = index + 1;
+        count++;
+    }
+    if ((count == 0) || (next != last + 1))
+    {
+        w25qxx_interface_debug_print("w25qxx: log ends at %d, not %d.\n", next - 1, last);
+        
+        return 1;
+    }
+    w25qxx_interface_debug_print("w25qxx: log holds records %d - %d, %d pages programmed, %d sectors erased.\n",
+                                 next - count, last, gs_log.program, gs_log.erase);
+    
+    return 0;
+}
+
+/**
+ * @brief     log test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+uint8_t w25qxx_log_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    uint8_t res;
+    uint8_t buf[W25QXX_LOG_RECORD_MAX];
+    uint16_t len;
+    uint32_t i;
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    
+    /* set chip type */
+    res = w25qxx_set_type(&gs_handle, type);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set type failed.\n");
+       
+        return 1;
+    }
+    
+    /* set chip interface */
+    res = w25qxx_set_interface(&gs_handle, interface);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set interface failed.\n");
+       
+        return 1;
+    }
+    
+    /* set dual quad spi */
+    res = w25qxx_set_dual_quad_spi(&gs_handle, dual_quad_spi_enable);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set dual quad spi failed.\n");
+       
+        return 1;
+    }
+    
+    /* chip init */
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    
+    /* start log test */
+    w25qxx_interface_debug_print("w25qxx: start log test.\n");
+    
+    /* the test region is reused, start from an erased one */
+    for (i = 0; i < W25QXX_LOG_TEST_SECTORS; i++)
+    {
+        res = w25qxx_sector_erase_4k(&gs_handle, i * 4096);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: sector erase 4k failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    
+    /* append more records than the ring holds */
+    w25qxx_interface_debug_print("w25qxx: append %d records.\n", W25QXX_LOG_TEST_RECORDS);
+    res = w25qxx_log_mount(&gs_handle, &gs_log, 0, W25QXX_LOG_TEST_SECTORS);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: log mount failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    for (i = 0; i < W25QXX_LOG_TEST_RECORDS; i++)
+    {
+        len = a_w25qxx_log_test_record(i, buf);
+        res = w25qxx_log_append(&gs_log, buf, len);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: log append failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        if ((i % 100) == 0)
+        {
+            /* idle time */
+            (void)w25qxx_log_prepare(&gs_log);
+        }
+    }
+    res = w25qxx_log_flush(&gs_log);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: log flush failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (a_w25qxx_log_test_check(W25QXX_LOG_TEST_RECORDS - 1) != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* remount, check and append again */
+    w25qxx_interface_debug_print("w25qxx: remount, check and append.\n");
+    for (i = W25QXX_LOG_TEST_RECORDS; i < W25QXX_LOG_TEST_RECORDS + 16 * 40; i += 40)
+    {
+        uint32_t j;
+        
+        (void)w25qxx_log_unmount(&gs_log);
+        res = w25qxx_log_mount(&gs_handle, &gs_log, 0, W25QXX_LOG_TEST_SECTORS);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: log mount failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        if (a_w25qxx_log_test_check(i - 1) != 0)
+        {
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        for (j = i; j < i + 40; j++)
+        {
+            len = a_w25qxx_log_test_record(j, buf);
+            res = w25qxx_log_append(&gs_log, buf, len);
+            if (res)
+            {
+                w25qxx_interface_debug_print("w25qxx: log append failed.\n");
+                (void)w25qxx_deinit(&gs_handle);
+                
+                return 1;
+            }
+        }
+    }
+    (void)w25qxx_log_unmount(&gs_log);
+    
+    /* finish log test */
+    w25qxx_interface_debug_print("w25qxx: finish log test.\n");
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+}
@@ -36,11 +36,152 @@
 
 #include "driver_w25qxx_read_test.h"
 #include <stdlib.h>
+#include <string.h>
 
 static w25qxx_handle_t gs_handle;            /**< w25qxx handle */
 static uint8_t gs_buffer_input[600];         /**< input buffer */
 static uint8_t gs_buffer_output[600];        /**< output buffer */
 static const uint32_t gsc_size[] = {0x100000, 0x200000, 0x400000, 0x800000, 0x1000000, 0x2000000};        /**< flash size */
+static volatile uint32_t gs_erase_4k = 0;    /**< 4k sector erase commands */
+
+/**
+ * @brief      read test interface spi qspi bus write read with erase counting
+ * @param[in]  instruction is the sent instruction
+ * @param[in]  instruction_line is the instruction phy lines
+ * @param[in]  address is the register address
+ * @param[in]  address_line is the address phy lines
+ * @param[in]  address_len is the address length
+ * @param[in]  alternate is the register address
+ * @param[in]  alternate_line is the alternate phy lines
+ * @param[in]  alternate_len is the alternate length
+ * @param[in]  dummy is the dummy cycle
+ * @param[in]  *in_buf points to a input buffer
+ * @param[in]  in_len is the input length
+ * @param[out] *out_buf points to a output buffer
+ * @param[in]  out_len is the output length
+ * @param[in]  data_line is the data phy lines
+ * @return     status code
+ *             - 0 success
+ *             - 1 write read failed
+ * @note       every 4k sector erase command increments gs_erase_4k
+ */
+static uint8_t a_w25qxx_read_test_write_read(uint8_t instruction, uint8_t instruction_line,
+                                             uint32_t address, uint8_t address_line, uint8_t address_len,
+                                             uint32_t alternate, uint8_t alternate_line, uint8_t alternate_len,
+                                             uint8_t dummy, uint8_t *in_buf, uint32_t in_len,
+                                             uint8_t *out_buf, uint32_t out_len, uint8_t data_line)
+{
+    uint8_t cmd;
+    
+    cmd = (instruction_line != 0) ? instruction : ((in_len != 0) ? in_buf[0] : 0x00);
+    if (cmd == 0x20)
+    {
+        gs_erase_4k++;
+    }
+    
+    return w25qxx_interface_spi_qspi_write_read(instruction, instruction_line, address, address_line, address_len,
+                                                alternate, alternate_line, alternate_len, dummy, in_buf, in_len,
+                                                out_buf, out_len, data_line);
+}
+
+/**
+ * @brief  read test rewrite a page with and without an erase
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   a bit clearing rewrite must program in place, any 0 to 1 bit must erase once
+ */
+static uint8_t a_w25qxx_read_test_rewrite(void)
+{
+    uint8_t res;
+    uint32_t j;
+    uint32_t addr;
+    
+    addr = 4096;
+    res = w25qxx_sector_erase_4k(&gs_handle, addr);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: sector erase 4k failed.\n");
+        
+        return 1;
+    }
+    for (j = 0; j < 512; j++)
+    {
+        gs_buffer_input[j] = rand() % 256;
+    }
+    res = w25qxx_write(&gs_handle, addr, gs_buffer_input, 512);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: write failed.\n");
+        
+        return 1;
+    }
+    
+    /* clear bits of the first page only */
+    for (j = 0; j < 256; j++)
+    {
+        gs_buffer_input[j] &= rand() % 256;
+    }
+    gs_buffer_input[0] = 0x00;
+    gs_erase_4k = 0;
+    res = w25qxx_write(&gs_handle, addr, gs_buffer_input, 256);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: write failed.\n");
+        
+        return 1;
+    }
+    if (gs_erase_4k != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: bit clearing write erased the sector.\n");
+        
+        return 1;
+    }
+    res = w25qxx_read(&gs_handle, addr, gs_buffer_output, 512);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: read failed.\n");
+        
+        return 1;
+    }
+    if (memcmp(gs_buffer_input, gs_buffer_output, 512) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: bit clearing write check failed.\n");
+        
+        return 1;
+    }
+    
+    /* set a bit back to 1 */
+    gs_buffer_input[0] = 0x5A;
+    res = w25qxx_write(&gs_handle, addr, gs_buffer_input, 256);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: write failed.\n");
+        
+        return 1;
+    }
+    if (gs_erase_4k != 1)
+    {
+        w25qxx_interface_debug_print("w25qxx: bit setting write did not erase once.\n");
+        
+        return 1;
+    }
+    res = w25qxx_read(&gs_handle, addr, gs_buffer_output, 512);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: read failed.\n");
+        
+        return 1;
+    }
+    if (memcmp(gs_buffer_input, gs_buffer_output, 512) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: bit setting write check failed.\n");
+        
+        return 1;
+    }
+    
+    return 0;
+}
 
 /**
  * @brief     read test
@@ -61,7 +202,7 @@ uint8_t w25qxx_read_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qx
     DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
     DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
     DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
-    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, a_w25qxx_read_test_write_read);
     DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
     DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
     DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
@@ -128,6 +269,15 @@ uint8_t w25qxx_read_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qx
     /* start read test */
     w25qxx_interface_debug_print("w25qxx: start read test.\n");
     
+    /* w25qxx_write rewrite test */
+    w25qxx_interface_debug_print("w25qxx: w25qxx_write rewrite test.\n");
+    if (a_w25qxx_read_test_rewrite() != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
     if (interface == W25QXX_INTERFACE_SPI)
     {
         volatile uint32_t size;
@@ -185,6 +335,16 @@ uint8_t w25qxx_read_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qx
            
             return 1;
         }
+        
+        /* w25qxx_blank_check */
+        res = w25qxx_blank_check(&gs_handle, addr, 4096);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: blank check failed.\n");
+            w25qxx_deinit(&gs_handle);
+           
+            return 1;
+        }
         for (j = 0; j < 256; j++)
         {
             gs_buffer_input[j] = rand() %256;
@@ -199,6 +359,13 @@ uint8_t w25qxx_read_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qx
            
             return 1;
         }
+        if (w25qxx_blank_check(&gs_handle, addr, 4096) != 5)
+        {
+            w25qxx_interface_debug_print("w25qxx: blank check misses the programmed page.\n");
+            w25qxx_deinit(&gs_handle);
+           
+            return 1;
+        }
         
         /* w25qxx_only_spi_read */
         res = w25qxx_only_spi_read(&gs_handle, addr, gs_buffer_output, 256);
@@ -1027,6 +1194,16 @@ uint8_t w25qxx_read_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qx
            
             return 1;
         }
+        
+        /* w25qxx_blank_check */
+        res = w25qxx_blank_check(&gs_handle, addr, 4096);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: blank check failed.\n");
+            w25qxx_deinit(&gs_handle);
+           
+            return 1;
+        }
         for (j = 0; j < 256; j++)
         {
             gs_buffer_input[j] = rand() %256;
@@ -1041,6 +1218,13 @@ uint8_t w25qxx_read_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qx
            
             return 1;
         }
+        if (w25qxx_blank_check(&gs_handle, addr, 4096) != 5)
+        {
+            w25qxx_interface_debug_print("w25qxx: blank check misses the programmed page.\n");
+            w25qxx_deinit(&gs_handle);
+           
+            return 1;
+        }
         
         /* w25qxx_fast_read */
         res = w25qxx_fast_read(&gs_handle, addr, gs_buffer_output, 256);
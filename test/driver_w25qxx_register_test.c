@@ -176,6 +176,7 @@ uint8_t w25qxx_register_test(w25qxx_type_t type, w25qxx_interface_t interface, w
     }
     w25qxx_interface_debug_print("w25qxx: check chip type %s.\n", type_check == W25Q64 ? "ok" : "error");
     
+#if (W25QXX_CONFIG_MAX_TYPE >= 0xEF17)
     /* set type w25q128 */
     res = w25qxx_set_type(&gs_handle, W25Q128);
     if (res)
@@ -195,7 +196,9 @@ uint8_t w25qxx_register_test(w25qxx_type_t type, w25qxx_interface_t interface, w
         return 1;
     }
     w25qxx_interface_debug_print("w25qxx: check chip type %s.\n", type_check == W25Q128 ? "ok" : "error");
+#endif
 
+#if (W25QXX_CONFIG_MAX_TYPE >= 0xEF18)
     /* set type w25q256 */
     res = w25qxx_set_type(&gs_handle, W25Q256);
     if (res)
@@ -215,10 +218,12 @@ uint8_t w25qxx_register_test(w25qxx_type_t type, w25qxx_interface_t interface, w
         return 1;
     }
     w25qxx_interface_debug_print("w25qxx: check chip type %s.\n", type_check == W25Q256 ? "ok" : "error");
+#endif
     
     /* w25qxx_set_interface/w25qxx_get_interface test */
     w25qxx_interface_debug_print("w25qxx: w25qxx_set_interface/w25qxx_get_interface test.\n");
     
+#if ((W25QXX_CONFIG_INTERFACE & W25QXX_CONFIG_INTERFACE_SPI) != 0)
     /* set chip interface spi */
     res = w25qxx_set_interface(&gs_handle, W25QXX_INTERFACE_SPI);
     if (res)
@@ -238,7 +243,9 @@ uint8_t w25qxx_register_test(w25qxx_type_t type, w25qxx_interface_t interface, w
         return 1;
     }
     w25qxx_interface_debug_print("w25qxx: check chip interface %s.\n", interface_check == W25QXX_INTERFACE_SPI ? "ok" : "error");
+#endif
     
+#if ((W25QXX_CONFIG_INTERFACE & W25QXX_CONFIG_INTERFACE_QSPI) != 0)
     /* set chip interface qspi */
     res = w25qxx_set_interface(&gs_handle, W25QXX_INTERFACE_QSPI);
     if (res)
@@ -258,6 +265,7 @@ uint8_t w25qxx_register_test(w25qxx_type_t type, w25qxx_interface_t interface, w
         return 1;
     }
     w25qxx_interface_debug_print("w25qxx: check chip interface %s.\n", interface_check == W25QXX_INTERFACE_QSPI ? "ok" : "error");
+#endif
     
     /* set chip type */
     res = w25qxx_set_type(&gs_handle, type);
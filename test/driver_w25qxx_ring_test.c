@@ -0,0 +1,302 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_ring_test.c
+ * @brief     driver w25qxx ring test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_ring_test.h"
+#include <stdlib.h>
+
+static w25qxx_handle_t gs_handle;                                                 /**< w25qxx handle */
+static w25qxx_ring_t gs_ring;                                                     /**< w25qxx ring */
+static w25qxx_ring_sqe_t gs_sq[W25QXX_RING_TEST_ENTRIES];                         /**< submission entries */
+static w25qxx_ring_cqe_t gs_cq[W25QXX_RING_TEST_ENTRIES];                         /**< completion entries */
+static w25qxx_ring_sqe_t gs_ops[32];                                              /**< test operations */
+static uint8_t gs_res[32];                                                        /**< expected results */
+static uint8_t gs_page[16][256];                                                  /**< programmed pages */
+static uint8_t gs_buf[4096];                                                      /**< read buffer */
+static uint32_t gs_max_depth;                                                     /**< most queued operations */
+static uint32_t gs_calls;                                                         /**< worker calls */
+
+/**
+ * @brief     ring test add an operation
+ * @param[in] num is the operation index
+ * @param[in] op is the operation
+ * @param[in] addr is the flash address
+ * @param[in] *buf points to a data buffer
+ * @param[in] len is the length
+ * @param[in] res is the expected result
+ * @note      the tag is the operation index
+ */
+static void a_w25qxx_ring_test_add(uint32_t num, uint8_t op, uint32_t addr, uint8_t *buf, uint32_t len, uint8_t res)
+{
+    gs_ops[num].handle = &gs_handle;
+    gs_ops[num].op = op;
+    gs_ops[num].addr = addr;
+    gs_ops[num].buf = buf;
+    gs_ops[num].len = len;
+    gs_ops[num].user_data = num;
+    gs_res[num] = res;
+}
+
+/**
+ * @brief     ring test run the operations
+ * @param[in] first is the number of operations submitted before
+ * @param[in] num is the operation number
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      the caller submits and reaps and the worker runs in the same loop,
+ *            the completions must come in the submission order with the expected results
+ */
+static uint8_t a_w25qxx_ring_test_run(uint32_t first, uint32_t num)
+{
+    uint32_t submitted;
+    uint32_t reaped;
+    uint32_t loop;
+    w25qxx_ring_cqe_t cqe;
+    
+    submitted = first;
+    reaped = 0;
+    for (loop = 0; (reaped < num) && (loop < 1000000); loop++)
+    {
+        while ((submitted < num) && (w25qxx_ring_submit(&gs_ring, &gs_ops[submitted]) == 0))
+        {
+            submitted++;
+        }
+        if (submitted - reaped > gs_max_depth)
+        {
+            gs_max_depth = submitted - reaped;
+        }
+        if (w25qxx_ring_process(&gs_ring, NULL) != 0)
+        {
+            w25qxx_interface_debug_print("w25qxx: ring process failed.\n");
+            
+            return 1;
+        }
+        gs_calls++;
+        while (w25qxx_ring_reap(&gs_ring, &cqe) == 0)
+        {
+            if ((cqe.user_data != reaped) || (cqe.op != gs_ops[reaped].op) || (cqe.res != gs_res[reaped]))
+            {
+                w25qxx_interface_debug_print("w25qxx: completion %d has tag %d and result %d.\n", reaped, cqe.user_data, cqe.res);
+                
+                return 1;
+            }
+            reaped++;
+        }
+    }
+    if (reaped != num)
+    {
+        w25qxx_interface_debug_print("w25qxx: ring operations are lost.\n");
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     ring test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+uint8_t w25qxx_ring_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    uint8_t res;
+    uint32_t i;
+    uint32_t j;
+    uint32_t num;
+    uint32_t addr;
+    uint32_t inflight;
+    uint8_t data[100];
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    
+    /* set chip type */
+    res = w25qxx_set_type(&gs_handle, type);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set type failed.\n");
+       
+        return 1;
+    }
+    
+    /* set chip interface */
+    res = w25qxx_set_interface(&gs_handle, interface);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set interface failed.\n");
+       
+        return 1;
+    }
+    
+    /* set dual quad spi */
+    res = w25qxx_set_dual_quad_spi(&gs_handle, dual_quad_spi_enable);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set dual quad spi failed.\n");
+       
+        return 1;
+    }
+    
+    /* chip init */
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    
+    /* start ring test */
+    w25qxx_interface_debug_print("w25qxx: start ring test.\n");
+    
+    /* ring init */
+    if (w25qxx_ring_init(&gs_ring, gs_sq, 6, gs_cq, W25QXX_RING_TEST_ENTRIES) != 4)
+    {
+        w25qxx_interface_debug_print("w25qxx: ring accepts 6 entries.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    res = w25qxx_ring_init(&gs_ring, gs_sq, W25QXX_RING_TEST_ENTRIES, gs_cq, W25QXX_RING_TEST_ENTRIES);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: ring init failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    addr = (type == W25Q256) ? 0x1000000 : 0x10000;
+    gs_max_depth = 0;
+    gs_calls = 0;
+    
+    /* the worker must not wait for an erase */
+    w25qxx_interface_debug_print("w25qxx: erase without waiting.\n");
+    a_w25qxx_ring_test_add(0, W25QXX_RING_OP_ERASE, addr, NULL, 4096, 0);
+    (void)w25qxx_ring_submit(&gs_ring, &gs_ops[0]);
+    (void)w25qxx_ring_process(&gs_ring, NULL);
+    (void)w25qxx_ring_get_inflight(&gs_ring, &inflight);
+    if (inflight != 1)
+    {
+        w25qxx_interface_debug_print("w25qxx: the erase is not in flight.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* program a sector through the rings */
+    w25qxx_interface_debug_print("w25qxx: program 16 pages, flush and read back.\n");
+    for (i = 0; i < 16; i++)
+    {
+        for (j = 0; j < 256; j++)
+        {
+            gs_page[i][j] = (uint8_t)(rand() % 256);
+        }
+        a_w25qxx_ring_test_add(1 + i, W25QXX_RING_OP_PROGRAM, addr + i * 256, gs_page[i], 256, 0);
+    }
+    a_w25qxx_ring_test_add(17, W25QXX_RING_OP_FLUSH, 0, NULL, 0, 0);
+    gs_ops[17].handle = NULL;
+    a_w25qxx_ring_test_add(18, W25QXX_RING_OP_READ, addr, gs_buf, 4096, 0);
+    num = 19;
+    
+    /* the erase completes as tag 0 */
+    res = a_w25qxx_ring_test_run(1, num);
+    if (res)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    for (i = 0; i < 4096; i++)
+    {
+        if (gs_buf[i] != gs_page[i / 256][i % 256])
+        {
+            w25qxx_interface_debug_print("w25qxx: check error.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    w25qxx_interface_debug_print("w25qxx: check ok.\n");
+    
+    /* read modify write and invalid submissions */
+    w25qxx_interface_debug_print("w25qxx: write, read back and reject invalid submissions.\n");
+    for (i = 0; i < 100; i++)
+    {
+        data[i] = (uint8_t)(i * 3);
+    }
+    a_w25qxx_ring_test_add(0, W25QXX_RING_OP_WRITE, addr + 1000, data, 100, 0);
+    a_w25qxx_ring_test_add(1, W25QXX_RING_OP_READ, addr, gs_buf, 4096, 0);
+    a_w25qxx_ring_test_add(2, W25QXX_RING_OP_PROGRAM, addr + 200, data, 100, 4);
+    a_w25qxx_ring_test_add(3, W25QXX_RING_OP_ERASE, addr, NULL, 1000, 4);
+    a_w25qxx_ring_test_add(4, 0x55, addr, NULL, 0, 4);
+    res = a_w25qxx_ring_test_run(0, 5);
+    if (res)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    for (i = 0; i < 4096; i++)
+    {
+        if (gs_buf[i] != (((i >= 1000) && (i < 1100)) ? data[i - 1000] : gs_page[i / 256][i % 256]))
+        {
+            w25qxx_interface_debug_print("w25qxx: check error.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    w25qxx_interface_debug_print("w25qxx: check ok.\n");
+    w25qxx_interface_debug_print("w25qxx: %d operations, max queue depth %d, %d worker calls.\n", num + 5, gs_max_depth, gs_calls);
+    
+    /* finish ring test */
+    w25qxx_interface_debug_print("w25qxx: finish ring test.\n");
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+}
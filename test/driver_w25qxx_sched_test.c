@@ -0,0 +1,318 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_sched_test.c
+ * @brief     driver w25qxx sched test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_sched_test.h"
+#include <stdlib.h>
+
+static w25qxx_handle_t gs_handle;                                                 /**< w25qxx handle */
+static w25qxx_sched_t gs_sched;                                                   /**< w25qxx scheduler */
+static w25qxx_sched_req_t gs_req[W25QXX_SCHED_TEST_REQUESTS];                     /**< request array */
+static uint8_t gs_pool[4096];                                                     /**< write data pool */
+static uint8_t gs_buf[4096];                                                      /**< scheduler buffer */
+static uint8_t gs_shadow[4 * 4096];                                               /**< expected content */
+static uint8_t gs_read[4 * 4096];                                                 /**< read buffer */
+
+/**
+ * @brief     sched test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+uint8_t w25qxx_sched_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    uint8_t res;
+    uint32_t i;
+    uint32_t j;
+    uint32_t off;
+    uint32_t len;
+    uint32_t base;
+    uint8_t data[64];
+    w25qxx_sched_stats_t stats;
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    
+    /* set chip type */
+    res = w25qxx_set_type(&gs_handle, type);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set type failed.\n");
+       
+        return 1;
+    }
+    
+    /* set chip interface */
+    res = w25qxx_set_interface(&gs_handle, interface);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set interface failed.\n");
+       
+        return 1;
+    }
+    
+    /* set dual quad spi */
+    res = w25qxx_set_dual_quad_spi(&gs_handle, dual_quad_spi_enable);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set dual quad spi failed.\n");
+       
+        return 1;
+    }
+    
+    /* chip init */
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    
+    /* start sched test */
+    w25qxx_interface_debug_print("w25qxx: start sched test.\n");
+    
+    /* sched init */
+    res = w25qxx_sched_init(&gs_sched, &gs_handle, gs_req, W25QXX_SCHED_TEST_REQUESTS, 
+                            gs_pool, sizeof(gs_pool), gs_buf, W25QXX_SCHED_TEST_WINDOW);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: sched init failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* on the W25Q256 the four sectors straddle the 16MB bank boundary */
+    base = (type == W25Q256) ? (0x1000000 - 2 * 4096) : 0x30000;
+    res = w25qxx_read(&gs_handle, base, gs_shadow, sizeof(gs_shadow));
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: read failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* scattered writes and adjacent reads */
+    w25qxx_interface_debug_print("w25qxx: queue 48 scattered writes and 32 adjacent reads.\n");
+    for (i = 0; i < 48; i++)
+    {
+        off = ((i * 3) % 4) * 4096 + (i * 37 * 16) % 4000;
+        len = 16 + i % 32;
+        for (j = 0; j < len; j++)
+        {
+            data[j] = (uint8_t)(rand() % 256);
+        }
+        memcpy(&gs_shadow[off], data, len);
+        res = w25qxx_sched_write(&gs_sched, base + off, data, len);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: sched write failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    for (i = 0; i < 16; i++)
+    {
+        /* queued in the reverse order, the scheduler sorts them */
+        off = 1024 + (15 - i) * 64;
+        (void)w25qxx_sched_read(&gs_sched, base + off, &gs_read[off], 64);
+        off = 3 * 4096 + 1024 + (15 - i) * 64;
+        (void)w25qxx_sched_read(&gs_sched, base + off, &gs_read[off], 64);
+    }
+    
+    /* the window */
+    (void)w25qxx_sched_poll(&gs_sched, W25QXX_SCHED_TEST_WINDOW - 1);
+    (void)w25qxx_sched_get_stats(&gs_sched, &stats);
+    if (stats.flushes != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: flushed inside the window.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    res = w25qxx_sched_poll(&gs_sched, 1);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: sched poll failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    (void)w25qxx_sched_get_stats(&gs_sched, &stats);
+    if ((stats.flushes != 1) || (stats.sector_writes != 4) || (stats.read_transactions != 2) ||
+        (stats.bank_switches != ((type == W25Q256) ? 1 : 0)))
+    {
+        w25qxx_interface_debug_print("w25qxx: %d flushes, %d sector writes, %d read transactions, %d bank switches.\n",
+                                     stats.flushes, stats.sector_writes, stats.read_transactions, stats.bank_switches);
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    w25qxx_interface_debug_print("w25qxx: %d writes in %d sector writes, merge ratio %0.2f.\n",
+                                 stats.writes, stats.sector_writes, (double)stats.writes / (double)stats.sector_writes);
+    w25qxx_interface_debug_print("w25qxx: %d reads in %d transactions, %d bank switches.\n",
+                                 stats.reads, stats.read_transactions, stats.bank_switches);
+    
+    /* check the data */
+    for (i = 0; i < 16 * 64; i++)
+    {
+        if ((gs_read[1024 + i] != gs_shadow[1024 + i]) || (gs_read[3 * 4096 + 1024 + i] != gs_shadow[3 * 4096 + 1024 + i]))
+        {
+            w25qxx_interface_debug_print("w25qxx: queued read check error.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    res = w25qxx_read(&gs_handle, base, gs_read, sizeof(gs_read));
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: read failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (memcmp(gs_read, gs_shadow, sizeof(gs_shadow)) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: check error.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    w25qxx_interface_debug_print("w25qxx: check ok.\n");
+    
+    /* a read queued before a write sees the old data */
+    w25qxx_interface_debug_print("w25qxx: keep a read in front of a later write.\n");
+    memset(data, 0x5A, 64);
+    (void)w25qxx_sched_read(&gs_sched, base + 2048, gs_read, 64);
+    (void)w25qxx_sched_write(&gs_sched, base + 2048, data, 64);
+    res = w25qxx_sched_flush(&gs_sched);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: sched flush failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (memcmp(gs_read, &gs_shadow[2048], 64) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: the read saw the later write.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    res = w25qxx_read(&gs_handle, base + 2048, gs_read, 64);
+    if ((res != 0) || (memcmp(gs_read, data, 64) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: check error.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    w25qxx_interface_debug_print("w25qxx: check ok.\n");
+    
+    /* a read across the 16MB bank boundary is split into both banks */
+    if (type == W25Q256)
+    {
+        w25qxx_interface_debug_print("w25qxx: read across the bank boundary from 0xFFFF00 to 0x1000100.\n");
+        res = w25qxx_read(&gs_handle, 0xFFFE00, gs_shadow, 1024);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: read failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        memset(gs_read, 0, 1024);
+        (void)w25qxx_sched_read(&gs_sched, 0x1000100, &gs_read[768], 256);
+        (void)w25qxx_sched_read(&gs_sched, 0xFFFF00, &gs_read[256], 512);
+        (void)w25qxx_sched_read(&gs_sched, 0xFFFE00, &gs_read[0], 256);
+        if (gs_sched.req_num != 4)
+        {
+            w25qxx_interface_debug_print("w25qxx: %d requests were queued, not 4.\n", gs_sched.req_num);
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        for (i = 0; i < gs_sched.req_num; i++)
+        {
+            if ((gs_req[i].addr >> 24) != ((gs_req[i].addr + gs_req[i].len - 1) >> 24))
+            {
+                w25qxx_interface_debug_print("w25qxx: a queued read crosses the bank boundary.\n");
+                (void)w25qxx_deinit(&gs_handle);
+                
+                return 1;
+            }
+        }
+        (void)w25qxx_sched_get_stats(&gs_sched, &stats);
+        j = stats.read_transactions;
+        res = w25qxx_sched_flush(&gs_sched);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: sched flush failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        (void)w25qxx_sched_get_stats(&gs_sched, &stats);
+        if ((stats.read_transactions - j != 2) || (memcmp(gs_read, gs_shadow, 1024) != 0))
+        {
+            w25qxx_interface_debug_print("w25qxx: %d read transactions, check error.\n", stats.read_transactions - j);
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        w25qxx_interface_debug_print("w25qxx: check ok.\n");
+    }
+    
+    /* finish sched test */
+    w25qxx_interface_debug_print("w25qxx: finish sched test.\n");
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+}
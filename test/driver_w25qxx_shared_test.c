@@ -0,0 +1,578 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_shared_test.c
+ * @brief     driver w25qxx shared test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_shared_test.h"
+
+static w25qxx_handle_t gs_handle;                                                              /**< w25qxx handle */
+static w25qxx_shared_t gs_shared;                                                              /**< w25qxx shared front end */
+static uint32_t gs_base;                                                                       /**< test region */
+static volatile uint8_t gs_order[W25QXX_SHARED_CLASS_MAX];                                     /**< served classes */
+static volatile uint32_t gs_order_num;                                                         /**< served number */
+static volatile uint8_t gs_stop;                                                               /**< stop the readers */
+static uint32_t gs_reads[W25QXX_SHARED_TEST_THREADS];                                          /**< reads of every reader */
+static uint8_t gs_result[W25QXX_SHARED_TEST_THREADS * W25QXX_SHARED_CLASS_MAX];                /**< thread results */
+static uint8_t gs_buf[W25QXX_SHARED_TEST_THREADS * W25QXX_SHARED_CLASS_MAX][4096];             /**< thread buffers */
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+static uint16_t gs_map[W25QXX_SHARED_TEST_DISCARD];                                            /**< erase map */
+#endif
+static const uint32_t gsc_size[] = {0x100000, 0x200000, 0x400000, 0x800000, 0x1000000, 0x2000000};        /**< flash size */
+
+/**
+ * @brief     shared test wait for the statistics
+ * @param[in] cls is the request class
+ * @param[in] depth is the waited depth
+ * @param[in] requests is the waited served number
+ * @note      none
+ */
+static void a_w25qxx_shared_test_wait(w25qxx_shared_class_t cls, uint32_t depth, uint32_t requests)
+{
+    w25qxx_shared_stats_t stats;
+    
+    do
+    {
+        (void)w25qxx_shared_get_stats(&gs_shared, cls, &stats);
+    } while ((stats.depth < depth) || (stats.requests < requests));
+}
+
+/**
+ * @brief     shared test priority thread
+ * @param[in] index is the thread index
+ * @note      thread 0 holds the chip until one request of every class waits
+ */
+static void a_w25qxx_shared_test_priority(uint32_t index)
+{
+    w25qxx_shared_class_t cls;
+    
+    if (index == 0)
+    {
+        (void)w25qxx_shared_lock(&gs_shared, W25QXX_SHARED_CLASS_ERASE);
+        a_w25qxx_shared_test_wait(W25QXX_SHARED_CLASS_READ, 1, 0);
+        a_w25qxx_shared_test_wait(W25QXX_SHARED_CLASS_WRITE, 1, 0);
+        a_w25qxx_shared_test_wait(W25QXX_SHARED_CLASS_ERASE, 1, 1);
+        (void)w25qxx_shared_unlock(&gs_shared);
+        
+        return;
+    }
+    
+    /* queue in the reverse order of the priority */
+    cls = (w25qxx_shared_class_t)(W25QXX_SHARED_CLASS_MAX - index);
+    a_w25qxx_shared_test_wait(W25QXX_SHARED_CLASS_ERASE, 0, 1);
+    (void)w25qxx_shared_lock(&gs_shared, cls);
+    gs_order[gs_order_num++] = (uint8_t)cls;
+    (void)w25qxx_shared_unlock(&gs_shared);
+}
+
+/**
+ * @brief     shared test load thread
+ * @param[in] index is the thread index
+ * @note      readers check the reference sector, writers and erasers own one sector each
+ */
+static void a_w25qxx_shared_test_load(uint32_t index)
+{
+    uint32_t cls;
+    uint32_t sector;
+    uint32_t i;
+    uint32_t j;
+    uint8_t *buf;
+    
+    cls = index / W25QXX_SHARED_TEST_THREADS;
+    buf = gs_buf[index];
+    sector = gs_base + (1 + index) * 4096;
+    gs_result[index] = 0;
+    for (i = 0; (i < W25QXX_SHARED_TEST_ROUNDS) && (gs_result[index] == 0); i++)
+    {
+        if (cls == W25QXX_SHARED_CLASS_READ)
+        {
+            if (w25qxx_shared_read(&gs_shared, gs_base, buf, 4096) != 0)
+            {
+                gs_result[index] = 1;
+            }
+            for (j = 0; j < 4096; j++)
+            {
+                if (buf[j] != (uint8_t)(j * 7))
+                {
+                    gs_result[index] = 1;
+                    
+                    break;
+                }
+            }
+        }
+        else if (cls == W25QXX_SHARED_CLASS_WRITE)
+        {
+            for (j = 0; j < 4096; j++)
+            {
+                buf[j] = (uint8_t)(j + index + i * 13);
+            }
+            if (w25qxx_shared_write(&gs_shared, sector, buf, 4096) != 0)
+            {
+                gs_result[index] = 1;
+            }
+            if (w25qxx_shared_read(&gs_shared, sector, buf, 4096) != 0)
+            {
+                gs_result[index] = 1;
+            }
+            for (j = 0; j < 4096; j++)
+            {
+                if (buf[j] != (uint8_t)(j + index + i * 13))
+                {
+                    gs_result[index] = 1;
+                    
+                    break;
+                }
+            }
+        }
+        else
+        {
+            if (w25qxx_shared_erase(&gs_shared, sector, 4096) != 0)
+            {
+                gs_result[index] = 1;
+            }
+            if (w25qxx_shared_read(&gs_shared, sector, buf, 4096) != 0)
+            {
+                gs_result[index] = 1;
+            }
+            for (j = 0; j < 4096; j++)
+            {
+                if (buf[j] != 0xFF)
+                {
+                    gs_result[index] = 1;
+                    
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief     shared test aging thread
+ * @param[in] index is the thread index
+ * @note      the readers read without a pause until the last thread finished its erase
+ */
+static void a_w25qxx_shared_test_aging(uint32_t index)
+{
+    uint32_t j;
+    uint8_t *buf;
+    
+    buf = gs_buf[index];
+    gs_result[index] = 0;
+    if (index == W25QXX_SHARED_TEST_THREADS)
+    {
+        a_w25qxx_shared_test_wait(W25QXX_SHARED_CLASS_READ, 0, W25QXX_SHARED_TEST_THREADS * W25QXX_SHARED_TEST_ROUNDS);
+        if (w25qxx_shared_erase(&gs_shared, gs_base + 4096, 4096) != 0)
+        {
+            gs_result[index] = 1;
+        }
+        gs_stop = 1;
+        
+        return;
+    }
+    for (gs_reads[index] = 0; (gs_stop == 0) && (gs_result[index] == 0); gs_reads[index]++)
+    {
+        if (gs_reads[index] >= W25QXX_SHARED_TEST_STARVE)
+        {
+            gs_result[index] = 1;
+            
+            break;
+        }
+        if (w25qxx_shared_read(&gs_shared, gs_base, buf, 4096) != 0)
+        {
+            gs_result[index] = 1;
+        }
+        for (j = 0; j < 4096; j++)
+        {
+            if (buf[j] != (uint8_t)(j * 7))
+            {
+                gs_result[index] = 1;
+                
+                break;
+            }
+        }
+    }
+}
+
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+/**
+ * @brief     shared test discard thread
+ * @param[in] index is the thread index
+ * @note      thread 0 discards the region first, then every thread checks the reference sector
+ */
+static void a_w25qxx_shared_test_discard(uint32_t index)
+{
+    uint32_t i;
+    uint32_t j;
+    uint8_t *buf;
+    
+    buf = gs_buf[index];
+    gs_result[index] = 0;
+    if (index == 0)
+    {
+        if (w25qxx_shared_discard(&gs_shared, gs_base + 0x10000, W25QXX_SHARED_TEST_DISCARD * 4096) != 0)
+        {
+            gs_result[index] = 1;
+        }
+    }
+    for (i = 0; (i < W25QXX_SHARED_TEST_ROUNDS) && (gs_result[index] == 0); i++)
+    {
+        if (w25qxx_shared_read(&gs_shared, gs_base, buf, 4096) != 0)
+        {
+            gs_result[index] = 1;
+        }
+        for (j = 0; j < 4096; j++)
+        {
+            if (buf[j] != (uint8_t)(j * 7))
+            {
+                gs_result[index] = 1;
+                
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief      shared test get the pool
+ * @param[out] *pool points to a known erased bytes buffer
+ * @param[out] *backlog points to a discarded bytes buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 get failed
+ * @note       queues in the erase class behind the worker steps
+ */
+static uint8_t a_w25qxx_shared_test_pool(uint32_t *pool, uint32_t *backlog)
+{
+    uint8_t res;
+    
+    if (w25qxx_shared_lock(&gs_shared, W25QXX_SHARED_CLASS_ERASE) != 0)
+    {
+        return 1;
+    }
+    res = w25qxx_discard_get_pool(&gs_handle, pool, backlog);
+    (void)w25qxx_shared_unlock(&gs_shared);
+    
+    return (res != 0) ? 1 : 0;
+}
+#endif
+
+/**
+ * @brief     shared test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+uint8_t w25qxx_shared_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    uint8_t res;
+    uint32_t i;
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    uint32_t j;
+    uint32_t pool;
+    uint32_t backlog;
+#endif
+    w25qxx_shared_stats_t stats;
+    const char *name[W25QXX_SHARED_CLASS_MAX] = {"read", "write", "erase"};
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    
+    /* set chip type */
+    res = w25qxx_set_type(&gs_handle, type);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set type failed.\n");
+       
+        return 1;
+    }
+    
+    /* set chip interface */
+    res = w25qxx_set_interface(&gs_handle, interface);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set interface failed.\n");
+       
+        return 1;
+    }
+    
+    /* set dual quad spi */
+    res = w25qxx_set_dual_quad_spi(&gs_handle, dual_quad_spi_enable);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set dual quad spi failed.\n");
+       
+        return 1;
+    }
+    
+    /* chip init */
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    
+    /* start shared test */
+    w25qxx_interface_debug_print("w25qxx: start shared test.\n");
+    
+    /* link the shared hooks */
+    DRIVER_W25QXX_SHARED_LINK_INIT(&gs_shared);
+    DRIVER_W25QXX_SHARED_LINK_MUTEX_LOCK(&gs_shared, w25qxx_shared_test_interface_mutex_lock);
+    DRIVER_W25QXX_SHARED_LINK_MUTEX_UNLOCK(&gs_shared, w25qxx_shared_test_interface_mutex_unlock);
+    DRIVER_W25QXX_SHARED_LINK_COND_WAIT(&gs_shared, w25qxx_shared_test_interface_cond_wait);
+    DRIVER_W25QXX_SHARED_LINK_COND_BROADCAST(&gs_shared, w25qxx_shared_test_interface_cond_broadcast);
+    DRIVER_W25QXX_SHARED_LINK_TIMESTAMP_US(&gs_shared, w25qxx_shared_test_interface_timestamp_us);
+    res = w25qxx_shared_init(&gs_shared, &gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: shared init failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* the class order */
+    w25qxx_interface_debug_print("w25qxx: check the class order.\n");
+    gs_order_num = 0;
+    res = w25qxx_shared_test_interface_run(a_w25qxx_shared_test_priority, 1 + W25QXX_SHARED_CLASS_MAX);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: run threads failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    for (i = 0; i < W25QXX_SHARED_CLASS_MAX; i++)
+    {
+        if ((gs_order_num != W25QXX_SHARED_CLASS_MAX) || (gs_order[i] != i))
+        {
+            w25qxx_interface_debug_print("w25qxx: served out of the class order.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    w25qxx_interface_debug_print("w25qxx: read, write and erase were served in order.\n");
+    
+    /* concurrent load */
+    w25qxx_interface_debug_print("w25qxx: run %d threads of every class.\n", W25QXX_SHARED_TEST_THREADS);
+    gs_base = gsc_size[type - W25Q80] / 2;
+    for (i = 0; i < 4096; i++)
+    {
+        gs_buf[0][i] = (uint8_t)(i * 7);
+    }
+    res = w25qxx_write(&gs_handle, gs_base, gs_buf[0], 4096);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: write failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    (void)w25qxx_shared_clear_stats(&gs_shared);
+    res = w25qxx_shared_test_interface_run(a_w25qxx_shared_test_load, W25QXX_SHARED_TEST_THREADS * W25QXX_SHARED_CLASS_MAX);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: run threads failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    for (i = 0; i < W25QXX_SHARED_TEST_THREADS * W25QXX_SHARED_CLASS_MAX; i++)
+    {
+        if (gs_result[i] != 0)
+        {
+            w25qxx_interface_debug_print("w25qxx: %s thread %d failed.\n", name[i / W25QXX_SHARED_TEST_THREADS], i);
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    for (i = 0; i < W25QXX_SHARED_CLASS_MAX; i++)
+    {
+        (void)w25qxx_shared_get_stats(&gs_shared, (w25qxx_shared_class_t)i, &stats);
+        w25qxx_interface_debug_print("w25qxx: %s requests %d max depth %d mean wait %dus max wait %dus.\n",
+                                     name[i], stats.requests, stats.max_depth,
+                                     (stats.requests != 0) ? (uint32_t)(stats.wait_us / stats.requests) : 0, stats.max_wait_us);
+    }
+    for (i = 0; i < W25QXX_SHARED_CLASS_MAX; i++)
+    {
+        (void)w25qxx_shared_get_stats(&gs_shared, (w25qxx_shared_class_t)i, &stats);
+        if (stats.requests != W25QXX_SHARED_TEST_THREADS * W25QXX_SHARED_TEST_ROUNDS * ((i == W25QXX_SHARED_CLASS_READ) ? 3 : 1))
+        {
+            w25qxx_interface_debug_print("w25qxx: %s requests are lost.\n", name[i]);
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    
+    /* an erase is not starved by continuous reads */
+    w25qxx_interface_debug_print("w25qxx: erase under continuous reads.\n");
+    (void)w25qxx_shared_clear_stats(&gs_shared);
+    gs_stop = 0;
+    res = w25qxx_shared_test_interface_run(a_w25qxx_shared_test_aging, W25QXX_SHARED_TEST_THREADS + 1);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: run threads failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    for (i = 0; i <= W25QXX_SHARED_TEST_THREADS; i++)
+    {
+        if (gs_result[i] != 0)
+        {
+            w25qxx_interface_debug_print("w25qxx: the erase was starved by the reads.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    (void)w25qxx_shared_get_stats(&gs_shared, W25QXX_SHARED_CLASS_ERASE, &stats);
+    if (stats.max_bypass > W25QXX_SHARED_MAX_BYPASS)
+    {
+        w25qxx_interface_debug_print("w25qxx: %d reads overtook the erase.\n", stats.max_bypass);
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    w25qxx_interface_debug_print("w25qxx: %d reads overtook the erase, max bypass is %d.\n",
+                                 stats.max_bypass, W25QXX_SHARED_MAX_BYPASS);
+    
+#if (W25QXX_ENABLE_ERASE_MAP == 1)
+    /* discard worker */
+    w25qxx_interface_debug_print("w25qxx: run the discard worker under reads.\n");
+    for (i = 0; i < 4096; i++)
+    {
+        gs_buf[1][i] = (uint8_t)(i + 1);
+    }
+    for (i = 0; i < W25QXX_SHARED_TEST_DISCARD; i++)
+    {
+        res = w25qxx_write(&gs_handle, gs_base + 0x10000 + i * 4096, gs_buf[1], 4096);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: write failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    res = w25qxx_erase_map_init(&gs_handle, gs_map, (gs_base + 0x10000) / 4096, W25QXX_SHARED_TEST_DISCARD, W25QXX_BOOL_FALSE);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: erase map init failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    (void)w25qxx_shared_clear_stats(&gs_shared);
+    res = w25qxx_shared_test_interface_worker_start(&gs_shared);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: start the worker failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    res = w25qxx_shared_test_interface_run(a_w25qxx_shared_test_discard, W25QXX_SHARED_TEST_THREADS);
+    for (i = 0; i < W25QXX_SHARED_TEST_THREADS; i++)
+    {
+        res |= gs_result[i];
+    }
+    pool = 0;
+    backlog = 1;
+    for (i = 0; (i < 100000) && (res == 0); i++)
+    {
+        res = a_w25qxx_shared_test_pool(&pool, &backlog);
+        if (backlog == 0)
+        {
+            break;
+        }
+    }
+    if (w25qxx_shared_test_interface_worker_stop(&gs_shared) != 0)
+    {
+        res = 1;
+    }
+    if ((res != 0) || (backlog != 0) || (pool != W25QXX_SHARED_TEST_DISCARD * 4096))
+    {
+        w25qxx_interface_debug_print("w25qxx: discard worker failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    for (i = 0; i < W25QXX_SHARED_TEST_DISCARD; i++)
+    {
+        res = w25qxx_read(&gs_handle, gs_base + 0x10000 + i * 4096, gs_buf[1], 4096);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: read failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        for (j = 0; j < 4096; j++)
+        {
+            if (gs_buf[1][j] != 0xFF)
+            {
+                w25qxx_interface_debug_print("w25qxx: discarded sector %d is not erased.\n", i);
+                (void)w25qxx_deinit(&gs_handle);
+                
+                return 1;
+            }
+        }
+    }
+    (void)w25qxx_shared_get_stats(&gs_shared, W25QXX_SHARED_CLASS_ERASE, &stats);
+    w25qxx_interface_debug_print("w25qxx: the worker erased %d discarded sectors in %d erase requests.\n",
+                                 W25QXX_SHARED_TEST_DISCARD, stats.requests);
+    (void)w25qxx_erase_map_init(&gs_handle, NULL, 0, 0, W25QXX_BOOL_FALSE);
+#endif
+    
+    /* finish shared test */
+    w25qxx_interface_debug_print("w25qxx: finish shared test.\n");
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+}
@@ -0,0 +1,140 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_shared_test.h
+ * @brief     driver w25qxx shared test header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef _DRIVER_W25QXX_SHARED_TEST_H_
+#define _DRIVER_W25QXX_SHARED_TEST_H_
+
+#include "driver_w25qxx_interface.h"
+#include "driver_w25qxx_shared.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @addtogroup w25qxx_test_driver
+ * @{
+ */
+
+/**
+ * @brief w25qxx shared test definition
+ */
+#define W25QXX_SHARED_TEST_THREADS        3         /**< threads of every class */
+#define W25QXX_SHARED_TEST_ROUNDS         8         /**< requests of every thread */
+#define W25QXX_SHARED_TEST_DISCARD        32        /**< discarded sectors */
+#define W25QXX_SHARED_TEST_STARVE         10000     /**< reads of every thread before the erase counts as starved */
+
+/**
+ * @brief shared test interface mutex lock
+ * @note  none
+ */
+void w25qxx_shared_test_interface_mutex_lock(void);
+
+/**
+ * @brief shared test interface mutex unlock
+ * @note  none
+ */
+void w25qxx_shared_test_interface_mutex_unlock(void);
+
+/**
+ * @brief shared test interface condition wait
+ * @note  releases the mutex while it sleeps
+ */
+void w25qxx_shared_test_interface_cond_wait(void);
+
+/**
+ * @brief shared test interface condition broadcast
+ * @note  none
+ */
+void w25qxx_shared_test_interface_cond_broadcast(void);
+
+/**
+ * @brief  shared test interface timestamp
+ * @return monotonic time in us
+ * @note   none
+ */
+uint64_t w25qxx_shared_test_interface_timestamp_us(void);
+
+/**
+ * @brief     shared test interface run threads
+ * @param[in] *entry points to the thread function, called with the thread index
+ * @param[in] num is the thread number
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      returns when every thread finished
+ */
+uint8_t w25qxx_shared_test_interface_run(void (*entry)(uint32_t index), uint32_t num);
+
+/**
+ * @brief     shared test interface start the discard worker
+ * @param[in] *shared points to an inited w25qxx shared structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 start failed
+ * @note      runs w25qxx_shared_discard_worker on its own thread
+ */
+uint8_t w25qxx_shared_test_interface_worker_start(w25qxx_shared_t *shared);
+
+/**
+ * @brief     shared test interface stop the discard worker
+ * @param[in] *shared points to the w25qxx shared structure of the worker
+ * @return    status code of w25qxx_shared_discard_worker
+ * @note      returns when the worker thread finished
+ */
+uint8_t w25qxx_shared_test_interface_worker_stop(w25qxx_shared_t *shared);
+
+/**
+ * @brief     shared test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+uint8_t w25qxx_shared_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
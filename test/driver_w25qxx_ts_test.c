@@ -0,0 +1,382 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_ts_test.c
+ * @brief     driver w25qxx ts test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_ts_test.h"
+
+static w25qxx_handle_t gs_handle;                                      /**< w25qxx handle */
+static w25qxx_ts_t gs_ts;                                              /**< w25qxx ts */
+static w25qxx_ts_sector_t gs_sector[W25QXX_TS_TEST_SECTORS];           /**< w25qxx ts sector index */
+static w25qxx_ts_sample_t gs_samples[W25QXX_TS_TEST_SECTORS * W25QXX_TS_SECTOR_SAMPLES];    /**< query buffer */
+static w25qxx_ts_bucket_t gs_bucket[W25QXX_TS_TEST_SECTORS * W25QXX_TS_SECTOR_PAGES];       /**< bucket buffer */
+
+/**
+ * @brief     ts test get the timestamp of a sample
+ * @param[in] index is the sample index
+ * @return    timestamp
+ * @note      none
+ */
+static uint32_t a_w25qxx_ts_test_time(uint32_t index)
+{
+    return 1000 + index * 3;
+}
+
+/**
+ * @brief     ts test get the value of a sample
+ * @param[in] index is the sample index
+ * @return    value
+ * @note      none
+ */
+static float a_w25qxx_ts_test_value(uint32_t index)
+{
+    return (float)(index % 1000);
+}
+
+/**
+ * @brief     ts test check a time range
+ * @param[in] first is the first sample index of the range
+ * @param[in] end is the last sample index of the range
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      the range bounds are moved off the sample timestamps
+ */
+static uint8_t a_w25qxx_ts_test_range(uint32_t first, uint32_t end)
+{
+    uint32_t num;
+    uint32_t i;
+    
+    if (w25qxx_ts_query(&gs_ts, a_w25qxx_ts_test_time(first) - 1, a_w25qxx_ts_test_time(end) + 1, 
+                        gs_samples, sizeof(gs_samples) / sizeof(gs_samples[0]), &num) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: ts query failed.\n");
+        
+        return 1;
+    }
+    if (num != end - first + 1)
+    {
+        w25qxx_interface_debug_print("w25qxx: ts query returns %d samples, not %d.\n", num, end - first + 1);
+        
+        return 1;
+    }
+    for (i = 0; i < num; i++)
+    {
+        if ((gs_samples[i].timestamp != a_w25qxx_ts_test_time(first + i)) || 
+            (gs_samples[i].value != a_w25qxx_ts_test_value(first + i)))
+        {
+            w25qxx_interface_debug_print("w25qxx: ts sample %d is wrong.\n", first + i);
+            
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     ts test check the whole store
+ * @param[in] last is the last sample index
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      the store holds a contiguous run of the newest samples
+ */
+static uint8_t a_w25qxx_ts_test_check(uint32_t last)
+{
+    uint32_t num;
+    uint32_t first;
+    uint32_t count;
+    uint32_t i;
+    uint32_t k;
+    float min;
+    float max;
+    
+    /* everything */
+    if (w25qxx_ts_query(&gs_ts, 0, 0xFFFFFFFEU, gs_samples, 
+                        sizeof(gs_samples) / sizeof(gs_samples[0]), &num) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: ts query failed.\n");
+        
+        return 1;
+    }
+    if (num == 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: ts is empty.\n");
+        
+        return 1;
+    }
+    first = (gs_samples[0].timestamp - 1000) / 3;
+    if (first + num - 1 != last)
+    {
+        w25qxx_interface_debug_print("w25qxx: ts ends at %d, not %d.\n", first + num - 1, last);
+        
+        return 1;
+    }
+    
+    /* ranges inside the store */
+    if ((a_w25qxx_ts_test_range(first, first) != 0) || 
+        (a_w25qxx_ts_test_range(first + 31, first + 33) != 0) || 
+        (a_w25qxx_ts_test_range(first + (last - first) / 3, last - (last - first) / 3) != 0) || 
+        (a_w25qxx_ts_test_range(last - 100, last) != 0))
+    {
+        return 1;
+    }
+    
+    /* the buckets cover the same samples without reading them */
+    if (w25qxx_ts_downsample(&gs_ts, 0, 0xFFFFFFFEU, gs_bucket, 
+                             sizeof(gs_bucket) / sizeof(gs_bucket[0]), &num) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: ts downsample failed.\n");
+        
+        return 1;
+    }
+    count = first;
+    for (i = 0; i < num; i++)
+    {
+        if ((gs_bucket[i].first_ts != a_w25qxx_ts_test_time(count)) || (gs_bucket[i].count == 0))
+        {
+            w25qxx_interface_debug_print("w25qxx: ts bucket %d starts wrong.\n", i);
+            
+            return 1;
+        }
+        min = a_w25qxx_ts_test_value(count);
+        max = min;
+        for (k = count; k < count + gs_bucket[i].count; k++)
+        {
+            min = (a_w25qxx_ts_test_value(k) < min) ? a_w25qxx_ts_test_value(k) : min;
+            max = (a_w25qxx_ts_test_value(k) > max) ? a_w25qxx_ts_test_value(k) : max;
+        }
+        if ((gs_bucket[i].min != min) || (gs_bucket[i].max != max))
+        {
+            w25qxx_interface_debug_print("w25qxx: ts bucket %d is wrong.\n", i);
+            
+            return 1;
+        }
+        count = k;
+    }
+    if (count != last + 1)
+    {
+        w25qxx_interface_debug_print("w25qxx: ts buckets end at %d, not %d.\n", count - 1, last);
+        
+        return 1;
+    }
+    w25qxx_interface_debug_print("w25qxx: ts holds samples %d - %d in %d buckets.\n", first, last, num);
+    
+    return 0;
+}
+
+/**
+ * @brief     ts test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+uint8_t w25qxx_ts_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    uint8_t res;
+    uint32_t i;
+    uint32_t j;
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    
+    /* set chip type */
+    res = w25qxx_set_type(&gs_handle, type);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set type failed.\n");
+       
+        return 1;
+    }
+    
+    /* set chip interface */
+    res = w25qxx_set_interface(&gs_handle, interface);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set interface failed.\n");
+       
+        return 1;
+    }
+    
+    /* set dual quad spi */
+    res = w25qxx_set_dual_quad_spi(&gs_handle, dual_quad_spi_enable);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set dual quad spi failed.\n");
+       
+        return 1;
+    }
+    
+    /* chip init */
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    
+    /* start ts test */
+    w25qxx_interface_debug_print("w25qxx: start ts test.\n");
+    
+    /* the test region is reused, start from an erased one */
+    for (i = 0; i < W25QXX_TS_TEST_SECTORS; i++)
+    {
+        res = w25qxx_sector_erase_4k(&gs_handle, i * 4096);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: sector erase 4k failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    
+    /* append more samples than the store holds */
+    w25qxx_interface_debug_print("w25qxx: append %d samples.\n", W25QXX_TS_TEST_SAMPLES);
+    res = w25qxx_ts_mount(&gs_handle, &gs_ts, gs_sector, 0, W25QXX_TS_TEST_SECTORS);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: ts mount failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    for (i = 0; i < W25QXX_TS_TEST_SAMPLES; i++)
+    {
+        res = w25qxx_ts_append(&gs_ts, a_w25qxx_ts_test_time(i), a_w25qxx_ts_test_value(i));
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: ts append failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    res = w25qxx_ts_flush(&gs_ts);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: ts flush failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (a_w25qxx_ts_test_check(W25QXX_TS_TEST_SAMPLES - 1) != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* an older timestamp is rejected */
+    if (w25qxx_ts_append(&gs_ts, a_w25qxx_ts_test_time(0), 0.0f) != 4)
+    {
+        w25qxx_interface_debug_print("w25qxx: ts accepts an older timestamp.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* remount, check and append again, partial pages keep filling */
+    w25qxx_interface_debug_print("w25qxx: remount, check and append.\n");
+    for (i = W25QXX_TS_TEST_SAMPLES; i < W25QXX_TS_TEST_SAMPLES + 24 * 37; i += 37)
+    {
+        (void)w25qxx_ts_unmount(&gs_ts);
+        res = w25qxx_ts_mount(&gs_handle, &gs_ts, gs_sector, 0, W25QXX_TS_TEST_SECTORS);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: ts mount failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        if (a_w25qxx_ts_test_check(i - 1) != 0)
+        {
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        for (j = i; j < i + 37; j++)
+        {
+            res = w25qxx_ts_append(&gs_ts, a_w25qxx_ts_test_time(j), a_w25qxx_ts_test_value(j));
+            if (res)
+            {
+                w25qxx_interface_debug_print("w25qxx: ts append failed.\n");
+                (void)w25qxx_deinit(&gs_handle);
+                
+                return 1;
+            }
+        }
+    }
+    
+    /* unflushed samples are seen by both query and downsample */
+    w25qxx_interface_debug_print("w25qxx: check the unflushed samples.\n");
+    j = W25QXX_TS_TEST_SAMPLES + 24 * 37;
+    do
+    {
+        res = w25qxx_ts_append(&gs_ts, a_w25qxx_ts_test_time(j), a_w25qxx_ts_test_value(j));
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: ts append failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        j++;
+    } while (gs_ts.fill == gs_ts.programmed);
+    if (a_w25qxx_ts_test_check(j - 1) != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    (void)w25qxx_ts_unmount(&gs_ts);
+    
+    /* finish ts test */
+    w25qxx_interface_debug_print("w25qxx: finish ts test.\n");
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+}
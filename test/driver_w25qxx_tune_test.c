@@ -0,0 +1,221 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_tune_test.c
+ * @brief     driver w25qxx tune test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_tune_test.h"
+
+static w25qxx_handle_t gs_handle;        /**< w25qxx handle */
+static uint8_t gs_pattern[256];          /**< pattern page */
+static const uint32_t gsc_size[] =
+{
+    0x100000, 0x200000, 0x400000, 0x800000, 0x1000000, 0x2000000,
+};                                       /**< chip size */
+
+/**
+ * @brief     tune test check the pattern
+ * @param[in] addr is the pattern address
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      none
+ */
+static uint8_t a_w25qxx_tune_test_check(uint32_t addr)
+{
+    uint8_t buf[256];
+    
+    if ((w25qxx_read(&gs_handle, addr, buf, 256) != 0) || (memcmp(buf, gs_pattern, 256) != 0))
+    {
+        return 1;
+    }
+    if ((w25qxx_fast_read(&gs_handle, addr, buf, 256) != 0) || (memcmp(buf, gs_pattern, 256) != 0))
+    {
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     tune test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+uint8_t w25qxx_tune_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+    uint8_t res;
+    uint32_t i;
+    uint32_t addr;
+    w25qxx_qspi_read_dummy_t dummy;
+    w25qxx_qspi_read_dummy_t init_dummy;
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    
+    /* set chip type */
+    res = w25qxx_set_type(&gs_handle, type);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set type failed.\n");
+       
+        return 1;
+    }
+    
+    /* set chip interface */
+    res = w25qxx_set_interface(&gs_handle, interface);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set interface failed.\n");
+       
+        return 1;
+    }
+    
+    /* set dual quad spi */
+    res = w25qxx_set_dual_quad_spi(&gs_handle, dual_quad_spi_enable);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set dual quad spi failed.\n");
+       
+        return 1;
+    }
+    
+    /* chip init */
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    
+    /* start tune test */
+    w25qxx_interface_debug_print("w25qxx: start tune test.\n");
+    
+    /* spi has no read dummy setting */
+    if (interface == W25QXX_INTERFACE_SPI)
+    {
+        if (w25qxx_tune_read_dummy(&gs_handle, 0, &dummy) != 4)
+        {
+            w25qxx_interface_debug_print("w25qxx: spi interface is not rejected.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+        w25qxx_interface_debug_print("w25qxx: spi interface keeps the fixed read dummy.\n");
+        w25qxx_interface_debug_print("w25qxx: finish tune test.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 0;
+    }
+    
+    /* pattern in the last sector */
+    addr = gsc_size[type - W25Q80] - 4096;
+    for (i = 0; i < 256; i++)
+    {
+        gs_pattern[i] = (uint8_t)((i * 7) ^ (i >> 3) ^ 0x5A);
+    }
+    if ((w25qxx_sector_erase_4k(&gs_handle, addr) != 0) || (w25qxx_page_program(&gs_handle, addr, gs_pattern, 256) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: write pattern failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* an erased page can't show a shifted read */
+    if (w25qxx_tune_read_dummy(&gs_handle, addr + 256, &dummy) != 5)
+    {
+        w25qxx_interface_debug_print("w25qxx: erased page is not rejected.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* tune */
+    res = w25qxx_tune_read_dummy(&gs_handle, addr, &dummy);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: tune read dummy failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    w25qxx_interface_debug_print("w25qxx: tuned read dummy is %d clocks.\n", dummy * 2 + 2);
+    if (a_w25qxx_tune_test_check(addr) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: read with the tuned dummy failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* the next init uses the tuned dummy */
+    (void)w25qxx_deinit(&gs_handle);
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    (void)w25qxx_get_init_read_dummy(&gs_handle, &init_dummy);
+    if ((init_dummy != dummy) || (a_w25qxx_tune_test_check(addr) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: init with the tuned dummy failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    w25qxx_interface_debug_print("w25qxx: init uses the tuned dummy.\n");
+    
+    /* clean up */
+    (void)w25qxx_sector_erase_4k(&gs_handle, addr);
+    
+    /* finish tune test */
+    w25qxx_interface_debug_print("w25qxx: finish tune test.\n");
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+}
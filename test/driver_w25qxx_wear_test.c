@@ -0,0 +1,369 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_w25qxx_wear_test.c
+ * @brief     driver w25qxx wear test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2021-07-15
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2021/07/15  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_w25qxx_wear_test.h"
+
+#if (W25QXX_ENABLE_WEAR == 1)
+
+static w25qxx_handle_t gs_handle;                                  /**< w25qxx handle */
+static w25qxx_wear_t gs_wear;                                      /**< w25qxx wear */
+static uint32_t gs_count[W25QXX_WEAR_TEST_SECTORS];                /**< erase counters */
+static uint32_t gs_expect[W25QXX_WEAR_TEST_SECTORS];               /**< expected counters */
+static const uint32_t gsc_size[] =
+{
+    0x100000, 0x200000, 0x400000, 0x800000, 0x1000000, 0x2000000,
+};                                                                 /**< chip size */
+
+/**
+ * @brief     wear test reload the table
+ * @param[in] *expect points to the expected counters, NULL means all zero
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      the table is filled with garbage before the load
+ */
+static uint8_t a_w25qxx_wear_test_reload(const uint32_t *expect)
+{
+    uint32_t i;
+    
+    (void)w25qxx_wear_deinit(&gs_wear);
+    memset(gs_count, 0xAA, sizeof(gs_count));
+    if (w25qxx_wear_init(&gs_handle, &gs_wear, gs_count, W25QXX_WEAR_TEST_FIRST,
+                         W25QXX_WEAR_TEST_SECTORS, 0) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: wear init failed.\n");
+        
+        return 1;
+    }
+    for (i = 0; i < W25QXX_WEAR_TEST_SECTORS; i++)
+    {
+        if (gs_count[i] != ((expect != NULL) ? expect[i] : 0))
+        {
+            w25qxx_interface_debug_print("w25qxx: sector %d count %d is wrong.\n",
+                                         W25QXX_WEAR_TEST_FIRST + i, gs_count[i]);
+            
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  wear test check the live counters
+ * @return status code
+ *         - 0 success
+ *         - 1 check failed
+ * @note   none
+ */
+static uint8_t a_w25qxx_wear_test_check(void)
+{
+    if (memcmp(gs_count, gs_expect, sizeof(gs_count)) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: wear count check failed.\n");
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     wear test corrupt the latest saved copy
+ * @return    status code
+ *            - 0 success
+ *            - 1 corrupt failed
+ * @note      clears the low byte of the first counter, the counts crc no longer matches
+ */
+static uint8_t a_w25qxx_wear_test_corrupt(void)
+{
+    uint8_t zero;
+    
+    zero = 0x00;
+    if (w25qxx_page_program(&gs_handle, gs_wear.region + gs_wear.slot * gs_wear.slot_size + 256, &zero, 1) != 0)
+    {
+        w25qxx_interface_debug_print("w25qxx: page program failed.\n");
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+#endif
+
+/**
+ * @brief     wear test
+ * @param[in] type is the chip type
+ * @param[in] interface is the chip interface
+ * @param[in] dual_quad_spi_enable is a bool value
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      W25QXX_ENABLE_WEAR must be 1
+ */
+uint8_t w25qxx_wear_test(w25qxx_type_t type, w25qxx_interface_t interface, w25qxx_bool_t dual_quad_spi_enable)
+{
+#if (W25QXX_ENABLE_WEAR == 1)
+    uint8_t res;
+    uint32_t i;
+    uint32_t sectors;
+    uint32_t state[W25QXX_WEAR_TEST_SECTORS];
+    uint32_t sector[3];
+    uint32_t count[3];
+    w25qxx_wear_report_t report;
+    
+    /* link interface function */
+    DRIVER_W25QXX_LINK_INIT(&gs_handle, w25qxx_handle_t);
+    DRIVER_W25QXX_LINK_SPI_QSPI_INIT(&gs_handle, w25qxx_interface_spi_qspi_init);
+    DRIVER_W25QXX_LINK_SPI_QSPI_DEINIT(&gs_handle, w25qxx_interface_spi_qspi_deinit);
+    DRIVER_W25QXX_LINK_SPI_QSPI_WRITE_READ(&gs_handle, w25qxx_interface_spi_qspi_write_read);
+    DRIVER_W25QXX_LINK_DELAY_MS(&gs_handle, w25qxx_interface_delay_ms);
+    DRIVER_W25QXX_LINK_DELAY_US(&gs_handle, w25qxx_interface_delay_us);
+    DRIVER_W25QXX_LINK_DEBUG_PRINT(&gs_handle, w25qxx_interface_debug_print);
+    
+    /* set chip type */
+    res = w25qxx_set_type(&gs_handle, type);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set type failed.\n");
+       
+        return 1;
+    }
+    
+    /* set chip interface */
+    res = w25qxx_set_interface(&gs_handle, interface);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set interface failed.\n");
+       
+        return 1;
+    }
+    
+    /* set dual quad spi */
+    res = w25qxx_set_dual_quad_spi(&gs_handle, dual_quad_spi_enable);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: set dual quad spi failed.\n");
+       
+        return 1;
+    }
+    
+    /* chip init */
+    res = w25qxx_init(&gs_handle);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: init failed.\n");
+       
+        return 1;
+    }
+    
+    /* start wear test */
+    w25qxx_interface_debug_print("w25qxx: start wear test.\n");
+    
+    /* the region is reused, start from an erased one */
+    for (i = 0; i < w25qxx_wear_region_size(W25QXX_WEAR_TEST_SECTORS); i += 4096)
+    {
+        res = w25qxx_sector_erase_4k(&gs_handle, i);
+        if (res)
+        {
+            w25qxx_interface_debug_print("w25qxx: sector erase 4k failed.\n");
+            (void)w25qxx_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+    
+    /* ranges past the chip end are rejected */
+    w25qxx_interface_debug_print("w25qxx: check the range rejection.\n");
+    sectors = gsc_size[type - W25Q80] / 4096;
+    if ((w25qxx_wear_init(&gs_handle, &gs_wear, gs_count, sectors - 8, W25QXX_WEAR_TEST_SECTORS, 0) != 4) ||
+        (w25qxx_wear_init(&gs_handle, &gs_wear, gs_count, sectors, 1, 0) != 4) ||
+        (w25qxx_wear_init(&gs_handle, &gs_wear, gs_count, W25QXX_WEAR_TEST_FIRST, 
+                          W25QXX_WEAR_TEST_SECTORS, gsc_size[type - W25Q80] - 4096) != 4))
+    {
+        w25qxx_interface_debug_print("w25qxx: wear range check failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* start from an empty table */
+    res = w25qxx_wear_init(&gs_handle, &gs_wear, gs_count, W25QXX_WEAR_TEST_FIRST, W25QXX_WEAR_TEST_SECTORS, 0);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: wear init failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    memset(gs_expect, 0, sizeof(gs_expect));
+    if (a_w25qxx_wear_test_check() != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* count 4k and 32k erases, the untracked sector is ignored */
+    w25qxx_interface_debug_print("w25qxx: count the erases.\n");
+    res = 0;
+    for (i = 0; i < 3; i++)
+    {
+        res |= w25qxx_sector_erase_4k(&gs_handle, (W25QXX_WEAR_TEST_FIRST + 0) * 4096);
+    }
+    res |= w25qxx_sector_erase_4k(&gs_handle, (W25QXX_WEAR_TEST_FIRST + 1) * 4096);
+    res |= w25qxx_block_erase_32k(&gs_handle, (W25QXX_WEAR_TEST_FIRST + 8) * 4096);
+    res |= w25qxx_sector_erase_4k(&gs_handle, (W25QXX_WEAR_TEST_FIRST + W25QXX_WEAR_TEST_SECTORS) * 4096);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: erase failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    gs_expect[0] = 3;
+    gs_expect[1] = 1;
+    for (i = 8; i < 16; i++)
+    {
+        gs_expect[i] = 1;
+    }
+    if (a_w25qxx_wear_test_check() != 0)
+    {
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    res = w25qxx_wear_hottest(&gs_wear, sector, count, 3);
+    if ((res != 0) || (sector[0] != W25QXX_WEAR_TEST_FIRST) || (count[0] != 3) || (count[1] != 1) || (count[2] != 1))
+    {
+        w25qxx_interface_debug_print("w25qxx: wear hottest check failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    res = w25qxx_wear_report(&gs_wear, W25QXX_WEAR_ENDURANCE, 0, &report);
+    if ((res != 0) || (report.total != 12) || (report.max != 3) || (report.min != 0) ||
+        (report.remaining != W25QXX_WEAR_ENDURANCE - 3))
+    {
+        w25qxx_interface_debug_print("w25qxx: wear report check failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* the saved table survives a reinit */
+    w25qxx_interface_debug_print("w25qxx: save and reload the table.\n");
+    res = w25qxx_wear_save(&gs_wear);
+    if (res)
+    {
+        w25qxx_interface_debug_print("w25qxx: wear save failed.\n");
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    if (a_w25qxx_wear_test_reload(gs_expect) != 0)
+    {
+        (void)w25qxx_wear_deinit(&gs_wear);
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    memcpy(state, gs_expect, sizeof(state));
+    
+    /* sync only saves after enough erases */
+    w25qxx_interface_debug_print("w25qxx: check the sync interval.\n");
+    res = w25qxx_sector_erase_4k(&gs_handle, (W25QXX_WEAR_TEST_FIRST + 2) * 4096);
+    res |= w25qxx_sector_erase_4k(&gs_handle, (W25QXX_WEAR_TEST_FIRST + 2) * 4096);
+    res |= w25qxx_wear_sync(&gs_wear, 4);
+    if ((res != 0) || (a_w25qxx_wear_test_reload(state) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: wear sync check failed.\n");
+        (void)w25qxx_wear_deinit(&gs_wear);
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    res = w25qxx_sector_erase_4k(&gs_handle, (W25QXX_WEAR_TEST_FIRST + 2) * 4096);
+    res |= w25qxx_sector_erase_4k(&gs_handle, (W25QXX_WEAR_TEST_FIRST + 2) * 4096);
+    res |= w25qxx_wear_sync(&gs_wear, 2);
+    gs_expect[2] = 2;
+    if ((res != 0) || (a_w25qxx_wear_test_reload(gs_expect) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: wear sync check failed.\n");
+        (void)w25qxx_wear_deinit(&gs_wear);
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* a corrupted copy is rejected and the older one is used */
+    w25qxx_interface_debug_print("w25qxx: corrupt the latest copy.\n");
+    if ((a_w25qxx_wear_test_corrupt() != 0) || (a_w25qxx_wear_test_reload(state) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: wear crc check failed.\n");
+        (void)w25qxx_wear_deinit(&gs_wear);
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* no valid copy clears the table */
+    w25qxx_interface_debug_print("w25qxx: corrupt the older copy.\n");
+    if ((a_w25qxx_wear_test_corrupt() != 0) || (a_w25qxx_wear_test_reload(NULL) != 0))
+    {
+        w25qxx_interface_debug_print("w25qxx: wear crc check failed.\n");
+        (void)w25qxx_wear_deinit(&gs_wear);
+        (void)w25qxx_deinit(&gs_handle);
+        
+        return 1;
+    }
+    (void)w25qxx_wear_deinit(&gs_wear);
+    
+    /* finish wear test */
+    w25qxx_interface_debug_print("w25qxx: finish wear test.\n");
+    (void)w25qxx_deinit(&gs_handle);
+    
+    return 0;
+#else
+    (void)type;
+    (void)interface;
+    (void)dual_quad_spi_enable;
+    w25qxx_interface_debug_print("w25qxx: wear is disabled.\n");
+    
+    return 1;
+#endif
+}